@@ -152,6 +152,9 @@ class OBConversion; //used only as pointer
       //! Electronic transition data (e.g., UV/Vis, excitation energies, etc.)
       ElectronicTransitionData = 29,
 
+      //! Cached results of perception algorithms (e.g., graph symmetry classes)
+      PerceptionData =    30,
+
       // space for up to 2^14 more entries...
 
       //! Custom (user-defined data)
@@ -170,6 +170,10 @@ namespace OpenBabel
       static std::vector<std::pair<OBSmartsPattern*, std::vector<vector3> > > _ring_fragments;
       static std::map<std::string, int> _rigid_fragments_index;
       static std::map<std::string, std::vector<vector3> > _rigid_fragments_cache;
+      //! invariants of the ring fragments, used to skip impossible SMARTS matches
+      static std::vector<std::vector<unsigned int> > _ring_fragments_keys;
+      //! indexes of the ring fragments matching a fragment (by canonical SMILES)
+      static std::map<std::string, std::vector<unsigned int> > _ring_fragments_matches;
       //! Connect a ring fragment to an already matched fragment. Currently only
       //  supports the case where the fragments overlap at a spiro atom only.
       static void ConnectFrags(OBMol &mol, OBMol &workmol, std::vector<int> match, std::vector<vector3> coords,
@@ -28,6 +28,7 @@ GNU General Public License for more details.
 #include <vector>
 #include <string>
 #include <cstring>
+#include <atomic>
 
 namespace OpenBabel
 {
@@ -44,11 +45,16 @@ namespace OpenBabel
       -# Checks for the directory _dir (def. determined by the build environment)
       - Tries the subdirectory corresponding to this version, then the main directory
       -# Reverts to the compiled-in default data
+
+      Init() may be called from several threads at once: the first caller
+      reads the data while the others wait, and the table is only marked
+      as read once it is complete. After that the tables are not changed,
+      so that the global instances can be shared between threads.
   **/
   class OBAPI OBGlobalDataBase
     {
     protected:
-      bool         _init;		//!< Whether the data been read already
+      std::atomic<bool> _init;	//!< Whether the data been read already
       const char  *_dataptr;//!< Default data table if file is unreadable
       std::string  _filename;//!< File to search for
       std::string  _dir;		//!< Data directory for file if _envvar fails
@@ -58,6 +64,21 @@ namespace OpenBabel
     public:
       //! Constructor
       OBGlobalDataBase(): _init(false), _dataptr(nullptr) { }
+      //! Copy constructor
+      OBGlobalDataBase(const OBGlobalDataBase &other): _init(other._init.load()),
+        _dataptr(other._dataptr), _filename(other._filename), _dir(other._dir),
+        _subdir(other._subdir), _envvar(other._envvar) { }
+      //! Assignment
+      OBGlobalDataBase &operator=(const OBGlobalDataBase &other)
+        {
+          _init = other._init.load();
+          _dataptr = other._dataptr;
+          _filename = other._filename;
+          _dir = other._dir;
+          _subdir = other._subdir;
+          _envvar = other._envvar;
+          return *this;
+        }
       //! Destructor
       virtual ~OBGlobalDataBase()                  {}
       //! Read in the data file, falling back as needed
@@ -187,7 +208,6 @@ namespace OpenBabel
     {
       int             _linecount;
       unsigned int    _ncols,_nrows;
-      int             _from,_to;
       std::vector<std::string> _colnames;
       std::vector<std::vector<std::string> > _table;
 
@@ -201,7 +221,8 @@ namespace OpenBabel
       //! \return the number of atom types in the translation table
       size_t GetSize() { return _table.size(); }
 
-      //! Set the initial atom type to be translated
+      //! Set the initial atom type to be translated. The types chosen with
+      //! SetFromType() and SetToType() are kept separately for each thread.
       bool SetFromType(const char*);
       //! Set the destination atom type for translation
       bool SetToType(const char*);
@@ -231,7 +252,6 @@ namespace OpenBabel
   **/
   class OBAPI OBResidueData : public OBGlobalDataBase
     {
-      int                                               _resnum;
       std::vector<std::string>                          _resname;
       std::vector<std::vector<std::string> >            _resatoms;
       std::vector<std::vector<std::pair<std::string,int> > > _resbonds;
@@ -248,7 +268,7 @@ namespace OpenBabel
       size_t GetSize() { return _resname.size(); }
 
       //! Sets the table to access the residue information for a specified
-      //!  residue name
+      //!  residue name (the residue is kept separately for each thread)
       //! \return whether this residue name is in the table
       bool SetResName(const std::string &);
       //! \return the bond order for the bond specified in the current residue
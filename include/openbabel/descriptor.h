@@ -22,9 +22,13 @@ GNU General Public License for more details.
 #include <string>
 #include <sstream>
 #include <limits>
+#include <map>
+#include <unordered_map>
+#include <vector>
 
 #include <openbabel/babelconfig.h>
 #include <openbabel/plugin.h>
+#include <openbabel/base.h>
 
 namespace OpenBabel
 {
@@ -48,6 +52,11 @@ public:
   ///Provides a string value for non-numeric descriptors and returns NaN, or a string representation and returns a numeric value
   virtual double GetStringValue(OBBase* pOb, std::string& svalue, std::string* param=nullptr);
 
+  /// As GetStringValue(), but numeric values are memoized on the object (see OBDescriptorData)
+  /// and are calculated again only if its structure has changed
+  /// \since version 3.2
+  double GetCachedValue(OBBase* pOb, std::string& svalue, std::string* param=nullptr);
+
   ///Parses the filter stream for a relational expression and returns its result when applied to the chemical object
   virtual bool Compare(OBBase* pOb, std::istream& ss, bool noEval, std::string* param=nullptr);
 
@@ -99,6 +108,106 @@ protected:
   static bool MatchPairData(OBBase* pOb, std::string& s);
 };
 
+/// \class OBDescriptorData descriptor.h <openbabel/descriptor.h>
+/// \brief Descriptor values memoized on a molecule, and the work shared between descriptors
+/// The values are stored with a key of the structure (elements, isotopes, charges,
+/// hydrogens and bonds) and are only returned while it still matches the molecule.
+/// Between BeginSharing() and EndSharing() descriptors can also keep intermediate
+/// results here for the others, e.g. the molecule with explicit hydrogens and the
+/// SMARTS matches of the group contribution descriptors.
+/// The data is copied along with the molecule (without the intermediate results)
+/// and is not written to output files.
+/// \since version 3.2
+class OBAPI OBDescriptorData : public OBGenericData
+{
+public:
+  OBDescriptorData();
+  OBDescriptorData(const OBDescriptorData& other);
+  virtual ~OBDescriptorData();
+  virtual OBGenericData* Clone(OBBase* /*parent*/) const { return new OBDescriptorData(*this); }
+
+  /// \return the data of a molecule, which is added if necessary and create is true,
+  /// or nullptr for other objects
+  static OBDescriptorData* Get(OBBase* pOb, bool create=true);
+
+  /// \return true and the value if it was stored for the current structure of pOb
+  bool GetValue(OBBase* pOb, const std::string& key, double& val, std::string& svalue);
+  void SetValue(OBBase* pOb, const std::string& key, double val, const std::string& svalue);
+
+  /// Calls can be nested; the intermediate results are deleted by the last EndSharing()
+  void BeginSharing() { ++_sharing; }
+  void EndSharing();
+  bool IsSharing() const { return _sharing > 0; }
+
+  /// \return a shared object, or nullptr. It is deleted by EndSharing().
+  OBBase* GetShared(const std::string& key) const;
+  /// Stores an object made by a descriptor, which is then owned by this data
+  void SetShared(const std::string& key, OBBase* pOb);
+
+  /// \return the shared SMARTS matches stored with the key; found is false
+  /// when they are new and still have to be filled in
+  std::vector<std::vector<int> >& GetMatches(const std::string& key, bool& found);
+
+private:
+  //! Check the stored structure key against pOb, clears all the values if it does not match
+  bool Validate(OBBase* pOb);
+
+  std::vector<unsigned int> _key; //!< structure key of the molecule the values belong to
+  std::map<std::string, std::pair<double, std::string> > _values;
+  int _sharing;
+  std::map<std::string, OBBase*> _shared;
+  std::unordered_map<std::string, std::vector<std::vector<int> > > _matches;
+};
+
+/// \class OBDescriptorBatch descriptor.h <openbabel/descriptor.h>
+/// \brief Evaluates a list of descriptors on each molecule in one pass
+/// The descriptors share intermediate results through OBDescriptorData and their
+/// numeric values are memoized on the molecule, so later uses of the same descriptors
+/// (e.g. in --filter or --sort) are not calculated again. The time spent in each
+/// descriptor is accumulated over all the calls of Evaluate().
+/// \code
+/// OBDescriptorBatch batch("logP TPSA MR MW HBD HBA1 rotors");
+/// vector<double> values;
+/// vector<string> svalues;
+/// while(conv.Read(&mol))
+///   batch.Evaluate(&mol, values, svalues);
+/// for(unsigned i=0; i<batch.Size(); ++i)
+///   cout << batch.GetID(i) << ' ' << batch.GetTime(i) << endl;
+/// \endcode
+/// \since version 3.2
+class OBAPI OBDescriptorBatch
+{
+public:
+  /// \param DescrList descriptor IDs, each optionally followed by a parameter
+  /// in parentheses, separated by spaces or commas, as in the --append option.
+  /// IDs which are not descriptors are reported and skipped.
+  OBDescriptorBatch(const std::string& DescrList);
+
+  unsigned int Size() const { return _items.size(); }
+  const std::string& GetID(unsigned int i) const { return _items[i].id; }
+  OBDescriptor* GetDescriptor(unsigned int i) const { return _items[i].pDesc; }
+
+  /// Evaluates all the descriptors on the object.
+  /// values[i] is NaN for descriptors which are strings, svalues[i] is always set.
+  void Evaluate(OBBase* pOb, std::vector<double>& values, std::vector<std::string>& svalues);
+
+  /// \return the total time in seconds spent calculating the i-th descriptor
+  double GetTime(unsigned int i) const { return _items[i].time; }
+  /// \return the number of times the i-th descriptor was calculated, rather than memoized
+  unsigned int GetCount(unsigned int i) const { return _items[i].count; }
+
+private:
+  struct Item
+  {
+    std::string id;
+    std::string param;
+    OBDescriptor* pDesc;
+    double time;
+    unsigned int count;
+  };
+  std::vector<Item> _items;
+};
+
 template <class T>
 static bool DoComparison(char ch1, char ch2, T& val, T& filterval)
 {
@@ -38,6 +38,7 @@ namespace OpenBabel {
 
   class DistanceGeometryPrivate;
   class OBCisTransStereo;
+  class OBRandom;
 
   class TetrahedralInfo {
     int c;
@@ -82,7 +83,24 @@ namespace OpenBabel {
 
     void Generate();
     void AddConformer();
+    /**
+     * Generate @p numConformers embeddings from the current setup. The
+     * smoothed bounds matrix is only computed once in Setup() and shared by
+     * all embeddings, which run in parallel when OpenMP is enabled. Use
+     * GetConformers() to copy them to a molecule.
+     *
+     * \return The number of embeddings that satisfy the bounds and stereo constraints
+     */
+    unsigned int AddConformers(unsigned int numConformers);
     void GetConformers(OBMol &mol);
+    /**
+     * Copy the coordinates of the last embedding (e.g., from AddConformer())
+     * to @p mol, which must have the same atoms as the molecule used in Setup().
+     *
+     * \return True if the last embedding satisfies the bounds and stereo constraints
+     * \since version 3.2
+     */
+    bool GetLastConformer(OBMol &mol);
 
     /**
      * Check if last call to AddConformer was successful.
@@ -118,9 +136,12 @@ namespace OpenBabel {
 
     unsigned int dim;
 
-    bool generateInitialCoords();
-    bool firstMinimization();
-    bool minimizeFourthDimension();
+    bool generateInitialCoords(Eigen::VectorXd &coord, OBRandom &generator);
+    bool firstMinimization(OBMol &mol, Eigen::VectorXd &coord);
+    bool minimizeFourthDimension(OBMol &mol, Eigen::VectorXd &coord);
+    //! \brief Embed @p mol (with coordinates @p coord), retrying until the constraints are met
+    //! \return True if the embedding satisfies the bounds and stereo constraints
+    bool Embed(OBMol &mol, Eigen::VectorXd &coord, OBRandom &generator);
     
     //! \brief Set the default upper bounds for the constraint matrix
     //! Upper bounds = maximum length of the molecule, or 1/2 the body diagonal in a unit cell
@@ -151,10 +172,10 @@ namespace OpenBabel {
     void CorrectStereoConstraints(double scale = 1.0);
     //! \brief Check that the double bond and atom stereo constraints are met
     //! \return True if all constraints are valid
-    bool CheckStereoConstraints();
+    bool CheckStereoConstraints(OBMol &mol);
 
     //! \return True if the bounds are met
-    bool CheckBounds();
+    bool CheckBounds(OBMol &mol);
   };
   class DistGeomFunc {
     OBDistanceGeometry* const owner;
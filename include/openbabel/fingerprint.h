@@ -79,6 +79,36 @@ public:
     return txt;
   }
 
+  /// \brief A feature of a sparse fingerprint and the number of times it occurs
+  /// \since version 3.2
+  typedef std::pair<unsigned int, unsigned int> FeatureCount;
+
+  /// \return the unfolded features of the object with their counts, sorted by feature.
+  /// Only fingerprints made from hashed features, like ECFP and FCFP, provide these.
+  /// \since version 3.2
+  virtual bool GetCountFingerprint(OBBase* /* pOb */, std::vector<FeatureCount>& /* features */)
+  {
+    return false;
+  }
+
+  /// Folds sparse features to nbits, i.e. to feature % nbits, adding the counts of those which coincide
+  /// \since version 3.2
+  static void FoldFeatures(std::vector<FeatureCount>& features, unsigned int nbits);
+
+  /// \brief Calculates the fingerprints of several objects into one buffer.
+  /// Each fingerprint has the same number of words, and that of object i starts at buffer[i*words].
+  /// \return false if any could not be calculated; its words are then zero.
+  /// \since version 3.2
+  bool GetFingerprints(const std::vector<OBBase*>& objects, std::vector<unsigned int>& buffer,
+                       unsigned int& words, int nbits=0);
+
+  /// \brief Calculates the count fingerprints of several objects into one buffer.
+  /// The features of object i are features[offsets[i]] to features[offsets[i+1]-1].
+  /// \return false if any could not be calculated; it then has no features.
+  /// \since version 3.2
+  bool GetCountFingerprints(const std::vector<OBBase*>& objects, std::vector<FeatureCount>& features,
+                            std::vector<size_t>& offsets);
+
   /// \return the Tanimoto coefficient between two vectors (vector<unsigned int>& SeekPositions)
   static double Tanimoto(const std::vector<unsigned int>& vec1, const std::vector<unsigned int>& vec2);
 
@@ -190,9 +220,38 @@ public:
   bool    FindSimilar(OBBase* pOb, std::multimap<double, unsigned long>& SeekposMap,
     int nCandidates=0);
 
+  /// \brief Clusters all the fingerprints in the index, see ButinaCluster()
+  /// \return the number of clusters; clusters[i] is the cluster of the i-th entry
+  /// \since version 3.2
+  unsigned int Cluster(double MinTani, std::vector<unsigned int>& clusters,
+    std::vector<unsigned int>& centroids, bool leader=false);
+
+  /// \brief Finds all the pairs of fingerprints with Tanimoto coefficients of at least MinTani
+  /// The fingerprints are nEntries consecutive blocks of words in fptdata.
+  /// The neighbors of the i-th are neighbors[offsets[i]] to neighbors[offsets[i+1]-1],
+  /// in increasing order.
+  /// \since version 3.2
+  static bool FindNeighbors(const unsigned int* fptdata, unsigned int nEntries, unsigned int words,
+    double MinTani, std::vector<size_t>& offsets, std::vector<unsigned int>& neighbors);
+
+  /// \brief Butina clustering of the neighbor lists made by FindNeighbors()
+  /// The entry with most neighbors and its neighbors form the first cluster, and so on
+  /// for the remaining entries. With leader set, the entries are taken in their order
+  /// instead (leader clustering). Clusters are numbered from 1, and centroids[c-1] is
+  /// the entry at the center of cluster c.
+  /// \return the number of clusters
+  /// \since version 3.2
+  static unsigned int ButinaCluster(const std::vector<size_t>& offsets,
+    const std::vector<unsigned int>& neighbors, std::vector<unsigned int>& clusters,
+    std::vector<unsigned int>& centroids, bool leader=false);
+
   /// \return a pointer to the fingerprint type used to constuct the index
   OBFingerprint* GetFingerprint() const{ return _pFP;};
 
+  /// \return the positions in the datafile of the entries of the index
+  /// \since version 3.2
+  const std::vector<unsigned long>& GetSeekPositions() const{ return _index.seekdata;};
+
   /// \return a pointer to the index header containing size info etc.
   const FptIndexHeader& GetIndexHeader() const{ return _index.header;};
 
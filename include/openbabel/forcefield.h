@@ -530,13 +530,14 @@ const double GAS_CONSTANT = 8.31446261815324e-3 / KCAL_TO_KJ;  //!< kcal mol^-1
     bool 	_validSetup; //!< was the last call to Setup successful
     double	*_gradientPtr; //!< pointer to the gradients (used by AddGradient(), minimization functions, ...)
     // logging variables
-    std::ostream* _logos; //!< Output for logfile
+    std::ostream* _logos = nullptr; //!< Output for logfile
     char 	_logbuf[BUFF_SIZE+1]; //!< Temporary buffer for logfile output
-    int 	_loglvl; //!< Log level for output
+    int 	_loglvl = OBFF_LOGLVL_NONE; //!< Log level for output
     int 	_origLogLevel;
     // conformer genereation (rotor search) variables
     int 	_current_conformer; //!< used to hold i for current conformer (needed by UpdateConformers)
     std::vector<double> _energies; //!< used to hold the energies for all conformers
+    double 	_rotorClashFactor = -1.0; //!< steric clash threshold for rotor key pruning (0.0 = disabled, < 0.0 = default)
     // minimization variables
     double 	_econv, _gconv, _e_n1; //!< Used for conjugate gradients and steepest descent(Initialize and TakeNSteps)
     int 	_cstep, _nsteps; //!< Used for conjugate gradients and steepest descent(Initialize and TakeNSteps)
@@ -551,6 +552,7 @@ const double GAS_CONSTANT = 8.31446261815324e-3 / KCAL_TO_KJ;  //!< kcal mol^-1
     static OBFFConstraints _constraints; //!< Constraints
     static unsigned int _fixAtom; //!< SetFixAtom()/UnsetFixAtom()
     static unsigned int _ignoreAtom; //!< SetIgnoreAtom()/UnsetIgnoreAtom()
+    bool _ignoreConstraints = false; //!< SetupCalculations() without _constraints (GetGrid() probe instances)
     // cut-off variables
     bool 	_cutoff; //!< true = cut-off enabled
     double 	_rvdw; //!< VDW cut-off distance
@@ -738,6 +740,34 @@ const double GAS_CONSTANT = 8.31446261815324e-3 / KCAL_TO_KJ;  //!< kcal mol^-1
      *  \return Pointer to the grid constaining the results.
      */
     OBGridData *GetGrid(double step, double padding, const char *type, double pchg);
+    /*! Create a probe grid as above, but only include the interactions between the probe and the
+     *  atoms near a grid point. The grid is computed in blocks of about 3 A, in parallel when OpenMP
+     *  is enabled, and every point of a block sees the atoms within @p cutoff of any point of that
+     *  block. Only force fields for which SupportsFastProbeGrid() is true (MMFF94) compute the
+     *  grid this way. The others evaluate every point serially with the probe added to the
+     *  molecule, as the overload above does, and ignore @p cutoff: their grids always include
+     *  all atoms.
+     *  \param step The grid step size in A..
+     *  \param padding The padding for the grid in A.
+     *  \param type The force field atom type for the probe.
+     *  \param pchg The partial charge for the probe atom.
+     *  \param cutoff The interaction cutoff in A, 0.0 to include all atoms.
+     *  \param floatPrecision Store the values in single precision (see OBGridData::SetFloatPrecision()).
+     *  \return Pointer to the grid containing the results, or nullptr if the probe could not be set up.
+     *  \since version 3.2
+     */
+    OBGridData *GetGrid(double step, double padding, const char *type, double pchg,
+                        double cutoff, bool floatPrecision = false);
+    /*! \return Whether GetGrid() may evaluate the probe in a force field set up with the probe
+     *  and copies of the nearby atoms only, without bonds. This requires the atom types and
+     *  partial charges of the molecule to be kept as they are and the nonbonded terms not to
+     *  depend on the connectivity.
+     *  \since version 3.2
+     */
+    virtual bool SupportsFastProbeGrid() const
+    {
+      return false;
+    }
 
     /////////////////////////////////////////////////////////////////////////
     // Interacting groups                                                  //
@@ -1187,6 +1217,39 @@ const double GAS_CONSTANT = 8.31446261815324e-3 / KCAL_TO_KJ;  //!< kcal mol^-1
      * @since version 2.4
      */
     int FastRotorSearch(bool permute = true);
+    /*! Set the steric clash threshold used to prune rotor keys in SystematicRotorSearch(),
+     *  RandomRotorSearch() and WeightedRotorSearch().
+     *
+     *  Two atoms separated by more than three bonds clash when their distance is smaller
+     *  than @p factor times the sum of their van der Waals radii. Rotors are applied from
+     *  the most central to the most peripheral, so a clash between atoms that are not
+     *  moved by any of the remaining rotors can not be relieved anymore. The systematic
+     *  search skips all rotor keys sharing such a prefix, the random and weighted searches
+     *  draw another key instead (up to 10 times in a row) before the geometry optimization.
+     *  The random search then uses more random numbers, so its conformers differ from those
+     *  of an unpruned search with the same seed. Keys which are skipped are not counted
+     *  as conformers by the weighted search.
+     *
+     *  By default, only a systematic search without geometry optimization (geomSteps = 0)
+     *  is pruned, with a factor of 0.5. Its rotamers keep the rigid geometry, so a clash
+     *  can not be relieved and such a rotamer can not have the lowest energy. The pruned
+     *  rotamers are left out of the conformers and are not evaluated.
+     *
+     *  \param factor The fraction of the van der Waals radii sum, e.g. 0.5. Use 0.0 to
+     *  disable pruning, or a negative factor for the default.
+     *  \since version 3.2
+     */
+    void SetRotorClashFactor(double factor)
+    {
+      _rotorClashFactor = factor;
+    }
+    /*! \return The steric clash threshold used to prune rotor keys (see SetRotorClashFactor()).
+     *  \since version 3.2
+     */
+    double GetRotorClashFactor()
+    {
+      return _rotorClashFactor;
+    }
 
 #ifdef HAVE_EIGEN
     //! \since version 2.4
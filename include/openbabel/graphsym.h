@@ -22,8 +22,11 @@ GNU General Public License for more details.
 #define OB_GRAPHSYM_H
 
 #include <openbabel/babelconfig.h>
+#include <openbabel/base.h>
+#include <openbabel/bitvec.h>
 #include <openbabel/stereo/stereo.h>
 #include <vector>
+#include <unordered_map>
 
 #ifndef OB_EXTERN
 #  define OB_EXTERN extern
@@ -74,6 +77,60 @@ namespace OpenBabel {
       OBGraphSymPrivate * const d;
   };
 
+  /**
+   * @class OBGraphSymData graphsym.h <openbabel/graphsym.h>
+   * @brief Cached symmetry classes computed by OBGraphSym.
+   *
+   * The symmetry classes of each fragment are stored together with a key of
+   * the molecular graph (elements, formal charges, aromaticity and bonds).
+   * Cached classes are only returned while this key still matches the
+   * molecule, so changing the structure invalidates them without explicit
+   * bookkeeping in the OBMol modification methods. The entries are looked
+   * up by a hash of the fragment and at most MaxEntries fragments are kept.
+   * The data is copied along with the molecule and is not written to output
+   * files.
+   *
+   * @since version 3.2
+   */
+  class OBAPI OBGraphSymData : public OBGenericData {
+    public:
+      OBGraphSymData();
+      virtual OBGenericData* Clone(OBBase* /*parent*/) const
+      {
+        return new OBGraphSymData(*this);
+      }
+
+      /**
+       * Look up the symmetry classes of fragment @p frag_atoms in @p mol.
+       *
+       * @return The number of symmetry classes or -1 if they are not cached
+       * or no longer valid.
+       */
+      int GetSymmetry(OBMol *mol, const OBBitVec &frag_atoms,
+          std::vector<unsigned int> &symmetry_classes);
+      /**
+       * Store the symmetry classes of fragment @p frag_atoms in @p mol.
+       */
+      void SetSymmetry(OBMol *mol, const OBBitVec &frag_atoms,
+          const std::vector<unsigned int> &symmetry_classes, int nclasses);
+
+      //! The largest number of fragments kept, an arbitrary one is dropped to make room
+      static const std::size_t MaxEntries = 64;
+
+    private:
+      //! Check the stored graph key against @p mol, clears all entries if it does not match
+      bool Validate(OBMol *mol);
+
+      struct Entry {
+        OBBitVec fragment;
+        std::vector<unsigned int> symmetry_classes;
+        int nclasses;
+      };
+      std::vector<unsigned int> _key; //!< graph key of the molecule the entries belong to
+      //! Entries by fragment hash, a fragment with the same hash replaces the entry
+      std::unordered_map<std::size_t, Entry> _entries;
+  };
+
 } // namespace OpenBabel
 
 #endif // OB_GRAPHSYM_H
@@ -92,6 +92,9 @@ namespace OpenBabel {
     bool GetUnrestricted() const;
     /// \return the number of symmetries.
     int GetNumSymmetries() const;
+    /// \return true if the values are stored in single precision.
+    /// \since version 3.2
+    bool GetFloatPrecision() const;
     //@}
 
 
@@ -113,12 +116,20 @@ namespace OpenBabel {
     bool SetValue(int i, int j, int k, double val);
     /// Set the values, this vector must match the dimensions of the grid
     void SetValues(const std::vector< double >& v);
+    /// Set the values from single precision data, e.g. as read from a file
+    /// for a grid that uses SetFloatPrecision(true)
+    /// \since version 3.2
+    void SetValues(const std::vector< float >& v);
     /// Set the unit of measure
     void SetUnit(Unit u);
     /// Set the unrestricted flag
     void SetUnrestricted(bool u);
     /// Set the number of symmetries
     void SetNumSymmetries(int s);
+    /// Store the values as floats rather than doubles, halving the memory
+    /// needed for large grids. Any values already set are converted.
+    /// \since version 3.2
+    void SetFloatPrecision(bool f);
     //@}
 
   private:
@@ -100,7 +100,11 @@ namespace OpenBabel {
        * Get a pointer to an instance of the specified @p algorithm. This pointer
        * has to be delted when the instance is no longer needed.
        * @param query The search query to be mapped.
-       * @param algorithm The algorithm for the mapper.
+       * @param algorithm The algorithm for the mapper. Available algorithms are
+       * "VF2" and "VF2++" (since version 3.2). The latter precomputes candidate
+       * bitsets for each query atom and matches the query atoms in a fixed order
+       * (rarest and most connected atoms first), which is considerably faster for
+       * symmetric structures. FindAutomorphisms() uses the "VF2++" mapper.
        * @return OBIsomorphismMapper instance or 0 if there is no subclass implementing
        * the specified @p algorithm.
        */
@@ -201,6 +201,91 @@ namespace OpenBabel
     // converted to newidx(10X243) instead.
     std::vector<unsigned int> _newidx;
   };
+
+  /**
+   * \class OBRMSDMatrix align.h <openbabel/math/align.h>
+   * \brief Compute all pairwise RMSDs between poses or conformers of a molecule
+   *
+   * This class computes the symmetric matrix of RMSDs between a set of
+   * structures of the same molecule (e.g. docking poses or conformers).
+   * Each structure added with AddMol() is mapped onto the atom order of the
+   * reference molecule once, and its coordinates are stored (centered when
+   * minimizing). For each pair, the RMSD is the minimum over the automorphisms
+   * of the reference molecule, as in OBAlign. Automorphisms that cannot improve
+   * the best RMSD found so far are skipped using a cheap lower bound.
+   *
+   * Only the upper triangle of the matrix is computed. When Open Babel is
+   * compiled with OpenMP support, the rows are computed in parallel. For very
+   * large sets, ComputeRows() can be used to process (and write out) blocks of
+   * rows without storing the whole matrix.
+   *
+   * \code
+   * OBRMSDMatrix matrix;
+   * matrix.SetRefMol(mols[0]);
+   * for (std::size_t i = 0; i < mols.size(); ++i)
+   *   matrix.AddMol(mols[i]);
+   * std::vector<double> rmsds; // upper triangle, row by row
+   * matrix.Compute(rmsds);
+   * \endcode
+   *
+   * @since version 3.2
+   */
+  class OBAPI OBRMSDMatrix {
+  public:
+    /**
+     * Constructor. By default, hydrogens are ignored, symmetry is taken into
+     * account and the structures are superimposed (@p minimize) before
+     * computing the RMSD.
+     */
+    OBRMSDMatrix(bool includeH=false, bool symmetry=true, bool minimize=true);
+
+    /**
+     * Set the reference molecule. This defines the atom order and the
+     * automorphisms and removes all previously added structures.
+     */
+    void SetRefMol(const OBMol &refmol);
+    /**
+     * Add a structure. If the atoms are not in the same order as in the
+     * reference molecule, they are mapped onto the reference molecule using
+     * an isomorphism search.
+     * @return False if @p mol does not match the reference molecule. The
+     * structure is still added (to keep the indexes in sync with the input)
+     * but all RMSDs involving it are HUGE_VAL.
+     */
+    bool AddMol(const OBMol &mol);
+    /**
+     * @return The number of structures added.
+     */
+    std::size_t NumMols() const { return _coords.size(); }
+
+    /**
+     * @return The RMSD between structures @p i and @p j.
+     */
+    double GetRMSD(std::size_t i, std::size_t j) const;
+    /**
+     * Compute the rows @p first to @p last (exclusive). Row i contains the
+     * RMSDs between structure i and the structures j > i.
+     */
+    void ComputeRows(std::size_t first, std::size_t last, std::vector<std::vector<double> > &rows) const;
+    /**
+     * Compute the complete upper triangle of the matrix (without the
+     * diagonal), stored row by row in @p rmsds.
+     */
+    void Compute(std::vector<double> &rmsds) const;
+
+  private:
+    bool _includeH;
+    bool _symmetry;
+    bool _minimize;
+    OBMol _refmol;
+    OBBitVec _frag_atoms;
+    std::vector<unsigned int> _fragIndexes; // atom index for each coordinate
+    std::vector<std::vector<unsigned int> > _perms; // automorphisms as permutations of coordinates
+    std::vector<std::vector<double> > _coords; // the coordinates (x, y, z for each atom)
+    std::vector<std::vector<double> > _norms; // distance to the centroid for each atom
+    std::vector<double> _sqnorms; // sum of the squared distances to the centroid
+    std::vector<bool> _valid; // structures that match the reference
+  };
 }
 
 #endif // OB_ALIGN_H
@@ -27,6 +27,7 @@ General Public License for more details.
 #include <string>
 #include <vector>
 #include <deque>
+#include <atomic>
 
 #ifndef OBERROR
 #define OBERROR
@@ -107,7 +108,7 @@ namespace OpenBabel
     {
     protected:
       //! Count of messages at each message level
-      unsigned int           _messageCount[5];
+      std::atomic<unsigned int> _messageCount[5];
 
     public:
       OBMessageHandler();
@@ -127,13 +128,14 @@ namespace OpenBabel
       //! Stop logging messages completely
       void StopLogging()  { _logging = false; }
 
-      //! Set the maximum number of entries (or 0 for no limit)
-      void SetMaxLogEntries(unsigned int max) { _maxEntries = max; }
-      //! \return the current maximum number of entries (default = 0 for no limit)
+      //! Set the maximum number of entries, at most 65536. 0 gives the largest
+      //! log, 65536 entries: the log is no longer unbounded.
+      void SetMaxLogEntries(unsigned int max);
+      //! \return the current maximum number of entries (default = 100)
       unsigned int GetMaxLogEntries() { return _maxEntries; }
 
       //! Clear the current message log entirely
-      void ClearLog() { _messageList.clear(); }
+      void ClearLog();
 
       //! \brief Set the level of messages to output
       //! (i.e., messages with at least this priority will be output)
@@ -155,7 +157,9 @@ namespace OpenBabel
       unsigned int GetWarningMessageCount() { return _messageCount[obWarning];}
       //! \return Count of messages received at the obInfo level
       unsigned int GetInfoMessageCount() { return _messageCount[obInfo];}
-      //! \return Count of messages received at the obAuditMsg level
+      //! \return Count of messages received at the obAuditMsg level. The audit
+      //! messages of Open Babel are only thrown, and so only logged and counted,
+      //! when the output level is at least obAuditMsg.
       unsigned int GetAuditMessageCount() { return _messageCount[obAuditMsg];}
       //! \return Count of messages received at the obDebug level
       unsigned int GetDebugMessageCount() { return _messageCount[obDebug];}
@@ -163,8 +167,18 @@ namespace OpenBabel
       std::string GetMessageSummary();
 
     protected:
-      //! Log of messages for later retrieval via GetMessagesOfLevel()
-      std::deque<OBError>    _messageList;
+      //! \return whether the log holds a message equal to @p err
+      bool IsLogged(const OBError &err);
+
+      //! Log of messages for later retrieval via GetMessagesOfLevel(): a ring in
+      //! which message number n is kept at n % size, replacing the oldest
+      std::vector<OBError>   _messageList;
+      //! Number + 1 of the message held by each entry of _messageList, 0 if none
+      std::vector<unsigned long> _messageStamp;
+      //! One flag per entry of _messageList, set while the entry is in use
+      std::vector<std::atomic<bool> > _messageBusy;
+      //! Number of messages logged since the log was last cleared
+      std::atomic<unsigned long> _messageTotal;
 
       //! Filtering level for messages and logging (messages of lower priority will be ignored
       obMessageLevel         _outputLevel;
@@ -24,6 +24,7 @@ GNU General Public License for more details.
 
 #include <string>
 #include <iosfwd>
+#include <ctime> // clock() for OBStopwatch
 
 #if TIME_WITH_SYS_TIME
 #include <sys/time.h>
@@ -50,6 +50,14 @@ public:
   /// Do something with an array of objects. Used a a callback routine in OpSort, etc.
   virtual bool ProcessVec(std::vector<OBBase*>& /* vec */){ return false; }
 
+  /// \return true if the result of Do() with these options depends only on
+  /// the structure of the molecule and the options, so that it can be kept in
+  /// the result cache (the --cache option). A result from the cache is one the
+  /// op could have given, so ops using random numbers can still return true,
+  /// but ops with other effects, like printing or logging, should not.
+  /// \since version 3.2
+  virtual bool Cacheable(const char* /* OptionText */, OpMap* /* pOptions */) const { return false; }
+
   /// \return string describing options, for display with -H and to make checkboxes in GUI
   static std::string OpOptions(OBBase* pOb)
   {
@@ -79,18 +87,31 @@ public:
   ///The key is the option name and the value, if any, is text which follows the option name.
   /// In some cases, there may be several parameters, space separated)
   /// \return false indicating object should not be output, if any Do() returns false
+  /// If there is a --cache option, the results of Cacheable() ops are taken
+  /// from the cache when available.
   static bool DoOps(OBBase* pOb, OpMap* pOptions, OBConversion* pConv)
   {
     OpMap::const_iterator itr;
+    bool useCache = pOptions->find("cache")!=pOptions->end();
     for(itr=pOptions->begin();itr!=pOptions->end();++itr)
     {
       OBOp* pOp = FindType(itr->first.c_str());
       if(pOp)
-        if(!pOp->Do(pOb, itr->second.c_str(), pOptions, pConv))
+      {
+        bool ret = useCache && pOp->Cacheable(itr->second.c_str(), pOptions)
+          ? DoCached(pOp, pOb, itr->second.c_str(), pOptions, pConv)
+          : pOp->Do(pOb, itr->second.c_str(), pOptions, pConv);
+        if(!ret)
           return false; //Op has decided molecule should not be output
+      }
     }
     return true;
   }
+
+  /// Calls pOp->Do(), unless its result for this molecule and options is in
+  /// the cache directory given by the --cache option, and stores the result.
+  /// \since version 3.2
+  static bool DoCached(OBOp* pOp, OBBase* pOb, const char* OptionText, OpMap* pOptions, OBConversion* pConv);
 };
 
 /** \class OBOp op.h <openbabel/op.h>
@@ -125,6 +146,21 @@ Options which need parameters are passed these (space delimited) in the text par
 of the Do() function. They can also access other general options specified on the
 command line by examining the the OpMap parameter.
 
+The results of expensive ops which are deterministic, like --gen3D or
+--minimize, can be kept between runs with the --cache option:
+\code
+obabel library.smi -O library.sdf --gen3D --cache ~/.obcache --cachesize 2000
+\endcode
+The cache directory holds a file for each result, named from a hash of the op,
+its options (all the general options except --cache and --cachesize) and the
+structure of the molecule as it is when the op is applied: atoms, bonds,
+coordinates and stereochemistry, in their input order. The title and the
+molecule's pair data are not part of the key, and are kept when a result is
+taken from the cache. When the files exceed the size given in MB by
+--cachesize (default 1000), the least recently used ones are deleted. The
+results are stored in the obbin format, so the cache is not used if that
+format is not available. An op takes part by returning true from Cacheable().
+
 To use an OBOp class from the API it is necessary to use an extra step in case it isn't
 present. So to apply the OBOp class with ID gen3D to your mol
 
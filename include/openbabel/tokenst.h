@@ -34,6 +34,9 @@ namespace OpenBabel
   OBERROR bool tokenize(std::vector<std::string>&, std::string&, const char *delimstr=" \t\n\r", int limit=-1);
   //! Remove leading and trailing whitespace from a string (docs in tokenst.cpp)
   OBERROR std::string& Trim(std::string& txt);
+  //! Parse a number like strtod(), faster for short decimal numbers (docs in tokenst.cpp)
+  //! \since version 3.2
+  OBERROR double ParseDouble(const char *str, char **endptr);
 
   // \return a string representation of a variable
   template<typename T>
@@ -13,6 +13,7 @@ GNU General Public License for more details.
 ***********************************************************************/
 #include <openbabel/babelconfig.h>
 #include <cstdlib>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <openbabel/alias.h>
@@ -340,15 +341,19 @@ void AliasData::RevertToAliasForm(OBMol& mol)
 bool AliasData::AddAliases(OBMol* pmol)
 {
   static SmartsTable smtable;
-  if(smtable.empty())
-    LoadFile(smtable);
+  {
+    static std::mutex loadMutex;
+    std::lock_guard<std::mutex> lock(loadMutex);
+    if(smtable.empty())
+      LoadFile(smtable);
+  }
   set<int> AllExAtoms;
   SmartsTable::iterator iter;
+  vector<std::vector<int> > mlist;
   for(iter=smtable.begin();iter!=smtable.end();++iter)
   {
-    if((*iter).second->Match(*pmol))
+    if((*iter).second->Match(*pmol, mlist, OBSmartsPattern::AllUnique))
     {
-      vector<std::vector<int> > mlist = (*iter).second->GetUMapList();
       for(unsigned imatch=0;imatch<mlist.size();++imatch) //each match
       {
         AliasData* ad  = new AliasData;
@@ -1180,8 +1180,9 @@ namespace OpenBabel
     if (GetAtomicNum() != OBElements::Hydrogen)
       return(false);
 
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::HtoMethyl", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::HtoMethyl", obAuditMsg);
 
     OBMol *mol = (OBMol*)GetParent();
 
@@ -1248,9 +1249,10 @@ namespace OpenBabel
   //! \deprecated This will be removed in future versions of Open Babel
   bool OBAtom::SetHybAndGeom(int hyb)
   {
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::SetHybridizationAndGeometry",
-                          obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::SetHybridizationAndGeometry",
+                            obAuditMsg);
 
     //if (hyb == GetHyb()) return(true);
     if (GetAtomicNum() == 1)
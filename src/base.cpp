@@ -336,6 +336,29 @@ namespace OpenBabel
   behind) and ideally any perception or transformations will occur when
   writing to some other format later.
 
+  \section Threads
+  Since version 3.2 the library can be used from several threads at once,
+  provided that each thread works on its own objects:
+  - Each thread should use its own OBConversion and its own OBMol objects.
+    Because of lazy evaluation, even "read-only" calls such as
+    OBAtom::IsAromatic() may change a molecule, so a molecule may not be
+    shared between threads without a lock.
+  - The global data tables (e.g., ttab, resdat, the atom and bond typers)
+    are read once, by whichever thread needs them first, and are not
+    changed after that. The atom types chosen with OBTypeTable::SetFromType()
+    and OBTypeTable::SetToType() are kept separately for each thread.
+  - Plugins are loaded on first use. Call OBPlugin::LoadAllPlugins() (or
+    create an OBConversion) before starting the threads.
+  - A single instance of each plugin is shared. The fingerprint, descriptor
+    and format plugins keep no per-molecule state in the instance, but a
+    force field does: each thread should use its own copy, made with
+    OBForceField::MakeNewInstance().
+  - Messages may be sent to obErrorLog from any thread, but its settings
+    (e.g., OBMessageHandler::SetOutputLevel()) should not be changed while
+    other threads are running.
+  - Options set on a plugin itself (such as OBFingerprint::SetFlags())
+    apply to all threads and should be set before they start.
+
   \page start Getting Started
 
   Not surprisingly, the Open Babel library is a full chemical
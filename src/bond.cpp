@@ -105,8 +105,9 @@ namespace OpenBabel
     vector3 v1,v2,v3,v4,v5;
     vector<int> children;
 
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::SetBondLength", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::SetBondLength", obAuditMsg);
 
     int a = fixed->GetIdx();
     int b = GetNbrAtom(fixed)->GetIdx();
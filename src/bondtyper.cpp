@@ -129,9 +129,9 @@ namespace OpenBabel
         currentPattern = i->first;
         assignments = i->second;
 
-        if (currentPattern && currentPattern->Match(mol))
+        // the patterns are shared, so the matches are kept in mlist
+        if (currentPattern && currentPattern->Match(mol, mlist, OBSmartsPattern::AllUnique))
           {
-            mlist = currentPattern->GetUMapList();
             for (matches = mlist.begin(); matches != mlist.end(); ++matches)
               {
                 // Now loop through the bonds to assign from _fgbonds
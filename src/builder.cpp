@@ -37,6 +37,9 @@ GNU General Public License for more details.
 #include <openbabel/stereo/cistrans.h>
 #include <openbabel/stereo/tetrahedral.h>
 #include <openbabel/stereo/squareplanar.h>
+
+#include <mutex>
+
 /* OBBuilder::GetNewBondVector():
  * - is based on OBAtom::GetNewBondVector()
  * - but: when extending a long chain all the bonds are trans
@@ -74,9 +77,76 @@ namespace OpenBabel
   std::map<std::string, int> OBBuilder::_rigid_fragments_index;
   std::map<std::string, std::vector<vector3> > OBBuilder::_rigid_fragments_cache;
   std::vector<std::pair<OBSmartsPattern*, std::vector<vector3> > > OBBuilder::_ring_fragments;
+  std::vector<std::vector<unsigned int> > OBBuilder::_ring_fragments_keys;
+  std::map<std::string, std::vector<unsigned int> > OBBuilder::_ring_fragments_matches;
+
+  // The maximum number of fragments in _ring_fragments_matches
+  #define MAX_RING_FRAGMENT_MATCHES 10000
+
+  // Guards the fragment tables and caches above, which are shared by all
+  // OBBuilder instances and so by all threads. It is recursive because
+  // LoadFragments() calls AddRingFragment().
+  static std::recursive_mutex &FragmentsMutex()
+  {
+    static std::recursive_mutex fragmentsMutex;
+    return fragmentsMutex;
+  }
+
+  // Invariants of a connected graph that can not be larger for a subgraph:
+  // the number of atoms, bonds, atoms with 3 or more neighbors, atoms with 4
+  // or more neighbors and rings. For a pattern with several components, the
+  // number of rings is underestimated which is still safe.
+  static std::vector<unsigned int> FragmentKey(unsigned int numAtoms, const std::vector<unsigned int> &degrees)
+  {
+    std::vector<unsigned int> key(5, 0);
+    key[0] = numAtoms;
+    for (std::size_t i = 0; i < degrees.size(); ++i) {
+      key[1] += degrees[i];
+      if (degrees[i] >= 3)
+        key[2]++;
+      if (degrees[i] >= 4)
+        key[3]++;
+    }
+    key[1] /= 2;
+    key[4] = (key[1] + 1 > numAtoms) ? key[1] + 1 - numAtoms : 0;
+    return key;
+  }
+
+  static std::vector<unsigned int> FragmentKey(OBSmartsPattern &sp)
+  {
+    std::vector<unsigned int> degrees(sp.NumAtoms(), 0);
+    for (unsigned int i = 0; i < sp.NumBonds(); ++i) {
+      int src, dst, ord;
+      sp.GetBond(src, dst, ord, i);
+      degrees[src]++;
+      degrees[dst]++;
+    }
+    return FragmentKey(sp.NumAtoms(), degrees);
+  }
+
+  static std::vector<unsigned int> FragmentKey(OBMol &mol)
+  {
+    std::vector<unsigned int> degrees;
+    FOR_ATOMS_OF_MOL (atom, mol)
+      degrees.push_back(atom->GetExplicitDegree());
+    return FragmentKey(mol.NumAtoms(), degrees);
+  }
+
+  //! \return True if no invariant of @p sub is larger than the one of @p key
+  static bool IsSubKey(const std::vector<unsigned int> &sub, const std::vector<unsigned int> &key)
+  {
+    for (std::size_t i = 0; i < sub.size(); ++i)
+      if (sub[i] > key[i])
+        return false;
+    return true;
+  }
 
   void OBBuilder::AddRingFragment(OBSmartsPattern *sp, const std::vector<vector3> &coords)
   {
+    std::lock_guard<std::recursive_mutex> lock(FragmentsMutex());
+    if (sp == nullptr)
+      return;
+
     bool hasAllZeroCoords = true;
     for (std::size_t i = 0; i < coords.size(); ++i) {
       if (fabs(coords[i].x()) > 10e-8 ||
@@ -91,11 +161,15 @@ namespace OpenBabel
       std::stringstream ss;
       ss << "Ring fragment " << sp->GetSMARTS() << " in ring-fragments.txt has all zero coordinates. Ignoring fragment.";
       obErrorLog.ThrowError(__FUNCTION__, ss.str(), obError);
-    } else
+    } else {
       _ring_fragments.push_back(pair<OBSmartsPattern*, vector<vector3> > (sp, coords));
+      _ring_fragments_keys.push_back(FragmentKey(*sp));
+      _ring_fragments_matches.clear();
+    }
   }
 
   void OBBuilder::LoadFragments()  {
+    std::lock_guard<std::recursive_mutex> lock(FragmentsMutex());
     // open data/fragments.txt
     ifstream ifs;
     if (OpenDatafile(ifs, "rigid-fragments-index.txt").length() == 0) {
@@ -162,6 +236,7 @@ namespace OpenBabel
   }
 
   std::vector<vector3> OBBuilder::GetFragmentCoord(std::string smiles) {
+    std::lock_guard<std::recursive_mutex> lock(FragmentsMutex());
     if (_rigid_fragments_cache.count(smiles) > 0) {
       return _rigid_fragments_cache[smiles];
     }
@@ -1133,8 +1208,11 @@ namespace OpenBabel
     vector<OBMol> fragments = mol_copy.Separate();
 
     // datafile is read only on first use of Build()
-    if(_rigid_fragments.empty())
-      LoadFragments();
+    {
+      std::lock_guard<std::recursive_mutex> lock(FragmentsMutex());
+      if(_rigid_fragments.empty())
+        LoadFragments();
+    }
 
 
     for(vector<OBMol>::iterator f = fragments.begin(); f != fragments.end(); ++f) {
@@ -1193,19 +1271,42 @@ namespace OpenBabel
         }
         if (ratoms < 3) continue; // Smallest ring fragment has 3 atoms
 
-        vector<pair<OBSmartsPattern*, vector<vector3 > > >::iterator i;
         // Skip all fragments that are too big to match
         // Note: It would be faster to compare to the size of the largest
         //       isolated ring system instead of comparing to ratoms
-        for (i = _ring_fragments.begin(); i != _ring_fragments.end() && i->first->NumAtoms() > ratoms; ++i);
+        unsigned int first = 0;
+        while (first < _ring_fragments.size() && _ring_fragments[first].first->NumAtoms() > ratoms)
+          ++first;
+
+        // The ring fragments that match this fragment. The same ring systems
+        // occur in many molecules, so these are cached by canonical SMILES.
+        // Otherwise, only ring fragments with compatible invariants are
+        // matched.
+        // The matches are copied, as another thread may clear the cache.
+        std::vector<unsigned int> matches;
+        {
+          std::lock_guard<std::recursive_mutex> lock(FragmentsMutex());
+          std::map<std::string, std::vector<unsigned int> >::iterator cached = _ring_fragments_matches.find(fragment_smiles);
+          if (cached == _ring_fragments_matches.end()) {
+            std::vector<unsigned int> key = FragmentKey(*f);
+            for (unsigned int r = 0; r < _ring_fragments.size(); ++r)
+              if (IsSubKey(_ring_fragments_keys[r], key) && _ring_fragments[r].first->HasMatch(*f))
+                matches.push_back(r);
+            if (_ring_fragments_matches.size() >= MAX_RING_FRAGMENT_MATCHES)
+              _ring_fragments_matches.clear();
+            _ring_fragments_matches.insert(std::make_pair(fragment_smiles, matches));
+          }
+          else
+            matches = cached->second;
+        }
 
-        // Loop through the remaining fragments and assign the coordinates from
+        // Loop through the matching fragments and assign the coordinates from
         // the first (most complex) fragment.
-        // Stop if there are no unassigned ring atoms (ratoms).
-        for (; i != _ring_fragments.end() && ratoms; ++i) {
-          if (i->first != nullptr && i->first->Match(*f)) { // if match to fragment
-            i->first->Match(mol);                        // match over mol
-            mlist = i->first->GetUMapList();
+        for (std::size_t m = 0; m < matches.size(); ++m) {
+          pair<OBSmartsPattern*, vector<vector3> > &ring_fragment = _ring_fragments[matches[m]];
+          if (matches[m] >= first) {
+            // match over mol, keeping the matches in mlist as the pattern is shared
+            ring_fragment.first->Match(mol, mlist, OBSmartsPattern::AllUnique);
             for (j = mlist.begin();j != mlist.end();++j) { // for all matches
               // Have any atoms of this match already been added?
               bool alreadydone = false;
@@ -1223,7 +1324,7 @@ namespace OpenBabel
               for (k = j->begin(), counter=0; k != j->end(); ++k, ++counter) { // for all atoms of the fragment
                 // set coordinates for atoms
                 OBAtom *atom = workMol.GetAtom(*k);
-                atom->SetVector(i->second[counter]);
+                atom->SetVector(ring_fragment.second[counter]);
               }
               // add the bonds for the fragment
               for (k = j->begin(); k != j->end(); ++k) {
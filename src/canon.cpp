@@ -42,6 +42,7 @@ GNU General Public License for more details.
 #define DEBUG 0
 
 #define MAX_IDENTITY_NODES 50
+#define MAX_AUTOMORPHISMS 200
 
 using namespace std;
 
@@ -402,10 +403,19 @@ namespace OpenBabel {
    * number of states to consider in various ways.
    *
    * @subsubsection canonical_opt5 Optimization 4
+   * The discovered automorphisms are stored as permutations of the atoms and
+   * used in two ways. First, a start atom that is in the same orbit as an
+   * already tried start atom (under the group generated by the automorphisms
+   * found so far) is skipped. Second, when the neighbors of a ring atom are
+   * permuted, an ordering that is the image of an already explored ordering
+   * under an automorphism fixing all labeled atoms is skipped. In both cases
+   * the skipped subtree only contains the images of codes that have already
+   * been considered. This makes the search fast for highly symmetric
+   * structures such as cages and polyhedra. Since stereo data of units that
+   * are not stereogenic is not part of the code, only automorphisms that
+   * also preserve the parities of all specified stereo units are used.
    *
-   *
-   *
-   *
+   * @note This optimization does <b>not affect the final result</b>.
    *
      @verbatim
      [1] Brendan D. McKay, Backtrack programming and isomorphism rejection on
@@ -421,6 +431,12 @@ namespace OpenBabel {
   {
     typedef std::vector<OBAtom*> Orbit;
     typedef std::vector<Orbit> Orbits;
+    /**
+     * An automorphism stored as a permutation of atom indexes (i.e. atom
+     * with index i is mapped to the atom with index automorphism[i]).
+     */
+    typedef std::vector<unsigned int> Automorphism;
+    typedef std::vector<Automorphism> Automorphisms;
 
     static void print_orbits(const Orbits &orbits)
     {
@@ -695,10 +711,13 @@ namespace OpenBabel {
       State(const std::vector<unsigned int> &_symmetry_classes,
             const OBBitVec &_fragment, std::vector<StereoCenter> &_stereoCenters,
             std::vector<FullCode> &_identityCodes, Orbits &_orbits, OBBitVec &_mcr,
-            bool _onlyOne) : symmetry_classes(_symmetry_classes), fragment(_fragment),
-          onlyOne(_onlyOne), stereoCenters(_stereoCenters),
-          code(_symmetry_classes.size()), identityCodes(_identityCodes),
-          backtrackDepth(0), orbits(_orbits), mcr(_mcr)
+            Automorphisms &_automorphisms, const std::vector<StereoCenter> &_preservedCenters,
+            bool _useAutomorphisms, bool _onlyOne) :
+          symmetry_classes(_symmetry_classes), fragment(_fragment), onlyOne(_onlyOne),
+          stereoCenters(_stereoCenters), code(_symmetry_classes.size()),
+          identityCodes(_identityCodes), backtrackDepth(0), orbits(_orbits), mcr(_mcr),
+          automorphisms(_automorphisms), preservedCenters(_preservedCenters),
+          useAutomorphisms(_useAutomorphisms)
       {
         mcr.Clear();
         if (mcr.IsEmpty())
@@ -730,6 +749,22 @@ namespace OpenBabel {
       unsigned int backtrackDepth;
       Orbits orbits;
       OBBitVec &mcr;
+      /**
+       * The automorphisms found so far. These are shared between all start
+       * atoms of a fragment and are used to prune equivalent subtrees.
+       */
+      Automorphisms &automorphisms;
+      /**
+       * All specified stereo units, including those that are not stereogenic.
+       * The code only contains the parities of the stereogenic units but the
+       * others are still written in the output, so only automorphisms that
+       * preserve the parities of all these units are stored.
+       */
+      const std::vector<StereoCenter> &preservedCenters;
+      /**
+       * Store the found automorphisms to prune the search tree.
+       */
+      bool useAutomorphisms;
     };
 
     /**
@@ -925,7 +960,8 @@ namespace OpenBabel {
             std::vector<CanonicalLabelsImpl::FullCode> identityCodes;
             Orbits orbits;
             OBBitVec mcr;
-            State lstate(state.symmetry_classes, ligand, state.stereoCenters, identityCodes, orbits, mcr, state.onlyOne);
+            Automorphisms automorphisms;
+            State lstate(state.symmetry_classes, ligand, state.stereoCenters, identityCodes, orbits, mcr, automorphisms, state.preservedCenters, state.useAutomorphisms, state.onlyOne);
             lstate.code.add(nbrs[i]);
             lstate.code.labels[nbrs[i]->GetIndex()] = 1;
             CanonicalLabelsRecursive(nbrs[i], 1, timeout, lbestCode, lstate);
@@ -1153,6 +1189,131 @@ namespace OpenBabel {
       }
     }
 
+    /**
+     * Store the automorphism mapping the atoms with labels @p labels1 to the
+     * atoms with the same labels in @p labels2. Both labelings must result in
+     * the same canonical code. Since the code contains all canonicalized
+     * attributes (including stereo), the permutation preserves these. Atoms
+     * that are not labeled are mapped onto themselves. The permutation is
+     * only stored if it also preserves the parities of the specified stereo
+     * units that are not stereogenic (see State::preservedCenters).
+     */
+    static void AddAutomorphism(State &state, const std::vector<unsigned int> &labels1,
+        const std::vector<unsigned int> &labels2)
+    {
+      if (!state.useAutomorphisms || state.automorphisms.size() >= MAX_AUTOMORPHISMS)
+        return;
+
+      std::vector<unsigned int> atomByLabel(labels2.size() + 1, 0);
+      for (std::size_t i = 0; i < labels2.size(); ++i)
+        if (labels2[i])
+          atomByLabel[labels2[i]] = i;
+
+      Automorphism automorphism(labels1.size());
+      bool isIdentity = true;
+      for (std::size_t i = 0; i < labels1.size(); ++i) {
+        automorphism[i] = labels1[i] ? atomByLabel[labels1[i]] : i;
+        if (automorphism[i] != i)
+          isIdentity = false;
+        // Only use permutations that also preserve the symmetry classes, these
+        // are used to order the search tree.
+        if (state.symmetry_classes[automorphism[i]] != state.symmetry_classes[i])
+          return;
+      }
+
+      if (isIdentity)
+        return;
+      if (std::find(state.automorphisms.begin(), state.automorphisms.end(), automorphism) != state.automorphisms.end())
+        return;
+
+      // Each specified stereo unit must be mapped onto a specified stereo
+      // unit with the same parity (i.e. the same descriptor for the labels).
+      const std::vector<StereoCenter> &centers = state.preservedCenters;
+      for (std::size_t i = 0; i < centers.size(); ++i) {
+        const StereoCenter &center = centers[i];
+        bool isPreserved = false;
+        for (std::size_t j = 0; j < centers.size(); ++j) {
+          const StereoCenter &image = centers[j];
+          if (image.indexes.size() != center.indexes.size())
+            continue;
+          bool isImage = image.indexes[0] == automorphism[center.indexes[0]];
+          if (center.indexes.size() == 2)
+            isImage = (isImage && image.indexes[1] == automorphism[center.indexes[1]]) ||
+                      (image.indexes[0] == automorphism[center.indexes[1]] &&
+                       image.indexes[1] == automorphism[center.indexes[0]]);
+          if (!isImage)
+            continue;
+          isPreserved = center.getDescriptor(state.symmetry_classes, labels1) ==
+                        image.getDescriptor(state.symmetry_classes, labels2);
+          break;
+        }
+        if (!isPreserved)
+          return;
+      }
+
+      state.automorphisms.push_back(automorphism);
+    }
+
+    /**
+     * Compute the orbits of the group generated by @p automorphisms. The
+     * result contains the lowest atom index in the orbit for each atom.
+     */
+    static void AutomorphismOrbits(const Automorphisms &automorphisms, std::size_t numAtoms,
+        std::vector<unsigned int> &orbits)
+    {
+      orbits.resize(numAtoms);
+      for (std::size_t i = 0; i < numAtoms; ++i)
+        orbits[i] = i;
+
+      for (std::size_t j = 0; j < automorphisms.size(); ++j)
+        for (std::size_t i = 0; i < numAtoms; ++i) {
+          // Union the orbits of i and automorphisms[j][i].
+          unsigned int a = i, b = automorphisms[j][i];
+          while (orbits[a] != a)
+            a = orbits[a];
+          while (orbits[b] != b)
+            b = orbits[b];
+          if (a < b)
+            orbits[b] = a;
+          else if (b < a)
+            orbits[a] = b;
+        }
+
+      for (std::size_t i = 0; i < numAtoms; ++i) {
+        unsigned int a = i;
+        while (orbits[a] != a)
+          a = orbits[a];
+        orbits[i] = a;
+      }
+    }
+
+    /**
+     * Check if the ordering @p nbrs of the neighbor atoms is the image of an
+     * already explored ordering under an automorphism that fixes all atoms
+     * labeled so far. If so, the subtree for @p nbrs is isomorphic to the
+     * explored subtree and produces the same canonical candidate codes.
+     */
+    static bool IsEquivalentOrdering(const std::vector<OBAtom*> &nbrs,
+        const std::vector<const std::vector<OBAtom*>*> &explored,
+        const Automorphisms &automorphisms, const std::vector<std::size_t> &stabilizer)
+    {
+      for (std::size_t a = 0; a < stabilizer.size(); ++a) {
+        const Automorphism &automorphism = automorphisms[stabilizer[a]];
+        for (std::size_t e = 0; e < explored.size(); ++e) {
+          const std::vector<OBAtom*> &other = *explored[e];
+          bool isImage = true;
+          for (std::size_t k = 0; k < nbrs.size(); ++k)
+            if (automorphism[other[k]->GetIndex()] != nbrs[k]->GetIndex()) {
+              isImage = false;
+              break;
+            }
+          if (isImage)
+            return true;
+        }
+      }
+      return false;
+    }
+
 
     /**
      * This is the recursive function implementing the labeling algorithm
@@ -1200,6 +1361,8 @@ namespace OpenBabel {
             //
             // An explicit automorphism has been found.
             //
+            AddAutomorphism(state, fullcode.labels, state.identityCodes[i-1].labels);
+
             std::vector<unsigned int> v1(fullcode.labels.size(), 0);
             for (std::size_t j = 0; j < fullcode.labels.size(); ++j)
               if (fullcode.labels[j])
@@ -1223,6 +1386,7 @@ namespace OpenBabel {
           }
 
         if (fullcode.code == bestCode.code) {
+          AddAutomorphism(state, fullcode.labels, bestCode.labels);
           UpdateMcr(state.mcr, state.orbits, bestCode.labels);
           FindOrbits(state.orbits, mol, fullcode.labels, bestCode.labels);
         } else if (fullcode > bestCode) {
@@ -1387,7 +1551,35 @@ namespace OpenBabel {
           }
         }
 
+        // The automorphisms fixing all labeled atoms (i.e. the stabilizer of
+        // the current search tree node). Automorphisms found while exploring
+        // the subtrees are added as they are discovered.
+        std::vector<std::size_t> stabilizer;
+        std::size_t numCheckedAutomorphisms = 0;
+        std::vector<const std::vector<OBAtom*>*> explored;
+
         for (std::size_t i = 0; i < allOrderedNbrs.size(); ++i) {
+          if (i) {
+            for (; numCheckedAutomorphisms < state.automorphisms.size(); ++numCheckedAutomorphisms) {
+              const Automorphism &automorphism = state.automorphisms[numCheckedAutomorphisms];
+              bool fixesLabeled = true;
+              for (std::size_t j = 0; j < code.atoms.size(); ++j) {
+                unsigned int index = code.atoms[j]->GetIndex();
+                if (automorphism[index] != index) {
+                  fixesLabeled = false;
+                  break;
+                }
+              }
+              if (fixesLabeled)
+                stabilizer.push_back(numCheckedAutomorphisms);
+            }
+
+            // Skip orderings equivalent to an explored ordering.
+            if (IsEquivalentOrdering(allOrderedNbrs[i], explored, state.automorphisms, stabilizer))
+              continue;
+          }
+          explored.push_back(&allOrderedNbrs[i]);
+
           // Convert the order stored in allOrderedNbrs to labels.
           unsigned int lbl = label;
           for (std::size_t j = 0; j < allOrderedNbrs[i].size(); ++j) {
@@ -1461,6 +1653,18 @@ namespace OpenBabel {
       return result;
     }
 
+    /**
+     * The index of the stereo reference atom with @p id. Hydrogens and
+     * implicit references are represented by the maximum unsigned int.
+     */
+    static unsigned int StereoRefIndex(OBMol *mol, unsigned long id)
+    {
+      OBAtom *ref = mol->GetAtomById(id);
+      if (ref && ref->GetAtomicNum() != OBElements::Hydrogen)
+        return ref->GetIndex();
+      return std::numeric_limits<unsigned int>::max();
+    }
+
     /**
      * Compute the canonical labels for @p mol. This function handles a whole molecule with
      * disconnected fragments. It finds a canonical code for each fragment, sorts these codes
@@ -1518,18 +1722,9 @@ namespace OpenBabel {
               continue;
 
             // Add the neighbor atom indexes.
-            OBAtom *from = mol->GetAtomById(config.from);
-            if (from && from->GetAtomicNum() != OBElements::Hydrogen)
-              stereoCenters.back().nbrIndexes1.push_back(from->GetIndex());
-            else
-              stereoCenters.back().nbrIndexes1.push_back(std::numeric_limits<unsigned int>::max());
-            for (std::size_t j = 0; j < config.refs.size(); ++j) {
-              OBAtom *ref = mol->GetAtomById(config.refs[j]);
-              if (ref && ref->GetAtomicNum() != OBElements::Hydrogen)
-                stereoCenters.back().nbrIndexes1.push_back(ref->GetIndex());
-              else
-                stereoCenters.back().nbrIndexes1.push_back(std::numeric_limits<unsigned int>::max());
-            }
+            stereoCenters.back().nbrIndexes1.push_back(StereoRefIndex(mol, config.from));
+            for (std::size_t j = 0; j < config.refs.size(); ++j)
+              stereoCenters.back().nbrIndexes1.push_back(StereoRefIndex(mol, config.refs[j]));
           } else if (unit.type == OBStereo::CisTrans) {
             OBBond *bond = mol->GetBondById(unit.id);
             if (!bond || bond->IsAromatic())
@@ -1551,8 +1746,7 @@ namespace OpenBabel {
 
             // Add the neighbor atom indexes.
             for (std::size_t j = 0; j < config.refs.size(); ++j) {
-              OBAtom *ref = mol->GetAtomById(config.refs[j]);
-              unsigned int r = (ref && ref->GetAtomicNum() != OBElements::Hydrogen) ? ref->GetIndex() : std::numeric_limits<unsigned int>::max();
+              unsigned int r = StereoRefIndex(mol, config.refs[j]);
               if (stereoCenters.back().nbrIndexes1.size() < 2)
                 stereoCenters.back().nbrIndexes1.push_back(r);
               else
@@ -1562,6 +1756,46 @@ namespace OpenBabel {
         }
       }
 
+      // The specified stereo units that must be preserved by the automorphisms
+      // used for pruning. Unlike the stereo centers above, these include the
+      // units that are not stereogenic.
+      std::vector<StereoCenter> preservedCenters;
+      bool useAutomorphisms = true;
+      if (stereoFacade) {
+        std::vector<OBTetrahedralStereo*> tetrahedral = stereoFacade->GetAllTetrahedralStereo();
+        for (std::size_t i = 0; i < tetrahedral.size(); ++i) {
+          OBTetrahedralStereo::Config config = tetrahedral[i]->GetConfig();
+          OBAtom *atom = mol->GetAtomById(config.center);
+          if (!atom || !config.specified)
+            continue;
+          preservedCenters.resize(preservedCenters.size()+1);
+          preservedCenters.back().indexes.push_back(atom->GetIndex());
+          preservedCenters.back().nbrIndexes1.push_back(StereoRefIndex(mol, config.from));
+          for (std::size_t j = 0; j < config.refs.size(); ++j)
+            preservedCenters.back().nbrIndexes1.push_back(StereoRefIndex(mol, config.refs[j]));
+        }
+        std::vector<OBCisTransStereo*> cistrans = stereoFacade->GetAllCisTransStereo();
+        for (std::size_t i = 0; i < cistrans.size(); ++i) {
+          OBCisTransStereo::Config config = cistrans[i]->GetConfig();
+          OBAtom *begin = mol->GetAtomById(config.begin);
+          OBAtom *end = mol->GetAtomById(config.end);
+          if (!begin || !end || !config.specified)
+            continue;
+          preservedCenters.resize(preservedCenters.size()+1);
+          preservedCenters.back().indexes.push_back(begin->GetIndex());
+          preservedCenters.back().indexes.push_back(end->GetIndex());
+          for (std::size_t j = 0; j < config.refs.size(); ++j) {
+            if (j < 2)
+              preservedCenters.back().nbrIndexes1.push_back(StereoRefIndex(mol, config.refs[j]));
+            else
+              preservedCenters.back().nbrIndexes2.push_back(StereoRefIndex(mol, config.refs[j]));
+          }
+        }
+        // Square planar parities are not computed, don't prune these molecules.
+        if (stereoFacade->NumSquarePlanarStereo())
+          useAutomorphisms = false;
+      }
+
       // Find the canonical code for each fragment.
       std::vector<CanonicalLabelsImpl::FullCode> fcodes;
       for (std::size_t f = 0; f < fragments.size(); ++f) {
@@ -1575,12 +1809,29 @@ namespace OpenBabel {
         std::vector<CanonicalLabelsImpl::FullCode> identityCodes;
         Orbits orbits;
         OBBitVec mcr;
+        Automorphisms automorphisms;
+        std::vector<unsigned int> automorphismOrbits;
+        std::vector<OBAtom*> triedStartAtoms;
 
         for (std::size_t i = 0; i < startAtoms.size(); ++i) {
           OBAtom *atom = startAtoms[i];
 
+          // Skip start atoms that are equivalent to a start atom that has
+          // already been tried. Labeling from such an atom only produces
+          // the images of the codes that have been found already.
+          if (!automorphisms.empty()) {
+            AutomorphismOrbits(automorphisms, mol->NumAtoms(), automorphismOrbits);
+            bool isEquivalent = false;
+            for (std::size_t j = 0; j < triedStartAtoms.size(); ++j)
+              if (automorphismOrbits[triedStartAtoms[j]->GetIndex()] == automorphismOrbits[atom->GetIndex()])
+                isEquivalent = true;
+            if (isEquivalent)
+              continue;
+          }
+          triedStartAtoms.push_back(atom);
+
           // Start labeling of the fragment.
-          State state(symmetry_classes, fragment, stereoCenters, identityCodes, orbits, mcr, onlyOne);
+          State state(symmetry_classes, fragment, stereoCenters, identityCodes, orbits, mcr, automorphisms, preservedCenters, useAutomorphisms, onlyOne);
           //if (!state.mcr.BitIsSet(atom->GetIdx()) && atom->IsInRing())
           //  continue;
 
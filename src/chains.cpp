@@ -1057,8 +1057,9 @@ namespace OpenBabel
 
     mol.SetChainsPerceived();
 
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::PerceiveChains", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::PerceiveChains", obAuditMsg);
 
     return result;
   }
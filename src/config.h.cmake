@@ -128,6 +128,12 @@
 /* have <sstream> */
 #cmakedefine HAVE_SSTREAM 1
 
+/* have <locale.h> */
+#cmakedefine HAVE_LOCALE_H 1
+
+/* have <xlocale.h> */
+#cmakedefine HAVE_XLOCALE_H 1
+
 /* have symbol clock_t */
 #cmakedefine HAVE_CLOCK_T 1
 
@@ -146,6 +152,9 @@
 /* have symbol strncasecmp */
 #cmakedefine HAVE_STRNCASECMP 1
 
+/* have symbol uselocale */
+#cmakedefine HAVE_USELOCALE 1
+
 /* have struct clock_t */
 #cmakedefine HAVE_CLOCK_T 1
 
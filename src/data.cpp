@@ -31,6 +31,9 @@ GNU General Public License for more details.
 #include <openbabel/oberror.h>
 #include <openbabel/elements.h>
 
+#include <map>
+#include <mutex>
+
 // data headers with default parameters
 #include "types.h"
 #include "resdata.h"
@@ -253,7 +256,20 @@ namespace OpenBabel
     _subdir = "data";
     _dataptr = TypesData;
     _linecount = 0;
-    _from = _to = -1;
+  }
+
+  // The columns chosen with SetFromType() and SetToType() are kept per thread
+  // and per table, so that threads can share the global ttab
+  struct TypeTableColumns
+  {
+    int from, to;
+    TypeTableColumns(): from(-1), to(-1) { }
+  };
+
+  static TypeTableColumns &SelectedColumns(const OBTypeTable *table)
+  {
+    static thread_local map<const OBTypeTable*, TypeTableColumns> columns;
+    return columns[table];
   }
 
   void OBTypeTable::ParseLine(const char *buffer)
@@ -293,7 +309,7 @@ namespace OpenBabel
     for (i = 0;i < _colnames.size();++i)
       if (tmp == _colnames[i])
         {
-          _from = i;
+          SelectedColumns(this).from = i;
           return(true);
         }
 
@@ -313,7 +329,7 @@ namespace OpenBabel
     for (i = 0;i < _colnames.size();++i)
       if (tmp == _colnames[i])
         {
-          _to = i;
+          SelectedColumns(this).to = i;
           return(true);
         }
 
@@ -349,14 +365,15 @@ namespace OpenBabel
     if (from == "")
       return(false);
 
-    if (_from >= 0 && _to >= 0 &&
-        _from < (signed)_table.size() && _to < (signed)_table.size())
+    const int fromCol = SelectedColumns(this).from, toCol = SelectedColumns(this).to;
+    if (fromCol >= 0 && toCol >= 0 &&
+        fromCol < (signed)_table.size() && toCol < (signed)_table.size())
       {
         vector<vector<string> >::iterator i;
         for (i = _table.begin();i != _table.end();++i)
-          if ((signed)(*i).size() > _from &&  (*i)[_from] == from)
+          if ((signed)(*i).size() > fromCol &&  (*i)[fromCol] == from)
             {
-              to = (*i)[_to];
+              to = (*i)[toCol];
               return(true);
             }
       }
@@ -375,14 +392,15 @@ namespace OpenBabel
     if (from.empty())
       return("");
 
-    if (_from >= 0 && _to >= 0 &&
-        _from < (signed)_table.size() && _to < (signed)_table.size())
+    const int fromCol = SelectedColumns(this).from, toCol = SelectedColumns(this).to;
+    if (fromCol >= 0 && toCol >= 0 &&
+        fromCol < (signed)_table.size() && toCol < (signed)_table.size())
       {
         vector<vector<string> >::iterator i;
         for (i = _table.begin();i != _table.end();++i)
-          if ((signed)(*i).size() > _from &&  (*i)[_from] == from)
+          if ((signed)(*i).size() > fromCol &&  (*i)[fromCol] == from)
             {
-              return (*i)[_to];
+              return (*i)[toCol];
             }
       }
 
@@ -396,8 +414,9 @@ namespace OpenBabel
     if (!_init)
       Init();
 
-    if (_from > 0 && _from < (signed)_table.size())
-      return( _colnames[_from] );
+    const int fromCol = SelectedColumns(this).from;
+    if (fromCol > 0 && fromCol < (signed)_table.size())
+      return( _colnames[fromCol] );
     else
       return( _colnames[0] );
   }
@@ -407,8 +426,9 @@ namespace OpenBabel
     if (!_init)
       Init();
 
-    if (_to > 0 && _to < (signed)_table.size())
-      return( _colnames[_to] );
+    const int toCol = SelectedColumns(this).to;
+    if (toCol > 0 && toCol < (signed)_table.size())
+      return( _colnames[toCol] );
     else
       return( _colnames[0] );
   }
@@ -596,6 +616,20 @@ namespace OpenBabel
       }
   }
 
+  // The residue chosen with SetResName() is kept per thread and per table,
+  // so that threads can share the global resdat
+  struct SelectedResidueNumber
+  {
+    int resnum;
+    SelectedResidueNumber(): resnum(-1) { }
+  };
+
+  static int &SelectedResidue(const OBResidueData *data)
+  {
+    static thread_local map<const OBResidueData*, SelectedResidueNumber> residues;
+    return residues[data].resnum;
+  }
+
   bool OBResidueData::SetResName(const string &s)
   {
     if (!_init)
@@ -606,52 +640,55 @@ namespace OpenBabel
     for (i = 0;i < _resname.size();++i)
       if (_resname[i] == s)
         {
-          _resnum = i;
+          SelectedResidue(this) = i;
           return(true);
         }
 
-    _resnum = -1;
+    SelectedResidue(this) = -1;
     return(false);
   }
 
   int OBResidueData::LookupBO(const string &s)
   {
-    if (_resnum == -1)
+    const int resnum = SelectedResidue(this);
+    if (resnum == -1)
       return(0);
 
     unsigned int i;
-    for (i = 0;i < _resbonds[_resnum].size();++i)
-      if (_resbonds[_resnum][i].first == s)
-        return(_resbonds[_resnum][i].second);
+    for (i = 0;i < _resbonds[resnum].size();++i)
+      if (_resbonds[resnum][i].first == s)
+        return(_resbonds[resnum][i].second);
 
     return(0);
   }
 
   int OBResidueData::LookupBO(const string &s1, const string &s2)
   {
-    if (_resnum == -1)
+    const int resnum = SelectedResidue(this);
+    if (resnum == -1)
       return(0);
     string s;
 
     s = (s1 < s2) ? s1 + " " + s2 : s2 + " " + s1;
 
     unsigned int i;
-    for (i = 0;i < _resbonds[_resnum].size();++i)
-      if (_resbonds[_resnum][i].first == s)
-        return(_resbonds[_resnum][i].second);
+    for (i = 0;i < _resbonds[resnum].size();++i)
+      if (_resbonds[resnum][i].first == s)
+        return(_resbonds[resnum][i].second);
 
     return(0);
   }
 
   bool OBResidueData::LookupType(const string &atmid,string &type,int &hyb)
   {
-    if (_resnum == -1)
+    const int resnum = SelectedResidue(this);
+    if (resnum == -1)
       return(false);
 
     string s;
     vector<string>::iterator i;
 
-    for (i = _resatoms[_resnum].begin();i != _resatoms[_resnum].end();i+=3)
+    for (i = _resatoms[resnum].begin();i != _resatoms[resnum].end();i+=3)
       if (atmid == *i)
         {
           ++i;
@@ -668,7 +705,13 @@ namespace OpenBabel
   {
     if (_init)
       return;
-    _init = true;
+
+    // One thread reads the data while any others wait for it. The lock is
+    // recursive because parsing one table may need another one.
+    static recursive_mutex initMutex;
+    lock_guard<recursive_mutex> lock(initMutex);
+    if (_init)
+      return;
 
     ifstream ifs;
     char charBuffer[BUFF_SIZE];
@@ -728,6 +771,8 @@ namespace OpenBabel
         obErrorLog.ThrowError(__FUNCTION__, s, obWarning);
       }
 
+    // only now can other threads use the table
+    _init = true;
   }
 
 } // end namespace OpenBabel
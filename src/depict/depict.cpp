@@ -31,6 +31,7 @@ GNU General Public License for more details.
 #include <openbabel/stereo/cistrans.h>
 #include <openbabel/obiter.h>
 #include <openbabel/obfunctions.h>
+#include <openbabel/graphsym.h>
 
 #include <cmath>
 
@@ -267,27 +268,10 @@ namespace OpenBabel
 
   unsigned int GetAtomSymClass(OBAtom *atom)
   {
-    OBPairData *pd = dynamic_cast<OBPairData*>(atom->GetParent()->GetData("OpenBabel Symmetry Classes"));
-    if (pd) {
-
-      cout << "same? = " << pd->GetValue() << endl;
-
-      istringstream iss(pd->GetValue());
-      std::vector<unsigned int> symmetry_classes;
-      copy(istream_iterator<unsigned int>(iss),
-           istream_iterator<unsigned int>(),
-           back_inserter<vector<unsigned int> >(symmetry_classes));
-      // Now find the number of unique elements
-      vector<unsigned int> copy_sym = symmetry_classes;
-      sort(copy_sym.begin(), copy_sym.end());
-      vector<unsigned int>::iterator end_pos = unique(copy_sym.begin(), copy_sym.end()); // Requires sorted elements
-      int nclasses = end_pos - copy_sym.begin();
-
-      cout << "sym_class[" << atom->GetIndex() << "] = " << symmetry_classes.at(atom->GetIndex()) << endl;
-      return symmetry_classes.at(atom->GetIndex());
-    }
-
-    return 99;
+    OBGraphSym gs(atom->GetParent());
+    std::vector<unsigned int> symmetry_classes;
+    gs.GetSymmetry(symmetry_classes);
+    return symmetry_classes.at(atom->GetIndex());
   }
 
   bool OBDepict::AddAtomLabels(AtomLabelType type)
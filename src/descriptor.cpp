@@ -20,7 +20,13 @@ GNU General Public License for more details.
 #include <openbabel/oberror.h>
 #include <openbabel/generic.h>
 #include <openbabel/base.h>
+#include <openbabel/mol.h>
+#include <openbabel/atom.h>
+#include <openbabel/bond.h>
+#include <openbabel/obiter.h>
+#include <openbabel/obutil.h>
 #include <openbabel/descriptor.h>
+#include <chrono>
 
 using namespace std;
 namespace OpenBabel
@@ -59,7 +65,8 @@ bool OBDescriptor::Compare(OBBase* pOb, istream& optionText, bool noEval, string
     if(noEval)
       return false;
 
-    val = Predict(pOb, param);
+    string svalue;
+    val = GetCachedValue(pOb, svalue, param);
 
     return DoComparison(ch1, ch2, val, filterval);
   }
@@ -338,7 +345,7 @@ double OBDescriptor::PredictAndSave(OBBase* pOb, string* param)
 {
   string attr = GetID();
   string svalue;
-  double val = GetStringValue(pOb,svalue, param );
+  double val = GetCachedValue(pOb, svalue, param);
 
   OBPairData *dp = static_cast<OBPairData *> (pOb->GetData(attr));
   bool PreviouslySet = true;
@@ -365,6 +372,184 @@ double OBDescriptor::GetStringValue(OBBase* pOb, string& svalue, string* param)
   return val;
 }
 
+// The key of a value in OBDescriptorData
+static string ValueKey(OBDescriptor* pDesc, const string* param)
+{
+  string key(pDesc->GetID());
+  if(param && !param->empty())
+    key += '(' + *param + ')';
+  return key;
+}
+
+double OBDescriptor::GetCachedValue(OBBase* pOb, string& svalue, string* param)
+{
+  OBDescriptorData* data = OBDescriptorData::Get(pOb);
+  string key = ValueKey(this, param);
+  double val;
+  if(data && data->GetValue(pOb, key, val, svalue))
+    return val;
+  val = GetStringValue(pOb, svalue, param);
+  // string values (e.g. cansmi, InChI, title) may depend on more than the structure
+  if(data && !IsNan(val))
+    data->SetValue(pOb, key, val, svalue);
+  return val;
+}
+
+//////////////////////////////////////////////////////////////
+OBDescriptorData::OBDescriptorData() :
+  OBGenericData("OpenBabel Descriptor Values", OBGenericDataType::PerceptionData, local), _sharing(0)
+{
+}
+
+OBDescriptorData::OBDescriptorData(const OBDescriptorData& other) :
+  OBGenericData(other), _key(other._key), _values(other._values), _sharing(0)
+{
+}
+
+OBDescriptorData::~OBDescriptorData()
+{
+  _sharing = 1;
+  EndSharing();
+}
+
+OBDescriptorData* OBDescriptorData::Get(OBBase* pOb, bool create)
+{
+  if(!dynamic_cast<OBMol*>(pOb))
+    return nullptr;
+  OBDescriptorData* data = dynamic_cast<OBDescriptorData*>(pOb->GetData("OpenBabel Descriptor Values"));
+  if(!data && create)
+  {
+    data = new OBDescriptorData;
+    pOb->SetData(data);
+  }
+  return data;
+}
+
+bool OBDescriptorData::Validate(OBBase* pOb)
+{
+  // Everything the descriptors of the structure depend on: elements, isotopes,
+  // charges, hydrogens and the connectivity with bond orders
+  OBMol* pmol = static_cast<OBMol*>(pOb);
+  vector<unsigned int> key;
+  key.reserve(1 + 2 * pmol->NumAtoms() + 2 * pmol->NumBonds());
+  key.push_back(pmol->NumAtoms());
+  FOR_ATOMS_OF_MOL(atom, pmol)
+  {
+    key.push_back(atom->GetAtomicNum()
+                  | ((128 + atom->GetFormalCharge()) << 8)
+                  | (atom->GetImplicitHCount() << 16));
+    key.push_back(atom->GetIsotope());
+  }
+  FOR_BONDS_OF_MOL(bond, pmol)
+  {
+    key.push_back(bond->GetBeginAtomIdx() | (bond->GetBondOrder() << 24));
+    key.push_back(bond->GetEndAtomIdx());
+  }
+
+  if(key == _key)
+    return true;
+
+  _key.swap(key);
+  _values.clear();
+  return false;
+}
+
+bool OBDescriptorData::GetValue(OBBase* pOb, const string& key, double& val, string& svalue)
+{
+  if(!Validate(pOb))
+    return false;
+  map<string, pair<double, string> >::const_iterator iter = _values.find(key);
+  if(iter == _values.end())
+    return false;
+  val = iter->second.first;
+  svalue = iter->second.second;
+  return true;
+}
+
+void OBDescriptorData::SetValue(OBBase* pOb, const string& key, double val, const string& svalue)
+{
+  Validate(pOb);
+  _values[key] = make_pair(val, svalue);
+}
+
+void OBDescriptorData::EndSharing()
+{
+  if(_sharing == 0 || --_sharing > 0)
+    return;
+  for(map<string, OBBase*>::iterator iter = _shared.begin(); iter != _shared.end(); ++iter)
+    delete iter->second;
+  _shared.clear();
+  _matches.clear();
+}
+
+OBBase* OBDescriptorData::GetShared(const string& key) const
+{
+  map<string, OBBase*>::const_iterator iter = _shared.find(key);
+  return iter == _shared.end() ? nullptr : iter->second;
+}
+
+void OBDescriptorData::SetShared(const string& key, OBBase* pOb)
+{
+  OBBase*& shared = _shared[key];
+  delete shared;
+  shared = pOb;
+}
+
+vector<vector<int> >& OBDescriptorData::GetMatches(const string& key, bool& found)
+{
+  found = _matches.find(key) != _matches.end();
+  return _matches[key];
+}
+
+//////////////////////////////////////////////////////////////
+OBDescriptorBatch::OBDescriptorBatch(const string& DescrList)
+{
+  stringstream ss(DescrList);
+  while(ss)
+  {
+    pair<string,string> spair = OBDescriptor::GetIdentifier(ss);
+    if(spair.first.empty())
+      continue;
+    Item item;
+    item.pDesc = OBDescriptor::FindType(spair.first.c_str());
+    if(!item.pDesc)
+    {
+      obErrorLog.ThrowError(__FUNCTION__, spair.first + " not recognized as a descriptor", obError, onceOnly);
+      continue;
+    }
+    item.id = spair.first;
+    item.param = spair.second;
+    item.time = 0.0;
+    item.count = 0;
+    _items.push_back(item);
+  }
+}
+
+void OBDescriptorBatch::Evaluate(OBBase* pOb, vector<double>& values, vector<string>& svalues)
+{
+  values.resize(_items.size());
+  svalues.resize(_items.size());
+  OBDescriptorData* data = OBDescriptorData::Get(pOb);
+  if(data)
+    data->BeginSharing();
+  for(unsigned int i = 0; i < _items.size(); ++i)
+  {
+    Item& item = _items[i];
+    string key = ValueKey(item.pDesc, &item.param);
+    if(data && data->GetValue(pOb, key, values[i], svalues[i]))
+      continue;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    values[i] = item.pDesc->GetStringValue(pOb, svalues[i], &item.param);
+    item.time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    ++item.count;
+    if(data && !IsNan(values[i]))
+      data->SetValue(pOb, key, values[i], svalues[i]);
+  }
+  if(data)
+    data->EndSharing();
+}
+
 bool OBDescriptor::CompareStringWithFilter(istream& optionText, string& sval, bool, bool NoCompOK)
 {
   char ch1=0, ch2=0;
@@ -417,6 +602,9 @@ void OBDescriptor::AddProperties(OBBase* pOb, const string& DescrList)
 {
   stringstream ss(DescrList);
   OBDescriptor* pDescr;
+  OBDescriptorData* data = OBDescriptorData::Get(pOb);
+  if(data)
+    data->BeginSharing();
   while(ss)
   {
     pair<string,string> spair = GetIdentifier(ss);
@@ -425,6 +613,8 @@ void OBDescriptor::AddProperties(OBBase* pOb, const string& DescrList)
     else
       obErrorLog.ThrowError(__FUNCTION__, spair.first + " not recognized as a descriptor", obError, onceOnly);
   }
+  if(data)
+    data->EndSharing();
 }
 
 void OBDescriptor::DeleteProperties(OBBase* pOb, const string& DescrList)
@@ -467,6 +657,9 @@ void OBDescriptor::DeleteProperties(OBBase* pOb, const string& DescrList)
 
     string values;
     OBDescriptor* pDescr;
+    OBDescriptorData* data = OBDescriptorData::Get(pOb);
+    if(data)
+      data->BeginSharing();
     while(ss)
     {
       string thisvalue;
@@ -478,7 +671,7 @@ void OBDescriptor::DeleteProperties(OBBase* pOb, const string& DescrList)
       else
       {
         if( (pDescr = OBDescriptor::FindType(spair.first.c_str())) ) // extra parentheses to indicate truth value
-          pDescr->GetStringValue(pOb, thisvalue, &spair.second);
+          pDescr->GetCachedValue(pOb, thisvalue, &spair.second);
         else
         {
           obErrorLog.ThrowError(__FUNCTION__,
@@ -488,6 +681,8 @@ void OBDescriptor::DeleteProperties(OBBase* pOb, const string& DescrList)
       }
       values += delim + thisvalue;
     }
+    if(data)
+      data->EndSharing();
     return values;
   }
 
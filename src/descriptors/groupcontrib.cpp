@@ -25,12 +25,15 @@ GNU General Public License for more details.
 #include <vector>
 #include <utility>
 #include <cstdlib>
+#include <memory>
+#include <mutex>
 #include <openbabel/mol.h>
 #include <openbabel/atom.h>
 #include <openbabel/oberror.h>
 #include <openbabel/parsmart.h>
 #include <openbabel/bitvec.h>
 #include <openbabel/groupcontrib.h>
+#include <openbabel/descriptor.h>
 #include <openbabel/locale.h>
 #include <openbabel/elements.h>
 
@@ -125,44 +128,71 @@ namespace OpenBabel
   }
 
 
+  // The matches of a pattern. Within OBDescriptorData::BeginSharing() and
+  // EndSharing() they are shared with the other group contribution descriptors,
+  // e.g. logP and MR have most of their patterns in common.
+  static const vector<vector<int> >& Matches(OBSmartsPattern* sp, OBMol& mol, OBDescriptorData* data,
+                                             vector<vector<int> >& mlist)
+  {
+    bool found = false;
+    vector<vector<int> >& matches = data ? data->GetMatches("OBGroupContrib " + sp->GetSMARTS(), found) : mlist;
+    if(!found && !sp->Match(mol, matches))
+      matches.clear();
+    return matches;
+  }
+
   double OBGroupContrib::Predict(OBBase* pOb, string* param)
   {
     OBMol* pmol = dynamic_cast<OBMol*>(pOb);
     if(!pmol)
       return 0.0;
 
-    //Need to add hydrogens, so do this to a copy to leave original unchanged
-    OBMol mol(*pmol);
-    mol.AddHydrogens(false, false);
-
     //Read in data, unless it has already been done.
-    if(_contribsHeavy.empty() && _contribsHydrogen.empty())
-      ParseFile();
+    {
+      static std::mutex parseMutex;
+      std::lock_guard<std::mutex> lock(parseMutex);
+      if(_contribsHeavy.empty() && _contribsHydrogen.empty())
+        ParseFile();
+    }
 
-    vector<vector<int> > _mlist; // match list for atom typing
-    vector<vector<int> >::iterator j;
+    //Need to add hydrogens and convert dative bonds, so do this to a copy to
+    //leave original unchanged. The copy is shared when several descriptors
+    //are calculated together.
+    OBDescriptorData* data = OBDescriptorData::Get(pOb, false);
+    if(data && !data->IsSharing())
+      data = nullptr;
+    OBMol* ptmpmol = data ? static_cast<OBMol*>(data->GetShared("OBGroupContrib")) : nullptr;
+    std::unique_ptr<OBMol> owned;
+    if(!ptmpmol)
+    {
+      ptmpmol = new OBMol(*pmol);
+      ptmpmol->AddHydrogens(false, false);
+      ptmpmol->ConvertDativeBonds();
+      if(data)
+        data->SetShared("OBGroupContrib", ptmpmol);
+      else
+        owned.reset(ptmpmol);
+    }
+    OBMol& tmpmol = *ptmpmol;
+
+    vector<vector<int> > mlist; // match list for atom typing
+    vector<vector<int> >::const_iterator j;
     vector<pair<OBSmartsPattern*, double> >::iterator i;
 
     stringstream debugMessage;
-    OBBitVec seenHeavy(mol.NumAtoms() + 1);
-    OBBitVec seenHydrogen(mol.NumAtoms() + 1);
-    vector<double> atomValues(mol.NumAtoms(), 0.0);
-
-    OBMol tmpmol;
-    tmpmol = mol;
-    tmpmol.ConvertDativeBonds();
+    OBBitVec seenHeavy(tmpmol.NumAtoms() + 1);
+    OBBitVec seenHydrogen(tmpmol.NumAtoms() + 1);
+    vector<double> atomValues(tmpmol.NumAtoms(), 0.0);
 
     // atom contributions
     if (_debug) debugMessage << "Heavy atom contributions:" << endl;
     for (i = _contribsHeavy.begin();i != _contribsHeavy.end();++i) {
-      if (i->first->Match(tmpmol)) {
-        _mlist = i->first->GetMapList();
-        for (j = _mlist.begin();j != _mlist.end();++j) {
-          atomValues[(*j)[0] - 1] = i->second;
-          seenHeavy.SetBitOn((*j)[0]);
-	        if (_debug)
-            debugMessage << (*j)[0] << " = " << i->first->GetSMARTS() << " : " << i->second << endl;
-        }
+      const vector<vector<int> >& matches = Matches(i->first, tmpmol, data, mlist);
+      for (j = matches.begin();j != matches.end();++j) {
+        atomValues[(*j)[0] - 1] = i->second;
+        seenHeavy.SetBitOn((*j)[0]);
+        if (_debug)
+          debugMessage << (*j)[0] << " = " << i->first->GetSMARTS() << " : " << i->second << endl;
       }
     }
 
@@ -171,17 +201,15 @@ namespace OpenBabel
     // Hydrogen contributions - note that matches to hydrogens themselves are ignored
     if (_debug) debugMessage << "  Hydrogen contributions:" << endl;
     for (i = _contribsHydrogen.begin();i != _contribsHydrogen.end();++i) {
-      if (i->first->Match(tmpmol)) {
-        _mlist = i->first->GetMapList();
-        for (j = _mlist.begin();j != _mlist.end();++j) {
-          if (tmpmol.GetAtom((*j)[0])->GetAtomicNum() == OBElements::Hydrogen)
-            continue;
-          int Hcount = tmpmol.GetAtom((*j)[0])->GetExplicitDegree() - tmpmol.GetAtom((*j)[0])->GetHvyDegree();
-          hydrogenValues[(*j)[0] - 1] = i->second * Hcount;
-          seenHydrogen.SetBitOn((*j)[0]);
-          if (_debug)
-            debugMessage << (*j)[0] << " = " << i->first->GetSMARTS() << " : " << i->second << " Hcount " << Hcount << endl;
-        }
+      const vector<vector<int> >& matches = Matches(i->first, tmpmol, data, mlist);
+      for (j = matches.begin();j != matches.end();++j) {
+        if (tmpmol.GetAtom((*j)[0])->GetAtomicNum() == OBElements::Hydrogen)
+          continue;
+        int Hcount = tmpmol.GetAtom((*j)[0])->GetExplicitDegree() - tmpmol.GetAtom((*j)[0])->GetHvyDegree();
+        hydrogenValues[(*j)[0] - 1] = i->second * Hcount;
+        seenHydrogen.SetBitOn((*j)[0]);
+        if (_debug)
+          debugMessage << (*j)[0] << " = " << i->first->GetSMARTS() << " : " << i->second << " Hcount " << Hcount << endl;
       }
     }
 
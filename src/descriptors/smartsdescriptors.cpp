@@ -21,6 +21,7 @@ GNU General Public License for more details.
 #include <openbabel/mol.h>
 #include <openbabel/descriptor.h>
 #include <openbabel/parsmart.h>
+#include <mutex>
 
 using namespace std;
 namespace OpenBabel
@@ -32,7 +33,7 @@ namespace OpenBabel
   public:
     //! constructor. Each instance provides an ID, a SMARTS pattern and a description.
     SmartsDescriptor(const char* ID, const char* smarts, const char* descr)
-      : OBDescriptor(ID, false), _smarts(smarts), _descr(descr){}
+      : OBDescriptor(ID, false), _smarts(smarts), _descr(descr), _parsed(false), _valid(false){}
 
     virtual const char* Description()
     {
@@ -51,9 +52,17 @@ namespace OpenBabel
       if(!pmol)
         return 0;
 
-      OBSmartsPattern sp;
-      if (sp.Init(_smarts) && sp.Match(*pmol))
-        return sp.GetUMapList().size();
+      // The pattern is parsed once, and matched without changing it
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_parsed) {
+          _valid = _sp.Init(_smarts);
+          _parsed = true;
+        }
+      }
+      vector<vector<int> > mlist;
+      if (_valid && _sp.Match(*pmol, mlist, OBSmartsPattern::AllUnique))
+        return mlist.size();
       else
         return 0.0;
     }
@@ -66,6 +75,10 @@ namespace OpenBabel
   private:
     const char* _smarts;
     const char* _descr;
+    OBSmartsPattern _sp;
+    bool _parsed;
+    bool _valid;
+    std::mutex _mutex;
   };
 
   //Make global instances
@@ -40,6 +40,7 @@ GNU General Public License for more details.
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <cstring>
 #include <cmath>
 #include <Eigen/Core>
 #include <Eigen/Eigenvalues>
@@ -832,64 +833,77 @@ namespace OpenBabel {
   //! https://doi.org/10.1016/0166-218X(88)90009-1
   void OBDistanceGeometry::TriangleSmooth()
   {
-    int a, b, c;
+    const int N = _mol.NumAtoms();
 
     _d->maxBoxSize = 0.0; // size of surrounding space
 
-    float u_ab, u_bc, u_ac; // upper limits
-    float l_ab, l_bc, l_ac; // lower limits
-    FOR_ATOMS_OF_MOL (_a, _mol) {
-      a = _a->GetIdx() - 1;
-      FOR_ATOMS_OF_MOL (_b, _mol) {
-        if (&*_b == &*_a)
+    // Work on full, row-major copies of the upper and lower limits so that the
+    // innermost loop runs over contiguous memory without branching on the
+    // triangle of the bounds matrix. Both halves are kept symmetric. Row a is
+    // not modified while it is the vertex, so the pairs bc of one iteration
+    // are independent and the rows b are smoothed in parallel. The result is
+    // identical to smoothing the bounds matrix in place.
+    std::vector<float> upper(N * N), lower(N * N);
+    for (int i = 0; i < N; ++i)
+      for (int j = 0; j < N; ++j) {
+        upper[i * N + j] = _d->GetUpperBounds(i, j);
+        lower[i * N + j] = _d->GetLowerBounds(i, j);
+      }
+
+    for (int a = 0; a < N; ++a) {
+      const float *u_a = &upper[a * N]; // row a is not modified in this iteration
+      const float *l_a = &lower[a * N];
+      for (int b = 0; b < N; ++b)
+        if (b != a && u_a[b] > _d->maxBoxSize)
+          _d->maxBoxSize = u_a[b];
+
+      #pragma omp parallel for schedule(dynamic)
+      for (int b = 0; b < N; ++b) {
+        if (b == a)
           continue;
-        b = _b->GetIdx() - 1;
 
         // Get upper and lower bounds for ab
-        u_ab = _d->GetUpperBounds(a, b);
-        l_ab = _d->GetLowerBounds(a, b);
-        FOR_ATOMS_OF_MOL (_c, _mol) {
-          if (_c->GetIdx() <= _b->GetIdx())
+        const float u_ab = u_a[b];
+        const float l_ab = l_a[b];
+        float *u_b = &upper[b * N];
+        float *l_b = &lower[b * N];
+        for (int c = b + 1; c < N; ++c) {
+          if (c == a)
             continue;
-          if (&*_c == &*_a)
-            continue;
-
-          c = _c->GetIdx() - 1;
 
           // get the upper and lower limits for bc and ac
-          u_bc = _d->GetUpperBounds(b, c);
-          l_bc = _d->GetLowerBounds(b, c);
-          u_ac = _d->GetUpperBounds(a, c);
-          l_ac = _d->GetLowerBounds(a, c);
+          float u_bc = u_b[c];
+          float l_bc = l_b[c];
+          const float u_ac = u_a[c];
+          const float l_ac = l_a[c];
 
           // Triangle rule: length can't be longer than the sum of the two other legs
           //   here "a" is the vertex
-          if (u_bc > (u_ab + u_ac)) { // u_bc <= u_ab + u_bc
+          if (u_bc > (u_ab + u_ac)) // u_bc <= u_ab + u_bc
             u_bc = u_ab + u_ac;
-            _d->SetUpperBounds(b, c, u_bc);
-          }
 
           // Triangle rule: length can't be shorter than the difference between the legs
-          if (l_bc < (l_ab - l_ac)) {
+          if (l_bc < (l_ab - l_ac))
             l_bc = l_ab - l_ac;
-            _d->SetLowerBounds(b, c, l_bc);
-          } else if (l_bc < (l_ac - l_ab)) {
+          else if (l_bc < (l_ac - l_ab))
             l_bc = l_ac - l_ab;
-            _d->SetLowerBounds(b, c, l_bc);
-          }
 
           if (u_bc < l_bc) {
-            _d->SetUpperBounds(b, c, l_bc);
+            u_bc = l_bc;
             //obErrorLog.ThrowError(__FUNCTION__, "Triagle Smoothing: Erroneous Bounds.", obWarning);
           }
 
+          u_b[c] = upper[c * N + b] = u_bc;
+          l_b[c] = lower[c * N + b] = l_bc;
         } // loop(c)
-
-        // Update boxSize after all "c" updates for this pair
-        if (_d->GetUpperBounds(a, b) > _d->maxBoxSize)
-          _d->maxBoxSize = _d->GetUpperBounds(a, b);
       } // loop(b)
     } // loop(a)
+
+    for (int i = 0; i < N; ++i)
+      for (int j = i + 1; j < N; ++j) {
+        _d->SetUpperBounds(i, j, upper[i * N + j]);
+        _d->SetLowerBounds(i, j, lower[i * N + j]);
+      }
   }
 
   void OBDistanceGeometry::SetLowerBounds()
@@ -922,9 +936,9 @@ namespace OpenBabel {
     }
   }
 
-  bool OBDistanceGeometry::CheckStereoConstraints()
+  bool OBDistanceGeometry::CheckStereoConstraints(OBMol &mol)
   {
-    return _d->stereoHelper.Check(&_mol);
+    return _d->stereoHelper.Check(&mol);
 
     /*
     // Check stereo by canonical SMILES
@@ -1010,13 +1024,11 @@ namespace OpenBabel {
       return false;
   }
 
-  bool OBDistanceGeometry::generateInitialCoords(void) {
+  bool OBDistanceGeometry::generateInitialCoords(Eigen::VectorXd &coord, OBRandom &generator) {
     // place atoms randomly
     unsigned int N = _mol.NumAtoms();
     // random distance matrix
     Eigen::MatrixXd distMat = Eigen::MatrixXd::Zero(N, N);
-    OBRandom generator;
-    generator.TimeSeed();
     for (size_t i=0; i<N; ++i) {
       for(size_t j=0; j<i; ++j) {
         double lb = _d->GetLowerBounds(i, j);
@@ -1066,18 +1078,18 @@ namespace OpenBabel {
       else eigVals(i) *= -1;
     }
 
-    _coord.resize(N * dim);
+    coord.resize(N * dim);
     for (size_t i = 0; i < N; i++) {
       for (size_t j = 0; j < dim; j++) {
-        if(N-1-j >= 0) _coord(i*dim + j) = eigVals(N-1-j) * eigVecs(i, N-1-j);
-        else _coord(i*dim + j) = 0;
+        if(N-1-j >= 0) coord(i*dim + j) = eigVals(N-1-j) * eigVecs(i, N-1-j);
+        else coord(i*dim + j) = 0;
       }
     }
     Eigen::MatrixXd distMat2(N, N);
     for (size_t i = 0; i < N; i++) {
       for (size_t j = 0; j < N; j++) {
         for(size_t k = 0; k < dim; k++)
-          distMat2(i, j) += pow(_coord(i*dim + k)-_coord(j*dim + k), 2.0);
+          distMat2(i, j) += pow(coord(i*dim + k)-coord(j*dim + k), 2.0);
         distMat2(i, j) = sqrt(distMat2(i, j));
       }
     }
@@ -1092,11 +1104,11 @@ namespace OpenBabel {
     return true;
   }
 
-  bool OBDistanceGeometry::firstMinimization(void) {
-    unsigned int N = _mol.NumAtoms();
+  bool OBDistanceGeometry::firstMinimization(OBMol &mol, Eigen::VectorXd &coord) {
+    unsigned int N = mol.NumAtoms();
     for(size_t i=0; i<N; ++i) {
-      vector3 v(_coord(i*dim), _coord(i*dim+1), _coord(i*dim+2));
-      OBAtom* a = _mol.GetAtom(i+1);
+      vector3 v(coord(i*dim), coord(i*dim+1), coord(i*dim+2));
+      OBAtom* a = mol.GetAtom(i+1);
       a->SetVector(v);
     }
     DistGeomFunc f(this);
@@ -1110,13 +1122,13 @@ namespace OpenBabel {
     DistGeomFunc fun(this);
 
     double fx;
-    int niter = solver.minimize(fun, _coord, fx);
+    int niter = solver.minimize(fun, coord, fx);
     //std::cout << niter << " iterations" << std::endl;
     //std::cout << "f(x) = " << fx << std::endl;
 
     for(size_t i=0; i<N; ++i) {
-      vector3 v(_coord(i*dim), _coord(i*dim+1), _coord(i*dim+2));
-      OBAtom* a = _mol.GetAtom(i+1);
+      vector3 v(coord(i*dim), coord(i*dim+1), coord(i*dim+2));
+      OBAtom* a = mol.GetAtom(i+1);
       a->SetVector(v);
     }
 
@@ -1124,7 +1136,7 @@ namespace OpenBabel {
     for (size_t i = 0; i < N; i++) {
       for (size_t j = 0; j < N; j++) {
         for(size_t k = 0; k < dim; k++)
-          distMat2(i, j) += pow(_coord(i*dim + k)-_coord(j*dim + k), 2.0);
+          distMat2(i, j) += pow(coord(i*dim + k)-coord(j*dim + k), 2.0);
         distMat2(i, j) = sqrt(distMat2(i, j));
       }
     }
@@ -1139,11 +1151,11 @@ namespace OpenBabel {
     return true;
   }
 
-  bool OBDistanceGeometry::minimizeFourthDimension(void) {
-    unsigned int N = _mol.NumAtoms();
+  bool OBDistanceGeometry::minimizeFourthDimension(OBMol &mol, Eigen::VectorXd &coord) {
+    unsigned int N = mol.NumAtoms();
     for(size_t i=0; i<N; ++i) {
-      vector3 v(_coord(i*dim), _coord(i*dim+1), _coord(i*dim+2));
-      OBAtom* a = _mol.GetAtom(i+1);
+      vector3 v(coord(i*dim), coord(i*dim+1), coord(i*dim+2));
+      OBAtom* a = mol.GetAtom(i+1);
       a->SetVector(v);
     }
 
@@ -1155,45 +1167,88 @@ namespace OpenBabel {
     DistGeomFunc4D fun(this);
 
     double fx;
-    int niter = solver.minimize(fun, _coord, fx);
+    int niter = solver.minimize(fun, coord, fx);
     //std::cout << niter << " iterations" << std::endl;
     //std::cout << "f(x) = " << fx << std::endl;
 
     for(size_t i=0; i<N; ++i) {
-      vector3 v(_coord(i*dim), _coord(i*dim+1), _coord(i*dim+2));
-      OBAtom* a = _mol.GetAtom(i+1);
+      vector3 v(coord(i*dim), coord(i*dim+1), coord(i*dim+2));
+      OBAtom* a = mol.GetAtom(i+1);
       a->SetVector(v);
     }
     return true;
   }
 
+  bool OBDistanceGeometry::Embed(OBMol &mol, Eigen::VectorXd &coord, OBRandom &generator)
+  {
+    unsigned int maxIter = 10 * mol.NumAtoms();
+    for (unsigned int trial = 0; trial < maxIter; trial++) {
+      generateInitialCoords(coord, generator);
+      firstMinimization(mol, coord);
+      if (dim == 4) minimizeFourthDimension(mol, coord);
+      if (CheckStereoConstraints(mol) && CheckBounds(mol))
+        return true;
+      if (_d->debug)
+        cerr << "Stereo unsatisfied, trying again" << endl;
+    }
+    return false;
+  }
+
   void OBDistanceGeometry::AddConformer()
   {
     // We should use Eigen here, and cast to double*
     double *confCoord = new double [_mol.NumAtoms() * 3]; // initial state (random)
     _mol.AddConformer(confCoord);
-    _mol.SetConformer(_mol.NumConformers());
+    _mol.SetConformer(_mol.NumConformers() - 1);
 
-    OBRandom generator(true); // Use system rand() functions
+    OBRandom generator;
     generator.TimeSeed();
 
     if (_d->debug) {
       cerr << " max box size: " << _d->maxBoxSize << endl;
     }
 
-    _d->success = false;
-    unsigned int maxIter = 10 * _mol.NumAtoms();
-    for (unsigned int trial = 0; trial < maxIter; trial++) {
-      generateInitialCoords();
-      firstMinimization();
-      if (dim == 4) minimizeFourthDimension();
-      if (CheckStereoConstraints() && CheckBounds()) {
-        _d->success = true;
-        break;
-      }
-      if (_d->debug && !_d->success)
-        cerr << "Stereo unsatisfied, trying again" << endl;
+    _d->success = Embed(_mol, _coord, generator);
+  }
+
+  unsigned int OBDistanceGeometry::AddConformers(unsigned int numConformers)
+  {
+    if (!numConformers)
+      return 0;
+
+    // Each embedding has its own random sequence, drawn up front so that the
+    // result does not depend on the number of threads.
+    OBRandom generator;
+    generator.TimeSeed();
+    std::vector<int> seeds(numConformers);
+    for (unsigned int i = 0; i < numConformers; ++i)
+      seeds[i] = generator.NextInt();
+
+    const int N = _mol.NumAtoms();
+    std::vector<double*> confCoords(numConformers);
+    std::vector<char> success(numConformers);
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < static_cast<int>(numConformers); ++i) {
+      // the stereo check perceives the stereochemistry of its molecule, so
+      // each embedding works on a copy
+      OBMol mol(_mol);
+      Eigen::VectorXd coord;
+      OBRandom embeddingGenerator;
+      embeddingGenerator.Seed(seeds[i]);
+      success[i] = Embed(mol, coord, embeddingGenerator);
+      confCoords[i] = new double [N * 3];
+      memcpy(confCoords[i], mol.GetCoordinates(), sizeof(double) * 3 * N);
     }
+
+    unsigned int numSuccessful = 0;
+    for (unsigned int i = 0; i < numConformers; ++i) {
+      _mol.AddConformer(confCoords[i]);
+      if (success[i])
+        ++numSuccessful;
+    }
+    _mol.SetConformer(_mol.NumConformers() - 1);
+    _d->success = success.back();
+    return numSuccessful;
   }
 
   bool OBDistanceGeometry::WasSuccessful() const
@@ -1201,17 +1256,17 @@ namespace OpenBabel {
     return _d->success;
   }
 
-  bool OBDistanceGeometry::CheckBounds()
+  bool OBDistanceGeometry::CheckBounds(OBMol &mol)
   {
     // remember atom indexes from 1
     OBAtom *a, *b;
     double dist, aRad, bRad, minDist, uBounds;
 
-    for (unsigned int i = 1; i <= _mol.NumAtoms(); ++i) {
-      a = _mol.GetAtom(i);
+    for (unsigned int i = 1; i <= mol.NumAtoms(); ++i) {
+      a = mol.GetAtom(i);
       aRad = OBElements::GetVdwRad(a->GetAtomicNum());
-      for (unsigned int j = i + 1; j <= _mol.NumAtoms(); ++j) {
-          b = _mol.GetAtom(j);
+      for (unsigned int j = i + 1; j <= mol.NumAtoms(); ++j) {
+          b = mol.GetAtom(j);
 
           // Compare the current distance to the lower and upper bounds
           dist = a->GetDistance(b);
@@ -1224,7 +1279,7 @@ namespace OpenBabel {
             return false;
           }
           // now lower.. if the two atoms aren't bonded
-          if (_mol.GetBond(a, b))
+          if (mol.GetBond(a, b))
             continue;
 
           bRad = OBElements::GetVdwRad(b->GetAtomicNum());
@@ -1272,6 +1327,20 @@ namespace OpenBabel {
     }
   }
 
+  bool OBDistanceGeometry::GetLastConformer(OBMol &mol)
+  {
+    if (_mol.NumAtoms() != mol.NumAtoms()) {
+      obErrorLog.ThrowError(__FUNCTION__, "The number of atoms did not match.", obWarning);
+      return false;
+    }
+
+    // only copy the new embedding, not the input coordinates
+    mol.SetDimension(3);
+    mol.SetCoordinates(_mol.GetCoordinates());
+
+    return _d->success;
+  }
+
   bool OBDistanceGeometry::GetGeometry(OBMol &mol, bool useCurrentGeom)
   {
     mol.AddHydrogens();
@@ -1279,9 +1348,8 @@ namespace OpenBabel {
       return false;
 
     AddConformer();
-    GetConformers(mol);
 
-    return _d->success;
+    return GetLastConformer(mol);
   }
 
   double DistGeomFunc::operator() (const Eigen::VectorXd& x, Eigen::VectorXd& grad) {
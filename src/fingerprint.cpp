@@ -70,6 +70,79 @@ namespace OpenBabel
     }
   }
 
+  ////////////////////////////////////////
+  void OBFingerprint::FoldFeatures(vector<FeatureCount>& features, unsigned int nbits)
+  {
+    if(nbits==0)
+      return;
+    for(unsigned int i=0;i<features.size();++i)
+      features[i].first %= nbits;
+    sort(features.begin(), features.end());
+    vector<FeatureCount>::iterator out = features.begin();
+    for(vector<FeatureCount>::iterator in=features.begin();in!=features.end();++in)
+    {
+      if(out!=features.begin() && (out-1)->first==in->first)
+        (out-1)->second += in->second;
+      else
+        *out++ = *in;
+    }
+    features.erase(out, features.end());
+  }
+
+  ////////////////////////////////////////
+  bool OBFingerprint::GetFingerprints(const vector<OBBase*>& objects, vector<unsigned int>& buffer,
+                                      unsigned int& words, int nbits)
+  {
+    buffer.clear();
+    words = 0;
+    bool ok = true;
+    vector<unsigned int> fp;
+    for(unsigned int i=0;i<objects.size();++i)
+    {
+      fp.clear();
+      if(!GetFingerprint(objects[i], fp, nbits))
+      {
+        ok = false;
+        fp.clear();
+      }
+      if(words==0 && !fp.empty())
+      {
+        // the size is known from the first fingerprint
+        words = fp.size();
+        buffer.reserve(objects.size()*words);
+      }
+      else if(!fp.empty() && fp.size()!=words)
+      {
+        obErrorLog.ThrowError(__FUNCTION__, "The fingerprints are of different sizes", obError);
+        return false;
+      }
+      buffer.resize(i*words, 0);
+      buffer.insert(buffer.end(), fp.begin(), fp.end());
+    }
+    buffer.resize(objects.size()*words, 0);
+    return ok;
+  }
+
+  ////////////////////////////////////////
+  bool OBFingerprint::GetCountFingerprints(const vector<OBBase*>& objects, vector<FeatureCount>& features,
+                                           vector<size_t>& offsets)
+  {
+    features.clear();
+    offsets.assign(1, 0);
+    offsets.reserve(objects.size()+1);
+    bool ok = true;
+    vector<FeatureCount> fc;
+    for(unsigned int i=0;i<objects.size();++i)
+    {
+      if(GetCountFingerprint(objects[i], fc))
+        features.insert(features.end(), fc.begin(), fc.end());
+      else
+        ok = false;
+      offsets.push_back(features.size());
+    }
+    return ok;
+  }
+
   ////////////////////////////////////////
 /*  bool OBFingerprint::GetNextFPrt(std::string& id, OBFingerprint*& pFPrt)
   {
@@ -296,6 +369,172 @@ namespace OpenBabel
     return true;
   }
 
+  /////////////////////////////////////////////////////////
+  unsigned int FastSearch::Cluster(double MinTani, vector<unsigned int>& clusters,
+                                   vector<unsigned int>& centroids, bool leader)
+  {
+    vector<size_t> offsets;
+    vector<unsigned int> neighbors;
+    clusters.clear();
+    centroids.clear();
+    if(_index.header.nEntries==0 || !FindNeighbors(&_index.fptdata[0], _index.header.nEntries,
+                                                     _index.header.words, MinTani, offsets, neighbors))
+      return 0;
+    return ButinaCluster(offsets, neighbors, clusters, centroids, leader);
+  }
+
+  static inline unsigned int CountBits(unsigned long long word)
+  {
+#if __GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4)
+    return __builtin_popcountll(word);
+#else
+    unsigned int n = 0;
+    for(;word;word&=word-1)
+      ++n;
+    return n;
+#endif
+  }
+
+  /////////////////////////////////////////////////////////
+  bool FastSearch::FindNeighbors(const unsigned int* fptdata, unsigned int nEntries, unsigned int words,
+                                 double MinTani, vector<size_t>& offsets, vector<unsigned int>& neighbors)
+  {
+    offsets.assign(nEntries+1, 0);
+    neighbors.clear();
+    if(MinTani<=0.0 || MinTani>1.0)
+    {
+      obErrorLog.ThrowError(__FUNCTION__, "The Tanimoto threshold should be greater than 0 and not more than 1", obError);
+      return false;
+    }
+
+    // The fingerprints in order of the number of bits set. The Tanimoto
+    // coefficient of fingerprints with a and b bits set (a<=b) is at most a/b,
+    // so the candidates for each one are the following ones, up to the first
+    // for which a/b is below the threshold.
+    vector<pair<unsigned int, unsigned int> > order(nEntries);
+    for(unsigned int i=0;i<nEntries;++i)
+    {
+      const unsigned int* p = fptdata + (size_t)i*words;
+      unsigned int bits = 0;
+      for(unsigned int w=0;w<words;++w)
+        bits += CountBits(p[w]);
+      order[i] = make_pair(bits, i);
+    }
+    sort(order.begin(), order.end());
+    vector<unsigned int> sorted((size_t)nEntries*words);
+    for(unsigned int i=0;i<nEntries;++i)
+      memcpy(&sorted[(size_t)i*words], fptdata + (size_t)order[i].second*words, words*sizeof(unsigned int));
+
+    // The upper triangle, a block of rows at a time in parallel. Only the
+    // pairs above the threshold are kept, as positions in the sorted order.
+    const unsigned int blockSize = 256;
+    int numBlocks = (nEntries + blockSize - 1) / blockSize;
+    vector<vector<unsigned int> > rowSizes(numBlocks), upper(numBlocks);
+#ifdef _OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+    for(int blk=0;blk<numBlocks;++blk)
+    {
+      unsigned int first = blk*blockSize;
+      unsigned int last = min(first+blockSize, nEntries);
+      rowSizes[blk].resize(last-first);
+      for(unsigned int i=first;i<last;++i)
+      {
+        size_t before = upper[blk].size();
+        unsigned int a = order[i].first;
+        const unsigned int* p = &sorted[(size_t)i*words];
+        for(unsigned int j=i+1;a && j<nEntries;++j) //speed critical section
+        {
+          unsigned int b = order[j].first;
+          if((double)a/(double)b < MinTani)
+            break;
+          const unsigned int* q = &sorted[(size_t)j*words];
+          unsigned int andbits = 0, w = 0;
+          for(;w+1<words;w+=2) // two words at a time
+            andbits += CountBits(((unsigned long long)(p[w] & q[w]) << 32) | (p[w+1] & q[w+1]));
+          if(w<words)
+            andbits += CountBits(p[w] & q[w]);
+          if((double)andbits/(double)(a+b-andbits) >= MinTani)
+            upper[blk].push_back(j);
+        }
+        rowSizes[blk][i-first] = upper[blk].size() - before;
+      }
+    }
+
+    // Both directions, as indices in the original order
+    for(int blk=0;blk<numBlocks;++blk)
+    {
+      size_t k = 0;
+      for(unsigned int r=0;r<rowSizes[blk].size();++r)
+      {
+        offsets[order[blk*blockSize+r].second+1] += rowSizes[blk][r];
+        for(unsigned int n=0;n<rowSizes[blk][r];++n)
+          ++offsets[order[upper[blk][k++]].second+1];
+      }
+    }
+    for(unsigned int i=0;i<nEntries;++i)
+      offsets[i+1] += offsets[i];
+    neighbors.resize(offsets[nEntries]);
+    vector<size_t> next(offsets.begin(), offsets.end()-1);
+    for(int blk=0;blk<numBlocks;++blk)
+    {
+      size_t k = 0;
+      for(unsigned int r=0;r<rowSizes[blk].size();++r)
+      {
+        unsigned int i = order[blk*blockSize+r].second;
+        for(unsigned int n=0;n<rowSizes[blk][r];++n)
+        {
+          unsigned int j = order[upper[blk][k++]].second;
+          neighbors[next[i]++] = j;
+          neighbors[next[j]++] = i;
+        }
+      }
+      vector<unsigned int>().swap(upper[blk]);
+    }
+    for(unsigned int i=0;i<nEntries;++i)
+      sort(neighbors.begin()+offsets[i], neighbors.begin()+offsets[i+1]);
+    return true;
+  }
+
+  /////////////////////////////////////////////////////////
+  struct MoreNeighbors
+  {
+    MoreNeighbors(const vector<size_t>& offsets) : _offsets(offsets){}
+    bool operator()(unsigned int i, unsigned int j) const
+    {
+      return _offsets[i+1]-_offsets[i] > _offsets[j+1]-_offsets[j];
+    }
+    const vector<size_t>& _offsets;
+  };
+
+  unsigned int FastSearch::ButinaCluster(const vector<size_t>& offsets, const vector<unsigned int>& neighbors,
+                                         vector<unsigned int>& clusters, vector<unsigned int>& centroids, bool leader)
+  {
+    unsigned int n = offsets.empty() ? 0 : offsets.size()-1;
+    // The candidate centers by decreasing number of neighbors, then in the input order
+    vector<unsigned int> order(n);
+    for(unsigned int i=0;i<n;++i)
+      order[i] = i;
+    if(!leader)
+      stable_sort(order.begin(), order.end(), MoreNeighbors(offsets));
+
+    clusters.assign(n, 0);
+    centroids.clear();
+    for(unsigned int o=0;o<n;++o)
+    {
+      unsigned int center = order[o];
+      if(clusters[center])
+        continue;
+      centroids.push_back(center);
+      unsigned int id = centroids.size();
+      clusters[center] = id;
+      for(size_t k=offsets[center];k<offsets[center+1];++k)
+        if(!clusters[neighbors[k]])
+          clusters[neighbors[k]] = id;
+    }
+    return centroids.size();
+  }
+
   /////////////////////////////////////////////////////////
   string FastSearch::ReadIndex(istream* pIndexstream)
   {
@@ -22,7 +22,7 @@ GNU General Public License for more details.
 #include <openbabel/atom.h>
 #include <openbabel/bond.h>
 #include <openbabel/fingerprint.h>
-#include <set>
+#include <sstream>
 #include <vector>
 #include <algorithm>
 #include <openbabel/elements.h>
@@ -45,7 +45,7 @@ public:
     "from one to Max_Fragment_Size = 7 atoms but single atom fragments of C,N,and O\n"
     "are ignored. A fragment is terminated when the atoms form a ring.\n"
     "For each of these fragments the atoms, bonding and whether they constitute\n"
-    "a complete ring is recorded and saved in a std::set, so that there is\n"
+    "a complete ring is recorded and saved in a set, so that there is\n"
     "only one of each fragment type. Chemically identical versions, i.e. ones with\n"
     "the atoms listed in reverse order and rings listed starting at different\n"
     "atoms, are identified and only a single canonical fragment is retained\n"
@@ -65,27 +65,68 @@ public:
    For the rest, even when stopped by encountering atoms already visited
          0    , atno(1), bo(1)(2), atno(2), bo(2)(3),...atno(n)
   **/
+  /// The info is kept for each thread, and is that of its last GetFingerprint() call.
 virtual std::string DescribeBits(const std::  vector<unsigned int> fp, bool bSet=true)
-  { return _ss.str(); }
+  { return LastDescription(); }
 
   virtual unsigned int Flags() { return _flags;};
   virtual void SetFlags(unsigned int f){ _flags=f; }
 
 private:
-	typedef std::set<std::vector<int> > Fset;
-	typedef std::set<std::vector<int> >::iterator SetItr;
+	enum { Max_Fragment_Size = 7, Max_Fragment_Length = 2 * Max_Fragment_Size };
 
-	void getFragments(std::vector<int> levels, std::vector<int> curfrag,
-			int level, OBAtom* patom, OBBond* pbond);
-	void DoReverses();
-	void DoRings();
+	/// A set of fragments kept in fixed size slots of a single vector and found
+	/// by open addressing. Its storage is reused from one molecule to the next.
+	class FragmentSet
+	{
+	public:
+		FragmentSet() : _count(0) {}
+		/// \returns true if the fragment was not already present
+		bool Insert(const int* frag, unsigned int size);
+		void Clear();
+		/// The fragments, in the order they were added
+		unsigned int Size() const { return _used.size(); }
+		const int* Fragment(unsigned int i) const { return &_slots[_used[i] * SlotSize + 1]; }
+		unsigned int FragmentSize(unsigned int i) const { return _slots[_used[i] * SlotSize]; }
+	private:
+		enum { SlotSize = Max_Fragment_Length + 2 }; // size, fragment and padding
+		void Grow();
+		std::vector<int> _slots; // an empty slot has size 0
+		std::vector<unsigned int> _used;
+		unsigned int _count;
+	};
+
+	/// The heavy atom graph of the molecule, the current path and the fragments
+	/// found, which are kept for each thread so that the single instance can be
+	/// used from several threads at once, and little is allocated for each molecule.
+	struct Workspace
+	{
+		std::vector<int> atno;     // atomic number of each atom (index = idx-1)
+		std::vector<int> levels;   // position of each atom in the current path, or 0
+		std::vector<int> nbrStart; // the neighbours of atom i are nbrStart[i] to nbrStart[i+1]-1
+		std::vector<int> nbrAtom, nbrBond, nbrCode;
+		std::vector<int> nbrNext;  // used while filling the above
+		int curfrag[Max_Fragment_Length];
+		FragmentSet fragset;
+	};
+	static Workspace& GetWorkspace()
+	{
+		static thread_local Workspace ws;
+		return ws;
+	}
 
-	unsigned int CalcHash(const std::vector<int>& frag);
-	void PrintFpt(const std::vector<int>& f, int hash=0);
+	void getFragments(Workspace& ws, std::vector<unsigned int>& fp, int level, int atom, int bond);
+	void AddFragment(Workspace& ws, std::vector<unsigned int>& fp, const int* frag, unsigned int size);
+
+	unsigned int CalcHash(const int* frag, unsigned int size);
+	void PrintFpt(std::ostream& os, const int* f, unsigned int size, int hash=0);
+
+	static std::string& LastDescription()
+	{
+		static thread_local std::string description;
+		return description;
+	}
 
-	Fset fragset;
-	Fset ringset;
-  stringstream _ss;
   unsigned int _flags;
 
 };
@@ -105,173 +146,221 @@ bool fingerprint2::GetFingerprint(OBBase* pOb, vector<unsigned int>&fp, int nbit
 	OBMol* pmol = dynamic_cast<OBMol*>(pOb);
 	if(!pmol) return false;
 	fp.resize(1024/Getbitsperint());
-	fragset.clear();//needed because now only one instance of fp class
-	ringset.clear();
- 
-	//identify fragments starting at every atom
+
+	//Make the graph of heavy atoms, with the bond codes used in the fragments
+	Workspace& ws = GetWorkspace();
+	const unsigned int natoms = pmol->NumAtoms();
+	ws.atno.resize(natoms);
+	ws.levels.assign(natoms, 0);
+	ws.nbrStart.assign(natoms + 1, 0);
 	OBAtom *patom;
 	vector<OBNodeBase*>::iterator i;
 	for (patom = pmol->BeginAtom(i);patom;patom = pmol->NextAtom(i))
+		ws.atno[patom->GetIdx()-1] = patom->GetAtomicNum();
+	OBBond *pbond;
+	vector<OBBond*>::iterator j;
+	for (pbond = pmol->BeginBond(j);pbond;pbond = pmol->NextBond(j))
 	{
-		if(patom->GetAtomicNum() == OBElements::Hydrogen) continue;
-		vector<int> curfrag;
-		vector<int> levels(pmol->NumAtoms());
-		getFragments(levels, curfrag, 1, patom, nullptr);
+		int a = pbond->GetBeginAtomIdx()-1, b = pbond->GetEndAtomIdx()-1;
+		if(ws.atno[a] == OBElements::Hydrogen || ws.atno[b] == OBElements::Hydrogen) continue;
+		++ws.nbrStart[a+1];
+		++ws.nbrStart[b+1];
+	}
+	for (unsigned int n = 0; n < natoms; ++n)
+		ws.nbrStart[n+1] += ws.nbrStart[n];
+	const int nnbrs = ws.nbrStart[natoms];
+	ws.nbrAtom.resize(nnbrs);
+	ws.nbrBond.resize(nnbrs);
+	ws.nbrCode.resize(nnbrs);
+	ws.nbrNext.assign(ws.nbrStart.begin(), ws.nbrStart.end() - 1);
+	vector<int>& next = ws.nbrNext;
+	for (pbond = pmol->BeginBond(j);pbond;pbond = pmol->NextBond(j))
+	{
+		int a = pbond->GetBeginAtomIdx()-1, b = pbond->GetEndAtomIdx()-1;
+		if(ws.atno[a] == OBElements::Hydrogen || ws.atno[b] == OBElements::Hydrogen) continue;
+		int bo = pbond->IsAromatic() ? 5 : pbond->GetBondOrder();
+		//Hydrogens,charges(except dative bonds), spinMultiplicity ignored
+		int idx = pbond->GetIdx();
+		ws.nbrAtom[next[a]] = b; ws.nbrBond[next[a]] = idx; ws.nbrCode[next[a]++] = bo;
+		ws.nbrAtom[next[b]] = a; ws.nbrBond[next[b]] = idx; ws.nbrCode[next[b]++] = bo;
 	}
 
-//	TRACE("%s %d frags before; ",pmol->GetTitle(),fragset.size());
-
-	//Ensure that each chemically identical fragment is present only in a single
-	DoRings();
-	DoReverses();
+	//identify fragments starting at every atom. Each is hashed and its bit set
+	//as it is found, if it has not been seen already.
+	ws.fragset.Clear();
+	ws.curfrag[0] = 0;
+	for (unsigned int n = 0; n < natoms; ++n)
+	{
+		if(ws.atno[n] == OBElements::Hydrogen) continue;
+		getFragments(ws, fp, 1, n, -1);
+	}
 
-	SetItr itr;
-  _ss.str("");
-	for(itr=fragset.begin();itr!=fragset.end();++itr)
+	if(!(Flags() & FPT_NOINFO))
 	{
-		//Use hash of fragment to set a bit in the fingerprint
-		int hash = CalcHash(*itr);
-		SetBit(fp,hash);
-		if(!(Flags() & FPT_NOINFO))
-      PrintFpt(*itr,hash);
+		//The description lists the fragments in order
+		vector<vector<int> > frags(ws.fragset.Size());
+		for(unsigned int n = 0; n < frags.size(); ++n)
+			frags[n].assign(ws.fragset.Fragment(n), ws.fragset.Fragment(n) + ws.fragset.FragmentSize(n));
+		sort(frags.begin(), frags.end());
+		stringstream ss;
+		for(unsigned int n = 0; n < frags.size(); ++n)
+			PrintFpt(ss, &frags[n][0], frags[n].size(), CalcHash(&frags[n][0], frags[n].size()));
+		LastDescription() = ss.str();
 	}
+	else
+		LastDescription().clear();
 	if(nbits)
 		Fold(fp, nbits);
 
-//	TRACE("%d after\n",fragset.size());
 	return true;
 }
 
 //////////////////////////////////////////////////////////
-void fingerprint2::getFragments(vector<int> levels, vector<int> curfrag,
-					int level, OBAtom* patom, OBBond* pbond)
+void fingerprint2::getFragments(Workspace& ws, vector<unsigned int>& fp, int level, int atom, int bond)
 {
-	//Recursive routine to analyse schemical structure and populate fragset and ringset
-	//Hydrogens,charges(except dative bonds), spinMultiplicity ignored
-	const int Max_Fragment_Size = 7;
-	int bo=0;
-	if(pbond)
-	{
-		bo = pbond->IsAromatic() ? 5 : pbond->GetBondOrder();
-
-//		OBAtom* pprevat = pbond->GetNbrAtom(patom);
-//		if(patom->GetFormalCharge() && (patom->GetFormalCharge() == -pprevat->GetFormalCharge()))
-//			++bo; //coordinate (dative) bond eg C[N+]([O-])=O is seen as CN(=O)=O
-	}
-	curfrag.push_back(bo);
-	curfrag.push_back(patom->GetAtomicNum());
-	levels[patom->GetIdx()-1] = level;
-
-	vector<OBBond*>::iterator itr;
-	OBBond *pnewbond;
-//	PrintFpt(curfrag,(int)patom);
-	for (pnewbond = patom->BeginBond(itr);pnewbond;pnewbond = patom->NextBond(itr))
+	//Recursive routine to analyse chemical structure, extending the path in
+	//ws.curfrag by atom and adding the fragments found.
+	//Each fragment is kept only in its chemically unique representation: for a
+	//linear fragment the larger of the two directions, and for a complete ring
+	//the largest of its rotations and their reverses, comparing them as
+	//sequences of ints. Since every path is found in each direction and from
+	//each starting point, only those found in this representation are added.
+	int* curfrag = ws.curfrag;
+	const int size = 2 * level;
+	curfrag[size-1] = ws.atno[atom];
+	ws.levels[atom] = level;
+
+	for (int n = ws.nbrStart[atom]; n < ws.nbrStart[atom+1]; ++n)
 	{
-		if(pnewbond==pbond) continue; //don't retrace steps
-		OBAtom* pnxtat = pnewbond->GetNbrAtom(patom);
-		if(pnxtat->GetAtomicNum() == OBElements::Hydrogen) continue;
+		if(ws.nbrBond[n] == bond) continue; //don't retrace steps
+		int nxtat = ws.nbrAtom[n];
 
-		int atlevel = levels[pnxtat->GetIdx()-1];
+		int atlevel = ws.levels[nxtat];
 		if(atlevel) //ring
 		{
 			if(atlevel==1)
 			{
 				//If complete ring (last bond is back to starting atom) add bond at front
-				//and save in ringset
-				curfrag[0] = pnewbond->IsAromatic() ? 5 : pnewbond->GetBondOrder();
-				ringset.insert(curfrag);
- 				curfrag[0] = 0;
+				curfrag[0] = ws.nbrCode[n];
+				bool largest = true;
+				for(int rot = 2; rot <= size && largest; rot += 2)
+				{
+					//compare with the rotation and its reverse
+					for(int rev = 0; rev < 2; ++rev)
+					{
+						int k = 0, diff = 0;
+						for(; k < size && !diff; ++k)
+						{
+							int r = rev && k ? (size - k + rot) % size : (k + rot) % size;
+							diff = curfrag[r] - curfrag[k];
+						}
+						if(diff > 0)
+						{
+							largest = false;
+							break;
+						}
+					}
+				}
+				if(largest)
+					AddFragment(ws, fp, curfrag, size);
+				curfrag[0] = 0;
 			}
 		}
 		else //no ring
 		{
 			if(level<Max_Fragment_Size)
 			{
-//				TRACE("level=%d size=%d %p frag[0]=%p\n",level, curfrag.size(),&curfrag, &(curfrag[0]));
-				//Do the next atom; levels, curfrag are passed by value and hence copied
-				getFragments(levels, curfrag, level+1, pnxtat, pnewbond);
+				//Do the next atom
+				curfrag[size] = ws.nbrCode[n];
+				getFragments(ws, fp, level+1, nxtat, ws.nbrBond[n]);
 			}
 		}
 	}
+	ws.levels[atom] = 0;
 
 	//do not save C,N,O single atom fragments
-	if(curfrag[0]==0 &&
-		(level>1 || patom->GetAtomicNum()>8  || patom->GetAtomicNum()<6))
+	if(level>1 || ws.atno[atom]>8  || ws.atno[atom]<6)
 	{
-		fragset.insert(curfrag); //curfrag ignored if an identical fragment already present
-//		PrintFpt(curfrag,level);
+		//Only the larger direction, leaving 0 at the front alone
+		int k = 1;
+		while(k < size && curfrag[k] == curfrag[size-k])
+			++k;
+		if(k == size || curfrag[k] > curfrag[size-k])
+			AddFragment(ws, fp, curfrag, size);
 	}
 }
 
 ///////////////////////////////////////////////////
-void fingerprint2::DoReverses()
+void fingerprint2::AddFragment(Workspace& ws, vector<unsigned int>& fp, const int* frag, unsigned int size)
 {
-	SetItr itr;
-	for(itr=fragset.begin();itr!=fragset.end();)
-	{
-		//Reverse the order of the atoms, add the smallest fragment and remove the larger
-		SetItr titr = itr++; //Ensure have valid next iterator in case current one is erased
-		vector<int> t1(*titr); //temporary copy
-		reverse(t1.begin()+1, t1.end()); //(leave 0 at front alone)
-		if(t1!=*titr)
-		{
-			//Add the larger fragment and delete the smaller
-			if(t1>*titr)
-			{
-				fragset.erase(titr);
-				fragset.insert(t1);
-			}
-			else
-				fragset.erase(t1);
-		}
-	}
+	//Use hash of fragment to set a bit in the fingerprint, once for each fragment
+	if(ws.fragset.Insert(frag, size))
+		SetBit(fp, CalcHash(frag, size));
 }
+
 ///////////////////////////////////////////////////
-void fingerprint2::DoRings()
+bool fingerprint2::FragmentSet::Insert(const int* frag, unsigned int size)
 {
-	//For each complete ring fragment, find its largest chemically identical representation
-	//by rotating and reversing, and insert into the main set of fragments
-	SetItr itr;
-	for(itr=ringset.begin();itr!=ringset.end();++itr)
+	if((_count + 1) * 2 > _slots.size() / SlotSize)
+		Grow();
+	unsigned int hash = 2166136261u; // FNV-1a
+	for(unsigned int i = 0; i < size; ++i)
+		hash = (hash ^ static_cast<unsigned int>(frag[i])) * 16777619u;
+	hash ^= hash >> 15;
+	const unsigned int mask = _slots.size() / SlotSize - 1;
+	for(unsigned int slot = hash & mask;; slot = (slot + 1) & mask)
 	{
-		vector<int> t1(*itr); //temporary copy
-		vector<int> maxring(*itr); //the current largest vector
-		unsigned int i;
-		for(i=0;i<t1.size()/2;++i)
+		int* p = &_slots[slot * SlotSize];
+		if(p[0] == 0)
 		{
-			//rotate atoms in ring
-			rotate(t1.begin(),t1.begin()+2,t1.end());
-			if(t1>maxring)
-				maxring=t1;
-
-			//reverse the direction around ring
-			vector<int> t2(t1);
-			reverse(t2.begin()+1, t2.end());
-			if(t2>maxring)
-				maxring=t2;
+			p[0] = size;
+			copy(frag, frag + size, p + 1);
+			_used.push_back(slot);
+			++_count;
+			return true;
 		}
-		fragset.insert(maxring);
-		//PrintFpt(maxring,0);
+		if(static_cast<unsigned int>(p[0]) == size && equal(frag, frag + size, p + 1))
+			return false;
 	}
 }
 
+void fingerprint2::FragmentSet::Clear()
+{
+	for(unsigned int i = 0; i < _used.size(); ++i)
+		_slots[_used[i] * SlotSize] = 0;
+	_used.clear();
+	_count = 0;
+}
+
+void fingerprint2::FragmentSet::Grow()
+{
+	vector<int> old;
+	old.swap(_slots);
+	vector<unsigned int> used;
+	used.swap(_used);
+	_slots.assign(max<size_t>(256, 2 * (old.size() / SlotSize)) * SlotSize, 0);
+	_count = 0;
+	for(unsigned int i = 0; i < used.size(); ++i)
+		Insert(&old[used[i] * SlotSize + 1], old[used[i] * SlotSize]);
+}
+
 //////////////////////////////////////////////////////////
-unsigned int fingerprint2::CalcHash(const vector<int>& frag)
+unsigned int fingerprint2::CalcHash(const int* frag, unsigned int size)
 {
 	//Something like... whole of fragment treated as a binary number modulus 1021
 	const int MODINT = 108; //2^32 % 1021
 	unsigned int hash=0;
-	for(unsigned i=0;i<frag.size();++i)
+	for(unsigned i=0;i<size;++i)
 		hash= (hash*MODINT + (frag[i] % 1021)) % 1021;
 	return hash;
 }
 
-void fingerprint2::PrintFpt(const vector<int>& f, int hash)
+void fingerprint2::PrintFpt(ostream& os, const int* f, unsigned int size, int hash)
 {
 	unsigned int i;
-	for(i=0;i<f.size();++i)
-    _ss  << f[i] << " ";
-  _ss << "<" << hash << ">" << endl;
+	for(i=0;i<size;++i)
+    os  << f[i] << " ";
+  os << "<" << hash << ">" << endl;
 }
 
 } //namespace OpenBabel
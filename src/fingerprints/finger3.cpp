@@ -21,7 +21,9 @@ GNU General Public License for more details.
 #include <openbabel/oberror.h>
 #include <sstream>
 #include <fstream>
+#include <atomic>
 #include <map>
+#include <mutex>
 #include <string>
 
 #include <openbabel/fingerprint.h>
@@ -45,13 +47,15 @@ private:
   vector<pattern> _pats;
   int _bitcount;
   string _version;
+  std::atomic<bool> _patsRead; // whether _pats is complete and can be shared
+  std::mutex _readMutex;
 
 protected:
   string _patternsfile;
 
 public:
   PatternFP(const char* ID, const char* filename=nullptr,
-      bool IsDefault=false) : OBFingerprint(ID, IsDefault)
+      bool IsDefault=false) : OBFingerprint(ID, IsDefault), _patsRead(false)
   {
     if (filename == nullptr)
       _patternsfile="patterns.txt";
@@ -71,7 +75,7 @@ public:
     // so the secondline is present only after the fingerprint has been used.
     // the
     string secondline;
-    if(!_pats.empty())
+    if(_patsRead)
       secondline = "\n" + toString(_bitcount) + " bits. Datafile version = " +  _version;
     desc = "SMARTS patterns specified in the file " + _patternsfile
       + secondline
@@ -100,9 +104,15 @@ public:
     pmol->DeleteHydrogens();
 
     unsigned int n;
-    //Read patterns file if it has not been done already
-    if(_pats.empty())
-      ReadPatternFile(_version);
+    //Read patterns file if it has not been done already.
+    //Other threads wait, then share the patterns, which are not changed by matching.
+    if(!_patsRead)
+    {
+      std::lock_guard<std::mutex> lock(_readMutex);
+      if(_pats.empty())
+        ReadPatternFile(_version);
+      _patsRead = !_pats.empty();
+    }
 
     //Make fp size the smallest power of two to contain the patterns
     n=Getbitsperint();
@@ -111,11 +121,13 @@ public:
     fp.resize(n/Getbitsperint());
 
     n=0; //bit position
-    vector<pattern>::iterator ppat;
+    vector<vector<int> > mlist;
+    vector<pattern>::const_iterator ppat;
     for(ppat=_pats.begin();ppat!=_pats.end();++ppat)
     {
       if(ppat->numbits //ignore pattern if numbits==0
-        && ppat->obsmarts.Match(*pmol, ppat->numoccurrences==0))//do single match if all that's needed
+        && ppat->obsmarts.Match(*pmol, mlist, //do single match if all that's needed
+             ppat->numoccurrences==0 ? OBSmartsPattern::Single : OBSmartsPattern::AllUnique))
       {
         /* Set bits in the fingerprint depending on the number of matches in the molecule
            and the parameters, numbits and numoccurrences, in the pattern.
@@ -132,7 +144,7 @@ public:
               2 matches to the pattern would give 0111
               3 or more matches to the pattern would give 1111
         */
-        int numMatches = ppat->obsmarts.GetUMapList().size();
+        int numMatches = mlist.size();
         int num =  ppat->numbits, div = ppat->numoccurrences+1, ngrp;
 
         int i = n;
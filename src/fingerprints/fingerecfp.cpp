@@ -20,48 +20,74 @@ GNU General Public License for more details.
 #include <openbabel/fingerprint.h>
 #include <openbabel/obiter.h>
 #include <openbabel/elements.h>
+#include <openbabel/parsmart.h>
 
 #include <vector>
 #include <algorithm>
+#include <cstdlib>
 
 using namespace std;
 namespace OpenBabel
 {
 
-/// \brief Fingerprint based on ECFP
+/// \brief Fingerprint based on ECFP, or on FCFP when the atoms are described by their functional class
 class fingerprintECFP : public OBFingerprint
 {
 public:
 	fingerprintECFP(const char* ID, bool IsDefault=false,
-                  unsigned int radius=4, bool keepdups = true)
+                  unsigned int radius=4, bool keepdups = true, bool functional = false)
 		: OBFingerprint(ID, IsDefault),
-      _radius(radius), _keepdups(keepdups), _flags(0){};
+      _radius(radius), _keepdups(keepdups), _functional(functional), _flags(0){};
 
 	virtual const char* Description()
 	{ 
           // Important! The second line is used by some output formats (e.g. FPS)
 	  // to determine the default size
+	  if (_functional)
+	    return "Functional-Class Fingerprints (FCFPs)\n"
+                 "4096 bits.\n"
+                 "Circular topological fingerprints of specified radius, in which\n"
+                 "the atoms are described only by whether they are hydrogen bond\n"
+                 "donors or acceptors, aromatic, halogens, basic or acidic.\n"
+                 "FCFP is definable";
 	  return "Extended-Connectivity Fingerprints (ECFPs)\n"
                  "4096 bits.\n"
-                 "Circular topological fingerprints of specified radius\n";
+                 "Circular topological fingerprints of specified radius\n"
+                 "ECFP is definable";
 	}
 
+  /// Entries in plugindefines.txt like
+  /// \code
+  /// ECFP
+  /// ECFP12   # ID
+  /// 6        # radius
+  /// \endcode
+  /// (or FCFP) make fingerprints of larger radius
+  virtual fingerprintECFP* MakeInstance(const std::vector<std::string>& textlines)
+  {
+    return new fingerprintECFP(textlines[1].c_str(), false, atoi(textlines[2].c_str()),
+                               true, textlines[0] == "FCFP");
+  }
+
 	//Calculates the fingerprint
 	virtual bool GetFingerprint(OBBase* pOb, vector<unsigned int>&fp, int nbits=0);
 
-  /// \returns fragment info unless SetFlags(OBFingerprint::FPT_NOINFO) has been called before GetFingerprint() called.
+  /// The unfolded features, without those that duplicate the environment of another
+  virtual bool GetCountFingerprint(OBBase* pOb, vector<FeatureCount>& features);
+
+  /// \returns an empty string: no fragment info is kept, so that the instance can be shared between threads
   virtual std::string DescribeBits(const std::  vector<unsigned int> fp, bool bSet=true)
-  { return _ss.str(); }
+  { return std::string(); }
 
   virtual unsigned int Flags() { return _flags;};
   virtual void SetFlags(unsigned int f){ _flags=f; }
 
 private:
-  std::vector<unsigned int> v;
+  void GetFeatures(OBMol& mol, vector<unsigned int>& features, bool dedup);
 
-  stringstream _ss;
   unsigned int _radius;
   bool _keepdups;
+  bool _functional;
   unsigned int _flags;
 };
 
@@ -73,6 +99,12 @@ private:
   fingerprintECFP theECFP6("ECFP6",false, 3, true);
   fingerprintECFP theECFP8("ECFP8",false, 4, true);
   fingerprintECFP theECFP10("ECFP10",false, 5, true);
+  fingerprintECFP theFCFP0("FCFP0",false, 0, true, true);
+  fingerprintECFP theFCFP2("FCFP2",false, 1, true, true);
+  fingerprintECFP theFCFP4("FCFP4",false, 2, true, true);
+  fingerprintECFP theFCFP6("FCFP6",false, 3, true, true);
+  fingerprintECFP theFCFP8("FCFP8",false, 4, true, true);
+  fingerprintECFP theFCFP10("FCFP10",false, 5, true, true);
 //***********************************************
 
 #define mix32(a,b,c) \
@@ -154,11 +186,6 @@ static unsigned int ECFPHash(std::vector<unsigned int> &v)
 }
 
 
-struct AtomInfo {
-  unsigned int e[5]; // hashcodes for ecfp0, 2, 4... This will segfault at ECFP12
-  std::vector<unsigned int> b[4]; // for duplicate removal as described in paper?
-};
-
 struct NborInfo {
   unsigned int order;
   unsigned int idx;
@@ -172,17 +199,28 @@ struct NborInfo {
   }
 };
 
-static void ECFPPass(OpenBabel::OBMol &mol,
-                     AtomInfo *ainfo, unsigned int pass)
+// The hash codes of the atoms for one pass are in e[pass*stride + idx], where
+// stride = NumAtoms()+1. When duplicates are to be removed, the bonds within
+// the environment of each atom are kept as a bit set in env[(pass*stride + idx)*words].
+static void ECFPPass(OpenBabel::OBMol &mol, std::vector<unsigned int> &e,
+                     std::vector<unsigned long long> &env, unsigned int words,
+                     unsigned int pass)
 {
+  const unsigned int stride = mol.NumAtoms() + 1;
+  const unsigned int *prev = &e[(pass-1)*stride];
+  unsigned int *next = &e[pass*stride];
+  std::vector<NborInfo> nbrs;
+  std::vector<unsigned int> vint;
   FOR_ATOMS_OF_MOL(atom, mol) {
     if (atom->GetAtomicNum() == OBElements::Hydrogen)
       continue;
     OpenBabel::OBAtom* aptr = &(*atom);
     unsigned int idx = aptr->GetIdx();
-    AtomInfo *ptr = &ainfo[idx];
+    unsigned long long *aenv = words ? &env[(pass*stride + idx)*words] : nullptr;
+    if (aenv)
+      std::copy(aenv - stride*words, aenv - stride*words + words, aenv);
 
-    std::vector<NborInfo> nbrs;
+    nbrs.clear();
     FOR_BONDS_OF_ATOM(bptr, aptr) {
       OpenBabel::OBAtom* nptr = bptr->GetNbrAtom(aptr);
       if (nptr->GetAtomicNum() == OBElements::Hydrogen)
@@ -198,30 +236,83 @@ static void ECFPPass(OpenBabel::OBMol &mol,
 
       unsigned int nidx = nptr->GetIdx();
 
-      nbrs.push_back(NborInfo(order,ainfo[nidx].e[pass-1]));
-      // for duplicate removal as described in paper (?)
-      if (pass == 1)
-        ptr->b[pass-1].push_back(bptr->GetIdx());
+      nbrs.push_back(NborInfo(order,prev[nidx]));
+      if (aenv) {
+        // the environment grows by the bond and the previous one of the neighbour
+        const unsigned long long *nenv = &env[((pass-1)*stride + nidx)*words];
+        for (unsigned int w = 0; w < words; ++w)
+          aenv[w] |= nenv[w];
+        unsigned int bidx = bptr->GetIdx();
+        aenv[bidx / 64] |= 1ULL << (bidx % 64);
+      }
     }
     std::sort(nbrs.begin(),nbrs.end());
 
-    std::vector<unsigned int> vint;
+    vint.clear();
     vint.push_back(pass);
-    vint.push_back(ptr->e[pass-1]);
+    vint.push_back(prev[idx]);
     std::vector<NborInfo>::const_iterator ni;
     for (ni=nbrs.begin(); ni!=nbrs.end(); ++ni) {
       vint.push_back(ni->order);
       vint.push_back(ni->idx);
     }
-    ptr->e[pass] = ECFPHash(vint);
+    next[idx] = ECFPHash(vint);
   }
 }
 
+// The functional classes of atoms used in FCFP, as defined by Rogers and Hahn:
+// hydrogen bond donor, acceptor, aromatic, halogen, basic and acidic. Each is a
+// SMARTS pattern for the atom. The patterns are parsed once and are not changed
+// by matching, so they are shared between threads.
+struct FunctionalClasses {
+  enum { Count = 6 };
+  OBSmartsPattern patterns[Count];
+
+  FunctionalClasses()
+  {
+    patterns[0].Init("[$([N;!H0;v3,v4&+1]),$([O,S;H1;+0]),n&H1&+0]");
+    patterns[1].Init("[$([O,S;H1;v2;!$(*-*=[O,N,P,S])]),$([O,S;H0;v2]),$([O,S;-]),"
+                     "$([O,S;H0;v1;!$(*=*)]),n&H0&+0,$([o,s;+0;!$([o,s]:n);!$([o,s]:c:n)])]");
+    patterns[2].Init("[a]");
+    patterns[3].Init("[F,Cl,Br,I]");
+    patterns[4].Init("[#7;+,$([N;H2&+0][$([C,a]);!$([C,a](=O))]),"
+                     "$([N;H1&+0]([$([C,a]);!$([C,a](=O))])[$([C,a]);!$([C,a](=O))]),"
+                     "$([N;H0&+0]([C;!$(C=*)])([C;!$(C=*)])[C;!$(C=*)])]");
+    patterns[5].Init("[$([C,S](=[O,S,P])-[O;H1,-1])]");
+  }
+
+  // Sets a bit in classes[idx] for each class of the atom
+  void Match(OpenBabel::OBMol &mol, unsigned char *classes) const
+  {
+    std::vector<std::vector<int> > mlist;
+    for (unsigned int i = 0; i < Count; ++i)
+      if (patterns[i].Match(mol, mlist, OBSmartsPattern::AllUnique))
+        for (unsigned int m = 0; m < mlist.size(); ++m)
+          classes[mlist[m][0]] |= 1 << i;
+  }
+};
+
 static void ECFPFirstPass(OpenBabel::OBMol &mol,
-                          AtomInfo *ainfo)
+                          unsigned int *e, bool functional)
 {
   unsigned char buffer[8];
 
+  if (functional) {
+    /* First Pass: FCFP_0, from the functional classes of the atom */
+    static const FunctionalClasses functionalClasses;
+    std::vector<unsigned char> classes(mol.NumAtoms() + 1, 0);
+    functionalClasses.Match(mol, &classes[0]);
+    FOR_ATOMS_OF_MOL(atom, mol) {
+      if (atom->GetAtomicNum() == OBElements::Hydrogen)
+        continue;
+      unsigned int idx = atom->GetIdx();
+      for (unsigned int i = 0; i < FunctionalClasses::Count; ++i)
+        buffer[i] = (classes[idx] >> i) & 1;
+      e[idx] = ECFPHash(buffer,FunctionalClasses::Count);
+    }
+    return;
+  }
+
   /* First Pass: ECFP_0 */
   FOR_ATOMS_OF_MOL(atom, mol) {
     if (atom->GetAtomicNum() == OBElements::Hydrogen)
@@ -236,8 +327,82 @@ static void ECFPFirstPass(OpenBabel::OBMol &mol,
     buffer[5] = (unsigned char)(aptr->ExplicitHydrogenCount() + aptr->GetImplicitHCount());
     buffer[6] = aptr->IsInRing() ? 1 : 0;
     buffer[7] = 0;  // aptr->IsAromatic() ? 1 : 0;
-    ainfo[idx].e[0] = ECFPHash(buffer,8);
+    e[idx] = ECFPHash(buffer,8);
+  }
+}
+
+// An environment of radius >= 1, for duplicate removal
+struct ECFPEnvironment {
+  const unsigned long long *bonds;
+  unsigned int words;
+  unsigned int pass;
+  unsigned int code;
+
+  bool SameBonds(const ECFPEnvironment &x) const
+  {
+    return std::equal(bonds, bonds + words, x.bonds);
+  }
+  bool NoBonds() const
+  {
+    return std::count(bonds, bonds + words, 0ULL) == (std::ptrdiff_t)words;
+  }
+  bool operator < (const ECFPEnvironment &x) const
+  {
+    for (unsigned int w = 0; w < words; ++w)
+      if (bonds[w] != x.bonds[w])
+        return bonds[w] < x.bonds[w];
+    if (pass != x.pass)
+      return pass < x.pass;
+    return code < x.code;
+  }
+};
+
+void fingerprintECFP::GetFeatures(OBMol& mol, vector<unsigned int>& features, bool dedup)
+{
+  features.clear();
+  const unsigned int stride = mol.NumAtoms() + 1;
+  const unsigned int words = dedup ? (mol.NumBonds() + 63) / 64 : 0;
+
+  // Access these using the Atom::Idx()
+  std::vector<unsigned int> e(stride);
+  std::vector<unsigned long long> env(stride * words, 0);
+
+  ECFPFirstPass(mol, &e[0], _functional);
+  unsigned int pass, npasses = _radius;
+  for (pass=1; pass<= _radius; pass++) {
+    e.resize((pass+1) * stride);
+    env.resize((pass+1) * stride * words);
+    ECFPPass(mol, e, env, words, pass);
+    // when no environment has grown, neither will they in later passes
+    if (dedup && std::equal(env.end() - stride*words, env.end(), env.end() - 2*stride*words)) {
+      npasses = pass - 1;
+      break;
+    }
+  }
+
+  std::vector<ECFPEnvironment> envs;
+  FOR_ATOMS_OF_MOL(atom, mol) {
+    if (atom->GetAtomicNum() == OBElements::Hydrogen)
+      continue;
+    unsigned int idx = atom->GetIdx();
+    features.push_back(e[idx]);
+    for (pass=1; pass <= npasses; pass++) {
+      if (!dedup) {
+        features.push_back(e[pass*stride + idx]);
+        continue;
+      }
+      ECFPEnvironment x = { &env[(pass*stride + idx)*words], words, pass, e[pass*stride + idx] };
+      envs.push_back(x);
+    }
   }
+
+  // Of the environments which contain the same bonds, only that of the smallest
+  // radius, and then the smallest code, is kept. Those of radius 0, which contain
+  // no bonds, are kept for every atom, and so no other without bonds is.
+  std::sort(envs.begin(), envs.end());
+  for (unsigned int i = 0; i < envs.size(); ++i)
+    if (!envs[i].NoBonds() && (i == 0 || !envs[i].SameBonds(envs[i-1])))
+      features.push_back(envs[i].code);
 }
 
 bool fingerprintECFP::GetFingerprint(OBBase* pOb, vector<unsigned int>&fp, int nbits)
@@ -252,33 +417,35 @@ bool fingerprintECFP::GetFingerprint(OBBase* pOb, vector<unsigned int>&fp, int n
   fp.resize(0); // clear without deallocating memory
   fp.resize(nbits/Getbitsperint());
 	
-  _ss.str("");
-
-  unsigned int pass;
-
-  unsigned int count = pmol->NumAtoms();
-  if (count == 0) return true;
-
-  // Access this using the Atom::Idx()
-  AtomInfo *ainfo = new AtomInfo[count+1];
-
-  ECFPFirstPass(*pmol,ainfo);
-  for (pass=1; pass<= _radius; pass++)
-    ECFPPass(*pmol,ainfo,pass);
-
-  // Duplicate removal - this is a simplified version of what's in the paper
-  FOR_ATOMS_OF_MOL(atom, pmol) {
-    if (atom->GetAtomicNum() == OBElements::Hydrogen)
-      continue;    
-    unsigned int idx = atom->GetIdx();
-    for (pass=0; pass <= _radius; pass++) {
-      unsigned int bit = (ainfo[idx].e[pass] % nbits) & 0x7fffffff; 
-      SetBit(fp, bit);
-    }
+  if (pmol->NumAtoms() == 0) return true;
+
+  // The registered fingerprints keep duplicates, so that they are unchanged
+  vector<unsigned int> features;
+  GetFeatures(*pmol, features, !_keepdups);
+  for (unsigned int i = 0; i < features.size(); ++i) {
+    unsigned int bit = (features[i] % nbits) & 0x7fffffff;
+    SetBit(fp, bit);
   }
 
-  delete[] ainfo;
+  return true;
+}
 
+bool fingerprintECFP::GetCountFingerprint(OBBase* pOb, vector<FeatureCount>& counts)
+{
+  counts.clear();
+  OBMol* pmol = dynamic_cast<OBMol*>(pOb);
+  if(!pmol) return false;
+  if (pmol->NumAtoms() == 0) return true;
+
+  vector<unsigned int> features;
+  GetFeatures(*pmol, features, true);
+  std::sort(features.begin(), features.end());
+  for (unsigned int i = 0; i < features.size(); ++i) {
+    if (counts.empty() || counts.back().first != features[i])
+      counts.push_back(FeatureCount(features[i], 1));
+    else
+      ++counts.back().second;
+  }
   return true;
 }
 
@@ -20,6 +20,9 @@ GNU General Public License for more details.
 #include <openbabel/babelconfig.h>
 
 #include <set>
+#include <atomic>
+#include <algorithm>
+#include <limits>
 
 #include <openbabel/forcefield.h>
 
@@ -1164,6 +1167,113 @@ namespace OpenBabel
   //
   //////////////////////////////////////////////////////////////////////////////////
 
+  //! \brief Rigid-rotor steric screen used to prune rotor keys in the rotor searches
+  //!
+  //! Rotor keys are applied in rotor list order (central to peripheral). Once
+  //! rotors 1..d are set, the atoms that are not moved by any later rotor have
+  //! their final relative positions. A clash between two of these atoms can not
+  //! be relieved by the remaining rotors, so all keys sharing this prefix can be
+  //! skipped. Each atom pair is assigned to the depth at which it becomes fixed
+  //! and only the pairs of that depth are checked when rotor d changes.
+  class OBRotorClashScreen
+  {
+    public:
+      OBRotorClashScreen(OBMol &mol, OBRotorList &rl, double factor)
+      {
+        unsigned int numAtoms = mol.NumAtoms();
+        _pairs.resize(rl.Size() + 1);
+
+        // depth at which each atom reaches its final position
+        std::vector<unsigned int> depth(numAtoms, 0);
+        std::vector<int> children;
+        OBRotorIterator ri;
+        OBRotor *rotor = rl.BeginRotor(ri);
+        for (unsigned int d = 1; rotor; ++d, rotor = rl.NextRotor(ri)) {
+          std::vector<int> &ref = rotor->GetDihedralAtoms();
+          mol.FindChildren(children, ref[1], ref[2]);
+          for (std::vector<int>::iterator i = children.begin(); i != children.end(); ++i)
+            depth[*i - 1] = d;
+        }
+
+        // pairs within three bonds are never considered to clash
+        std::vector<unsigned int> stamp(numAtoms, 0);
+        std::vector<OBAtom*> shell, next;
+        FOR_ATOMS_OF_MOL (a, mol) {
+          unsigned int aIdx = a->GetIdx() - 1;
+          stamp[aIdx] = aIdx + 1;
+          shell.assign(1, &*a);
+          for (int n = 0; n < 3; ++n) {
+            next.clear();
+            for (std::vector<OBAtom*>::iterator i = shell.begin(); i != shell.end(); ++i)
+              FOR_NBORS_OF_ATOM (nbr, *i)
+                if (stamp[nbr->GetIdx() - 1] != aIdx + 1) {
+                  stamp[nbr->GetIdx() - 1] = aIdx + 1;
+                  next.push_back(&*nbr);
+                }
+            shell.swap(next);
+          }
+
+          double radA = OBElements::GetVdwRad(a->GetAtomicNum());
+          for (unsigned int bIdx = aIdx + 1; bIdx < numAtoms; ++bIdx) {
+            if (stamp[bIdx] == aIdx + 1)
+              continue;
+            unsigned int d = std::max(depth[aIdx], depth[bIdx]);
+            if (!d)
+              continue; // relative position never changes
+            double minDist = factor * (radA + OBElements::GetVdwRad(mol.GetAtom(bIdx + 1)->GetAtomicNum()));
+            Pair p = { 3 * aIdx, 3 * bIdx, minDist * minDist };
+            _pairs[d].push_back(p);
+          }
+        }
+      }
+
+      //! \return True if two atoms that became fixed at @p depth clash in @p c
+      bool Clash(const double *c, unsigned int depth) const
+      {
+        const std::vector<Pair> &pairs = _pairs[depth];
+        for (std::vector<Pair>::const_iterator p = pairs.begin(); p != pairs.end(); ++p) {
+          double dx = c[p->a] - c[p->b];
+          double dy = c[p->a + 1] - c[p->b + 1];
+          double dz = c[p->a + 2] - c[p->b + 2];
+          if (dx * dx + dy * dy + dz * dz < p->minDistSq)
+            return true;
+        }
+        return false;
+      }
+
+      //! \return True if any two atoms moved by the rotors clash in @p c
+      bool Clash(const double *c) const
+      {
+        for (unsigned int d = 1; d < _pairs.size(); ++d)
+          if (Clash(c, d))
+            return true;
+        return false;
+      }
+
+    private:
+      struct Pair
+      {
+        unsigned int a, b; //!< coordinate offsets
+        double minDistSq;
+      };
+      std::vector<std::vector<Pair> > _pairs; //!< atom pairs indexed by the depth at which they become fixed
+  };
+
+  //! \return The clash factor to prune a rotor search with: a negative @p factor
+  //! (the default) only prunes searches of @p rigid rotamers
+  static double RotorClashFactor(double factor, bool rigid)
+  {
+    if (factor < 0.0)
+      return rigid ? 0.5 : 0.0;
+    return factor;
+  }
+
+  //! Compare rotor keys in the order generated by OBRotorKeys (first rotor changes fastest)
+  static bool CompareRotorKeys(const std::vector<int> &a, const std::vector<int> &b)
+  {
+    return std::lexicographical_compare(a.rbegin(), a.rend(), b.rbegin(), b.rend());
+  }
+
   int OBForceField::SystematicRotorSearchInitialize(unsigned int geomSteps, bool sampleRingBonds)
   {
     if (!_validSetup)
@@ -1207,14 +1317,68 @@ namespace OpenBabel
       return 1; // there are no more conformers
     }
 
-    OBRotorKeys rotorKeys;
-    rotor = rl.BeginRotor(ri);
-    for (unsigned int i = 1; i < rl.Size() + 1; ++i, rotor = rl.NextRotor(ri)) // foreach rotor
-      rotorKeys.AddRotor(rotor->GetResolution().size());
+    double clashFactor = RotorClashFactor(_rotorClashFactor, geomSteps == 0);
+    if (clashFactor > 0.0 && !rl.HasRingRotors()) {
+      // Depth-first enumeration of the rotor keys, skipping all keys that share
+      // a prefix with a clash that can not be relieved by the remaining rotors
+      OBRotorClashScreen screen(_mol, rl, clashFactor);
+      std::vector<OBRotor*> vrotors;
+      for (rotor = rl.BeginRotor(ri); rotor; rotor = rl.NextRotor(ri))
+        vrotors.push_back(rotor);
+
+      unsigned int numCoords = 3 * _mol.NumAtoms();
+      double *initialCoord = new double [numCoords];
+      memcpy((char*)initialCoord,(char*)_mol.GetCoordinates(),sizeof(double)*numCoords);
+
+      std::vector<std::vector<int> > keys;
+      std::vector<int> rotorKey(rl.Size() + 1, -1);
+      rotorKey[0] = 0;
+      unsigned long int pruned = 0;
+      unsigned int depth = 1;
+      while (depth) {
+        if (depth > vrotors.size()) { // complete key
+          keys.push_back(rotorKey);
+          --depth;
+          continue;
+        }
+        if (++rotorKey[depth] == (int)vrotors[depth - 1]->GetResolution().size()) {
+          rotorKey[depth] = -1; // backtrack
+          --depth;
+          continue;
+        }
+        _mol.SetCoordinates(initialCoord);
+        rotamers.SetCurrentCoordinates(_mol, rotorKey);
+        if (screen.Clash(_mol.GetCoordinates(), depth)) {
+          ++pruned;
+          continue;
+        }
+        ++depth;
+      }
+      _mol.SetCoordinates(initialCoord);
+      delete [] initialCoord;
+
+      if (keys.empty()) // everything clashes, fall back to the unpruned search
+        keys.push_back(std::vector<int>(rl.Size() + 1, 0));
+
+      // keep the conformer order of the unpruned search
+      std::sort(keys.begin(), keys.end(), CompareRotorKeys);
+      for (std::vector<std::vector<int> >::iterator k = keys.begin(); k != keys.end(); ++k)
+        rotamers.AddRotamer(*k);
+
+      IF_OBFF_LOGLVL_LOW {
+        snprintf(_logbuf, BUFF_SIZE, "  PRUNED %lu PARTIAL ROTAMERS WITH STERIC CLASHES\n", pruned);
+        OBFFLog(_logbuf);
+      }
+    } else {
+      OBRotorKeys rotorKeys;
+      rotor = rl.BeginRotor(ri);
+      for (unsigned int i = 1; i < rl.Size() + 1; ++i, rotor = rl.NextRotor(ri)) // foreach rotor
+        rotorKeys.AddRotor(rotor->GetResolution().size());
 
-    rotamers.AddRotamer(rotorKeys.GetKey());
-    while (rotorKeys.Next())
       rotamers.AddRotamer(rotorKeys.GetKey());
+      while (rotorKeys.Next())
+        rotamers.AddRotamer(rotorKeys.GetKey());
+    }
 
     rotamers.ExpandConformerList(_mol, _mol.GetConformers());
 
@@ -1475,15 +1639,39 @@ namespace OpenBabel
 
     std::vector<int> rotorKey(rl.Size() + 1, 0); // indexed from 1
 
+    OBRotorClashScreen *screen = nullptr;
+    double *initialCoord = nullptr;
+    double clashFactor = RotorClashFactor(_rotorClashFactor, false);
+    if (clashFactor > 0.0 && !rl.HasRingRotors()) {
+      screen = new OBRotorClashScreen(_mol, rl, clashFactor);
+      initialCoord = new double [_mol.NumAtoms() * 3];
+      memcpy((char*)initialCoord,(char*)_mol.GetCoordinates(),sizeof(double)*3*_mol.NumAtoms());
+    }
+
     for (unsigned int c = 0; c < conformers; ++c) {
-      rotor = rl.BeginRotor(ri);
-      for (unsigned int i = 1; i < rl.Size() + 1; ++i, rotor = rl.NextRotor(ri)) {
-        // foreach rotor
-        rotorKey[i] = generator.NextInt() % rotor->GetResolution().size();
+      for (unsigned int attempt = 0; ; ++attempt) {
+        rotor = rl.BeginRotor(ri);
+        for (unsigned int i = 1; i < rl.Size() + 1; ++i, rotor = rl.NextRotor(ri)) {
+          // foreach rotor
+          rotorKey[i] = generator.NextInt() % rotor->GetResolution().size();
+        }
+        if (!screen || attempt == 10) // give up after 10 clashing keys
+          break;
+
+        _mol.SetCoordinates(initialCoord);
+        rotamers.SetCurrentCoordinates(_mol, rotorKey);
+        if (!screen->Clash(_mol.GetCoordinates()))
+          break;
       }
       rotamers.AddRotamer(rotorKey);
     }
 
+    if (screen) {
+      _mol.SetCoordinates(initialCoord);
+      delete [] initialCoord;
+      delete screen;
+    }
+
     rotamers.ExpandConformerList(_mol, _mol.GetConformers());
 
     IF_OBFF_LOGLVL_LOW {
@@ -1742,8 +1930,14 @@ namespace OpenBabel
       OBFFLog("--------------------\n");
     }
 
+    OBRotorClashScreen *screen = nullptr;
+    double clashFactor = RotorClashFactor(_rotorClashFactor, false);
+    if (clashFactor > 0.0 && !rl.HasRingRotors())
+      screen = new OBRotorClashScreen(_mol, rl, clashFactor);
+
     double defaultRotor = 1.0/sqrt((double)rl.Size());
     unsigned c = 0;
+    unsigned int clashes = 0; // clashing keys drawn in a row
     while (c < conformers) {
       _mol.SetCoordinates(initialCoord);
 
@@ -1770,6 +1964,16 @@ namespace OpenBabel
 
       //FIXME: for now, allow even invalid ring conformers
       rotamers.SetCurrentCoordinates(_mol, rotorKey);
+
+      // a clashing key is not counted as a conformer: there is no need to
+      // optimize the geometry, just penalize this rotorKey and draw another
+      // (but give up after 10 clashing keys in a row)
+      if (screen && clashes < 10 && screen->Clash(_mol.GetCoordinates())) {
+        Reweight(rotorWeights, rotorKey, -0.11);
+        ++clashes;
+        continue;
+      }
+      clashes = 0;
       ++c;
 
       SetupPointers(); // update pointers to atom positions in the OBFFCalculation objects
@@ -1793,7 +1997,7 @@ namespace OpenBabel
 
       if (currentE < bestE) {
         bestE = currentE;
-        best_conformer = c;
+        best_conformer = _mol.NumConformers() - 1;
 
         // improve this rotorKey
         Reweight(rotorWeights, rotorKey, +0.11);
@@ -1808,6 +2012,8 @@ namespace OpenBabel
       }
     }
 
+    delete screen;
+
     IF_OBFF_LOGLVL_LOW {
       snprintf(_logbuf, BUFF_SIZE, "\n  LOWEST ENERGY: %8.3f\n\n",
                bestE);
@@ -4330,40 +4536,111 @@ namespace OpenBabel
     return false;
   }
 
-  OBGridData* OBForceField::GetGrid(double step, double padding, const char* type, double pchg)
+  // Uniform cell list over a set of atom positions. GetGrid() uses it to
+  // find the atoms close to a block of grid points.
+  class GridAtomCells
   {
-    cout << "OBForceFieldMMFF94::GetGrid(" << step << ", " << type << ")" << endl;
-    OBFloatGrid fgrid;
-    fgrid.Init(_mol, step, padding);
-    vector3 min;
-    unsigned int xDim, yDim, zDim, xyzDim;
+    public:
+      GridAtomCells(const std::vector<vector3> &coords, double cellSize) :
+        _coords(coords), _cellSize(cellSize)
+      {
+        _dim[0] = _dim[1] = _dim[2] = 1;
+        if (coords.empty())
+          return;
+
+        double max[3];
+        for (int d = 0; d < 3; ++d)
+          _min[d] = max[d] = coords[0][d];
+        for (size_t i = 1; i < coords.size(); ++i)
+          for (int d = 0; d < 3; ++d) {
+            _min[d] = std::min(_min[d], coords[i][d]);
+            max[d] = std::max(max[d], coords[i][d]);
+          }
+        for (int d = 0; d < 3; ++d)
+          _dim[d] = static_cast<int>((max[d] - _min[d]) / _cellSize) + 1;
+
+        _cells.resize(_dim[0] * _dim[1] * _dim[2]);
+        for (unsigned int i = 0; i < coords.size(); ++i) {
+          int c[3];
+          for (int d = 0; d < 3; ++d)
+            c[d] = static_cast<int>((coords[i][d] - _min[d]) / _cellSize);
+          _cells[(c[0] * _dim[1] + c[1]) * _dim[2] + c[2]].push_back(i);
+        }
+      }
 
-    min = fgrid.GetMin();
+      //! Set @p atoms to the indices, in increasing order, of the atoms
+      //! within @p radius of the box from @p lo to @p hi.
+      void AtomsNear(const vector3 &lo, const vector3 &hi, double radius,
+                     std::vector<unsigned int> &atoms) const
+      {
+        atoms.clear();
+        if (_cells.empty())
+          return;
+
+        int first[3], last[3];
+        for (int d = 0; d < 3; ++d) {
+          first[d] = std::max(0, static_cast<int>(floor((lo[d] - radius - _min[d]) / _cellSize)));
+          last[d] = std::min(_dim[d] - 1, static_cast<int>(floor((hi[d] + radius - _min[d]) / _cellSize)));
+          if (first[d] > last[d])
+            return;
+        }
 
-    xDim = fgrid.GetXdim();
-    yDim = fgrid.GetYdim();
-    zDim = fgrid.GetZdim();
-    xyzDim = xDim * yDim * zDim;
+        double radiusSq = radius * radius;
+        for (int i = first[0]; i <= last[0]; ++i)
+          for (int j = first[1]; j <= last[1]; ++j)
+            for (int k = first[2]; k <= last[2]; ++k) {
+              const std::vector<unsigned int> &cell = _cells[(i * _dim[1] + j) * _dim[2] + k];
+              for (size_t n = 0; n < cell.size(); ++n) {
+                const vector3 &c = _coords[cell[n]];
+                double distSq = 0.0;
+                for (int d = 0; d < 3; ++d) {
+                  double outside = std::max(lo[d] - c[d], c[d] - hi[d]);
+                  if (outside > 0.0)
+                    distSq += outside * outside;
+                }
+                if (distSq <= radiusSq)
+                  atoms.push_back(cell[n]);
+              }
+            }
+        std::sort(atoms.begin(), atoms.end());
+      }
 
-    cout << "xDim = " << xDim << ", yDim = " << yDim << ", zDim = " << zDim << endl;
+    private:
+      const std::vector<vector3> &_coords;
+      double _cellSize;
+      double _min[3];
+      int _dim[3];
+      std::vector<std::vector<unsigned int> > _cells;
+  };
 
-    // Add the probe atom
-    _mol.BeginModify();
-    OBAtom *atom = _mol.NewAtom();
-    int index = atom->GetIdx();
-    _mol.EndModify();
-    SetTypes();
-    atom->SetType(type);
-    atom->SetPartialCharge(pchg);
+  OBGridData* OBForceField::GetGrid(double step, double padding, const char* type, double pchg)
+  {
+    return GetGrid(step, padding, type, pchg, 0.0, false);
+  }
 
-    SetupCalculations();
+  OBGridData* OBForceField::GetGrid(double step, double padding, const char* type, double pchg,
+                                    double cutoff, bool floatPrecision)
+  {
+    // Same limits as OBFloatGrid::Init(), without allocating its values
+    double lo[3] = { 0.0, 0.0, 0.0 }, hi[3] = { 0.0, 0.0, 0.0 };
+    FOR_ATOMS_OF_MOL (a, _mol) {
+      for (int d = 0; d < 3; ++d) {
+        double x = a->GetVector()[d];
+        lo[d] = (a->GetIdx() == 1) ? x : std::min(lo[d], x);
+        hi[d] = (a->GetIdx() == 1) ? x : std::max(hi[d], x);
+      }
+    }
+    vector3 min(lo[0] - padding, lo[1] - padding, lo[2] - padding);
 
-    atom = _mol.GetAtom(index);
-    double *pos = atom->GetCoordinate();
+    unsigned int xDim, yDim, zDim;
+    xDim = static_cast<int>(((hi[0] + padding) - (lo[0] - padding)) / step) + 1;
+    yDim = static_cast<int>(((hi[1] + padding) - (lo[1] - padding)) / step) + 1;
+    zDim = static_cast<int>(((hi[2] + padding) - (lo[2] - padding)) / step) + 1;
 
-    vector3 coord;
-    double evdw, eele;
-    double distance, minDistance;
+    stringstream msg;
+    msg << "GetGrid(" << step << ", " << type << "): xDim = " << xDim
+        << ", yDim = " << yDim << ", zDim = " << zDim;
+    obErrorLog.ThrowError(__FUNCTION__, msg.str(), obDebug);
 
     OBGridData *grid = new OBGridData;
     vector3 xAxis, yAxis, zAxis;
@@ -4371,69 +4648,212 @@ namespace OpenBabel
     yAxis = vector3(0.0, step, 0.0);
     zAxis = vector3(0.0, 0.0, step);
 
+    grid->SetFloatPrecision(floatPrecision);
     grid->SetNumberOfPoints(xDim, yDim, zDim);
     grid->SetLimits(min, xAxis, yAxis, zAxis);
 
-    // VDW surface
-    for (unsigned int i = 0; i < xDim; ++i) {
-      coord.SetX(min[0] + i * step);
-      for (unsigned int j = 0; j < yDim; ++j) {
-        coord.SetY(min[1] + j * step);
-        for (unsigned int k = 0; k < zDim; ++k)
-          {
-            coord.SetZ(min[2] + k * step);
-            minDistance = 1.0E+10;
-            FOR_ATOMS_OF_MOL (a, _mol) {
-              if (a->GetIdx() == atom->GetIdx())
-                continue;
-              if (a->GetAtomicNum() == OBElements::Hydrogen)
-                continue;
-
-              distance = sqrt(coord.distSq(a->GetVector()));
-
-              if (distance < minDistance)
-                minDistance = distance;
-            } // end checking atoms
-            // negative = away from molecule, 0 = vdw surface, positive = inside
-            if (minDistance > 1.0) {
-              grid->SetValue(i, j, k, 0.0); // outside the molecule
-            } else {
-              grid->SetValue(i, j, k, 10e99); // inside the molecule
+    const double insideValue = floatPrecision ? numeric_limits<float>::max() : 10e99;
+
+    vector<vector3> coords, heavyCoords;
+    vector<OBAtom*> atoms;
+    FOR_ATOMS_OF_MOL (a, _mol) {
+      if (a->GetAtomicNum() != OBElements::Hydrogen)
+        heavyCoords.push_back(a->GetVector());
+      if (_constraints.IsIgnored(a->GetIdx()))
+        continue;
+      coords.push_back(a->GetVector());
+      atoms.push_back(&*a);
+    }
+    GridAtomCells heavyCells(heavyCoords, 4.0);
+
+    // Force fields which have not been checked to give the same probe
+    // energies with copies of the atoms below add the probe to the molecule
+    // and evaluate the points one by one.
+    if (!SupportsFastProbeGrid()) {
+      _mol.BeginModify();
+      OBAtom *probe = _mol.NewAtom();
+      _mol.EndModify();
+      SetTypes();
+      probe->SetType(type);
+      probe->SetPartialCharge(pchg);
+      bool validSetup = SetupCalculations();
+      double *pos = probe->GetCoordinate();
+
+      vector<unsigned int> heavyNear;
+      for (unsigned int i = 0; i < xDim; ++i)
+        for (unsigned int j = 0; j < yDim; ++j)
+          for (unsigned int k = 0; k < zDim; ++k) {
+            vector3 coord = min + step * vector3(i, j, k);
+            heavyCells.AtomsNear(coord, coord, 1.0, heavyNear);
+            bool inside = false;
+            for (size_t n = 0; n < heavyNear.size() && !inside; ++n)
+              inside = coord.distSq(heavyCoords[heavyNear[n]]) <= 1.0;
+            if (inside) {
+              grid->SetValue(i, j, k, insideValue);
+            } else if (validSetup) {
+              pos[0] = coord.x();
+              pos[1] = coord.y();
+              pos[2] = coord.z();
+              grid->SetValue(i, j, k, E_VDW(false) + E_Electrostatic(false));
             }
-          } // z-axis
-      } // y-axis
-    } // x-axis
+          }
 
+      _mol.BeginModify();
+      _mol.DeleteAtom(probe);
+      _mol.EndModify();
+      SetTypes();
+      SetupCalculations();
+
+      if (!validSetup) {
+        obErrorLog.ThrowError(__FUNCTION__, "Could not set up the probe calculations", obError);
+        delete grid;
+        return nullptr;
+      }
+      return grid;
+    }
 
-    unsigned int count = 0;
-    for (unsigned int i = 0; i < xDim; ++i) {
-      coord.SetX(min[0] + i * step);
-      for (unsigned int j = 0; j < yDim; ++j) {
-        coord.SetY(min[1] + j * step);
-        for (unsigned int k = 0; k < zDim; ++k)
-          {
-            coord.SetZ(min[2] + k * step);
+    // The probe only adds its own interactions to the energy of the
+    // molecule, so that is computed once and the points only evaluate the
+    // probe-atom pairs.
+    const double moleculeEnergy = E_VDW(false) + E_Electrostatic(false);
+    GridAtomCells atomCells(coords, std::max(cutoff, 4.0));
 
-            count++;
-            cout << "\r" << count << "/" << xyzDim;
+    // Points are handled in cubes of about 3 A. With a cutoff, each cube is
+    // set up with only the atoms within the cutoff of any of its points.
+    const unsigned int blockSize = static_cast<int>(3.0 / step) + 1;
+    const unsigned int nbx = (xDim + blockSize - 1) / blockSize;
+    const unsigned int nby = (yDim + blockSize - 1) / blockSize;
+    const unsigned int nbz = (zDim + blockSize - 1) / blockSize;
+    const int numBlocks = nbx * nby * nbz;
 
-            if (grid->GetValue(i, j, k) == 0.0) {
-              pos[0] = coord.x();
-              pos[1] = coord.y();
-              pos[2] = coord.z();
-              evdw = E_VDW(false);
-              eele = E_Electrostatic(false);
-              grid->SetValue(i, j, k, evdw + eele);
+    std::atomic<bool> validSetup(true);
+
+#ifdef _OPENMP
+    #pragma omp parallel
+#endif
+    {
+      // Every thread evaluates the probe in its own force field instance
+      OBForceField *ff;
+#ifdef _OPENMP
+      #pragma omp critical(OBForceField_GetGrid)
+#endif
+      {
+        ff = MakeNewInstance();
+        ff->_parFile = _parFile;
+        ff->ParseParamFile();
+        ff->_init = true;
+        ff->_velocityPtr = nullptr;
+        ff->_gradientPtr = nullptr;
+        ff->_grad1 = nullptr;
+        ff->_loglvl = OBFF_LOGLVL_NONE;
+        ff->_epsilon = _epsilon;
+        // the constraints are static and indexed by the atoms of _mol, not
+        // of the smaller probe molecules
+        ff->_ignoreConstraints = true;
+      }
+
+      vector<unsigned int> nearAtoms, currentAtoms, heavyNear;
+      vector<unsigned int> points;
+      bool haveSetup = false;
+      double *pos = nullptr;
+
+#ifdef _OPENMP
+      #pragma omp for schedule(dynamic)
+#endif
+      for (int b = 0; b < numBlocks; ++b) {
+        unsigned int i0 = (b / (nby * nbz)) * blockSize;
+        unsigned int j0 = ((b / nbz) % nby) * blockSize;
+        unsigned int k0 = (b % nbz) * blockSize;
+        unsigned int i1 = std::min(i0 + blockSize, xDim);
+        unsigned int j1 = std::min(j0 + blockSize, yDim);
+        unsigned int k1 = std::min(k0 + blockSize, zDim);
+
+        vector3 blockMin = min + step * vector3(i0, j0, k0);
+        vector3 blockMax = min + step * vector3(i1 - 1, j1 - 1, k1 - 1);
+
+        // VDW surface: points within 1 A of a heavy atom are inside the molecule
+        heavyCells.AtomsNear(blockMin, blockMax, 1.0, heavyNear);
+        points.clear();
+        for (unsigned int i = i0; i < i1; ++i)
+          for (unsigned int j = j0; j < j1; ++j)
+            for (unsigned int k = k0; k < k1; ++k) {
+              vector3 coord = min + step * vector3(i, j, k);
+              bool inside = false;
+              for (size_t n = 0; n < heavyNear.size() && !inside; ++n)
+                inside = coord.distSq(heavyCoords[heavyNear[n]]) <= 1.0;
+              if (inside)
+                grid->SetValue(i, j, k, insideValue);
+              else
+                points.push_back((i * yDim + j) * zDim + k);
             }
-          } // z-axis
-      } // y-axis
-    } // x-axis
 
-    cout << endl;
+        if (!points.empty() && validSetup) {
+          if (cutoff > 0.0) {
+            atomCells.AtomsNear(blockMin, blockMax, cutoff, nearAtoms);
+          } else if (nearAtoms.size() != atoms.size()) {
+            nearAtoms.resize(atoms.size());
+            for (unsigned int n = 0; n < atoms.size(); ++n)
+              nearAtoms[n] = n;
+          }
+
+          if (!haveSetup || nearAtoms != currentAtoms) {
+            // probe is atom 1, followed by the atoms it interacts with
+            OBMol &mol = ff->_mol;
+            mol.Clear();
+            mol.BeginModify();
+            OBAtom *probe = mol.NewAtom();
+            probe->SetType(type);
+            probe->SetPartialCharge(pchg);
+            for (size_t n = 0; n < nearAtoms.size(); ++n) {
+              OBAtom *atom = mol.NewAtom();
+              OBAtom *source = atoms[nearAtoms[n]];
+              atom->SetAtomicNum(source->GetAtomicNum());
+              atom->SetVector(source->GetVector());
+              atom->SetType(source->GetType());
+              atom->SetPartialCharge(source->GetPartialCharge());
+            }
+            mol.EndModify();
+            mol.SetAtomTypesPerceived();
+            mol.SetAutomaticPartialCharge(false);
+
+            OBBitVec probeGroup, atomGroup;
+            probeGroup.SetBitOn(1);
+            if (!nearAtoms.empty())
+              atomGroup.SetRangeOn(2, nearAtoms.size() + 1);
+            ff->_interGroups.clear();
+            ff->_interGroups.push_back(make_pair(probeGroup, atomGroup));
+
+            if (!ff->SetupCalculations()) {
+              validSetup = false;
+              continue;
+            }
+            pos = mol.GetAtom(1)->GetCoordinate();
+            currentAtoms = nearAtoms;
+            haveSetup = true;
+          }
 
-    _mol.BeginModify();
-    _mol.DeleteAtom(atom);
-    _mol.EndModify();
+          for (size_t n = 0; n < points.size(); ++n) {
+            unsigned int k = points[n] % zDim;
+            unsigned int j = (points[n] / zDim) % yDim;
+            unsigned int i = points[n] / (yDim * zDim);
+            pos[0] = min[0] + i * step;
+            pos[1] = min[1] + j * step;
+            pos[2] = min[2] + k * step;
+            double evdw = ff->E_VDW(false);
+            double eele = ff->E_Electrostatic(false);
+            grid->SetValue(i, j, k, moleculeEnergy + evdw + eele);
+          }
+        }
+      }
+
+      delete ff;
+    }
+
+    if (!validSetup) {
+      obErrorLog.ThrowError(__FUNCTION__, "Could not set up the probe calculations", obError);
+      delete grid;
+      return nullptr;
+    }
 
     return grid;
   }
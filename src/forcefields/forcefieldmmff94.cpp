@@ -2692,6 +2692,10 @@ namespace OpenBabel
     bool found;
     int order;
 
+    // the probe instances of GetGrid() do not share the constraints of the molecule
+    OBFFConstraints noConstraints;
+    OBFFConstraints &constraints = _ignoreConstraints ? noConstraints : _constraints;
+
     IF_OBFF_LOGLVL_LOW
       OBFFLog("\nS E T T I N G   U P   C A L C U L A T I O N S\n\n");
 
@@ -2714,7 +2718,7 @@ namespace OpenBabel
       b = bond->GetEndAtom();
 
       // skip this bond if the atoms are ignored
-      if ( _constraints.IsIgnored(a->GetIdx()) || _constraints.IsIgnored(b->GetIdx()) )
+      if ( constraints.IsIgnored(a->GetIdx()) || constraints.IsIgnored(b->GetIdx()) )
         continue;
 
       // if there are any groups specified, check if the two bond atoms are in a single intraGroup
@@ -2810,7 +2814,7 @@ namespace OpenBabel
       type_c = atoi(c->GetType());
 
       // skip this angle if the atoms are ignored
-      if ( _constraints.IsIgnored(a->GetIdx()) || _constraints.IsIgnored(b->GetIdx()) || _constraints.IsIgnored(c->GetIdx()) )
+      if ( constraints.IsIgnored(a->GetIdx()) || constraints.IsIgnored(b->GetIdx()) || constraints.IsIgnored(c->GetIdx()) )
         continue;
 
       // if there are any groups specified, check if the three angle atoms are in a single intraGroup
@@ -3107,8 +3111,8 @@ namespace OpenBabel
       type_d = atoi(d->GetType());
 
       // skip this torsion if the atoms are ignored
-      if ( _constraints.IsIgnored(a->GetIdx()) || _constraints.IsIgnored(b->GetIdx()) ||
-           _constraints.IsIgnored(c->GetIdx()) || _constraints.IsIgnored(d->GetIdx()) )
+      if ( constraints.IsIgnored(a->GetIdx()) || constraints.IsIgnored(b->GetIdx()) ||
+           constraints.IsIgnored(c->GetIdx()) || constraints.IsIgnored(d->GetIdx()) )
         continue;
 
       // if there are any groups specified, check if the four torsion atoms are in a single intraGroup
@@ -3390,8 +3394,8 @@ namespace OpenBabel
           type_d = atoi(d->GetType());
 
           // skip this oop if the atoms are ignored
-          if ( _constraints.IsIgnored(a->GetIdx()) || _constraints.IsIgnored(b->GetIdx()) ||
-               _constraints.IsIgnored(c->GetIdx()) || _constraints.IsIgnored(d->GetIdx()) )
+          if ( constraints.IsIgnored(a->GetIdx()) || constraints.IsIgnored(b->GetIdx()) ||
+               constraints.IsIgnored(c->GetIdx()) || constraints.IsIgnored(d->GetIdx()) )
             continue;
 
           // if there are any groups specified, check if the four oop atoms are in a single intraGroup
@@ -3493,7 +3497,7 @@ namespace OpenBabel
       b = _mol.GetAtom((*p)[1]);
 
       // skip this vdw if the atoms are ignored
-      if ( _constraints.IsIgnored(a->GetIdx()) || _constraints.IsIgnored(b->GetIdx()) )
+      if ( constraints.IsIgnored(a->GetIdx()) || constraints.IsIgnored(b->GetIdx()) )
         continue;
 
       // if there are any groups specified, check if the two atoms are in a single _interGroup or if
@@ -3626,7 +3630,7 @@ namespace OpenBabel
       b = _mol.GetAtom((*p)[1]);
 
       // skip this ele if the atoms are ignored
-      if ( _constraints.IsIgnored(a->GetIdx()) || _constraints.IsIgnored(b->GetIdx()) )
+      if ( constraints.IsIgnored(a->GetIdx()) || constraints.IsIgnored(b->GetIdx()) )
         continue;
 
       // if there are any groups specified, check if the two atoms are in a single _interGroup or if
@@ -262,6 +262,12 @@ namespace OpenBabel
         return new OBForceFieldMMFF94(_id, false);
       }
 
+      //! The probe energies of GetGrid() are checked against the full molecule
+      bool SupportsFastProbeGrid() const
+      {
+        return true;
+      }
+
       //! Get the description for this force field
       const char* Description()
       {
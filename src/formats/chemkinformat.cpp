@@ -112,12 +112,14 @@ private:
   /// The "Convert" interface functions
   virtual bool ReadChemObject(OBConversion* pConv)
   {
-    std::string auditMsg = "OpenBabel::Read ChemKinFormat";
-    std::string description(Description());
-    auditMsg += description.substr(0,description.find('\n'));
-    obErrorLog.ThrowError(__FUNCTION__,
-              auditMsg,
-              obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg) {
+      std::string auditMsg = "OpenBabel::Read ChemKinFormat";
+      std::string description(Description());
+      auditMsg += description.substr(0,description.find('\n'));
+      obErrorLog.ThrowError(__FUNCTION__,
+                auditMsg,
+                obAuditMsg);
+    }
     //Makes a new OBReaction
     OBReaction* pReact = new OBReaction;
     bool ret=ReadMolecule(pReact,pConv); //call the "API" read function
@@ -138,12 +140,14 @@ private:
     {
       ret=WriteMolecule(pReact,pConv);
 
-      std::string auditMsg = "OpenBabel::Write reaction ";
-      std::string description(Description());
-            auditMsg += description.substr( 0, description.find('\n') );
-            obErrorLog.ThrowError(__FUNCTION__,
-                                  auditMsg,
-                                  obAuditMsg);
+      if (obErrorLog.GetOutputLevel() >= obAuditMsg) {
+        std::string auditMsg = "OpenBabel::Write reaction ";
+        std::string description(Description());
+        auditMsg += description.substr( 0, description.find('\n') );
+        obErrorLog.ThrowError(__FUNCTION__,
+                              auditMsg,
+                              obAuditMsg);
+      }
     }
     delete pOb;
     return ret;
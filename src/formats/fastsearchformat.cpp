@@ -134,12 +134,14 @@ virtual const char* Description() //required
     //Searches index file for structural matches
     //This function is called only once per search
 
-    std::string auditMsg = "OpenBabel::Read fastsearch index ";
-    std::string description(Description());
-    auditMsg += description.substr(0,description.find('\n'));
-    obErrorLog.ThrowError(__FUNCTION__,
-                          auditMsg,
-                          obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg) {
+      std::string auditMsg = "OpenBabel::Read fastsearch index ";
+      std::string description(Description());
+      auditMsg += description.substr(0,description.find('\n'));
+      obErrorLog.ThrowError(__FUNCTION__,
+                            auditMsg,
+                            obAuditMsg);
+    }
 
     //Derive index name
     string indexname = pConv->GetInFilename();
@@ -375,10 +377,12 @@ virtual const char* Description() //required
           return false;
         }
 
-        std::string auditMsg = "OpenBabel::Write fastsearch index ";
-        std::string description(Description());
-        auditMsg += description.substr( 0, description.find('\n') );
-        obErrorLog.ThrowError(__FUNCTION__,auditMsg,obAuditMsg);
+        if (obErrorLog.GetOutputLevel() >= obAuditMsg) {
+          std::string auditMsg = "OpenBabel::Write fastsearch index ";
+          std::string description(Description());
+          auditMsg += description.substr( 0, description.find('\n') );
+          obErrorLog.ThrowError(__FUNCTION__,auditMsg,obAuditMsg);
+        }
 
         FptIndex* pidx = nullptr; //used with update
 
@@ -98,6 +98,12 @@ namespace OpenBabel
 "aromatic bonds. For example, bit 623 above is the linear fragment O=C\n"
 "(8 for oxygen, 2 for double bond and 6 for carbon).\n\n"
 
+"For the circular fingerprints ECFP and FCFP, the ``-xc`` option outputs the\n"
+"unfolded features as ``feature:count`` pairs instead, where the count is the\n"
+"number of atom environments with that feature. Environments that contain\n"
+"the same bonds as another of smaller radius are left out, as in the original\n"
+"paper. With ``-xN`` the features are folded, adding their counts.\n\n"
+
       "Write Options e.g. -xfFP3 -xN128\n"
       " f<id> fingerprint type\n"
       " N# fold to specified number of bits, 32, 64, 128, etc.\n"
@@ -105,6 +111,8 @@ namespace OpenBabel
       " o  hex output only\n"
       " s  describe each set bit\n"
       " u  describe each unset bit\n"
+      " c  the unfolded features with their counts, as feature:count (ECFP, FCFP)\n"
+      "     folded by -xN if given\n"
 ;
     };
 
@@ -156,6 +164,28 @@ namespace OpenBabel
       obErrorLog.ThrowError(__FUNCTION__,
       "The number of bits to fold to, in the-xN option, should be >=0", obWarning);
 
+    OBMol* pmol = dynamic_cast<OBMol*>(pOb);
+
+    // sparse output
+    if(pConv->IsOption("c"))
+    {
+      vector<OBFingerprint::FeatureCount> features;
+      if(!pFP->GetCountFingerprint(pOb, features))
+      {
+        obErrorLog.ThrowError(__FUNCTION__,
+        "Feature counts are not available for this fingerprint type", obError, onceOnly);
+        return false;
+      }
+      if(nbits>0)
+        OBFingerprint::FoldFeatures(features, nbits);
+      if(pmol)
+        ofs << ">" << pmol->GetTitle() << '\n';
+      for(unsigned int i=0;i<features.size();++i)
+        ofs << (i ? " " : "") << features[i].first << ':' << features[i].second;
+      ofs << endl;
+      return true;
+    }
+
     vector<unsigned int> fptvec;
     if(!pFP->GetFingerprint(pOb, fptvec, nbits))
       return false;
@@ -163,7 +193,6 @@ namespace OpenBabel
     if(pConv->IsOption("o"))
       return WriteHex(ofs, fptvec);
 
-    OBMol* pmol = dynamic_cast<OBMol*>(pOb);
     if(pmol)
       ofs << ">" << pmol->GetTitle();
 
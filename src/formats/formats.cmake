@@ -127,6 +127,7 @@ set(formats_misc
       mpqcformat
       msiformat
       msmsformat
+      obbinformat
       opendxformat
       outformat
       pcmodelformat
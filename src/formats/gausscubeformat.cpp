@@ -69,7 +69,8 @@ namespace OpenBabel
 
         "Read Options e.g. -as\n"
         "  b no bonds\n"
-        "  s no multiple bonds\n\n";
+        "  s no multiple bonds\n"
+        "  p store the grid values in single precision (halves the memory used)\n\n";
     }
 
     // Return a specification url, not really a specification since
@@ -102,6 +103,72 @@ namespace OpenBabel
     // Global variable used to register Gaussian cube format.
     OBGaussianCubeFormat theGaussianCubeFormat;
 
+//------------------------------------------------------------------------------
+  // Read the values of the cubes, which are interleaved in the file (all
+  // the values for the first point, then for the second...). Each line is
+  // parsed in place rather than split into strings; a field that is not a
+  // number is read as zero, as strtod() would.
+  template<typename T>
+  static bool ReadCubeValues(istream &ifs, char *buffer, int &line,
+                             int n, vector<vector<T> > &cubes)
+  {
+    const size_t nCubes = cubes.size();
+    const size_t total = static_cast<size_t>(n) * nCubes;
+    for (size_t i = 0; i < nCubes; ++i)
+      cubes[i].reserve(n);
+
+    size_t count = 0;
+    while (count < total)
+    {
+      // Read in values until we have a complete row of data
+      ++line;
+      if (!ifs.getline(buffer, BUFF_SIZE))
+      {
+        stringstream errorMsg;
+        errorMsg << "Problem reading the Gaussian cube file: cannot"
+                 << " read line " << line
+                 << " of the file. More data was expected.\n"
+                 << "Values read in = " << count
+                 << " and expected number of values = "
+                 << total << endl;
+        obErrorLog.ThrowError(__FUNCTION__, errorMsg.str(), obError);
+        return false;
+      }
+
+      const char *p = buffer;
+      bool empty = true;
+      while (count < total)
+      {
+        while (*p == ' ' || *p == '\t' || *p == '\r')
+          ++p;
+        if (*p == '\0')
+          break;
+        empty = false;
+        char *endptr;
+        double value = ParseDouble(p, &endptr);
+        if (endptr == p)
+          value = 0.0;
+        // skip whatever is left of this field
+        p = endptr;
+        while (*p != '\0' && *p != ' ' && *p != '\t' && *p != '\r')
+          ++p;
+        cubes[count % nCubes].push_back(static_cast<T>(value));
+        ++count;
+      }
+      if (empty)
+      {
+        stringstream errorMsg;
+        errorMsg << "Problem reading the Gaussian cube file: cannot"
+                 << " read line " << line
+                 << ", there does not appear to be any data in it.\n"
+                 << buffer << "\n";
+        obErrorLog.ThrowError(__FUNCTION__, errorMsg.str(), obError);
+        return false;
+      }
+    }
+    return true;
+  }
+
 //------------------------------------------------------------------------------
 bool OBGaussianCubeFormat::ReadMolecule( OBBase* pOb, OBConversion* pConv )
 {
@@ -472,62 +539,43 @@ bool OBGaussianCubeFormat::ReadMolecule( OBBase* pOb, OBConversion* pConv )
       vgd.at(0)->SetAttribute(cubeTitle.c_str());
     }
 
-    // get all values as one vector<double>
-    vector<double> values;
+    bool singlePrecision = pConv->IsOption("p", OBConversion::INOPTIONS) != nullptr;
     int n = voxels[0]*voxels[1]*voxels[2];
-    values.reserve(n*nCubes);
-    while (values.size() < n*nCubes)
+    for (int i = 0; i < nCubes; ++i) // foreach cube
     {
-      // Read in values until we have a complete row of data
-      ++line;
-      if (!ifs.getline(buffer, BUFF_SIZE))
-      {
-        errorMsg << "Problem reading the Gaussian cube file: cannot"
-                 << " read line " << line
-                 << " of the file. More data was expected.\n"
-                 << "Values read in = " << values.size()
-                 << " and expected number of values = "
-                 << n*nCubes << endl;
-        obErrorLog.ThrowError(__FUNCTION__, errorMsg.str(), obError);
-        return false;
-      }
-      tokenize(vs, buffer);
-      if (vs.size() == 0)
-      {
-        errorMsg << "Problem reading the Gaussian cube file: cannot"
-                 << " read line " << line
-                 << ", there does not appear to be any data in it.\n"
-                 << buffer << "\n";
-        obErrorLog.ThrowError(__FUNCTION__, errorMsg.str(), obError);
-        return false;
-      }
+      vgd[i]->SetFloatPrecision(singlePrecision);
+      vgd[i]->SetNumberOfPoints(voxels[0], voxels[1], voxels[2]);
+      vgd[i]->SetLimits(origin, axes[0], axes[1], axes[2]);
+      vgd[i]->SetUnit(angstroms ? OBGridData::ANGSTROM : OBGridData::BOHR);
+      vgd[i]->SetOrigin(fileformatInput); // i.e., is this data from a file or determined by Open Babel
+    }
 
-      for (unsigned int l = 0; l < vs.size(); ++l)
+    // read the values straight into one vector per cube
+    if (singlePrecision)
+    {
+      vector<vector<float> > cubes(nCubes);
+      if (!ReadCubeValues(ifs, buffer, line, n, cubes))
+        return false;
+      for (int i = 0; i < nCubes; ++i)
       {
-        values.push_back(strtod(static_cast<const char*>(vs.at(l).c_str()), &endptr));
+        vgd[i]->SetValues(cubes[i]);
+        vector<float>().swap(cubes[i]);
       }
     }
-
-    // translate the vector<double> to vector<vector<double> >
-    vector<vector<double> > vvd;
-    vvd.resize(nCubes);
-    for (unsigned int i = 0; i < values.size(); )
+    else
     {
-      for (int j = 0; j < nCubes; ++j, ++i) // foreach cube
+      vector<vector<double> > cubes(nCubes);
+      if (!ReadCubeValues(ifs, buffer, line, n, cubes))
+        return false;
+      for (int i = 0; i < nCubes; ++i)
       {
-        vvd[j].push_back(values[i]);
+        vgd[i]->SetValues(cubes[i]);
+        vector<double>().swap(cubes[i]);
       }
     }
 
-    for (int i = 0; i < nCubes; ++i) // foreach cube
-    {
-      vgd[i]->SetNumberOfPoints(voxels[0], voxels[1], voxels[2]);
-      vgd[i]->SetLimits(origin, axes[0], axes[1], axes[2]);
-      vgd[i]->SetUnit(angstroms ? OBGridData::ANGSTROM : OBGridData::BOHR);
-      vgd[i]->SetOrigin(fileformatInput); // i.e., is this data from a file or determined by Open Babel
-      vgd[i]->SetValues(vvd[i]); // set the values
+    for (int i = 0; i < nCubes; ++i)
       pmol->SetData(vgd[i]); // store the grids in the OBMol
-    }
 
     pmol->EndModify();
 
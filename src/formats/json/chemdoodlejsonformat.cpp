@@ -16,7 +16,7 @@ GNU General Public License for more details.
 
 #include <map>
 #include <openbabel/babelconfig.h>
-#include <openbabel/json.h>
+#include "jsonrecordreader.h"
 #include <openbabel/obmolecformat.h>
 #include <openbabel/mol.h>
 #include <openbabel/atom.h>
@@ -64,9 +64,8 @@ class ChemDoodleJSONFormat : public OBMoleculeFormat
     virtual bool WriteMolecule(OBBase* pOb, OBConversion* pConv);
 
   private:
-    rapidjson::Document inRoot;
+    JSONRecordReader inReader;
     rapidjson::Document outRoot;
-    int currentMolIndex;
 
   };
   
@@ -85,46 +84,29 @@ class ChemDoodleJSONFormat : public OBMoleculeFormat
 
     pmol->BeginModify();
 
-    // Parse entire file into memory once, then reuse inRoot for subsequent molecules
-    // (It's really tricky to stream json)
-    if (ifs.peek() != EOF) {
-      rapidjson::IStreamWrapper isw(ifs);
-      inRoot.ParseStream(isw);
-      if (inRoot.HasParseError()) {
-        stringstream msg;
-        msg << "JSON parse error at offset " << inRoot.GetErrorOffset() << ": "
-            << rapidjson::GetParseError_En(inRoot.GetParseError());
-        obErrorLog.ThrowError("ChemDoodleJSONFormat", msg.str(), obError);
-        return false;
-      }
-      // Clear ifs flags so it is "good" and any subsequent mols are read, but leave it at EOF position.
-      // Therefore, when not at EOF position we know to parse next file and reset currentMolIndex
-      ifs.clear();
-      currentMolIndex = 0;
-    }
-
-    if (!inRoot.IsObject()) {
-      obErrorLog.ThrowError("ChemDoodleJSONFormat", "JSON file should be a single object", obError);
+    // Parse one molecule record at a time, so that the memory used does not
+    // grow with the size of the file
+    static const vector<string> keys = { "m" };
+    if (pConv->GetCount() == 0) // a new conversion
+      inReader.Reset();
+    switch (inReader.Next(ifs, keys)) {
+    case JSONRecordReader::Failed:
+      obErrorLog.ThrowError("ChemDoodleJSONFormat", inReader.Error(), obError);
+      return false;
+    case JSONRecordReader::End:
       return false;
+    default:
+      break;
     }
 
     // Get the root level of the molecule
     rapidjson::Value molRoot;
-    if (inRoot.HasMember("m") && inRoot["m"].IsArray()) {
-      // File contains an array of molecules, iterate over them
-      if (inRoot["m"].Size() > currentMolIndex) {
-        molRoot = inRoot["m"][currentMolIndex];
-        currentMolIndex++;
-      } else {
-        // Finished the last molecule
-        ifs.seekg(0, ios::end);
-        return false;
-      }
-    } else {
-      obErrorLog.ThrowError("ChemDoodleJSONFormat", "JSON file must contain an 'm' molecules array", obError);
+    molRoot = inReader.GetRecord();
+    if (!molRoot.IsObject()) {
+      obErrorLog.ThrowError("ChemDoodleJSONFormat", "Molecules must be JSON objects", obError);
       return false;
     }
-    
+
     // Set dimension to 2 unless z coordinates are found
     unsigned short dim = 2;
     
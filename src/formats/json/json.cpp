@@ -0,0 +1,238 @@
+/**********************************************************************
+json.cpp - Reading the records of large JSON files one at a time
+
+This file is part of the Open Babel project.
+For more information, see <http://openbabel.org/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+***********************************************************************/
+#include <openbabel/babelconfig.h>
+#include "jsonrecordreader.h"
+
+#include <algorithm>
+#include <sstream>
+
+using namespace std;
+namespace OpenBabel
+{
+
+  // A RapidJSON input stream which takes characters from an istream one at
+  // a time, so the istream is left just after the last character that the
+  // parser used. (The IStreamWrapper of newer RapidJSON versions reads ahead
+  // into a buffer.)
+  class JSONIStream
+  {
+  public:
+    typedef char Ch;
+
+    JSONIStream(istream &ifs, size_t offset = 0) : _ifs(ifs), _count(offset) {}
+
+    Ch Peek() const
+    {
+      int c = _ifs.peek();
+      return c == char_traits<char>::eof() ? '\0' : static_cast<Ch>(c);
+    }
+    Ch Take()
+    {
+      int c = _ifs.get();
+      if (c == char_traits<char>::eof())
+        return '\0';
+      ++_count;
+      return static_cast<Ch>(c);
+    }
+    size_t Tell() const { return _count; }
+
+    // Not used for input
+    Ch* PutBegin() { RAPIDJSON_ASSERT(false); return 0; }
+    void Put(Ch) { RAPIDJSON_ASSERT(false); }
+    void Flush() { RAPIDJSON_ASSERT(false); }
+    size_t PutEnd(Ch*) { RAPIDJSON_ASSERT(false); return 0; }
+
+  private:
+    istream &_ifs;
+    size_t _count;
+  };
+
+  // Keeps the last key string that is read
+  struct KeyHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, KeyHandler>
+  {
+    bool String(const char *str, rapidjson::SizeType length, bool)
+    {
+      key.assign(str, length);
+      return true;
+    }
+    bool Default() { return false; }
+    string key;
+  };
+
+  template<typename Handler>
+  static bool Parse(JSONIStream &is, Handler &handler, string &error)
+  {
+    rapidjson::Reader reader;
+    if (reader.Parse<rapidjson::kParseStopWhenDoneFlag>(is, handler))
+      return true;
+    stringstream msg;
+    msg << "JSON parse error at offset " << reader.GetErrorOffset() << ": "
+        << rapidjson::GetParseError_En(reader.GetParseErrorCode());
+    error = msg.str();
+    return false;
+  }
+
+  // The stream slot (iword) marking a stream which holds a partly read document
+  static const int documentIndex = ios_base::xalloc();
+
+  JSONRecordReader::Status JSONRecordReader::Next(istream &ifs, const vector<string> &keys)
+  {
+    // A partly read document is not continued in another stream, e.g. after
+    // a conversion which stopped early with -l. (The stream position is not
+    // compared, as asking for it fails for streams that can not seek.)
+    if (!ifs.iword(documentIndex))
+      _offset = 0;
+    ifs.iword(documentIndex) = 0;
+
+    _record.reset(new rapidjson::Document);
+    // the offset is zero outside a document
+    JSONIStream is(ifs, _offset);
+    rapidjson::SkipWhitespace(is);
+    char c = is.Peek();
+    if (_offset == 0) {
+      if (c == '\0')
+        return End;
+      if (c != '{') {
+        _error = "JSON file should be a single object";
+        return Fail(is);
+      }
+      is.Take();
+      if (!FindArray(is, keys))
+        return Fail(is);
+    }
+    else if (c == ',')
+      is.Take();
+    else if (c == ']') {
+      is.Take();
+      return Finish(is);
+    }
+    else {
+      _error = c ? "Expected ',' or ']' after a record" : "Unexpected end of JSON file";
+      return Fail(is);
+    }
+
+    rapidjson::SkipWhitespace(is);
+    if (is.Peek() == ']') { // an empty array
+      is.Take();
+      return Finish(is);
+    }
+    _record->ParseStream<rapidjson::kParseStopWhenDoneFlag>(is);
+    if (_record->HasParseError()) {
+      stringstream msg;
+      msg << "JSON parse error at offset " << _record->GetErrorOffset() << ": "
+          << rapidjson::GetParseError_En(_record->GetParseError());
+      _error = msg.str();
+      return Fail(is);
+    }
+    _offset = is.Tell();
+    ifs.iword(documentIndex) = 1;
+    return Record;
+  }
+
+  bool JSONRecordReader::ReadKey(JSONIStream &is, string &key)
+  {
+    rapidjson::SkipWhitespace(is);
+    KeyHandler handler;
+    if (is.Peek() != '"' || !Parse(is, handler, _error))
+      return false;
+    key = handler.key;
+    rapidjson::SkipWhitespace(is);
+    if (is.Peek() != ':')
+      return false;
+    is.Take();
+    rapidjson::SkipWhitespace(is);
+    return true;
+  }
+
+  // Passes over a value, however large, without storing it
+  bool JSONRecordReader::SkipValue(JSONIStream &is)
+  {
+    rapidjson::BaseReaderHandler<> handler;
+    return Parse(is, handler, _error);
+  }
+
+  // Moves into the array named by the first of @p keys which is found,
+  // passing over the members before it
+  bool JSONRecordReader::FindArray(JSONIStream &is, const vector<string> &keys)
+  {
+    _key.clear();
+    string key;
+    for (;;) {
+      rapidjson::SkipWhitespace(is);
+      if (is.Peek() == '}')
+        break;
+      _error.clear();
+      if (!ReadKey(is, key)) {
+        if (_error.empty())
+          _error = "Expected a member of the JSON object";
+        return false;
+      }
+      if (find(keys.begin(), keys.end(), key) != keys.end() && is.Peek() == '[') {
+        is.Take();
+        _key = key;
+        return true;
+      }
+      if (!SkipValue(is))
+        return false;
+      rapidjson::SkipWhitespace(is);
+      if (is.Peek() == ',')
+        is.Take();
+      else if (is.Peek() != '}')
+        break;
+    }
+    string names;
+    for (vector<string>::size_type i = 0; i < keys.size(); ++i)
+      names += (i ? " or '" : "'") + keys[i] + "'";
+    _error = "JSON file must contain a " + names + " array";
+    return false;
+  }
+
+  // Passes over the members after the array, and the end of the object
+  JSONRecordReader::Status JSONRecordReader::Finish(JSONIStream &is)
+  {
+    string key;
+    for (;;) {
+      rapidjson::SkipWhitespace(is);
+      if (is.Peek() == '}') {
+        is.Take();
+        _offset = 0;
+        return End;
+      }
+      _error = "Expected ',' or '}' in the JSON object";
+      if (is.Peek() != ',')
+        return Fail(is);
+      is.Take();
+      _error.clear();
+      if (!ReadKey(is, key)) {
+        if (_error.empty())
+          _error = "Expected a member of the JSON object";
+        return Fail(is);
+      }
+      if (!SkipValue(is))
+        return Fail(is);
+    }
+  }
+
+  JSONRecordReader::Status JSONRecordReader::Fail(JSONIStream &is)
+  {
+    // Nothing more is read from a broken document
+    while (is.Take() != '\0')
+      ;
+    _offset = 0;
+    return Failed;
+  }
+
+} // end namespace OpenBabel
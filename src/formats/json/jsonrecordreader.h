@@ -0,0 +1,82 @@
+/**********************************************************************
+jsonrecordreader.h - Reading the records of large JSON files one at a time
+
+This file is part of the Open Babel project.
+For more information, see <http://openbabel.org/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+***********************************************************************/
+
+#ifndef OPENBABEL_JSONRECORDREADER_H
+#define OPENBABEL_JSONRECORDREADER_H
+
+// Used by the JSON format plugins only, this header is not installed
+#include <openbabel/json.h>
+
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace OpenBabel
+{
+  class JSONIStream;
+
+  /** \class JSONRecordReader jsonrecordreader.h
+      \brief Reads the records of an array in a JSON object one at a time
+
+      Files such as PubChem bulk downloads are a single object holding a very
+      large array of records. Rather than parsing the whole document into a DOM,
+      Next() steps through the object with RapidJSON's reader, without keeping
+      the values it passes over, and parses only the next record of the array
+      into a new Document, so the memory used is that of the largest record.
+      Several documents may follow each other in one stream. The reader starts
+      again at a new document when it is given a stream other than the one
+      holding the current document (which is marked in an iword slot of the
+      stream), or when Reset() is called.
+  */
+  class JSONRecordReader
+  {
+  public:
+    enum Status { Record, End, Failed };
+
+    JSONRecordReader() : _offset(0) {}
+
+    /// Parses the next record of the first array named in @p keys, which
+    /// is then available from GetRecord() until the next call.
+    /// \return Record if one was read, End at the end of the array and
+    /// Failed on error, when Error() holds the message.
+    Status Next(std::istream &ifs, const std::vector<std::string> &keys);
+
+    /// Forgets any document which has not been read to its end
+    void Reset() { _offset = 0; }
+
+    /// The record read by the last call to Next()
+    rapidjson::Document &GetRecord() { return *_record; }
+    /// The key of the array which holds the records of the current document
+    const std::string &Key() const { return _key; }
+    const std::string &Error() const { return _error; }
+
+  private:
+    bool ReadKey(JSONIStream &is, std::string &key);
+    bool SkipValue(JSONIStream &is);
+    bool FindArray(JSONIStream &is, const std::vector<std::string> &keys);
+    Status Finish(JSONIStream &is);
+    Status Fail(JSONIStream &is);
+
+    std::unique_ptr<rapidjson::Document> _record;
+    size_t _offset; // of the stream in the current document
+    std::string _key;
+    std::string _error;
+  };
+
+} // end namespace OpenBabel
+
+#endif //OPENBABEL_JSONRECORDREADER_H
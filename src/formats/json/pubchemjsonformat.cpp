@@ -17,7 +17,7 @@ GNU General Public License for more details.
 #include <map>
 #include <algorithm>
 #include <openbabel/babelconfig.h>
-#include <openbabel/json.h>
+#include "jsonrecordreader.h"
 #include <openbabel/obmolecformat.h>
 #include <openbabel/mol.h>
 #include <openbabel/atom.h>
@@ -69,9 +69,8 @@ class PubChemJSONFormat : public OBMoleculeFormat
     virtual bool WriteMolecule(OBBase* pOb, OBConversion* pConv);
 
   private:
-    rapidjson::Document inRoot;
+    JSONRecordReader inReader;
     rapidjson::Document outRoot;
-    int currentMolIndex;
 
   };
   
@@ -90,57 +89,37 @@ class PubChemJSONFormat : public OBMoleculeFormat
 
     pmol->BeginModify();
 
-    // Parse entire file into memory once, then reuse inRoot for subsequent molecules
-    // (It's really tricky to stream json)
-    if (ifs.peek() != EOF) {
-      rapidjson::IStreamWrapper isw(ifs);
-      inRoot.ParseStream(isw);
-      if (inRoot.HasParseError()) {
-        stringstream msg;
-        msg << "JSON parse error at offset " << inRoot.GetErrorOffset() << ": "
-            << rapidjson::GetParseError_En(inRoot.GetParseError());
-        obErrorLog.ThrowError("PubChemJSONFormat", msg.str(), obError);
-        return false;
-      }
-      // Clear ifs flags so it is "good" and any subsequent mols are read, but leave it at EOF position.
-      // Therefore, when not at EOF position we know to parse next file and reset currentMolIndex
-      ifs.clear();
-      currentMolIndex = 0;
-    }
-
-    if (!inRoot.IsObject()) {
-      obErrorLog.ThrowError("PubChemJSONFormat", "JSON file should be a single object", obError);
+    // Parse one compound record at a time, so that the memory used does not
+    // grow with the size of the file
+    static const vector<string> keys = { "PC_Compounds", "PC_Substances" };
+    if (pConv->GetCount() == 0) // a new conversion
+      inReader.Reset();
+    switch (inReader.Next(ifs, keys)) {
+    case JSONRecordReader::Failed:
+      obErrorLog.ThrowError("PubChemJSONFormat", inReader.Error(), obError);
       return false;
+    case JSONRecordReader::End:
+      return false;
+    default:
+      break;
     }
 
     // Get the root level of the molecule
+    rapidjson::Value &record = inReader.GetRecord();
     rapidjson::Value molRoot;
     rapidjson::Value subsRoot;
-    if (inRoot.HasMember("PC_Compounds") && inRoot["PC_Compounds"].IsArray()) {
+    if (inReader.Key() == "PC_Compounds" && record.IsObject()) {
       // File is a PC_Compounds array
-      if (inRoot["PC_Compounds"].Size() > currentMolIndex) {
-        molRoot = inRoot["PC_Compounds"][currentMolIndex];
-        currentMolIndex++;
-      } else {
-        // Finished the last molecule
-        ifs.seekg(0, ios::end);
-        return false;
-      }
-    } else if (inRoot.HasMember("PC_Substances") && inRoot["PC_Substances"].IsArray()) {
+      molRoot = record;
+    } else if (record.IsObject() && record.HasMember("compound") && record["compound"].IsArray() &&
+               record["compound"].Size() > 0 && record["compound"][0].IsObject()) {
       // File is a PC_Substances array
-      if (inRoot["PC_Substances"].Size() > currentMolIndex) {
-        subsRoot = inRoot["PC_Substances"][currentMolIndex];
-        // We are assuming the first item in compound array is the deposited entry
-        molRoot = subsRoot["compound"][0];
-        currentMolIndex++;
-      } else {
-        // Finished the last molecule
-        ifs.seekg(0, ios::end);
-        return false;
-      }
+      subsRoot = record;
+      // We are assuming the first item in compound array is the deposited entry
+      molRoot = subsRoot["compound"][0];
     } else {
-      obErrorLog.ThrowError("PubChemJSONFormat", "JSON file must contain a PC_Compounds or PC_Substances array",
-                            obError);
+      obErrorLog.ThrowError("PubChemJSONFormat", "Invalid " + inReader.Key() + " record", obError);
+      return false;
     }
 
     // CID or SID
@@ -660,9 +639,6 @@ class PubChemJSONFormat : public OBMoleculeFormat
 
     // TODO: Properties
 
-    // Increment currentMolIndex for next run
-    currentMolIndex++;
-
     return true;
   }
 
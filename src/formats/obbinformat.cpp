@@ -0,0 +1,872 @@
+/**********************************************************************
+obbinformat.cpp - Native binary format, keeping the perceived state of a molecule
+
+This file is part of the Open Babel project.
+For more information, see <http://openbabel.org/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+***********************************************************************/
+
+#include <openbabel/babelconfig.h>
+#include <openbabel/obmolecformat.h>
+#include <openbabel/mol.h>
+#include <openbabel/atom.h>
+#include <openbabel/bond.h>
+#include <openbabel/residue.h>
+#include <openbabel/ring.h>
+#include <openbabel/generic.h>
+#include <openbabel/obiter.h>
+#include <openbabel/math/spacegroup.h>
+#include <openbabel/stereo/stereo.h>
+#include <openbabel/stereo/tetrahedral.h>
+#include <openbabel/stereo/cistrans.h>
+#include <openbabel/stereo/squareplanar.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+namespace OpenBabel
+{
+
+/* Layout of a record, one per molecule:
+
+     "OBBN" <version> <length> <sections>
+
+   The sections fill the <length> bytes after the header. Each is
+
+     <tag> <length> <content>
+
+   so that a reader skips the sections it does not know. Unsigned integers
+   are written as base-128 varints (7 bits per byte, least significant
+   first), signed ones zigzag-encoded as varints, doubles as the 8 bytes of
+   their IEEE representation in little-endian order and strings as their
+   length followed by their bytes. Atoms are referred to by their index
+   (from 0). Stereo objects refer to atom ids, which are written renumbered
+   to the atom index so that a reader can check them against the number of
+   atoms; their refs are written as a count followed by the refs.
+*/
+
+static const char RecordMagic[4] = { 'O', 'B', 'B', 'N' };
+
+// The version written; records of later versions are not read.
+static const unsigned int FormatVersion = 1;
+
+enum SectionTag {
+  MoleculeSection = 1,
+  AtomSection,
+  BondSection,
+  NeighborSection,
+  ConformerSection,
+  ResidueSection,
+  RingSection,
+  TetrahedralSection,
+  CisTransSection,
+  SquarePlanarSection,
+  PairDataSection,
+  CommentSection,
+  UnitCellSection
+};
+
+// atom flags
+enum { AromaticAtom = 1, RingAtom = 2 };
+
+class BinaryWriter
+{
+public:
+  string buffer;
+
+  void Unsigned(unsigned long value)
+  {
+    while (value >= 0x80) {
+      buffer += static_cast<char>((value & 0x7f) | 0x80);
+      value >>= 7;
+    }
+    buffer += static_cast<char>(value);
+  }
+  void Signed(long value)
+  {
+    Unsigned(value < 0 ? ~(static_cast<unsigned long>(value) << 1)
+                       : static_cast<unsigned long>(value) << 1);
+  }
+  void Double(double value)
+  {
+    unsigned long long bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; ++i, bits >>= 8)
+      buffer += static_cast<char>(bits & 0xff);
+  }
+  void String(const string &value)
+  {
+    Unsigned(value.size());
+    buffer += value;
+  }
+  void Char(char value)
+  {
+    buffer += value;
+  }
+  // Sections are written to a separate writer, then added with their length
+  void Section(SectionTag tag, const BinaryWriter &section)
+  {
+    Unsigned(tag);
+    String(section.buffer);
+  }
+};
+
+// Reads from a buffer, failing (rather than reading past its end) on
+// truncated or corrupt data
+class BinaryReader
+{
+public:
+  const char *pos, *end;
+  bool ok;
+
+  BinaryReader(const char *begin, const char *end_): pos(begin), end(end_), ok(true) {}
+
+  unsigned long Unsigned()
+  {
+    unsigned long value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (pos == end) {
+        ok = false;
+        return 0;
+      }
+      unsigned char byte = static_cast<unsigned char>(*pos++);
+      value |= static_cast<unsigned long>(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        return value;
+    }
+    ok = false;
+    return 0;
+  }
+  long Signed()
+  {
+    unsigned long value = Unsigned();
+    return (value & 1) ? static_cast<long>(~(value >> 1)) : static_cast<long>(value >> 1);
+  }
+  double Double()
+  {
+    if (end - pos < 8) {
+      ok = false;
+      pos = end;
+      return 0.0;
+    }
+    unsigned long long bits = 0;
+    for (int i = 7; i >= 0; --i)
+      bits = (bits << 8) | static_cast<unsigned char>(pos[i]);
+    pos += 8;
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+  string String()
+  {
+    unsigned long size = Unsigned();
+    if (static_cast<unsigned long>(end - pos) < size) {
+      ok = false;
+      pos = end;
+      return string();
+    }
+    string value(pos, size);
+    pos += size;
+    return value;
+  }
+  char Char()
+  {
+    if (pos == end) {
+      ok = false;
+      return 0;
+    }
+    return *pos++;
+  }
+  //! \return an index below @p n, or fail
+  unsigned int Index(unsigned int n)
+  {
+    unsigned long value = Unsigned();
+    if (value >= n)
+      ok = false;
+    return ok ? static_cast<unsigned int>(value) : 0;
+  }
+};
+
+class OBBinFormat : public OBMoleculeFormat
+{
+public:
+  OBBinFormat()
+  {
+    OBConversion::RegisterFormat("obbin", this);
+  }
+
+  virtual const char* Description()
+  {
+    return
+      "Open Babel native binary format\n"
+      "A compact binary format which keeps the perceived state of a molecule\n"
+      "The atoms, bonds, conformers, stereochemistry, residues, rings (SSSR/LSSR),\n"
+      "unit cell, pair and comment data are written together with the flags\n"
+      "recording which properties (aromaticity, ring membership, hybridization,\n"
+      "atom types, partial charges, stereochemistry...) have been perceived.\n"
+      "A molecule read back is ready to use without any perception, which\n"
+      "makes it suited for passing molecules between the stages of a pipeline.\n"
+      "The format is specific to Open Babel and may change between versions;\n"
+      "files written by a later version are not read.\n\n"
+      "Write Options e.g. -xa\n"
+      "  a  Perceive rings, aromaticity, atom types, hybridization, partial\n"
+      "     charges and stereochemistry before writing, so that they are stored\n\n";
+  }
+
+  virtual const char* SpecificationURL() { return ""; }
+
+  virtual unsigned int Flags()
+  {
+    return READBINARY | WRITEBINARY;
+  }
+
+  virtual int SkipObjects(int n, OBConversion* pConv);
+  virtual bool ReadMolecule(OBBase* pOb, OBConversion* pConv);
+  virtual bool WriteMolecule(OBBase* pOb, OBConversion* pConv);
+
+private:
+  bool ReadHeader(istream &ifs, unsigned long &length);
+  bool ReadSection(OBMol &mol, SectionTag tag, BinaryReader &in);
+};
+
+//Make an instance of the format class
+OBBinFormat theOBBinFormat;
+
+/////////////////////////////////////////////////////////////////
+// The written id of the atom with id @p id, see the layout above
+static unsigned long StereoId(OBMol &mol, OBStereo::Ref id)
+{
+  if (id == OBStereo::NoRef || id == OBStereo::ImplicitRef)
+    return id;
+  OBAtom *atom = mol.GetAtomById(id);
+  return atom ? atom->GetIndex() : static_cast<unsigned long>(OBStereo::NoRef);
+}
+
+static void WriteRefs(BinaryWriter &section, OBMol &mol, const OBStereo::Refs &refs)
+{
+  section.Unsigned(refs.size());
+  for (unsigned int i = 0; i < refs.size(); ++i)
+    section.Unsigned(StereoId(mol, refs[i]));
+}
+
+static void WriteStereo(BinaryWriter &out, OBMol &mol)
+{
+  // The stereo objects are written as stored: they are not perceived here
+  vector<OBGenericData*> vdata = mol.GetAllData(OBGenericDataType::StereoData);
+  for (vector<OBGenericData*>::iterator data = vdata.begin(); data != vdata.end(); ++data) {
+    OBStereoBase *stereo = dynamic_cast<OBStereoBase*>(*data);
+    if (!stereo)
+      continue;
+    BinaryWriter section;
+    switch (stereo->GetType()) {
+    case OBStereo::Tetrahedral: {
+      OBTetrahedralStereo::Config config = static_cast<OBTetrahedralStereo*>(stereo)->GetConfig();
+      section.Unsigned(StereoId(mol, config.center));
+      section.Unsigned(StereoId(mol, config.from));
+      WriteRefs(section, mol, config.refs);
+      section.Unsigned(config.winding);
+      section.Unsigned(config.view);
+      section.Unsigned(config.specified);
+      out.Section(TetrahedralSection, section);
+      break;
+    }
+    case OBStereo::CisTrans: {
+      OBCisTransStereo::Config config = static_cast<OBCisTransStereo*>(stereo)->GetConfig();
+      section.Unsigned(StereoId(mol, config.begin));
+      section.Unsigned(StereoId(mol, config.end));
+      WriteRefs(section, mol, config.refs);
+      section.Unsigned(config.shape);
+      section.Unsigned(config.specified);
+      out.Section(CisTransSection, section);
+      break;
+    }
+    case OBStereo::SquarePlanar: {
+      OBSquarePlanarStereo::Config config = static_cast<OBSquarePlanarStereo*>(stereo)->GetConfig();
+      section.Unsigned(StereoId(mol, config.center));
+      WriteRefs(section, mol, config.refs);
+      section.Unsigned(config.shape);
+      section.Unsigned(config.specified);
+      out.Section(SquarePlanarSection, section);
+      break;
+    }
+    default:
+      break;
+    }
+  }
+}
+
+static void WriteGenericData(BinaryWriter &out, OBMol &mol)
+{
+  vector<OBGenericData*> &vdata = mol.GetData();
+  for (vector<OBGenericData*>::iterator data = vdata.begin(); data != vdata.end(); ++data) {
+    BinaryWriter section;
+    switch ((*data)->GetDataType()) {
+    case OBGenericDataType::PairData:
+      section.String((*data)->GetAttribute());
+      section.String((*data)->GetValue());
+      section.Unsigned((*data)->GetOrigin());
+      out.Section(PairDataSection, section);
+      break;
+    case OBGenericDataType::CommentData:
+      section.String(static_cast<OBCommentData*>(*data)->GetData());
+      section.Unsigned((*data)->GetOrigin());
+      out.Section(CommentSection, section);
+      break;
+    case OBGenericDataType::RingData: {
+      vector<OBRing*> &rings = static_cast<OBRingData*>(*data)->GetData();
+      section.String((*data)->GetAttribute());
+      section.Unsigned((*data)->GetOrigin());
+      section.Unsigned(rings.size());
+      for (vector<OBRing*>::iterator ring = rings.begin(); ring != rings.end(); ++ring) {
+        section.String(mol.HasRingTypesPerceived() ? (*ring)->GetType() : "");
+        section.Unsigned((*ring)->_path.size());
+        for (unsigned int i = 0; i < (*ring)->_path.size(); ++i)
+          section.Unsigned((*ring)->_path[i] - 1);
+      }
+      out.Section(RingSection, section);
+      break;
+    }
+    case OBGenericDataType::UnitCell: {
+      OBUnitCell *cell = static_cast<OBUnitCell*>(*data);
+      matrix3x3 m = cell->GetCellMatrix();
+      for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+          section.Double(m.Get(i, j));
+      vector3 offset = cell->GetOffset();
+      section.Double(offset.x());
+      section.Double(offset.y());
+      section.Double(offset.z());
+      section.String(cell->GetSpaceGroupName());
+      const SpaceGroup *sg = cell->GetSpaceGroup();
+      section.String(sg ? sg->GetHallName() : string());
+      section.Unsigned(cell->GetLatticeType());
+      section.Unsigned((*data)->GetOrigin());
+      out.Section(UnitCellSection, section);
+      break;
+    }
+    default:
+      break;
+    }
+  }
+}
+
+bool OBBinFormat::WriteMolecule(OBBase* pOb, OBConversion* pConv)
+{
+  OBMol* pmol = dynamic_cast<OBMol*>(pOb);
+  if (pmol == nullptr)
+    return false;
+  OBMol &mol = *pmol;
+  ostream &ofs = *pConv->GetOutStream();
+
+  if (pConv->IsOption("a") && mol.NumAtoms()) {
+    mol.GetSSSR(); // and the ring atoms and bonds
+    OBAtom *atom = mol.GetFirstAtom();
+    atom->IsAromatic();
+    atom->GetType();
+    atom->GetHyb();
+    atom->GetPartialCharge();
+    OBStereoFacade facade(&mol);
+  }
+
+  BinaryWriter out, section;
+  section.String(mol.GetTitle(false));
+  section.Unsigned(mol.GetFlags());
+  section.Unsigned(mol.GetDimension());
+  section.Double(mol.GetEnergy());
+  section.Signed(mol.HasFlag(OB_TCHARGE_MOL) ? mol.GetTotalCharge() : 0);
+  section.Unsigned(mol.HasFlag(OB_TSPIN_MOL) ? mol.GetTotalSpinMultiplicity() : 0);
+  section.Unsigned(mol.AutomaticFormalCharge());
+  section.Unsigned(mol.AutomaticPartialCharge());
+  out.Section(MoleculeSection, section);
+
+  // Properties which have not been perceived are written as 0, as they
+  // would be replaced on first use anyway. This avoids perceiving them here.
+  bool aromatic = mol.HasAromaticPerceived();
+  bool rings = mol.HasRingAtomsAndBondsPerceived();
+  bool hybridization = mol.HasHybridizationPerceived();
+  bool types = mol.HasAtomTypesPerceived();
+  bool charges = !mol.AutomaticPartialCharge() || mol.HasPartialChargesPerceived();
+  section.buffer.clear();
+  section.Unsigned(mol.NumAtoms());
+  FOR_ATOMS_OF_MOL(atom, mol) {
+    section.Unsigned(atom->GetIndex()); // the id when read
+    section.Unsigned(atom->GetAtomicNum());
+    section.Unsigned(atom->GetIsotope());
+    section.Signed(atom->GetFormalCharge());
+    section.Unsigned(atom->GetSpinMultiplicity());
+    section.Unsigned(atom->GetImplicitHCount());
+    section.Unsigned(hybridization ? atom->GetHyb() : 0);
+    section.Unsigned((aromatic && atom->IsAromatic() ? AromaticAtom : 0)
+                     | (rings && atom->IsInRing() ? RingAtom : 0));
+    section.Double(charges ? atom->GetPartialCharge() : 0.0);
+    section.String(types ? atom->GetType() : "");
+  }
+  out.Section(AtomSection, section);
+
+  section.buffer.clear();
+  section.Unsigned(mol.NumBonds());
+  FOR_BONDS_OF_MOL(bond, mol) {
+    section.Unsigned(bond->GetBeginAtomIdx() - 1);
+    section.Unsigned(bond->GetEndAtomIdx() - 1);
+    section.Unsigned(bond->GetBondOrder());
+    section.Unsigned(bond->GetFlags());
+  }
+  out.Section(BondSection, section);
+
+  // The bonds are added in order when reading, so only the atoms whose
+  // bonds are in some other order are written
+  section.buffer.clear();
+  FOR_ATOMS_OF_MOL(atom, mol) {
+    bool ordered = true;
+    OBBond *last = nullptr;
+    FOR_BONDS_OF_ATOM(bond, &*atom) {
+      if (last && bond->GetIdx() < last->GetIdx())
+        ordered = false;
+      last = &*bond;
+    }
+    if (ordered)
+      continue;
+    section.Unsigned(atom->GetIdx() - 1);
+    section.Unsigned(atom->GetExplicitDegree());
+    FOR_BONDS_OF_ATOM(bond, &*atom)
+      section.Unsigned(bond->GetIdx());
+  }
+  if (!section.buffer.empty())
+    out.Section(NeighborSection, section);
+
+  section.buffer.clear();
+  unsigned int n = mol.NumAtoms() * 3;
+  int current = 0;
+  if (mol.NumConformers()) {
+    section.Unsigned(mol.NumConformers());
+    for (int i = 0; i < mol.NumConformers(); ++i) {
+      double *c = mol.GetConformer(i);
+      if (c == mol.GetCoordinates())
+        current = i;
+      for (unsigned int j = 0; j < n; ++j)
+        section.Double(c[j]);
+    }
+  }
+  else { // the coordinates are only held by the atoms
+    section.Unsigned(1);
+    FOR_ATOMS_OF_MOL(atom, mol) {
+      section.Double(atom->GetX());
+      section.Double(atom->GetY());
+      section.Double(atom->GetZ());
+    }
+  }
+  section.Unsigned(current);
+  vector<double> energies = mol.GetEnergies();
+  section.Unsigned(energies.size());
+  for (unsigned int i = 0; i < energies.size(); ++i)
+    section.Double(energies[i]);
+  out.Section(ConformerSection, section);
+
+  if (mol.NumResidues()) {
+    section.buffer.clear();
+    section.Unsigned(mol.NumResidues());
+    FOR_RESIDUES_OF_MOL(res, mol) {
+      section.String(res->GetName());
+      section.String(res->GetNumString());
+      section.Char(res->GetChain());
+      section.Unsigned(res->GetChainNum());
+      section.Char(res->GetInsertionCode());
+      section.Unsigned(res->GetNumAtoms());
+      FOR_ATOMS_OF_RESIDUE(atom, &*res) {
+        section.Unsigned(atom->GetIdx() - 1);
+        section.String(res->GetAtomID(&*atom));
+        section.Unsigned(res->IsHetAtom(&*atom));
+        section.Unsigned(res->GetSerialNum(&*atom));
+      }
+    }
+    out.Section(ResidueSection, section);
+  }
+
+  WriteStereo(out, mol);
+  WriteGenericData(out, mol);
+
+  ofs.write(RecordMagic, sizeof(RecordMagic));
+  BinaryWriter header;
+  header.Unsigned(FormatVersion);
+  header.Unsigned(out.buffer.size());
+  ofs.write(header.buffer.data(), header.buffer.size());
+  ofs.write(out.buffer.data(), out.buffer.size());
+  return ofs.good();
+}
+
+/////////////////////////////////////////////////////////////////
+bool OBBinFormat::ReadHeader(istream &ifs, unsigned long &length)
+{
+  char magic[sizeof(RecordMagic)];
+  if (!ifs.read(magic, sizeof(magic)))
+    return false; // the end of the file
+  if (memcmp(magic, RecordMagic, sizeof(magic)) != 0) {
+    obErrorLog.ThrowError(__FUNCTION__, "Not an obbin record", obError);
+    return false;
+  }
+
+  // the version and the length, as varints
+  unsigned long values[2] = { 0, 0 };
+  for (int v = 0; v < 2; ++v) {
+    int shift = 0;
+    char c;
+    do {
+      if (!ifs.get(c) || shift >= 64) {
+        obErrorLog.ThrowError(__FUNCTION__, "Truncated obbin record", obError);
+        return false;
+      }
+      values[v] |= static_cast<unsigned long>(c & 0x7f) << shift;
+      shift += 7;
+    } while (c & 0x80);
+  }
+  if (values[0] > FormatVersion) {
+    obErrorLog.ThrowError(__FUNCTION__, "The obbin record was written by a later version of Open Babel", obError);
+    return false;
+  }
+  length = values[1];
+  return true;
+}
+
+int OBBinFormat::SkipObjects(int n, OBConversion* pConv)
+{
+  istream &ifs = *pConv->GetInStream();
+  unsigned long length;
+  for (int i = 0; i < n; ++i) {
+    if (!ReadHeader(ifs, length) || !ifs.ignore(length))
+      return -1;
+  }
+  return 1;
+}
+
+bool OBBinFormat::ReadMolecule(OBBase* pOb, OBConversion* pConv)
+{
+  OBMol* pmol = dynamic_cast<OBMol*>(pOb);
+  if (pmol == nullptr)
+    return false;
+  OBMol &mol = *pmol;
+  istream &ifs = *pConv->GetInStream();
+
+  unsigned long length;
+  if (!ReadHeader(ifs, length))
+    return false;
+  string buffer(length, '\0');
+  if (length && !ifs.read(&buffer[0], length)) {
+    obErrorLog.ThrowError(__FUNCTION__, "Truncated obbin record", obError);
+    return false;
+  }
+
+  mol.Clear();
+  mol.BeginModify();
+  BinaryReader in(buffer.data(), buffer.data() + buffer.size());
+  // the molecule flags are set last, as adding atoms and bonds may change them
+  unsigned long flags = 0;
+  unsigned int current = 0;
+  vector<double*> conformers;
+  while (in.ok && in.pos != in.end) {
+    SectionTag tag = static_cast<SectionTag>(in.Unsigned());
+    unsigned long size = in.Unsigned();
+    if (!in.ok || static_cast<unsigned long>(in.end - in.pos) < size) {
+      in.ok = false;
+      break;
+    }
+    BinaryReader section(in.pos, in.pos + size);
+    in.pos += size;
+
+    switch (tag) {
+    case MoleculeSection: {
+      string title = section.String();
+      mol.SetTitle(title);
+      flags = section.Unsigned();
+      mol.SetDimension(section.Unsigned());
+      mol.SetEnergy(section.Double());
+      int charge = section.Signed();
+      unsigned int spin = section.Unsigned();
+      if (flags & OB_TCHARGE_MOL)
+        mol.SetTotalCharge(charge);
+      if (flags & OB_TSPIN_MOL)
+        mol.SetTotalSpinMultiplicity(spin);
+      mol.SetAutomaticFormalCharge(section.Unsigned() != 0);
+      mol.SetAutomaticPartialCharge(section.Unsigned() != 0);
+      break;
+    }
+    case ConformerSection: {
+      // The atoms take the coordinates of the first conformer, from which
+      // EndModify() makes the first conformer of the molecule
+      unsigned int n = mol.NumAtoms() * 3;
+      unsigned long count = section.Unsigned();
+      // without atoms a conformer takes no space, so only one is allowed
+      if (count == 0 || (n ? static_cast<unsigned long>(section.end - section.pos) / (8ul * n) < count : count > 1)) {
+        section.ok = false;
+        break;
+      }
+      for (unsigned long i = 0; i < count; ++i) {
+        double *c = new double[n];
+        for (unsigned int j = 0; j < n; ++j)
+          c[j] = section.Double();
+        conformers.push_back(c);
+      }
+      for (unsigned int i = 0; i < mol.NumAtoms(); ++i)
+        mol.GetAtom(i + 1)->SetVector(conformers[0][3 * i], conformers[0][3 * i + 1], conformers[0][3 * i + 2]);
+      current = section.Index(count);
+      unsigned long numEnergies = section.Unsigned();
+      if (numEnergies > static_cast<unsigned long>(section.end - section.pos) / 8) {
+        section.ok = false;
+        break;
+      }
+      vector<double> energies(numEnergies);
+      for (unsigned int i = 0; i < energies.size() && section.ok; ++i)
+        energies[i] = section.Double();
+      if (!energies.empty())
+        mol.SetEnergies(energies);
+      break;
+    }
+    default:
+      if (!ReadSection(mol, tag, section))
+        section.ok = false;
+      break;
+    }
+    if (!section.ok)
+      in.ok = false;
+  }
+
+  mol.EndModify(false);
+  if (in.ok && conformers.size() > 1) {
+    // replaces the conformer made by EndModify() from the atom coordinates
+    mol.SetConformers(conformers);
+    mol.SetConformer(current);
+  }
+  else {
+    for (unsigned int i = 0; i < conformers.size(); ++i)
+      delete [] conformers[i];
+  }
+
+  if (!in.ok) {
+    obErrorLog.ThrowError(__FUNCTION__, string("Corrupt obbin record: ") + mol.GetTitle(false), obError);
+    mol.Clear();
+    return false;
+  }
+  mol.SetFlags(flags);
+  return true;
+}
+
+// An atom id of a stereo object: an atom of the molecule or a special ref
+static OBStereo::Ref ReadId(BinaryReader &in, OBMol &mol)
+{
+  unsigned long id = in.Unsigned();
+  if (id != OBStereo::NoRef && id != OBStereo::ImplicitRef && id >= mol.NumAtoms())
+    in.ok = false;
+  return id;
+}
+
+static bool ReadRefs(BinaryReader &in, OBMol &mol, unsigned int count, OBStereo::Refs &refs)
+{
+  if (in.Unsigned() != count || !in.ok)
+    return false;
+  refs.resize(count);
+  for (unsigned int i = 0; i < count; ++i)
+    refs[i] = ReadId(in, mol);
+  return in.ok;
+}
+
+bool OBBinFormat::ReadSection(OBMol &mol, SectionTag tag, BinaryReader &in)
+{
+  switch (tag) {
+  case AtomSection: {
+    unsigned long count = in.Unsigned();
+    if (count > static_cast<unsigned long>(in.end - in.pos))
+      return false;
+    mol.ReserveAtoms(count);
+    for (unsigned long i = 0; i < count && in.ok; ++i) {
+      // the ids are renumbered when written, checking them keeps a corrupt
+      // id from growing the id table of the molecule
+      unsigned long id = in.Unsigned();
+      if (!in.ok || id >= count)
+        return false;
+      OBAtom *atom = mol.NewAtom(id);
+      if (!atom)
+        return false;
+      atom->SetAtomicNum(in.Unsigned());
+      atom->SetIsotope(in.Unsigned());
+      atom->SetFormalCharge(in.Signed());
+      atom->SetSpinMultiplicity(in.Unsigned());
+      atom->SetImplicitHCount(in.Unsigned());
+      atom->SetHyb(in.Unsigned());
+      unsigned long atomFlags = in.Unsigned();
+      atom->SetAromatic((atomFlags & AromaticAtom) != 0);
+      atom->SetInRing((atomFlags & RingAtom) != 0);
+      atom->SetPartialCharge(in.Double());
+      atom->SetType(in.String());
+    }
+    break;
+  }
+  case BondSection: {
+    unsigned long count = in.Unsigned();
+    if (count > static_cast<unsigned long>(in.end - in.pos))
+      return false;
+    for (unsigned long i = 0; i < count && in.ok; ++i) {
+      unsigned int begin = in.Index(mol.NumAtoms());
+      unsigned int end = in.Index(mol.NumAtoms());
+      unsigned int order = in.Unsigned();
+      unsigned int bondFlags = in.Unsigned();
+      if (in.ok && !mol.AddBond(begin + 1, end + 1, order, bondFlags))
+        return false;
+    }
+    break;
+  }
+  case NeighborSection:
+    while (in.ok && in.pos != in.end) {
+      OBAtom *atom = mol.GetAtom(in.Index(mol.NumAtoms()) + 1);
+      unsigned int degree = in.Unsigned();
+      if (!in.ok || degree != atom->GetExplicitDegree())
+        return false;
+      vector<OBBond*> bonds;
+      for (unsigned int i = 0; i < degree; ++i) {
+        OBBond *bond = mol.GetBond(in.Index(mol.NumBonds()));
+        if (!in.ok || !bond)
+          return false;
+        if (bond->GetBeginAtom() != atom && bond->GetEndAtom() != atom)
+          return false;
+        bonds.push_back(bond);
+      }
+      atom->ClearBond();
+      for (unsigned int i = 0; i < degree; ++i)
+        atom->AddBond(bonds[i]);
+    }
+    break;
+  case ResidueSection: {
+    unsigned long count = in.Unsigned();
+    if (count > static_cast<unsigned long>(in.end - in.pos))
+      return false;
+    for (unsigned long i = 0; i < count && in.ok; ++i) {
+      OBResidue *res = mol.NewResidue();
+      res->SetName(in.String());
+      res->SetNum(in.String());
+      res->SetChain(in.Char());
+      res->SetChainNum(in.Unsigned());
+      res->SetInsertionCode(in.Char());
+      unsigned long natoms = in.Unsigned();
+      for (unsigned long j = 0; j < natoms && in.ok; ++j) {
+        OBAtom *atom = mol.GetAtom(in.Index(mol.NumAtoms()) + 1);
+        res->AddAtom(atom);
+        res->SetAtomID(atom, in.String());
+        res->SetHetAtom(atom, in.Unsigned() != 0);
+        res->SetSerialNum(atom, in.Unsigned());
+      }
+    }
+    break;
+  }
+  case RingSection: {
+    OBRingData *rd = new OBRingData;
+    rd->SetAttribute(in.String());
+    rd->SetOrigin(static_cast<DataOrigin>(in.Unsigned()));
+    vector<OBRing*> rings;
+    unsigned long count = in.Unsigned();
+    for (unsigned long i = 0; i < count && in.ok; ++i) {
+      string type = in.String();
+      // every index of the path takes at least one byte
+      unsigned long size = in.Unsigned();
+      if (!in.ok || size > static_cast<unsigned long>(in.end - in.pos)) {
+        in.ok = false;
+        break;
+      }
+      vector<int> path(size);
+      for (unsigned int j = 0; j < path.size() && in.ok; ++j)
+        path[j] = in.Index(mol.NumAtoms()) + 1;
+      OBRing *ring = new OBRing(path, mol.NumAtoms() + 1);
+      ring->SetType(type);
+      ring->SetParent(&mol);
+      rings.push_back(ring);
+    }
+    rd->SetData(rings);
+    mol.SetData(rd);
+    break;
+  }
+  case TetrahedralSection: {
+    OBTetrahedralStereo::Config config;
+    config.center = ReadId(in, mol);
+    config.from = ReadId(in, mol);
+    if (!ReadRefs(in, mol, 3, config.refs))
+      return false;
+    config.winding = static_cast<OBStereo::Winding>(in.Unsigned());
+    config.view = static_cast<OBStereo::View>(in.Unsigned());
+    config.specified = in.Unsigned() != 0;
+    OBTetrahedralStereo *ts = new OBTetrahedralStereo(&mol);
+    ts->SetConfig(config);
+    mol.SetData(ts);
+    break;
+  }
+  case CisTransSection: {
+    OBCisTransStereo::Config config;
+    config.begin = ReadId(in, mol);
+    config.end = ReadId(in, mol);
+    if (!ReadRefs(in, mol, 4, config.refs))
+      return false;
+    config.shape = static_cast<OBStereo::Shape>(in.Unsigned());
+    config.specified = in.Unsigned() != 0;
+    OBCisTransStereo *ct = new OBCisTransStereo(&mol);
+    ct->SetConfig(config);
+    mol.SetData(ct);
+    break;
+  }
+  case SquarePlanarSection: {
+    OBSquarePlanarStereo::Config config;
+    config.center = ReadId(in, mol);
+    if (!ReadRefs(in, mol, 4, config.refs))
+      return false;
+    config.shape = static_cast<OBStereo::Shape>(in.Unsigned());
+    config.specified = in.Unsigned() != 0;
+    OBSquarePlanarStereo *sp = new OBSquarePlanarStereo(&mol);
+    sp->SetConfig(config);
+    mol.SetData(sp);
+    break;
+  }
+  case PairDataSection: {
+    OBPairData *pd = new OBPairData;
+    pd->SetAttribute(in.String());
+    pd->SetValue(in.String());
+    pd->SetOrigin(static_cast<DataOrigin>(in.Unsigned()));
+    mol.SetData(pd);
+    break;
+  }
+  case CommentSection: {
+    OBCommentData *cd = new OBCommentData;
+    cd->SetData(in.String());
+    cd->SetOrigin(static_cast<DataOrigin>(in.Unsigned()));
+    mol.SetData(cd);
+    break;
+  }
+  case UnitCellSection: {
+    matrix3x3 m;
+    for (int i = 0; i < 3; ++i)
+      for (int j = 0; j < 3; ++j)
+        m.Set(i, j, in.Double());
+    double x = in.Double(), y = in.Double(), z = in.Double();
+    OBUnitCell *cell = new OBUnitCell;
+    cell->SetData(m);
+    cell->SetOffset(vector3(x, y, z));
+    cell->SetSpaceGroup(in.String());
+    string hall = in.String();
+    if (!hall.empty())
+      cell->SetSpaceGroup(SpaceGroup::GetSpaceGroup(hall));
+    cell->SetLatticeType(static_cast<OBUnitCell::LatticeType>(in.Unsigned()));
+    cell->SetOrigin(static_cast<DataOrigin>(in.Unsigned()));
+    mol.SetData(cell);
+    break;
+  }
+  default: // a section of a later version
+    break;
+  }
+  return in.ok;
+}
+
+} //namespace OpenBabel
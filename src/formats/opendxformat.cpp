@@ -53,7 +53,10 @@ namespace OpenBabel
         "OpenDX cube format for APBS\n"
         "A volume data format for IBM's Open Source visualization software\n"
           "The OpenDX support is currently designed to read the OpenDX cube\n"
-          "files from APBS. \n\n";
+          "files from APBS. \n\n"
+
+        "Read Options e.g. -ap\n"
+        "  p store the grid values in single precision (halves the memory used)\n\n";
     }
 
     // Return a specification url, not really a specification since
@@ -85,6 +88,54 @@ namespace OpenBabel
     // Global variable used to register OpenDX cube format.
     OBOpenDXCubeFormat theOpenDXCubeFormat;
 
+//------------------------------------------------------------------------------
+  // Read data lines up to the first "attribute" line. Each line is parsed
+  // in place rather than split into strings; a field that is not a number
+  // is read as zero, as strtod() would.
+  template<typename T>
+  static bool ReadDXValues(istream &ifs, char *buffer, int n, vector<T> &values)
+  {
+    values.reserve(n);
+    int line = 0;
+    while (ifs.getline(buffer, BUFF_SIZE))
+    {
+      ++line;
+      if (EQn(buffer, "attribute", 9))
+        break; // we're finished with reading data -- although we should probably have a voxel check in here too
+
+      const char *p = buffer;
+      bool empty = true;
+      for (;;)
+      {
+        while (*p == ' ' || *p == '\t' || *p == '\r')
+          ++p;
+        if (*p == '\0')
+          break;
+        empty = false;
+        char *endptr;
+        double value = ParseDouble(p, &endptr);
+        if (endptr == p)
+          value = 0.0;
+        // skip whatever is left of this field
+        p = endptr;
+        while (*p != '\0' && *p != ' ' && *p != '\t' && *p != '\r')
+          ++p;
+        values.push_back(static_cast<T>(value));
+      }
+      if (empty)
+      {
+        stringstream errorMsg;
+        errorMsg << "Problem reading the OpenDX grid file: cannot"
+                 << " read line " << line
+                 << ", there does not appear to be any data in it.\n"
+                 << buffer << "\n";
+        obErrorLog.ThrowError(__FUNCTION__, errorMsg.str(), obError);
+        return false;
+      }
+    }
+    return true;
+  }
+
 //------------------------------------------------------------------------------
 bool OBOpenDXCubeFormat::ReadMolecule( OBBase* pOb, OBConversion* pConv )
 {
@@ -171,40 +222,28 @@ bool OBOpenDXCubeFormat::ReadMolecule( OBBase* pOb, OBConversion* pConv )
     OBGridData *gd = new OBGridData;
     gd->SetAttribute("OpenDX");
 
-    // get all values as one vector<double>
-    char *endptr;
-    vector<double> values;
-    int n = voxels[0]*voxels[1]*voxels[2];
-    int line = 0;
-    values.reserve(n);
-    while (ifs.getline(buffer, BUFF_SIZE))
-    {
-      ++line;
-      if (EQn(buffer, "attribute", 9))
-        break; // we're finished with reading data -- although we should probably have a voxel check in here too
-
-      tokenize(vs, buffer);
-      if (vs.size() == 0)
-      {
-        errorMsg << "Problem reading the OpenDX grid file: cannot"
-                 << " read line " << line
-                 << ", there does not appear to be any data in it.\n"
-                 << buffer << "\n";
-        obErrorLog.ThrowError(__FUNCTION__, errorMsg.str(), obError);
-        return false;
-      }
-
-      for (unsigned int l = 0; l < vs.size(); ++l)
-      {
-        values.push_back(strtod(static_cast<const char*>(vs[l].c_str()), &endptr));
-      }
-    }
-
+    gd->SetFloatPrecision(pConv->IsOption("p", OBConversion::INOPTIONS) != nullptr);
     gd->SetNumberOfPoints(voxels[0], voxels[1], voxels[2]);
     gd->SetLimits(origin, axes[0], axes[1], axes[2]);
     gd->SetUnit(OBGridData::ANGSTROM);
     gd->SetOrigin(fileformatInput); // i.e., is this data from a file or determined by Open Babel
-    gd->SetValues(values); // set the values
+
+    // get all values as one vector
+    int n = voxels[0]*voxels[1]*voxels[2];
+    if (gd->GetFloatPrecision())
+    {
+      vector<float> values;
+      if (!ReadDXValues(ifs, buffer, n, values))
+        return false;
+      gd->SetValues(values); // set the values
+    }
+    else
+    {
+      vector<double> values;
+      if (!ReadDXValues(ifs, buffer, n, values))
+        return false;
+      gd->SetValues(values);
+    }
     pmol->SetData(gd); // store the grids in the OBMol
     pmol->EndModify();
 
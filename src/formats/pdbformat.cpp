@@ -26,7 +26,9 @@ GNU General Public License for more details.
 
 #include <vector>
 #include <map>
+#include <deque>
 #include <cstdlib>
+#include <cstring>
 #include <algorithm>
 
 #include <sstream>
@@ -46,6 +48,7 @@ namespace OpenBabel
       OBConversion::RegisterOptionParam("s", this, 0, OBConversion::INOPTIONS);
       OBConversion::RegisterOptionParam("b", this, 0, OBConversion::INOPTIONS);
       OBConversion::RegisterOptionParam("c", this, 0, OBConversion::INOPTIONS);
+      OBConversion::RegisterOptionParam("m", this, 0, OBConversion::INOPTIONS);
 
       OBConversion::RegisterOptionParam("o", this, 0, OBConversion::OUTOPTIONS);
       OBConversion::RegisterOptionParam("n", this, 0, OBConversion::OUTOPTIONS);
@@ -58,7 +61,9 @@ namespace OpenBabel
         "Read Options e.g. -as\n"
         "  s  Output single bonds only\n"
         "  b  Disable bonding entirely\n"
-        "  c  Ignore CONECT records\n\n"
+        "  c  Ignore CONECT records\n"
+        "  m  Read the following MODELs as conformers of the first\n"
+        "     (the atoms must be the same and in the same order)\n\n"
 
         "Write Options, e.g. -xo\n"
         "  n  Do not write duplicate CONECT records to indicate bond order\n"
@@ -77,7 +82,6 @@ namespace OpenBabel
   	virtual int SkipObjects(int n, OBConversion* pConv);
     virtual bool ReadMolecule(OBBase* pOb, OBConversion* pConv);
     virtual bool WriteMolecule(OBBase* pOb, OBConversion* pConv);
-
   };
   //***
 
@@ -88,9 +92,17 @@ namespace OpenBabel
   /// Utility functions
   static void fixRhombohedralSpaceGroupWriter(string &strHM);
   static void fixRhombohedralSpaceGroupReader(string &strHM);
-  static bool parseAtomRecord(char *buffer, OBMol & mol, int chainNum);
+  static bool parseAtomRecord(char *buffer, OBMol & mol, int chainNum,
+                              map<string, OBResidue*> &residues);
   static bool parseConectRecord(char *buffer, OBMol & mol);
   static bool readIntegerFromRecord(char *buffer, unsigned int columnAsSpecifiedInPDB, long int *target);
+  static bool readLine(istream &ifs, deque<string> &pending, char *buffer);
+  // the stream slot (pword) holding the lines of a MODEL that was read ahead
+  // with the m option but did not match the molecule, which are read again
+  // as the next molecule; the format instance is shared by every conversion
+  static const int readAheadIndex = ios_base::xalloc();
+  static deque<string> &readAhead(istream &ifs);
+  static void readModelConformers(istream &ifs, OBMol &mol, deque<string> &pending);
 
   //extern OBResidueData    resdat; now in mol.h
 
@@ -134,23 +146,32 @@ namespace OpenBabel
     char buffer[BUFF_SIZE] = {0,};
     string line, key, value;
     OBPairData *dp;
+    // residues read so far, keyed by name, number, chain and insertion code
+    map<string, OBResidue*> residues;
 
     mol.SetTitle(title);
     // We need to prevent chains perception routines from running while
     // we are adding residues from the PDB file
     mol.SetChainsPerceived();
 
+    // a new conversion starts at the current stream position
+    deque<string> &pending = readAhead(ifs);
+    if (pConv->GetCount() == 0)
+      pending.clear();
+
     mol.BeginModify();
     bool ateend = false;
-    while (ifs.good() && ifs.getline(buffer,BUFF_SIZE))
+    bool endmdl = false;
+    while ((!pending.empty() || ifs.good()) && readLine(ifs, pending, buffer))
       {
         if (EQn(buffer,"ENDMDL",6)) {
           ateend = true;
+          endmdl = true;
           break;
         }
         if (EQn(buffer,"END",3)) {
           // eat anything until the next ENDMDL
-          while (ifs.getline(buffer,BUFF_SIZE) && !EQn(buffer,"ENDMDL",6));
+          while (readLine(ifs, pending, buffer) && !EQn(buffer,"ENDMDL",6));
           ateend = true;
           break;
         }
@@ -160,7 +181,7 @@ namespace OpenBabel
         }
         if (EQn(buffer,"ATOM",4) || EQn(buffer,"HETATM",6))
           {
-            if( ! parseAtomRecord(buffer,mol,chainNum))
+            if( ! parseAtomRecord(buffer,mol,chainNum,residues))
               {
                 stringstream errorMsg;
                 errorMsg << "WARNING: Problems reading a PDB file\n"
@@ -256,8 +277,12 @@ namespace OpenBabel
     FOR_ATOMS_OF_MOL(matom, mol)
       OBAtomAssignTypicalImplicitHydrogens(&*matom);
 
+    // the topology perceived above is reused for the remaining models
+    if (endmdl && pConv->IsOption("m",OBConversion::INOPTIONS))
+      readModelConformers(ifs, mol, pending);
+
     // clean out remaining blank lines
-    while(ifs.peek() == '\n' && !ifs.eof())
+    while(pending.empty() && ifs.peek() == '\n' && !ifs.eof())
     {
       ifs.getline(buffer,BUFF_SIZE);
     }
@@ -265,6 +290,97 @@ namespace OpenBabel
     return(true);
   }
 
+  /////////////////////////////////////////////////////////////////////////
+  static void readAheadCallback(ios_base::event ev, ios_base &ios, int index)
+  {
+    if (ev == ios_base::erase_event)
+      delete static_cast<deque<string>*>(ios.pword(index));
+    else if (ev == ios_base::copyfmt_event)
+      ios.pword(index) = nullptr; // the lines belong to the source stream
+  }
+
+  //! The lines read ahead from \a ifs
+  static deque<string> &readAhead(istream &ifs)
+  {
+    void *&lines = ifs.pword(readAheadIndex);
+    if (!lines) {
+      lines = new deque<string>;
+      ifs.register_callback(readAheadCallback, readAheadIndex);
+    }
+    return *static_cast<deque<string>*>(lines);
+  }
+
+  /////////////////////////////////////////////////////////////////////////
+  //! Read a line from \a pending, or from \a ifs when it is empty
+  static bool readLine(istream &ifs, deque<string> &pending, char *buffer)
+  {
+    if (pending.empty())
+      return static_cast<bool>(ifs.getline(buffer,BUFF_SIZE));
+    strncpy(buffer, pending.front().c_str(), BUFF_SIZE - 1);
+    buffer[BUFF_SIZE - 1] = '\0';
+    pending.pop_front();
+    return true;
+  }
+
+  /////////////////////////////////////////////////////////////////////////
+  //! Read the coordinates of the following MODELs into conformers of \a mol
+  /*! Only the coordinate columns of the ATOM and HETATM records are parsed,
+    so each model must list the same atoms in the same order as the first.
+    Reading stops at END, at the end of the file, or at a model with a
+    different number of atoms. The lines of that model are kept in
+    \a pending to be read as a separate molecule, rather than rewinding the
+    stream (which fails for standard input and compressed files).
+  */
+  static void readModelConformers(istream &ifs, OBMol &mol, deque<string> &pending)
+  {
+    char buffer[BUFF_SIZE];
+    char field[9];
+    field[8] = '\0';
+    unsigned int size = mol.NumAtoms() * 3;
+    vector<double> coords;
+    coords.reserve(size);
+
+    bool atend = false;
+    while (!atend && ifs.good())
+      {
+        coords.clear();
+        pending.clear();
+        while (ifs.getline(buffer,BUFF_SIZE))
+          {
+            pending.push_back(buffer);
+            if (EQn(buffer,"ENDMDL",6))
+              break;
+            if (EQn(buffer,"END",3)) {
+              atend = true;
+              break;
+            }
+            // the same records that parseAtomRecord accepts
+            if ((EQn(buffer,"ATOM",4) || EQn(buffer,"HETATM",6)) && strlen(buffer) >= 54)
+              for (unsigned int column = 30; column < 54; column += 8) {
+                memcpy(field, buffer + column, 8);
+                coords.push_back(atof(field));
+              }
+          }
+
+        if (coords.empty()) { // e.g. trailing CONECT records
+          pending.clear();
+          break;
+        }
+        if (coords.size() != size) {
+          stringstream errorMsg;
+          errorMsg << "MODEL with " << coords.size() / 3 << " atoms instead of "
+                   << mol.NumAtoms() << " read as a separate molecule.";
+          obErrorLog.ThrowError(__FUNCTION__, errorMsg.str(), obWarning);
+          return;
+        }
+
+        double *conformer = new double [size];
+        copy(coords.begin(), coords.end(), conformer);
+        mol.AddConformer(conformer);
+        pending.clear();
+      }
+  }
+
   /////////////////////////////////////////////////////////////////////////
   //! Utility function to read a 5-digit integer starting from a specified column
   /*! This function reads a 5-digit integer, starting from column
@@ -889,7 +1005,8 @@ namespace OpenBabel
 	77 - 78        LString(2)      Element symbol, right-justified.
 	79 - 80        LString(2)      Charge on the atom.
   */
-  static bool parseAtomRecord(char *buffer, OBMol &mol,int /*chainNum*/)
+  static bool parseAtomRecord(char *buffer, OBMol &mol,int /*chainNum*/,
+                              map<string, OBResidue*> &residues)
   /* ATOMFORMAT "(i5,1x,a4,a1,a3,1x,a1,i4,a1,3x,3f8.3,2f6.2,a2,a2)" */
   {
     string sbuf = &buffer[6];
@@ -1131,22 +1248,23 @@ namespace OpenBabel
         || res->GetChain() != chain
         || res->GetInsertionCode() != insertioncode)
       {
-        vector<OBResidue*>::iterator ri;
-        for (res = mol.BeginResidue(ri) ; res ; res = mol.NextResidue(ri))
-          if (res->GetName() == resname
-              && res->GetNumString() == resnum
-              && static_cast<int>(res->GetChain()) == chain
-              && static_cast<int>(res->GetInsertionCode()) == insertioncode) {
-            if (insertioncode) fprintf(stderr,"I: identified residue wrt insertion code: '%c'\n",insertioncode);
-            break;
-          }
-
-        if (res == nullptr) {
+        // look the residue up rather than scanning them all, which is
+        // quadratic for large systems with many small residues (e.g. water)
+        string key = resname + '\n' + resnum;
+        key += chain;
+        key += insertioncode;
+        map<string, OBResidue*>::iterator ri = residues.find(key);
+        if (ri != residues.end()) {
+          res = ri->second;
+          if (insertioncode) fprintf(stderr,"I: identified residue wrt insertion code: '%c'\n",insertioncode);
+        }
+        else {
           res = mol.NewResidue();
           res->SetChain(chain);
           res->SetName(resname);
           res->SetNum(resnum);
           res->SetInsertionCode(insertioncode);
+          residues[key] = res;
         }
       }
 
@@ -74,12 +74,14 @@ namespace OpenBabel
       OBReaction* pReact = new OBReaction;
       bool ret=ReadMolecule(pReact,pConv); //call the "API" read function
 
-      std::string auditMsg = "OpenBabel::Read reaction ";
-      std::string description(Description());
-      auditMsg += description.substr(0,description.find('\n'));
-      obErrorLog.ThrowError(__FUNCTION__,
-          auditMsg,
-          obAuditMsg);
+      if (obErrorLog.GetOutputLevel() >= obAuditMsg) {
+        std::string auditMsg = "OpenBabel::Read reaction ";
+        std::string description(Description());
+        auditMsg += description.substr(0,description.find('\n'));
+        obErrorLog.ThrowError(__FUNCTION__,
+            auditMsg,
+            obAuditMsg);
+      }
 
       if(ret) //Do transformation and return molecule
         return pConv->AddChemObject(pReact->DoTransformations(pConv->GetOptions(OBConversion::GENOPTIONS),pConv))!=0;
@@ -103,12 +105,14 @@ namespace OpenBabel
       bool ret=false;
       ret=WriteMolecule(pReact,pConv);
 
-      std::string auditMsg = "OpenBabel::Write reaction ";
-      std::string description(Description());
-      auditMsg += description.substr( 0, description.find('\n') );
-      obErrorLog.ThrowError(__FUNCTION__,
-          auditMsg,
-          obAuditMsg);
+      if (obErrorLog.GetOutputLevel() >= obAuditMsg) {
+        std::string auditMsg = "OpenBabel::Write reaction ";
+        std::string description(Description());
+        auditMsg += description.substr( 0, description.find('\n') );
+        obErrorLog.ThrowError(__FUNCTION__,
+            auditMsg,
+            obAuditMsg);
+      }
       delete pOb;
       return ret;
     }
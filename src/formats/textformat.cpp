@@ -40,12 +40,14 @@ public:
     OBText* pReact = new OBText;
     bool ret=ReadMolecule(pReact,pConv); //call the "API" read function
 
-    std::string auditMsg = "OpenBabel::Read text ";
-    std::string description(Description());
-    auditMsg += description.substr(0,description.find('\n'));
-    obErrorLog.ThrowError(__FUNCTION__,
-              auditMsg,
-              obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg) {
+      std::string auditMsg = "OpenBabel::Read text ";
+      std::string description(Description());
+      auditMsg += description.substr(0,description.find('\n'));
+      obErrorLog.ThrowError(__FUNCTION__,
+                auditMsg,
+                obAuditMsg);
+    }
 
     if(ret) //Do transformation and return molecule
       return pConv->AddChemObject(pReact->DoTransformations(pConv->GetOptions(OBConversion::GENOPTIONS),pConv))!=0;
@@ -134,12 +134,14 @@ bool CMLReactFormat::ReadChemObject(OBConversion* pConv)
 
   bool ret=ReadMolecule(pReact,pConv); //call the "API" read function
 
-  std::string auditMsg = "OpenBabel::Read reaction ";
-  std::string description(Description());
-  auditMsg += description.substr(0,description.find('\n'));
-  obErrorLog.ThrowError(__FUNCTION__,
-            auditMsg,
-            obAuditMsg);
+  if (obErrorLog.GetOutputLevel() >= obAuditMsg) {
+    std::string auditMsg = "OpenBabel::Read reaction ";
+    std::string description(Description());
+    auditMsg += description.substr(0,description.find('\n'));
+    obErrorLog.ThrowError(__FUNCTION__,
+              auditMsg,
+              obAuditMsg);
+  }
 
    //Do transformation and return reaction, if it has either reactants or products
   if(ret && (pReact->NumReactants()!=0 || pReact->NumProducts()!=0)) //Do transformation and return molecule
@@ -386,10 +388,12 @@ bool CMLReactFormat::WriteChemObject(OBConversion* pConv)
   bool ret=false;
   ret=WriteMolecule(pReact,pConv);
 
-  std::string auditMsg = "OpenBabel::Write reaction ";
-  std::string description(Description());
-  auditMsg += description.substr( 0, description.find('\n') );
-  obErrorLog.ThrowError(__FUNCTION__, auditMsg, obAuditMsg);
+  if (obErrorLog.GetOutputLevel() >= obAuditMsg) {
+    std::string auditMsg = "OpenBabel::Write reaction ";
+    std::string description(Description());
+    auditMsg += description.substr( 0, description.find('\n') );
+    obErrorLog.ThrowError(__FUNCTION__, auditMsg, obAuditMsg);
+  }
 
   delete pOb;
 
@@ -27,6 +27,13 @@
 #endif
 #include <rpc/xdr.h>
 #include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <sys/types.h>
+#include <sys/stat.h>
 
 #define MAXID 20
 #define MAXABS INT_MAX-2
@@ -41,6 +48,15 @@
 #define SQR(x) ((x)*(x))
 #endif
 
+// frame offsets can exceed 2 GB in long trajectories
+#ifdef _MSC_VER
+#define XTC_FSEEK _fseeki64
+#define XTC_FTELL _ftelli64
+#else
+#define XTC_FSEEK fseeko
+#define XTC_FTELL ftello
+#endif
+
 #define FIRSTIDX 9
 /* note that magicints[FIRSTIDX-1] == 0 */
 #define LASTIDX (sizeof(magicints) / sizeof(*magicints))
@@ -70,18 +86,39 @@ namespace OpenBabel
                       unsigned int sizes[], int nums[]);
     int	xdr3dfcoord(XDR *xdrs, float *fp, int *size, float *precision);
 
+    int ReadFrame(XDR *xdrs, int natoms, float *coords);
+    bool FrameOffsets(const std::string &filename, int natoms,
+                      std::vector<long long> &offsets, bool &fromIndex,
+                      bool rebuildIndex);
+    bool ReadFrames(const std::string &filename, int natoms, int first,
+                    int last, int interval, std::vector<double*> &vconf,
+                    bool rebuildIndex = false);
+
   public:
     //Register this format type ID
     XTCFormat()
     {
       OBConversion::RegisterFormat("xtc",this);
+      OBConversion::RegisterOptionParam("f", this, 1, OBConversion::INOPTIONS);
+      OBConversion::RegisterOptionParam("l", this, 1, OBConversion::INOPTIONS);
+      OBConversion::RegisterOptionParam("i", this, 1, OBConversion::INOPTIONS);
     }
 
     virtual const char* Description() //required
     {
       return
         "XTC format\n"
-        "A portable format for trajectories (gromacs)\n";
+        "A portable format for trajectories (gromacs)\n"
+        "The frames are read as conformers of the molecule being read into,\n"
+        "which must already contain the atoms of the trajectory.\n\n"
+        "Read Options e.g. -al 100\n"
+        "  f <n> First frame to read (starting from 1)\n"
+        "  l <n> Last frame to read\n"
+        "  i <n> Read every n-th frame\n\n"
+        "With any of these options the frames are located through an index of\n"
+        "frame offsets, so only the selected frames are decompressed. The index\n"
+        "is built once and kept next to the trajectory as <file>.obidx. It is\n"
+        "rebuilt when the trajectory changes or a frame can not be read.\n";
     };
 
     virtual const char* SpecificationURL()
@@ -128,6 +165,19 @@ namespace OpenBabel
 
     OBMol &mol = *pmol;
     std::string filename = pConv->GetInFilename();
+    int natoms = mol.NumAtoms();
+    std::vector<double*> vconf;
+
+    const char *first = pConv->IsOption("f", OBConversion::INOPTIONS);
+    const char *last = pConv->IsOption("l", OBConversion::INOPTIONS);
+    const char *interval = pConv->IsOption("i", OBConversion::INOPTIONS);
+    if (first || last || interval) {
+      if (!ReadFrames(filename, natoms, first ? atoi(first) : 1,
+                      last ? atoi(last) : 0, interval ? atoi(interval) : 1, vconf))
+        return false;
+      mol.SetConformers(vconf);
+      return true;
+    }
 
     if (xdropen(&xd, filename.c_str(),"r") == 0) {
       std::stringstream errorMsg;
@@ -136,63 +186,14 @@ namespace OpenBabel
       return false;
     }
 
-    int magic, natoms, step;
-    float prec = 1000.0;
-    float time, box[3][3];
-    std::vector<float> floatCoord;
-    std::vector<double*> vconf;
-
-
-    while (true) {
-      // Check the magic int starting each frame
-      xdr_int(&xd, &magic);
-      if (magic != 1995) {
-        std::stringstream errorMsg;
-        errorMsg << "Error: magic int is " << magic << ", should be 1995.";
-        obErrorLog.ThrowError(__FUNCTION__, errorMsg.str(), obWarning);
-        return false;
-      }
-
-      // Get the number of atoms
-      xdr_int(&xd, &natoms);
-      if (natoms != mol.NumAtoms()) {
-        std::stringstream errorMsg;
-        errorMsg << "Error: number of atoms in the trajectory (" << natoms
-                 << ") doesn't match the number of atoms in the supplied "
-                 << "molecule (" << mol.NumAtoms() << ").";
-        obErrorLog.ThrowError(__FUNCTION__, errorMsg.str(), obWarning);
-        return false;
-      }
-
-      // Get the frame step number
-      xdr_int(&xd, &step);
-      // Get the frame time
-      xdr_float(&xd, &time);
-      // Get the frame box
-      xdr_float(&xd, &box[0][0]);
-      xdr_float(&xd, &box[0][1]);
-      xdr_float(&xd, &box[0][2]);
-      xdr_float(&xd, &box[1][0]);
-      xdr_float(&xd, &box[1][1]);
-      xdr_float(&xd, &box[1][2]);
-      xdr_float(&xd, &box[2][0]);
-      xdr_float(&xd, &box[2][1]);
-      xdr_float(&xd, &box[2][2]);
-
-      if (!floatCoord.size())
-        floatCoord.resize(natoms * 3);
-
-      // Read the positions
-      if (xdr3dfcoord(&xd, &floatCoord[0], &natoms, &prec) == 0) {
-        // printf("end reached...\n");
-        break;
-      }
-
+    std::vector<float> floatCoord(natoms * 3);
+    int status;
+    while ((status = ReadFrame(&xd, natoms, &floatCoord[0])) > 0) {
       // Convert positions from single to double precision and convert from
       // nm to A
       double *confs = new double[natoms *3];
-      for (int i=0; i < natoms * 3; ++i) // unroll??
-        confs[i] = static_cast<double>(10.0 * floatCoord.at(i));
+      for (int i=0; i < natoms * 3; ++i)
+        confs[i] = static_cast<double>(10.0 * floatCoord[i]);
 
       vconf.push_back(confs);
     }
@@ -200,12 +201,245 @@ namespace OpenBabel
     // Close the XDR file
     xdrclose(&xd);
 
+    if (status < 0) {
+      for (unsigned int i = 0; i < vconf.size(); ++i)
+        delete [] vconf[i];
+      return false;
+    }
+
     // Set the conformers in the mol object
     mol.SetConformers(vconf);
 
     return(true);
   }
 
+  //! Read the next frame from \a xdrs into \a coords (in nm).
+  //! \return 1 if a frame was read, 0 at the end of the trajectory or -1
+  //! if the frame does not match the molecule.
+  int XTCFormat::ReadFrame(XDR *xdrs, int natoms, float *coords)
+  {
+    int magic, n, step;
+    float prec = 1000.0;
+    float time, box[9];
+
+    // Check the magic int starting each frame
+    if (xdr_int(xdrs, &magic) == 0)
+      return 0;
+    if (magic != 1995) {
+      std::stringstream errorMsg;
+      errorMsg << "Error: magic int is " << magic << ", should be 1995.";
+      obErrorLog.ThrowError(__FUNCTION__, errorMsg.str(), obWarning);
+      return -1;
+    }
+
+    // Get the number of atoms
+    xdr_int(xdrs, &n);
+    if (n != natoms) {
+      std::stringstream errorMsg;
+      errorMsg << "Error: number of atoms in the trajectory (" << n
+               << ") doesn't match the number of atoms in the supplied "
+               << "molecule (" << natoms << ").";
+      obErrorLog.ThrowError(__FUNCTION__, errorMsg.str(), obWarning);
+      return -1;
+    }
+
+    // Get the frame step number, time and box
+    xdr_int(xdrs, &step);
+    xdr_float(xdrs, &time);
+    for (int i = 0; i < 9; ++i)
+      xdr_float(xdrs, &box[i]);
+
+    // Read the positions
+    if (xdr3dfcoord(xdrs, coords, &n, &prec) == 0)
+      return 0;
+    return 1;
+  }
+
+  static bool ReadBigEndianInts(FILE *fp, unsigned int count, int *values)
+  {
+    unsigned char bytes[4 * 14];
+    if (fread(bytes, 4, count, fp) != count)
+      return false;
+    for (unsigned int i = 0; i < count; ++i)
+      values[i] = static_cast<int>((static_cast<unsigned int>(bytes[4*i]) << 24) | (bytes[4*i+1] << 16)
+                                   | (bytes[4*i+2] << 8) | bytes[4*i+3]);
+    return true;
+  }
+
+  //! Get the byte offsets of the frames in \a filename. A sidecar index
+  //! is used if it matches the size and modification time of the file
+  //! (and \a rebuildIndex is false), otherwise the frame headers are
+  //! scanned (skipping the compressed coordinates) and the index is
+  //! written for next time. \a fromIndex tells which one it was.
+  bool XTCFormat::FrameOffsets(const std::string &filename, int natoms,
+                               std::vector<long long> &offsets, bool &fromIndex,
+                               bool rebuildIndex)
+  {
+    FILE *fp = fopen(filename.c_str(), "rb");
+    if (fp == nullptr)
+      return false;
+    XTC_FSEEK(fp, 0, SEEK_END);
+    long long size = XTC_FTELL(fp);
+    struct stat st;
+    long long mtime = stat(filename.c_str(), &st) == 0 ? static_cast<long long>(st.st_mtime) : 0;
+
+    std::string indexname = filename + ".obidx";
+    offsets.clear();
+    fromIndex = false;
+    if (!rebuildIndex) {
+      std::ifstream ifs(indexname.c_str());
+      std::string header;
+      long long indexSize, indexTime;
+      int indexAtoms;
+      unsigned int nframes;
+      if (std::getline(ifs, header) && header == "XTC frame index 2"
+          && ifs >> indexSize >> indexTime >> indexAtoms >> nframes
+          && indexSize == size && indexTime == mtime && indexAtoms == natoms) {
+        offsets.resize(nframes);
+        for (unsigned int i = 0; i < nframes; ++i)
+          ifs >> offsets[i];
+        if (ifs) {
+          fclose(fp);
+          fromIndex = true;
+          return true;
+        }
+      }
+    }
+
+    // magic, natoms, step, time, box[9] and the number of coordinates,
+    // then for compressed frames precision, minint[3], maxint[3],
+    // smallidx and the number of bytes that follow
+    offsets.clear();
+    int values[14];
+    long long pos = 0;
+    while (pos < size) {
+      XTC_FSEEK(fp, pos, SEEK_SET);
+      if (!ReadBigEndianInts(fp, 14, values) || values[0] != 1995 || values[1] != natoms)
+        break;
+      long long framesize = 14 * 4;
+      int ncoords = values[13];
+      if (ncoords <= 9)
+        framesize += 12 * ncoords;
+      else {
+        if (!ReadBigEndianInts(fp, 9, values))
+          break;
+        framesize += 9 * 4 + ((static_cast<long long>(values[8]) + 3) & ~3LL);
+      }
+      offsets.push_back(pos);
+      pos += framesize;
+    }
+    fclose(fp);
+
+    if (pos != size) {
+      std::stringstream errorMsg;
+      errorMsg << "Error: could not index the frames of " << filename
+               << "; the number of atoms may not match the molecule ("
+               << natoms << ").";
+      obErrorLog.ThrowError(__FUNCTION__, errorMsg.str(), obWarning);
+      return false;
+    }
+
+    // not being able to write the index is not an error
+    std::ofstream ofs(indexname.c_str());
+    if (ofs) {
+      ofs << "XTC frame index 2\n" << size << " " << mtime << " " << natoms << " "
+          << offsets.size() << "\n";
+      for (unsigned int i = 0; i < offsets.size(); ++i)
+        ofs << offsets[i] << "\n";
+    }
+    return true;
+  }
+
+  //! Read frames \a first, \a first + \a interval, ... up to \a last
+  //! (counting from 1, 0 for the last frame) into \a vconf. Only the
+  //! selected frames are decompressed, in parallel when OpenMP is enabled.
+  //! A frame which can not be read through the sidecar index makes it be
+  //! discarded and rebuilt (\a rebuildIndex) before reading again.
+  bool XTCFormat::ReadFrames(const std::string &filename, int natoms, int first,
+                             int last, int interval, std::vector<double*> &vconf,
+                             bool rebuildIndex)
+  {
+    std::vector<long long> offsets;
+    bool fromIndex;
+    if (!FrameOffsets(filename, natoms, offsets, fromIndex, rebuildIndex))
+      return false;
+
+    std::vector<int> frames;
+    int nframes = offsets.size();
+    if (last <= 0 || last > nframes)
+      last = nframes;
+    for (int i = std::max(first, 1) - 1; i < last; i += std::max(interval, 1))
+      frames.push_back(i);
+    if (frames.empty()) {
+      obErrorLog.ThrowError(__FUNCTION__, "No frames selected from " + filename, obWarning);
+      return false;
+    }
+
+    FILE *fp = fopen(filename.c_str(), "rb");
+    if (fp == nullptr)
+      return false;
+    XTC_FSEEK(fp, 0, SEEK_END);
+    long long size = XTC_FTELL(fp);
+
+    // read the compressed frames in blocks, then decompress each block
+    const int blockSize = 64;
+    std::vector<std::vector<char> > bytes(blockSize);
+    std::vector<float> floatCoord(static_cast<size_t>(blockSize) * natoms * 3);
+    bool ok = true;
+    for (size_t start = 0; ok && start < frames.size(); start += blockSize) {
+      int count = static_cast<int>(std::min(frames.size() - start, static_cast<size_t>(blockSize)));
+      for (int j = 0; j < count; ++j) {
+        int frame = frames[start + j];
+        long long end = frame + 1 < nframes ? offsets[frame + 1] : size;
+        if (offsets[frame] < 0 || end <= offsets[frame] || end > size) {
+          ok = false; // an index which does not fit the file
+          break;
+        }
+        bytes[j].resize(end - offsets[frame]);
+        XTC_FSEEK(fp, offsets[frame], SEEK_SET);
+        if (fread(&bytes[j][0], 1, bytes[j].size(), fp) != bytes[j].size())
+          ok = false;
+      }
+
+      std::vector<int> status(count, 0);
+#ifdef _OPENMP
+      #pragma omp parallel for schedule(dynamic)
+#endif
+      for (int j = 0; j < count; ++j) {
+        if (!ok)
+          continue;
+        XDR xdrs;
+        xdrmem_create(&xdrs, &bytes[j][0], bytes[j].size(), XDR_DECODE);
+        status[j] = ReadFrame(&xdrs, natoms, &floatCoord[static_cast<size_t>(j) * natoms * 3]);
+        xdr_destroy(&xdrs);
+      }
+
+      for (int j = 0; ok && j < count; ++j) {
+        if (status[j] <= 0) {
+          ok = false;
+          break;
+        }
+        // Convert from single to double precision and from nm to A
+        double *confs = new double[natoms * 3];
+        const float *coords = &floatCoord[static_cast<size_t>(j) * natoms * 3];
+        for (int i = 0; i < natoms * 3; ++i)
+          confs[i] = static_cast<double>(10.0 * coords[i]);
+        vconf.push_back(confs);
+      }
+    }
+    fclose(fp);
+
+    if (!ok) {
+      for (unsigned int i = 0; i < vconf.size(); ++i)
+        delete [] vconf[i];
+      vconf.clear();
+      if (fromIndex) // a stale index
+        return ReadFrames(filename, natoms, first, last, interval, vconf, true);
+      obErrorLog.ThrowError(__FUNCTION__, "Error reading the frames of " + filename, obWarning);
+    }
+    return ok;
+  }
+
   /*____________________________________________________________________________
     |
     | libxdrf - portable fortran interface to xdr. some xdr routines
@@ -613,8 +847,9 @@ namespace OpenBabel
   */
 
   int XTCFormat::xdr3dfcoord(XDR *xdrs, float *fp, int *size, float *precision) {
+    // scratch space, freed on return
+    std::vector<int> ipStore, bufStore;
     int *ip = nullptr;
-    int oldsize = 0;
     int *buf = nullptr;
 
     int minint[3], maxint[3], mindiff, *lip, diff;
@@ -628,21 +863,14 @@ namespace OpenBabel
     int tmp, *thiscoord,  prevcoord[3];
     unsigned int tmpcoord[30];
 
-    int bufsize, xdrid, lsize;
+    int bufsize, lsize;
     unsigned int bitsize;
     float inv_precision;
     int errval = 1;
 
-    /* find out if xdrs is opened for reading or for writing */
-    xdrid = 0;
-    while (xdridptr[xdrid] != xdrs) {
-      xdrid++;
-      if (xdrid >= MAXID) {
-        fprintf(stderr, "xdr error. no open xdr stream\n");
-        return 0;
-      }
-    }
-    if (xdrmodes[xdrid] == 'w') {
+    /* find out if xdrs is opened for reading or for writing; this also
+     * works for memory streams, which are not in xdridptr */
+    if (xdrs->x_op == XDR_ENCODE) {
 
       /* xdrs is open for writing */
 
@@ -658,33 +886,11 @@ namespace OpenBabel
       }
 
       xdr_float(xdrs, precision);
-      if (ip == nullptr) {
-        ip = (int *)calloc(size3, sizeof(*ip));
-        if (ip == NULL) {
-          fprintf(stderr,"malloc failed\n");
-          return 0;
-        }
-        bufsize = static_cast<int> (size3 * 1.2);
-        buf = (int *)calloc(bufsize, sizeof(*buf));
-        if (buf == nullptr) {
-          fprintf(stderr,"malloc failed\n");
-          return 0;
-        }
-        oldsize = *size;
-      } else if (*size > oldsize) {
-        ip = (int *)realloc(ip, size3 * sizeof(*ip));
-        if (ip == nullptr) {
-          fprintf(stderr,"malloc failed\n");
-          return 0;
-        }
-        bufsize = static_cast<int> (size3 * 1.2);
-        buf = (int *)realloc(buf, bufsize * sizeof(*buf));
-        if (buf == nullptr) {
-          fprintf(stderr,"malloc failed\n");
-          return 0;
-        }
-        oldsize = *size;
-      }
+      ipStore.resize(size3);
+      ip = &ipStore[0];
+      bufsize = static_cast<int> (size3 * 1.2);
+      bufStore.resize(bufsize);
+      buf = &bufStore[0];
       /* buf[0-2] are special and do not contain actual data */
       buf[0] = buf[1] = buf[2] = 0;
       minint[0] = minint[1] = minint[2] = INT_MAX;
@@ -902,33 +1108,11 @@ namespace OpenBabel
                            (xdrproc_t)xdr_float));
       }
       xdr_float(xdrs, precision);
-      if (ip == nullptr) {
-        ip = (int *)calloc(size3, sizeof(*ip));
-        if (ip == nullptr) {
-          fprintf(stderr,"malloc failed\n");
-          return 0;
-        }
-        bufsize = static_cast<int> (size3 * 1.2);
-        buf = (int *)calloc(bufsize, sizeof(*buf));
-        if (buf == nullptr) {
-          fprintf(stderr,"malloc failed\n");
-          return 0;
-        }
-        oldsize = *size;
-      } else if (*size > oldsize) {
-        ip = (int *)realloc(ip, size3 * sizeof(*ip));
-        if (ip == nullptr) {
-          fprintf(stderr,"malloc failed\n");
-          return 0;
-        }
-        bufsize = static_cast<int> (size3 * 1.2);
-        buf = (int *)realloc(buf, bufsize * sizeof(*buf));
-        if (buf == nullptr) {
-          fprintf(stderr,"malloc failed\n");
-          return 0;
-        }
-        oldsize = *size;
-      }
+      ipStore.resize(size3);
+      ip = &ipStore[0];
+      bufsize = static_cast<int> (size3 * 1.2);
+      bufStore.resize(bufsize);
+      buf = &bufStore[0];
       buf[0] = buf[1] = buf[2] = 0;
 
       xdr_int(xdrs, &(minint[0]));
@@ -21,7 +21,9 @@ GNU General Public License for more details.
 #include <openbabel/obiter.h>
 
 #include <sstream>
+#include <deque>
 #include <cstdlib>
+#include <cstring>
 
 using namespace std;
 namespace OpenBabel
@@ -82,7 +84,9 @@ namespace OpenBabel
 
         "Read Options e.g. -as\n"
         "  s  Output single bonds only\n"
-        "  b  Disable bonding entirely\n\n";
+        "  b  Disable bonding entirely\n"
+        "  m  Read the following frames as conformers of the first\n"
+        "     (the atoms must be the same and in the same order)\n\n";
     };
 
     virtual const char* SpecificationURL()
@@ -102,6 +106,107 @@ namespace OpenBabel
   //Make an instance of the format class
   XYZFormat theXYZFormat;
 
+  // The stream slot (pword) holding the lines of a frame that was read ahead
+  // with the m option but did not match the molecule, which are read again as
+  // the next molecule. They are kept with the stream rather than in the format
+  // instance, which is shared by every conversion.
+  static const int readAheadIndex = ios_base::xalloc();
+
+  static void readAheadCallback(ios_base::event ev, ios_base &ios, int index)
+  {
+    if (ev == ios_base::erase_event)
+      delete static_cast<deque<string>*>(ios.pword(index));
+    else if (ev == ios_base::copyfmt_event)
+      ios.pword(index) = nullptr; // the lines belong to the source stream
+  }
+
+  //! The lines read ahead from \a ifs
+  static deque<string> &readAhead(istream &ifs)
+  {
+    void *&lines = ifs.pword(readAheadIndex);
+    if (!lines) {
+      lines = new deque<string>;
+      ifs.register_callback(readAheadCallback, readAheadIndex);
+    }
+    return *static_cast<deque<string>*>(lines);
+  }
+
+  //! Read a line from \a pending, or from \a ifs when it is empty
+  static bool readLine(istream &ifs, deque<string> &pending, char *buffer)
+  {
+    if (pending.empty())
+      return static_cast<bool>(ifs.getline(buffer,BUFF_SIZE));
+    strncpy(buffer, pending.front().c_str(), BUFF_SIZE - 1);
+    buffer[BUFF_SIZE - 1] = '\0';
+    pending.pop_front();
+    return true;
+  }
+
+  //! Read the coordinates of the following frames into conformers of \a mol
+  /*! Only the coordinate columns are parsed, so each frame must list the
+    same atoms in the same order as the first. Reading stops at the end of
+    the file or at a frame with a different number of atoms (or one that
+    cannot be parsed), whose lines read so far are kept in \a pending to
+    be read as a separate molecule. (The stream is not rewound, as that
+    fails for standard input and compressed files.)
+  */
+  static void readFrameConformers(istream &ifs, OBMol &mol, deque<string> &pending)
+  {
+    char buffer[BUFF_SIZE];
+    unsigned int natoms = mol.NumAtoms();
+
+    for (;;)
+      {
+        pending.clear();
+        do
+          {
+            if (!ifs.getline(buffer,BUFF_SIZE))
+              return;
+          }
+        while (strlen(buffer) == 0);
+        pending.push_back(buffer);
+
+        unsigned int n;
+        bool ok = sscanf(buffer, "%u", &n) == 1 && n == natoms
+          && ifs.getline(buffer,BUFF_SIZE); // title
+        if (ok)
+          pending.push_back(buffer);
+        double *conformer = new double [natoms*3];
+        for (unsigned int i = 0; ok && i < natoms; ++i)
+          {
+            if (!ifs.getline(buffer,BUFF_SIZE))
+              {
+                ok = false;
+                break;
+              }
+            pending.push_back(buffer);
+            // skip the element column
+            char *p = buffer;
+            while (isspace(*p))
+              ++p;
+            while (*p && !isspace(*p))
+              ++p;
+            for (unsigned int j = 0; j < 3; ++j)
+              {
+                char *endptr;
+                conformer[i*3+j] = strtod(p, &endptr);
+                if (endptr == p)
+                  ok = false;
+                p = endptr;
+              }
+          }
+
+        if (!ok)
+          {
+            delete [] conformer;
+            obErrorLog.ThrowError(__FUNCTION__,
+                                  "Frame could not be read as a conformer; reading it as a separate molecule.", obWarning);
+            return;
+          }
+        mol.AddConformer(conformer);
+      }
+  }
+
   /////////////////////////////////////////////////////////////////
   bool XYZFormat::ReadMolecule(OBBase* pOb, OBConversion* pConv)
   {
@@ -119,10 +224,15 @@ namespace OpenBabel
 
     unsigned int natoms;	// [ejk] assumed natoms could not be -ve
 
-    if (!ifs)
+    // a new conversion starts at the current stream position
+    deque<string> &pending = readAhead(ifs);
+    if (pConv->GetCount() == 0)
+      pending.clear();
+
+    if (pending.empty() && !ifs)
       return false; // we're attempting to read past the end of the file
 
-    if (!ifs.getline(buffer,BUFF_SIZE))
+    if (!readLine(ifs, pending, buffer))
       {
         obErrorLog.ThrowError(__FUNCTION__,
                               "Problems reading an XYZ file: Cannot read the first line.", obWarning);
@@ -141,7 +251,7 @@ namespace OpenBabel
     // The next line contains a title string for the molecule. Use this
     // as the title for the molecule if the line is not
     // empty. Otherwise, use the title given by the calling function.
-    if (!ifs.getline(buffer,BUFF_SIZE))
+    if (!readLine(ifs, pending, buffer))
       {
         obErrorLog.ThrowError(__FUNCTION__,
                               "Problems reading an XYZ file: Could not read the second line (title/comments).", obWarning);
@@ -166,7 +276,7 @@ namespace OpenBabel
     vector<string> vs;
     for (unsigned int i = 1; i <= natoms; i ++)
       {
-        if (!ifs.getline(buffer,BUFF_SIZE))
+        if (!readLine(ifs, pending, buffer))
           {
             errorMsg << "Problems reading an XYZ file: "
                      << "Could not read line #" << i+2 << ", file error." << endl
@@ -263,14 +373,8 @@ namespace OpenBabel
       }
 
     // clean out any remaining blank lines
-    std::streampos ipos;
-    do
-    {
-      ipos = ifs.tellg();
-      ifs.getline(buffer,BUFF_SIZE);
-    }
-    while(strlen(buffer) == 0 && !ifs.eof() );
-    ifs.seekg(ipos);
+    while (pending.empty() && ifs.peek() == '\n')
+      ifs.get();
 
     if (!pConv->IsOption("b",OBConversion::INOPTIONS))
       mol.ConnectTheDots();
@@ -279,6 +383,10 @@ namespace OpenBabel
 
     mol.EndModify();
 
+    // the bonds perceived above are reused for the remaining frames
+    if (pConv->IsOption("m",OBConversion::INOPTIONS))
+      readFrameConformers(ifs, mol, pending);
+
     return(true);
   }
 
@@ -21,6 +21,7 @@ GNU General Public License for more details.
 
 #include <string>
 #include <set>
+#include <unordered_map>
 
 #include <openbabel/mol.h>
 #include <openbabel/atom.h>
@@ -607,6 +608,76 @@ namespace OpenBabel
     return (dr.length_2() < 1e-6);
   }
 
+  // Fractional coordinate bins used by FillUnitCell() to find atoms of the
+  // same element at the same position, allowing for periodic images.
+  class FractionalCellBins
+  {
+    public:
+      explicit FractionalCellBins(double tolerance) : _tolerance(tolerance) {}
+
+      //! Add @p frac for element @p atomicNum, unless there already is an
+      //! entry for that element within the tolerance.
+      //! \return true if the position was added
+      bool Insert(unsigned int atomicNum, const vector3 &frac)
+      {
+        // Neighbouring bins only need to be searched when the position is
+        // within the tolerance of their common face.
+        int bin[3], first[3], last[3];
+        for (int d = 0; d < 3; ++d) {
+          double x = (frac[d] - floor(frac[d])) * Bins;
+          bin[d] = std::min(Bins - 1, static_cast<int>(x));
+          first[d] = (x - bin[d] < _tolerance * Bins) ? -1 : 0;
+          last[d] = (bin[d] + 1 - x < _tolerance * Bins) ? 1 : 0;
+        }
+
+        for (int dx = first[0]; dx <= last[0]; ++dx)
+          for (int dy = first[1]; dy <= last[1]; ++dy)
+            for (int dz = first[2]; dz <= last[2]; ++dz) {
+              unordered_map<int, vector<Entry> >::const_iterator cell =
+                _cells.find(Key(bin[0] + dx, bin[1] + dy, bin[2] + dz));
+              if (cell == _cells.end())
+                continue;
+              for (size_t n = 0; n < cell->second.size(); ++n)
+                if (cell->second[n].atomicNum == atomicNum && Same(cell->second[n].frac, frac))
+                  return false;
+            }
+
+        Entry entry = { atomicNum, frac };
+        _cells[Key(bin[0], bin[1], bin[2])].push_back(entry);
+        return true;
+      }
+
+    private:
+      static const int Bins = 64; //!< bins along each cell axis
+
+      struct Entry
+      {
+        unsigned int atomicNum;
+        vector3 frac;
+      };
+
+      int Key(int x, int y, int z) const
+      {
+        x = (x + Bins) % Bins;
+        y = (y + Bins) % Bins;
+        z = (z + Bins) % Bins;
+        return (x * Bins + y) * Bins + z;
+      }
+
+      bool Same(const vector3 &a, const vector3 &b) const
+      {
+        for (int d = 0; d < 3; ++d) {
+          double diff = a[d] - b[d];
+          if (fabs(diff - round(diff)) >= _tolerance)
+            return false;
+        }
+        return true;
+      }
+
+      double _tolerance;
+      unordered_map<int, vector<Entry> > _cells;
+  };
+
   void OBUnitCell::FillUnitCell(OBMol *mol)
   {
     const SpaceGroup *sg = GetSpaceGroup(); // the actual space group and transformations for this unit cell
@@ -618,19 +689,19 @@ namespace OpenBabel
     vector3 baseV, uniqueV, updatedCoordinate;
     list<vector3> transformedVectors; // list of symmetry-defined copies of the atom
     list<vector3>::iterator transformIter;
-    list<OBAtom*>::iterator deleteIter, atomIter;
+    vector<OBAtom*>::iterator deleteIter, atomIter;
     OBAtom *newAtom;
-    list<OBAtom*> atoms, atomsToDelete;
-    char hash[22];
-    set<string> coordinateSet;
+    vector<OBAtom*> atoms, atomsToDelete;
+    // atoms of the same element closer than 5e-4 in each fractional
+    // coordinate are duplicates
+    FractionalCellBins positions(5.0e-4);
 
     // Check original mol for duplicates
     FOR_ATOMS_OF_MOL(atom, *mol) {
       baseV = atom->GetVector();
       baseV = CartesianToFractional(baseV);
       baseV = WrapFractionalCoordinate(baseV);
-      snprintf(hash, 22, "%03d,%.3f,%.3f,%.3f", atom->GetAtomicNum(), baseV.x(), baseV.y(), baseV.z());
-      if (coordinateSet.insert(hash).second) { // True if new entry
+      if (positions.Insert(atom->GetAtomicNum(), baseV)) { // True if new entry
         atoms.push_back(&(*atom));
       } else {
         atomsToDelete.push_back(&(*atom));
@@ -652,9 +723,7 @@ namespace OpenBabel
         updatedCoordinate = WrapFractionalCoordinate(*transformIter);
 
         // Check if the transformed coordinate is a duplicate of an atom
-        snprintf(hash, 22, "%03d,%.3f,%.3f,%.3f", (*atomIter)->GetAtomicNum(), updatedCoordinate.x(),
-                 updatedCoordinate.y(), updatedCoordinate.z());
-        if (coordinateSet.insert(hash).second) {
+        if (positions.Insert((*atomIter)->GetAtomicNum(), updatedCoordinate)) {
           newAtom = mol->NewAtom();
           newAtom->Duplicate(*atomIter);
           newAtom->SetVector(FractionalToCartesian(updatedCoordinate));
@@ -578,49 +578,94 @@ namespace OpenBabel {
       atom_sym_classes[symmetry_classes.at(i).first->GetIndex()] = symmetry_classes.at(i).second;
     }
 
-    // Store the symmetry classes in an OBPairData
-    stringstream temp;
-    vector<unsigned int>::iterator sym_iter = atom_sym_classes.begin();
-    if (sym_iter != atom_sym_classes.end())
-      temp << (*sym_iter++);
-    for (; sym_iter != atom_sym_classes.end(); ++sym_iter)
-      temp << " " << (*sym_iter);
-
-    OBPairData *symData = new OBPairData;
-    symData->SetAttribute("OpenBabel Symmetry Classes");
-    symData->SetOrigin(local); //will not show as sdf or cml property
-    symData->SetValue(temp.str());
-    _pmol->SetData(symData);
-
     return nclasses;
   }
 
   int OBGraphSym::GetSymmetry(std::vector<unsigned int> &symmetry_classes)
   {
-    ClearSymmetry(); // For the moment just recalculate the symmetry classes
-
     // Check to see whether we have already calculated the symmetry classes
-    OBPairData *pd = dynamic_cast<OBPairData*>(d->_pmol->GetData("OpenBabel Symmetry Classes"));
+    OBGraphSymData *gsd = dynamic_cast<OBGraphSymData*>(d->_pmol->GetData("OpenBabel Symmetry Classes"));
+    if (!gsd) {
+      gsd = new OBGraphSymData;
+      d->_pmol->SetData(gsd);
+    }
 
-    int nclasses = 0;
-    if (!pd) {
+    int nclasses = gsd->GetSymmetry(d->_pmol, d->_frag_atoms, symmetry_classes);
+    if (nclasses < 0) {
       nclasses = d->CalculateSymmetry(symmetry_classes);
-    } else {
-      istringstream iss(pd->GetValue());
-      symmetry_classes.clear();
-      copy(istream_iterator<unsigned int>(iss),
-           istream_iterator<unsigned int>(),
-           back_inserter<vector<unsigned int> >(symmetry_classes));
-      // Now find the number of unique elements
-      vector<unsigned int> copy_sym = symmetry_classes;
-      sort(copy_sym.begin(), copy_sym.end());
-      vector<unsigned int>::iterator end_pos = unique(copy_sym.begin(), copy_sym.end()); // Requires sorted elements
-      nclasses = end_pos - copy_sym.begin();
+      gsd->SetSymmetry(d->_pmol, d->_frag_atoms, symmetry_classes, nclasses);
     }
 
     return nclasses;
   }
 
+  OBGraphSymData::OBGraphSymData() :
+    OBGenericData("OpenBabel Symmetry Classes", OBGenericDataType::PerceptionData, local)
+  {
+  }
+
+  bool OBGraphSymData::Validate(OBMol *mol)
+  {
+    // Everything used by the graph invariants: elements, charges, implicit
+    // hydrogens, aromaticity, and the connectivity with bond orders
+    std::vector<unsigned int> key;
+    key.reserve(1 + mol->NumAtoms() + 2 * mol->NumBonds());
+    key.push_back(mol->NumAtoms());
+    FOR_ATOMS_OF_MOL (atom, mol)
+      key.push_back(atom->GetAtomicNum()
+          | ((atom->IsAromatic() ? 1 : 0) << 8)
+          | ((128 + atom->GetFormalCharge()) << 9)
+          | (atom->GetImplicitHCount() << 17));
+    FOR_BONDS_OF_MOL (bond, mol) {
+      key.push_back(bond->GetBeginAtomIdx() | (bond->GetBondOrder() << 24));
+      key.push_back(bond->GetEndAtomIdx() | ((bond->IsAromatic() ? 1u : 0u) << 31));
+    }
+
+    if (key == _key)
+      return true;
+
+    _key.swap(key);
+    _entries.clear();
+    return false;
+  }
+
+  static std::size_t FragmentHash(const OBBitVec &frag_atoms)
+  {
+    std::size_t hash = 0;
+    for (int i = frag_atoms.FirstBit(); i != frag_atoms.EndBit(); i = frag_atoms.NextBit(i))
+      hash = hash * 1000003 + i;
+    return hash;
+  }
+
+  int OBGraphSymData::GetSymmetry(OBMol *mol, const OBBitVec &frag_atoms,
+      std::vector<unsigned int> &symmetry_classes)
+  {
+    if (!Validate(mol))
+      return -1;
+
+    std::unordered_map<std::size_t, Entry>::const_iterator entry = _entries.find(FragmentHash(frag_atoms));
+    if (entry == _entries.end() || !(entry->second.fragment == frag_atoms))
+      return -1;
+
+    symmetry_classes = entry->second.symmetry_classes;
+    return entry->second.nclasses;
+  }
+
+  void OBGraphSymData::SetSymmetry(OBMol *mol, const OBBitVec &frag_atoms,
+      const std::vector<unsigned int> &symmetry_classes, int nclasses)
+  {
+    Validate(mol);
+
+    std::size_t hash = FragmentHash(frag_atoms);
+    if (_entries.size() >= MaxEntries && !_entries.count(hash))
+      _entries.erase(_entries.begin());
+
+    Entry &entry = _entries[hash];
+    entry.fragment = frag_atoms;
+    entry.symmetry_classes = symmetry_classes;
+    entry.nclasses = nclasses;
+  }
+
   int OBGraphSymPrivate::Iterate(vector<unsigned int> &symClasses)
   {
     // Create a vector-of-pairs, associating each atom with its Class ID.
@@ -34,11 +34,68 @@ using namespace std;
 
 namespace OpenBabel {
 
+  // OBFloatGrid keeps its values as doubles; this gives GridDataPrivate
+  // access to the storage so that float precision grids can share the
+  // geometry without also allocating a double array.
+  class GridDataFloatGrid : public OBFloatGrid {
+  public:
+    using OBFloatGrid::Interpolate;
+
+    void SetDimensions(int nx, int ny, int nz)
+    {
+      _xdim = nx;
+      _ydim = ny;
+      _zdim = nz;
+    }
+
+    std::vector<double> &Values() { return _values; }
+
+    int Index(int i, int j, int k) const
+    {
+      return i*_ydim*_zdim + j*_zdim + k;
+    }
+
+    int Size() const { return _xdim*_ydim*_zdim; }
+
+    //! Trilinear interpolation in float storage, as OBFloatGrid::Interpolate()
+    double Interpolate(const std::vector<float> &values, double x, double y, double z) const
+    {
+      if (values.empty())
+        return 0.0;
+
+      if( x<=_xmin || x>=_xmax
+          || y<=_ymin || y>=_ymax
+          || z<=_zmin || z>=_zmax ) return 0.0;
+
+      int yzdim = _ydim*_zdim;
+
+      double gx = std::max(0.0, (x-_xmin-_halfSpace)*_inv_spa);
+      double gy = std::max(0.0, (y-_ymin-_halfSpace)*_inv_spa);
+      double gz = std::max(0.0, (z-_zmin-_halfSpace)*_inv_spa);
+      int igx = static_cast<int>(gx);
+      int igy = static_cast<int>(gy);
+      int igz = static_cast<int>(gz);
+      double bx = gx - igx, by = gy - igy, bz = gz - igz;
+      double ax = 1.0 - bx, ay = 1.0 - by, az = 1.0 - bz;
+
+      int n = igx*yzdim + igy*_zdim + igz;
+      if ((n+1+_zdim+yzdim) >= (yzdim*_xdim))
+        return 0.0;
+
+      double AyA = az*values[n] + bz*values[n+1];
+      double ByA = az*values[n+_zdim] + bz*values[n+1+_zdim];
+      double AyB = az*values[n+yzdim] + bz*values[n+1+yzdim];
+      double ByB = az*values[n+_zdim+yzdim] + bz*values[n+1+_zdim+yzdim];
+
+      return ax*(ay*AyA + by*ByA) + bx*(ay*AyB + by*ByB);
+    }
+  };
+
   class GridDataPrivate {
   public:
-    GridDataPrivate() {    }
+    GridDataPrivate() : _floatPrecision(false) {    }
 
-    OBFloatGrid  floatGrid;
+    GridDataFloatGrid  floatGrid;
     OBGridData::Unit _unit;
 
     double           _max;
@@ -46,6 +103,10 @@ namespace OpenBabel {
 
     bool             _unrestricted;
     int              _symmetries;
+
+    //! values are kept in _floatValues instead of floatGrid
+    bool               _floatPrecision;
+    std::vector<float> _floatValues;
   };
 
   /** \class OBGridData griddata.h <openbabel/griddata.h>
@@ -161,16 +222,26 @@ namespace OpenBabel {
 
   std::vector< double > OBGridData::GetValues() const
   {
+    if (d->_floatPrecision)
+      return std::vector<double>(d->_floatValues.begin(), d->_floatValues.end());
     return d->floatGrid.GetDataVector();
   }
 
   double OBGridData::GetValue( int i, int j, int k ) const
   {
+    if (d->_floatPrecision) {
+      int index = d->floatGrid.Index(i, j, k);
+      if (index < 0 || index >= static_cast<int>(d->_floatValues.size()))
+        return 0.0;
+      return d->_floatValues[index];
+    }
     return d->floatGrid.GetValue(i, j, k);
   }
 
   double OBGridData::GetValue(vector3 pos) const
   {
+    if (d->_floatPrecision)
+      return d->floatGrid.Interpolate(d->_floatValues, pos.x(), pos.y(), pos.z());
     return d->floatGrid.Interpolate(pos.x(), pos.y(), pos.z());
   }
 
@@ -224,9 +295,35 @@ namespace OpenBabel {
     d->_symmetries = s;
   }
 
+  bool OBGridData::GetFloatPrecision() const
+  {
+    return d->_floatPrecision;
+  }
+
   void OBGridData::SetNumberOfPoints( int nx, int ny, int nz )
   {
-    d->floatGrid.SetNumberOfPoints(nx, ny, nz);
+    if (d->_floatPrecision) {
+      d->floatGrid.SetDimensions(nx, ny, nz);
+      d->_floatValues.resize(d->floatGrid.Size());
+    } else {
+      d->floatGrid.SetNumberOfPoints(nx, ny, nz);
+    }
+  }
+
+  void OBGridData::SetFloatPrecision(bool f)
+  {
+    if (f == d->_floatPrecision)
+      return;
+
+    std::vector<double> &values = d->floatGrid.Values();
+    if (f) {
+      d->_floatValues.assign(values.begin(), values.end());
+      std::vector<double>().swap(values);
+    } else {
+      values.assign(d->_floatValues.begin(), d->_floatValues.end());
+      std::vector<float>().swap(d->_floatValues);
+    }
+    d->_floatPrecision = f;
   }
 
   void OBGridData::SetLimits(const double origin [3], const double x[3],
@@ -243,12 +340,32 @@ namespace OpenBabel {
 
   bool OBGridData::SetValue(int i, int j, int k, double val)
   {
+    if (d->_floatPrecision) {
+      int index = d->floatGrid.Index(i, j, k);
+      if (index < 0 || index >= static_cast<int>(d->_floatValues.size()))
+        return false;
+      d->_floatValues[index] = static_cast<float>(val);
+      return true;
+    }
     return d->floatGrid.SetValue(i, j, k, val);
   }
 
   void OBGridData::SetValues( const std::vector< double >& v )
   {
-    d->floatGrid.SetVals(v);
+    if (d->_floatPrecision)
+      d->_floatValues.assign(v.begin(), v.end());
+    else
+      d->floatGrid.SetVals(v);
+    d->_min = *std::min_element( v.begin(), v.end() );
+    d->_max = *std::max_element( v.begin(), v.end() );
+  }
+
+  void OBGridData::SetValues( const std::vector< float >& v )
+  {
+    if (d->_floatPrecision)
+      d->_floatValues = v;
+    else
+      d->floatGrid.SetVals(std::vector<double>(v.begin(), v.end()));
     d->_min = *std::min_element( v.begin(), v.end() );
     d->_max = *std::max_element( v.begin(), v.end() );
   }
@@ -60,6 +60,57 @@ namespace OpenBabel {
   };
 
 
+  class MapFirstFunctor : public OBIsomorphismMapper::Functor
+  {
+    private:
+      OBIsomorphismMapper::Mapping &m_map;
+    public:
+      MapFirstFunctor(OBIsomorphismMapper::Mapping &map) : m_map(map)
+      {
+      }
+      bool operator()(OBIsomorphismMapper::Mapping &map)
+      {
+        m_map = map;
+        // stop mapping
+        return true;
+      }
+  };
+
+  class MapUniqueFunctor : public OBIsomorphismMapper::Functor
+  {
+    private:
+      OBIsomorphismMapper::Mappings &m_maps;
+    public:
+      MapUniqueFunctor(OBIsomorphismMapper::Mappings &maps) : m_maps(maps)
+      {
+      }
+      bool operator()(OBIsomorphismMapper::Mapping &map)
+      {
+        // get the values from the map
+        std::vector<unsigned int> values;
+        for (OBIsomorphismMapper::Mapping::const_iterator it = map.begin(); it != map.end(); ++it)
+          values.push_back(it->second);
+        std::sort(values.begin(), values.end());
+
+        bool isUnique = true;
+        for (unsigned int k = 0; k < m_maps.size(); ++k) {
+          std::vector<unsigned int> kValues;
+          for (OBIsomorphismMapper::Mapping::iterator it = m_maps[k].begin(); it != m_maps[k].end(); ++it)
+            kValues.push_back(it->second);
+          std::sort(kValues.begin(), kValues.end());
+
+          if (values == kValues)
+            isUnique = false;
+        }
+
+        if (isUnique)
+          m_maps.push_back(map);
+
+        // continue mapping
+        return false;
+      }
+  };
+
   class VF2Mapper : public OBIsomorphismMapper
   {
     time_t m_startTime;
@@ -365,22 +416,6 @@ namespace OpenBabel {
        */
       void MapFirst(const OBMol *queried, Mapping &map, const OBBitVec &mask)
       {
-        class MapFirstFunctor : public Functor
-        {
-          private:
-            Mapping &m_map;
-          public:
-            MapFirstFunctor(Mapping &map) : m_map(map)
-            {
-            }
-            bool operator()(Mapping &map)
-            {
-              m_map = map;
-              // stop mapping
-              return true;
-            }
-        };
-
         MapFirstFunctor functor(map);
         MapGeneric(functor, queried, mask);
       }
@@ -392,44 +427,6 @@ namespace OpenBabel {
        */
       void MapUnique(const OBMol *queried, Mappings &maps, const OBBitVec &mask)
       {
-        class MapUniqueFunctor : public OBIsomorphismMapper::Functor
-        {
-          private:
-            OBIsomorphismMapper::Mappings &m_maps;
-          public:
-            MapUniqueFunctor(OBIsomorphismMapper::Mappings &maps) : m_maps(maps)
-            {
-            }
-            bool operator()(OBIsomorphismMapper::Mapping &map)
-            {
-              // get the values from the map
-              std::vector<unsigned int> values;
-              for (OBIsomorphismMapper::Mapping::const_iterator it = map.begin(); it != map.end(); ++it)
-                values.push_back(it->second);
-              std::sort(values.begin(), values.end());
-               // print_vector("values ", values);
-
-              bool isUnique = true;
-              for (unsigned int k = 0; k < m_maps.size(); ++k) {
-                std::vector<unsigned int> kValues;
-                for (OBIsomorphismMapper::Mapping::iterator it = m_maps[k].begin(); it != m_maps[k].end(); ++it)
-                  kValues.push_back(it->second);
-                std::sort(kValues.begin(), kValues.end());
-
-              //  print_vector("kValues", kValues);
-                if (values == kValues)
-                  isUnique = false;
-              }
-
-              if (isUnique)
-                m_maps.push_back(map);
-
-              // continue mapping
-              return false;
-            }
-        };
-
-
         maps.clear();
         MapUniqueFunctor functor(maps);
         MapGeneric(functor, queried, mask);
@@ -505,6 +502,334 @@ namespace OpenBabel {
 
   };
 
+  /**
+   * VF2++ style mapper. The query atoms are matched in a fixed order that is
+   * computed once: a breadth-first ordering starting from the query atom with
+   * the fewest candidates, where each level prefers the atoms with the most
+   * connections to already ordered atoms. For each query atom, the candidate
+   * queried atoms (domain) are precomputed as bitsets. Candidates for an atom
+   * with an already mapped neighbor are restricted to the neighbors of its
+   * image, and a look-ahead rule rejects queried atoms that do not have enough
+   * unmapped neighbors left.
+   *
+   * The same mappings as the VF2Mapper are found, but each mapping is reported
+   * with the pairs sorted by query atom index.
+   */
+  class VF2PPMapper : public OBIsomorphismMapper
+  {
+    typedef std::vector<unsigned int> Bits;
+
+    static inline bool bitIsSet(const Bits &bits, unsigned int i)
+    {
+      return bits[i / 32] & (1u << (i % 32));
+    }
+
+    static inline unsigned int countBits(unsigned int word)
+    {
+      unsigned int count = 0;
+      for (; word; ++count)
+        word &= word - 1;
+      return count;
+    }
+
+    public:
+      VF2PPMapper(OBQuery *query) : OBIsomorphismMapper(query)
+      {
+      }
+
+      struct State {
+        State(Functor &_functor, const OBMol *_queried) : functor(_functor),
+            queried(_queried), abort(false), numStates(0)
+        {
+        }
+        Functor &functor;
+        const OBMol *queried;
+        bool abort;
+        time_t startTime;
+        unsigned long numStates;
+
+        std::size_t numWords; // the number of words in a queried atom bitset
+        std::vector<Bits> domains; // candidate queried atoms for each query atom
+        std::vector<Bits> adjacency; // neighbors of each queried atom (in mask)
+
+        std::vector<unsigned int> order; // the query atoms in matching order
+        std::vector<int> parents; // the first ordered neighbor for each position (or -1)
+        std::vector<std::vector<OBQueryBond*> > backBonds; // bonds to earlier ordered atoms
+        std::vector<unsigned int> numForward; // number of later ordered neighbors
+
+        std::vector<OBAtom*> mapping; // query atom index -> queried atom
+        Bits used; // the mapped queried atoms
+      };
+
+      /**
+       * Compute the matching order and the per position information used
+       * while matching.
+       */
+      void ComputeOrder(State &state)
+      {
+        const std::vector<OBQueryAtom*> &atoms = m_query->GetAtoms();
+        std::size_t numAtoms = atoms.size();
+
+        std::vector<unsigned int> domainSizes(numAtoms, 0);
+        for (std::size_t i = 0; i < numAtoms; ++i)
+          for (std::size_t w = 0; w < state.numWords; ++w)
+            domainSizes[i] += countBits(state.domains[i][w]);
+
+        std::vector<int> positions(numAtoms, -1);
+        std::vector<unsigned int> numOrderedNbrs(numAtoms, 0);
+        std::vector<bool> visited(numAtoms, false);
+
+        while (state.order.size() < numAtoms) {
+          // Start a new connected component from the atom with the fewest
+          // candidates (rarest label), ties broken by highest degree.
+          int root = -1;
+          for (std::size_t i = 0; i < numAtoms; ++i) {
+            if (visited[i])
+              continue;
+            if (root < 0 || domainSizes[i] < domainSizes[root] ||
+                (domainSizes[i] == domainSizes[root] && atoms[i]->GetNbrs().size() > atoms[root]->GetNbrs().size()))
+              root = i;
+          }
+
+          std::vector<unsigned int> level(1, root);
+          visited[root] = true;
+          while (!level.empty()) {
+            // Order the atoms in this level: most connections to the ordered
+            // atoms first, then highest degree, then fewest candidates.
+            for (std::size_t n = 0; n < level.size(); ++n) {
+              std::size_t best = n;
+              for (std::size_t m = n + 1; m < level.size(); ++m) {
+                unsigned int a = level[m], b = level[best];
+                if (numOrderedNbrs[a] != numOrderedNbrs[b]) {
+                  if (numOrderedNbrs[a] > numOrderedNbrs[b])
+                    best = m;
+                } else if (atoms[a]->GetNbrs().size() != atoms[b]->GetNbrs().size()) {
+                  if (atoms[a]->GetNbrs().size() > atoms[b]->GetNbrs().size())
+                    best = m;
+                } else if (domainSizes[a] < domainSizes[b])
+                  best = m;
+              }
+              std::swap(level[n], level[best]);
+
+              unsigned int index = level[n];
+              positions[index] = state.order.size();
+              state.order.push_back(index);
+              std::vector<OBQueryAtom*> nbrs = atoms[index]->GetNbrs();
+              for (std::size_t j = 0; j < nbrs.size(); ++j)
+                numOrderedNbrs[nbrs[j]->GetIndex()]++;
+            }
+
+            // The next level contains the unvisited neighbors.
+            std::vector<unsigned int> next;
+            for (std::size_t n = 0; n < level.size(); ++n) {
+              std::vector<OBQueryAtom*> nbrs = atoms[level[n]]->GetNbrs();
+              for (std::size_t j = 0; j < nbrs.size(); ++j) {
+                unsigned int index = nbrs[j]->GetIndex();
+                if (visited[index])
+                  continue;
+                visited[index] = true;
+                next.push_back(index);
+              }
+            }
+            level.swap(next);
+          }
+        }
+
+        state.parents.resize(numAtoms, -1);
+        state.backBonds.resize(numAtoms);
+        state.numForward.resize(numAtoms, 0);
+        for (std::size_t k = 0; k < numAtoms; ++k) {
+          OBQueryAtom *atom = atoms[state.order[k]];
+          const std::vector<OBQueryBond*> &bonds = atom->GetBonds();
+          int parentPosition = numAtoms;
+          for (std::size_t j = 0; j < bonds.size(); ++j) {
+            OBQueryAtom *nbr = bonds[j]->GetBeginAtom() == atom ? bonds[j]->GetEndAtom() : bonds[j]->GetBeginAtom();
+            int position = positions[nbr->GetIndex()];
+            if (position < static_cast<int>(k)) {
+              state.backBonds[k].push_back(bonds[j]);
+              if (position < parentPosition) {
+                parentPosition = position;
+                state.parents[k] = nbr->GetIndex();
+              }
+            } else if (position > static_cast<int>(k))
+              state.numForward[k]++;
+          }
+        }
+      }
+
+      /**
+       * Check if the query atom at position @p k can be mapped to @p queriedAtom.
+       */
+      bool IsFeasible(State &state, std::size_t k, OBAtom *queriedAtom)
+      {
+        unsigned int index = queriedAtom->GetIndex();
+
+        // Look-ahead: the query atom's unmapped neighbors need distinct unmapped
+        // neighbors of the queried atom.
+        if (state.numForward[k]) {
+          unsigned int numFree = 0;
+          const Bits &nbrs = state.adjacency[index];
+          for (std::size_t w = 0; w < state.numWords && numFree < state.numForward[k]; ++w)
+            numFree += countBits(nbrs[w] & ~state.used[w]);
+          if (numFree < state.numForward[k])
+            return false;
+        }
+
+        // Check the bonds to the already mapped atoms.
+        const std::vector<OBQueryBond*> &bonds = state.backBonds[k];
+        OBQueryAtom *queryAtom = m_query->GetAtoms()[state.order[k]];
+        for (std::size_t j = 0; j < bonds.size(); ++j) {
+          OBQueryAtom *nbr = bonds[j]->GetBeginAtom() == queryAtom ? bonds[j]->GetEndAtom() : bonds[j]->GetBeginAtom();
+          OBAtom *mappedNbr = state.mapping[nbr->GetIndex()];
+          if (!bitIsSet(state.adjacency[index], mappedNbr->GetIndex()))
+            return false;
+          OBBond *bond = state.queried->GetBond(queriedAtom, mappedNbr);
+          if (!bond || !bonds[j]->Matches(bond))
+            return false;
+        }
+
+        return true;
+      }
+
+      /**
+       * The depth-first isomorphism algorithm. Map the query atom at position
+       * @p k in the matching order.
+       */
+      void MapNext(State &state, std::size_t k)
+      {
+        if (state.abort)
+          return;
+
+        if (k == state.order.size()) {
+          Mapping map;
+          map.reserve(state.mapping.size());
+          for (std::size_t i = 0; i < state.mapping.size(); ++i)
+            map.push_back(std::make_pair(static_cast<unsigned int>(i), state.mapping[i]->GetIndex()));
+          state.abort = state.functor(map);
+          return;
+        }
+
+        // Checking the time for each state is too expensive.
+        if ((++state.numStates & 0xff) == 0 && time(nullptr) - state.startTime > m_timeout) {
+          state.abort = true;
+          return;
+        }
+
+        unsigned int queryIndex = state.order[k];
+        Bits candidates(state.domains[queryIndex]);
+        if (state.parents[k] >= 0) {
+          const Bits &nbrs = state.adjacency[state.mapping[state.parents[k]]->GetIndex()];
+          for (std::size_t w = 0; w < state.numWords; ++w)
+            candidates[w] &= nbrs[w];
+        }
+        for (std::size_t w = 0; w < state.numWords; ++w)
+          candidates[w] &= ~state.used[w];
+
+        for (std::size_t w = 0; w < state.numWords; ++w) {
+          unsigned int word = candidates[w];
+          while (word) {
+            unsigned int bit = 0;
+            while (!(word & (1u << bit)))
+              ++bit;
+            word &= ~(1u << bit);
+
+            OBAtom *queriedAtom = state.queried->GetAtom(w * 32 + bit + 1);
+            if (!IsFeasible(state, k, queriedAtom))
+              continue;
+
+            state.mapping[queryIndex] = queriedAtom;
+            state.used[w] |= 1u << bit;
+            MapNext(state, k + 1);
+            state.used[w] &= ~(1u << bit);
+            state.mapping[queryIndex] = nullptr;
+
+            if (state.abort)
+              return;
+          }
+        }
+      }
+
+      void MapFirst(const OBMol *queried, Mapping &map, const OBBitVec &mask)
+      {
+        MapFirstFunctor functor(map);
+        MapGeneric(functor, queried, mask);
+      }
+
+      void MapUnique(const OBMol *queried, Mappings &maps, const OBBitVec &mask)
+      {
+        maps.clear();
+        MapUniqueFunctor functor(maps);
+        MapGeneric(functor, queried, mask);
+      }
+
+      void MapAll(const OBMol *queried, Mappings &maps, const OBBitVec &mask, std::size_t maxMemory)
+      {
+        maps.clear();
+        MapAllFunctor functor(maps, maxMemory);
+        MapGeneric(functor, queried, mask);
+      }
+
+      void MapGeneric(Functor &functor, const OBMol *queried, const OBBitVec &mask)
+      {
+        const std::vector<OBQueryAtom*> &atoms = m_query->GetAtoms();
+        if (atoms.empty())
+          return;
+
+        State state(functor, queried);
+        state.startTime = time(nullptr);
+        std::size_t numQueried = queried->NumAtoms();
+        state.numWords = numQueried / 32 + 1;
+
+        // set all atoms to 1 if the mask is empty
+        bool useMask = mask.CountBits();
+
+        // the queried adjacency bitsets and degrees
+        state.adjacency.resize(numQueried, Bits(state.numWords, 0));
+        std::vector<unsigned int> degrees(numQueried, 0);
+        for (std::size_t i = 0; i < numQueried; ++i) {
+          if (useMask && !mask.BitIsSet(i + 1))
+            continue;
+          FOR_NBORS_OF_ATOM (nbr, queried->GetAtom(i + 1)) {
+            unsigned int index = nbr->GetIndex();
+            if (useMask && !mask.BitIsSet(index + 1))
+              continue;
+            state.adjacency[i][index / 32] |= 1u << (index % 32);
+            degrees[i]++;
+          }
+        }
+
+        // the candidate domains
+        state.domains.resize(atoms.size(), Bits(state.numWords, 0));
+        for (std::size_t i = 0; i < atoms.size(); ++i) {
+          std::size_t degree = atoms[i]->GetNbrs().size();
+          bool isEmpty = true;
+          for (std::size_t j = 0; j < numQueried; ++j) {
+            if (useMask && !mask.BitIsSet(j + 1))
+              continue;
+            if (degrees[j] < degree)
+              continue;
+            if (!atoms[i]->Matches(queried->GetAtom(j + 1)))
+              continue;
+            state.domains[i][j / 32] |= 1u << (j % 32);
+            isEmpty = false;
+          }
+          // no mapping possible
+          if (isEmpty)
+            return;
+        }
+
+        ComputeOrder(state);
+        state.mapping.resize(atoms.size(), nullptr);
+        state.used.resize(state.numWords, 0);
+
+        MapNext(state, 0);
+
+        if (time(nullptr) - state.startTime > m_timeout)
+          obErrorLog.ThrowError(__FUNCTION__, "time limit exceeded...", obError);
+      }
+
+  };
+
   OBIsomorphismMapper::OBIsomorphismMapper(OBQuery *query) : m_query(query), m_timeout(60)
   {
   }
@@ -517,6 +842,8 @@ namespace OpenBabel {
   {
     if (algorithm == "VF2")
       return new VF2Mapper(query);
+    if (algorithm == "VF2++")
+      return new VF2PPMapper(query);
     // return VF2 mapper as default
     return new VF2Mapper(query);
   }
@@ -656,7 +983,7 @@ namespace OpenBabel {
 
     for (std::size_t i = 0; i < fragments.size(); ++i) {
       OBQuery *query = CompileAutomorphismQuery(mol, fragments[i], symClasses);
-      OBIsomorphismMapper *mapper = OBIsomorphismMapper::GetInstance(query);
+      OBIsomorphismMapper *mapper = OBIsomorphismMapper::GetInstance(query, "VF2++");
 
       AutomorphismFunctor autFunctor(functor, fragments[i], mol->NumAtoms());
       mapper->MapGeneric(autFunctor, mol, fragments[i]);
@@ -20,6 +20,8 @@ GNU General Public License for more details.
 #include <cstring>
 #include <openbabel/locale.h>
 
+#include <mutex>
+
 #if HAVE_XLOCALE_H
 #include <xlocale.h>
 #endif
@@ -29,21 +31,40 @@ GNU General Public License for more details.
 
 namespace OpenBabel
 {
-  class OBLocalePrivate {
-  public:
-    char *old_locale_string;
 #if HAVE_USELOCALE
+  // With uselocale() the locale is set for the calling thread only, so the
+  // reference count and the locale to restore are kept for each thread
+  class OBLocaleThreadState {
+  public:
     locale_t new_c_num_locale;
     locale_t old_locale;
+    unsigned int counter;
+
+    OBLocaleThreadState(): new_c_num_locale(nullptr), old_locale(nullptr), counter(0)
+    {    }
+
+    ~OBLocaleThreadState()
+    {
+      if (new_c_num_locale)
+        freelocale(new_c_num_locale);
+    }
+  };
+
+  static OBLocaleThreadState &ThreadState()
+  {
+    static thread_local OBLocaleThreadState state;
+    return state;
+  }
 #endif
+
+  class OBLocalePrivate {
+  public:
+    char *old_locale_string;
     unsigned int counter; // Reference counter -- ensures balance in SetLocale/RestoreLocale calls
+    std::mutex mutex; // setlocale() changes the locale of the whole process
 
     OBLocalePrivate(): counter(0)
-    {
-#if HAVE_USELOCALE
-      new_c_num_locale = newlocale(LC_NUMERIC_MASK, NULL, NULL);
-#endif
-    }
+    {    }
 
     ~OBLocalePrivate()
     {    }
@@ -63,7 +84,8 @@ namespace OpenBabel
    * In particular, where available, OBLocale will use the enhanced uselocale()
    * interface, which sets the locale for a particular thread, rather
    * for the entire process. (This is available on Linux, Mac OS X,
-   * and other platforms.)
+   * and other platforms.) Otherwise the calls are serialized, and the
+   * numeric locale of the process stays "C" while any thread has it set.
    *
    * \code
    * obLocale.SetLocale(); // set the numeric locale before reading data
@@ -91,12 +113,21 @@ namespace OpenBabel
 
   void OBLocale::SetLocale()
   {
-    if (d->counter == 0) {
-      // Set the locale for number parsing to avoid locale issues: PR#1785463
 #if HAVE_USELOCALE
-      // Extended per-thread interface
-      d->old_locale = uselocale(d->new_c_num_locale);
+    // Extended per-thread interface
+    OBLocaleThreadState &state = ThreadState();
+    if (state.counter == 0) {
+      // Set the locale for number parsing to avoid locale issues: PR#1785463
+      if (!state.new_c_num_locale)
+        state.new_c_num_locale = newlocale(LC_NUMERIC_MASK, "C", duplocale(LC_GLOBAL_LOCALE));
+      if (state.new_c_num_locale)
+        state.old_locale = uselocale(state.new_c_num_locale);
+    }
+    ++state.counter;
 #else
+    std::lock_guard<std::mutex> lock(d->mutex);
+    if (d->counter == 0) {
+      // Set the locale for number parsing to avoid locale issues: PR#1785463
 #ifndef ANDROID
       // Original global POSIX interface
       // regular UNIX, no USELOCALE, no ANDROID
@@ -106,27 +137,33 @@ namespace OpenBabel
       d->old_locale_string = "C";
 #endif
   	  setlocale(LC_NUMERIC, "C");
-#endif
     }
 
     ++d->counter;
+#endif
   }
 
   void OBLocale::RestoreLocale()
   {
+#if HAVE_USELOCALE
+    OBLocaleThreadState &state = ThreadState();
+    --state.counter;
+    if (state.counter == 0 && state.new_c_num_locale) {
+      // return the locale to the original one
+      uselocale(state.old_locale);
+    }
+#else
+    std::lock_guard<std::mutex> lock(d->mutex);
     --d->counter;
     if(d->counter == 0) {
       // return the locale to the original one
-#ifdef HAVE_USELOCALE
-      uselocale(d->old_locale);
-#else
       setlocale(LC_NUMERIC, d->old_locale_string);
 #ifndef ANDROID
       // Don't free on Android because "C" is a static ctring constant
       free (d->old_locale_string);
-#endif
 #endif
     }
+#endif
   }
 
   //global definitions
@@ -28,6 +28,7 @@ GNU General Public License for more details.
 #include <openbabel/graphsym.h>
 #include <openbabel/math/vector3.h>
 #include <openbabel/elements.h>
+#include <openbabel/query.h>
 
 #include <Eigen/Core>
 #include <Eigen/Geometry>
@@ -451,6 +452,236 @@ namespace OpenBabel
     return _rmsd;
   }
 
+  OBRMSDMatrix::OBRMSDMatrix(bool includeH, bool symmetry, bool minimize)
+    : _includeH(includeH), _symmetry(symmetry), _minimize(minimize)
+  {
+  }
+
+  void OBRMSDMatrix::SetRefMol(const OBMol &refmol)
+  {
+    _refmol = refmol;
+    _coords.clear();
+    _norms.clear();
+    _sqnorms.clear();
+    _valid.clear();
+
+    _frag_atoms.Clear();
+    _frag_atoms.Resize(refmol.NumAtoms() + 1);
+    _fragIndexes.clear();
+    std::vector<unsigned int> local(refmol.NumAtoms(), UINT_MAX);
+    FOR_ATOMS_OF_MOL (atom, _refmol) {
+      if (_includeH || atom->GetAtomicNum() != OBElements::Hydrogen) {
+        _frag_atoms.SetBitOn(atom->GetIdx());
+        local[atom->GetIndex()] = _fragIndexes.size();
+        _fragIndexes.push_back(atom->GetIndex());
+      }
+    }
+
+    // Convert the automorphisms to permutations of the coordinates. The
+    // identity is always the first permutation.
+    std::vector<unsigned int> identity(_fragIndexes.size());
+    for (unsigned int k = 0; k < identity.size(); ++k)
+      identity[k] = k;
+    _perms.assign(1, identity);
+    if (_symmetry) {
+      Automorphisms aut;
+      FindAutomorphisms(&_refmol, aut, _frag_atoms);
+      for (std::size_t a = 0; a < aut.size(); ++a) {
+        std::vector<unsigned int> perm(_fragIndexes.size());
+        for (std::size_t l = 0; l < aut[a].size(); ++l)
+          perm[local[aut[a][l].first]] = local[aut[a][l].second];
+        if (perm != identity)
+          _perms.push_back(perm);
+      }
+    }
+  }
+
+  bool OBRMSDMatrix::AddMol(const OBMol &mol)
+  {
+    std::size_t N = _fragIndexes.size();
+
+    // Find the atom in mol for each reference atom, try the identity first.
+    std::vector<unsigned int> map;
+    bool isIdentity = mol.NumAtoms() == _refmol.NumAtoms();
+    for (std::size_t k = 0; isIdentity && k < N; ++k)
+      if (mol.GetAtom(_fragIndexes[k] + 1)->GetAtomicNum() != _refmol.GetAtom(_fragIndexes[k] + 1)->GetAtomicNum())
+        isIdentity = false;
+    if (isIdentity) {
+      FOR_BONDS_OF_MOL (bond, _refmol) {
+        if (!_frag_atoms.BitIsSet(bond->GetBeginAtomIdx()) || !_frag_atoms.BitIsSet(bond->GetEndAtomIdx()))
+          continue;
+        if (!mol.GetBond(bond->GetBeginAtomIdx(), bond->GetEndAtomIdx())) {
+          isIdentity = false;
+          break;
+        }
+      }
+    }
+
+    if (isIdentity)
+      map = _fragIndexes;
+    else {
+      OBQuery *query = CompileMoleculeQuery(&_refmol, _frag_atoms);
+      OBIsomorphismMapper *mapper = OBIsomorphismMapper::GetInstance(query, "VF2++");
+      OBIsomorphismMapper::Mapping mapping;
+      mapper->MapFirst(&mol, mapping);
+      if (mapping.size() == N) {
+        map.resize(N);
+        for (std::size_t l = 0; l < mapping.size(); ++l)
+          map[mapping[l].first] = mapping[l].second;
+      }
+      delete mapper;
+      delete query;
+    }
+
+    _coords.push_back(std::vector<double>(3 * N, 0.0));
+    _norms.push_back(std::vector<double>(N, 0.0));
+    _sqnorms.push_back(0.0);
+    _valid.push_back(!map.empty());
+    if (map.empty()) {
+      obErrorLog.ThrowError(__FUNCTION__, "The molecule does not match the reference molecule", obWarning);
+      return false;
+    }
+
+    std::vector<double> &coords = _coords.back();
+    double centroid[3] = { 0.0, 0.0, 0.0 };
+    for (std::size_t k = 0; k < N; ++k) {
+      const double *c = mol.GetAtom(map[k] + 1)->GetVector().AsArray();
+      for (unsigned int d = 0; d < 3; ++d) {
+        coords[3 * k + d] = c[d];
+        centroid[d] += c[d];
+      }
+    }
+
+    // Center the coordinates once instead of for each pair.
+    if (_minimize && N) {
+      for (std::size_t k = 0; k < N; ++k) {
+        double sqnorm = 0.0;
+        for (unsigned int d = 0; d < 3; ++d) {
+          coords[3 * k + d] -= centroid[d] / N;
+          sqnorm += coords[3 * k + d] * coords[3 * k + d];
+        }
+        _norms.back()[k] = sqrt(sqnorm);
+        _sqnorms.back() += sqnorm;
+      }
+    }
+
+    return true;
+  }
+
+  double OBRMSDMatrix::GetRMSD(std::size_t i, std::size_t j) const
+  {
+    if (i == j)
+      return 0.0;
+    if (!_valid[i] || !_valid[j])
+      return HUGE_VAL;
+    // make the result exactly symmetric
+    if (j < i)
+      std::swap(i, j);
+
+    std::size_t N = _fragIndexes.size();
+    if (!N)
+      return 0.0;
+    const std::vector<double> &x = _coords[i];
+    const std::vector<double> &y = _coords[j];
+
+    // the minimum sum of squared deviations
+    double best = HUGE_VAL;
+    for (std::size_t p = 0; p < _perms.size(); ++p) {
+      const std::vector<unsigned int> &perm = _perms[p];
+      double sqdev = 0.0;
+
+      if (_minimize) {
+        // The overlap after the optimal rotation can not exceed the sum of
+        // the products of the distances to the centroid. Skip permutations
+        // for which this lower bound is not better than the best result.
+        if (p) {
+          const std::vector<double> &xnorms = _norms[i];
+          const std::vector<double> &ynorms = _norms[j];
+          double overlap = 0.0;
+          for (std::size_t k = 0; k < N; ++k)
+            overlap += xnorms[k] * ynorms[perm[k]];
+          if (_sqnorms[i] + _sqnorms[j] - 2.0 * overlap >= best)
+            continue;
+        }
+
+        // Kabsch: the optimal overlap is the sum of the singular values of
+        // the covariance matrix (with the sign of the determinant applied to
+        // the smallest one).
+        Eigen::Matrix3d C = Eigen::Matrix3d::Zero();
+        for (std::size_t k = 0; k < N; ++k) {
+          const double *a = &x[3 * k];
+          const double *b = &y[3 * perm[k]];
+          for (unsigned int r = 0; r < 3; ++r)
+            for (unsigned int c = 0; c < 3; ++c)
+              C(r, c) += a[r] * b[c];
+        }
+#ifdef HAVE_EIGEN3
+        Eigen::JacobiSVD<Eigen::Matrix3d> svd(C);
+#else
+        Eigen::SVD<Eigen::Matrix3d> svd(C);
+#endif
+        Eigen::Vector3d sv = svd.singularValues();
+        double sign = (C.determinant() < 0.0) ? -1.0 : 1.0;
+        sqdev = _sqnorms[i] + _sqnorms[j] - 2.0 * (sv(0) + sv(1) + sign * sv(2));
+        if (sqdev < 0.0)
+          sqdev = 0.0;
+      } else {
+        // Without superposition, stop as soon as the sum exceeds the best.
+        for (std::size_t k = 0; k < N && sqdev < best; ++k) {
+          const double *a = &x[3 * k];
+          const double *b = &y[3 * perm[k]];
+          for (unsigned int d = 0; d < 3; ++d)
+            sqdev += (a[d] - b[d]) * (a[d] - b[d]);
+        }
+      }
+
+      if (sqdev < best)
+        best = sqdev;
+    }
+
+    return sqrt(best / N);
+  }
+
+  void OBRMSDMatrix::ComputeRows(std::size_t first, std::size_t last, std::vector<std::vector<double> > &rows) const
+  {
+    std::size_t n = _coords.size();
+    if (last > n)
+      last = n;
+    rows.clear();
+    if (first >= last)
+      return;
+    rows.resize(last - first);
+
+    int numRows = last - first;
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (int r = 0; r < numRows; ++r) {
+      std::size_t i = first + r;
+      rows[r].resize(n - i - 1);
+      for (std::size_t j = i + 1; j < n; ++j)
+        rows[r][j - i - 1] = GetRMSD(i, j);
+    }
+  }
+
+  void OBRMSDMatrix::Compute(std::vector<double> &rmsds) const
+  {
+    std::size_t n = _coords.size();
+    rmsds.resize(n ? n * (n - 1) / 2 : 0);
+
+    int numRows = n;
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (int r = 0; r < numRows; ++r) {
+      std::size_t i = r;
+      // offset of row i in the upper triangle
+      std::size_t offset = i * n - i * (i + 1) / 2;
+      for (std::size_t j = i + 1; j < n; ++j)
+        rmsds[offset + j - i - 1] = GetRMSD(i, j);
+    }
+  }
+
 } // namespace OpenBabel
 
 //! \file align.cpp
@@ -38,6 +38,7 @@ GNU General Public License for more details.
 
 #include <sstream>
 #include <set>
+#include <algorithm>
 
 using namespace std;
 
@@ -186,7 +187,7 @@ namespace OpenBabel
       return(_title.c_str());
 
     //Only multiline titles use the following to replace newlines by spaces
-    static string title;
+    static thread_local string title; // one per thread, as a pointer to it is returned
     title=_title;
     string::size_type j;
     for ( ; (j = title.find_first_of( "\n\r" )) != string::npos ; ) {
@@ -224,8 +225,9 @@ namespace OpenBabel
     vector<int> tor;
     vector<int> atoms;
 
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::SetTorsion", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::SetTorsion", obAuditMsg);
 
     tor.push_back(a->GetCoordinateIdx());
     tor.push_back(b->GetCoordinateIdx());
@@ -1108,9 +1110,10 @@ namespace OpenBabel
     if (dp != nullptr) // we already set the formula (or it was read from a file)
       return dp->GetValue();
 
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::SetFormula -- Hill order formula",
-                          obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::SetFormula -- Hill order formula",
+                            obAuditMsg);
 
     string sformula = GetSpacedFormula(1, "");
 
@@ -1154,9 +1157,10 @@ namespace OpenBabel
       return(_totalCharge);
     else // calculate from atomic formal charges (seems the best default)
       {
-        obErrorLog.ThrowError(__FUNCTION__,
-                              "Ran OpenBabel::GetTotalCharge -- calculated from formal charges",
-                              obAuditMsg);
+        if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+          obErrorLog.ThrowError(__FUNCTION__,
+                                "Ran OpenBabel::GetTotalCharge -- calculated from formal charges",
+                                obAuditMsg);
 
         OBAtom *atom;
         vector<OBAtom*>::iterator i;
@@ -1204,9 +1208,10 @@ namespace OpenBabel
       return(_totalSpin);
     else // calculate from atomic spin information (assuming high-spin case)
       {
-        obErrorLog.ThrowError(__FUNCTION__,
-                              "Ran OpenBabel::GetTotalSpinMultiplicity -- calculating from atomic spins assuming high spin case",
-                              obAuditMsg);
+        if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+          obErrorLog.ThrowError(__FUNCTION__,
+                                "Ran OpenBabel::GetTotalSpinMultiplicity -- calculating from atomic spins assuming high spin case",
+                                obAuditMsg);
 
         OBAtom *atom;
         vector<OBAtom*>::iterator i;
@@ -1824,7 +1829,8 @@ namespace OpenBabel
       }
 
 
-    obErrorLog.ThrowError(__FUNCTION__, "Ran OpenBabel::StripSalts", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__, "Ran OpenBabel::StripSalts", obAuditMsg);
 
     max = cfl.begin();
     for (i = cfl.begin();i != cfl.end();++i)
@@ -1883,9 +1889,10 @@ namespace OpenBabel
     vector<OBAtom*>::iterator i;
     vector<OBAtom*> delatoms;
 
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::DeleteHydrogens -- polar",
-                          obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::DeleteHydrogens -- polar",
+                            obAuditMsg);
 
     for (atom = BeginAtom(i);atom;atom = NextAtom(i))
       if (atom->IsPolarHydrogen() && IsSuppressibleHydrogen(atom))
@@ -1913,9 +1920,10 @@ namespace OpenBabel
     vector<OBAtom*>::iterator i;
     vector<OBAtom*> delatoms;
 
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::DeleteHydrogens -- nonpolar",
-                          obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::DeleteHydrogens -- nonpolar",
+                            obAuditMsg);
 
 
     for (atom = BeginAtom(i);atom;atom = NextAtom(i))
@@ -1955,8 +1963,9 @@ namespace OpenBabel
     vector<OBAtom*>::iterator i;
     vector<OBAtom*> delatoms,va;
 
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::DeleteHydrogens", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::DeleteHydrogens", obAuditMsg);
 
     for (atom = BeginAtom(i);atom;atom = NextAtom(i))
       if (atom->GetAtomicNum() == OBElements::Hydrogen && IsSuppressibleHydrogen(atom))
@@ -2134,15 +2143,17 @@ namespace OpenBabel
     return true;
     }
     */
-    if (whichHydrogen == AllHydrogen)
-      obErrorLog.ThrowError(__FUNCTION__,
-                            "Ran OpenBabel::AddHydrogens", obAuditMsg);
-    else if (whichHydrogen == PolarHydrogen)
-      obErrorLog.ThrowError(__FUNCTION__,
-                            "Ran OpenBabel::AddHydrogens -- polar only", obAuditMsg);
-    else
-      obErrorLog.ThrowError(__FUNCTION__,
-                            "Ran OpenBabel::AddHydrogens -- nonpolar only", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg) {
+      if (whichHydrogen == AllHydrogen)
+        obErrorLog.ThrowError(__FUNCTION__,
+                              "Ran OpenBabel::AddHydrogens", obAuditMsg);
+      else if (whichHydrogen == PolarHydrogen)
+        obErrorLog.ThrowError(__FUNCTION__,
+                              "Ran OpenBabel::AddHydrogens -- polar only", obAuditMsg);
+      else
+        obErrorLog.ThrowError(__FUNCTION__,
+                              "Ran OpenBabel::AddHydrogens -- nonpolar only", obAuditMsg);
+    }
 
     // Make sure we have conformers (PR#1665519)
     if (!_vconf.empty() && !Empty()) {
@@ -2232,9 +2243,10 @@ namespace OpenBabel
                       _c[(NumAtoms())*3]   = 0.0;
                       _c[(NumAtoms())*3+1] = 0.0;
                       _c[(NumAtoms())*3+2] = 0.0;
-                      obErrorLog.ThrowError(__FUNCTION__,
-                                            "Ran OpenBabel::AddHydrogens -- no reasonable bond geometry for desired hydrogen.",
-                                            obAuditMsg);
+                      if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+                        obErrorLog.ThrowError(__FUNCTION__,
+                                              "Ran OpenBabel::AddHydrogens -- no reasonable bond geometry for desired hydrogen.",
+                                              obAuditMsg);
                       badh++;
                     }
                   }
@@ -2362,8 +2374,9 @@ namespace OpenBabel
       return(true);
     phmodel.CorrectForPH(*this, pH);
 
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::CorrectForPH", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::CorrectForPH", obAuditMsg);
 
     return(true);
   }
@@ -2600,8 +2613,9 @@ namespace OpenBabel
   {
     vector<int> children;
 
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::Align", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::Align", obAuditMsg);
 
     //find which atoms to rotate
     FindChildren(children,a1->GetIdx(),a2->GetIdx());
@@ -2650,8 +2664,9 @@ namespace OpenBabel
     double mass = 0.0;
     double center[3],m[3][3];
 
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::ToInertialFrame", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::ToInertialFrame", obAuditMsg);
 
     for (i = 0;i < 3;++i)
       memset(&m[i],'\0',sizeof(double)*3);
@@ -2882,8 +2897,9 @@ namespace OpenBabel
     if (Empty())
       return;
 
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::RenumberAtoms", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::RenumberAtoms", obAuditMsg);
 
     OBAtom *atom;
     vector<OBAtom*> va;
@@ -2966,13 +2982,15 @@ namespace OpenBabel
       return;
     if (_dimension != 3) return; // not useful on non-3D structures
 
-    if (IsPeriodic())
-      obErrorLog.ThrowError(__FUNCTION__,
-                            "Ran OpenBabel::ConnectTheDots -- using periodic boundary conditions",
-                            obAuditMsg);
-    else
-      obErrorLog.ThrowError(__FUNCTION__,
-                            "Ran OpenBabel::ConnectTheDots", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg) {
+      if (IsPeriodic())
+        obErrorLog.ThrowError(__FUNCTION__,
+                              "Ran OpenBabel::ConnectTheDots -- using periodic boundary conditions",
+                              obAuditMsg);
+      else
+        obErrorLog.ThrowError(__FUNCTION__,
+                              "Ran OpenBabel::ConnectTheDots", obAuditMsg);
+    }
 
 
     int j,k,max;
@@ -3001,6 +3019,8 @@ namespace OpenBabel
         pair<OBAtom*,double> entry(atom, atom->GetVector().z());
         zsortedAtoms.push_back(entry);
       }
+    // the z order fixes the order in which bonds are tried (and so which
+    // ones survive the valence checks); the search itself uses a grid below
     sort(zsortedAtoms.begin(), zsortedAtoms.end(), SortAtomZ);
 
     max = zsortedAtoms.size();
@@ -3014,14 +3034,130 @@ namespace OpenBabel
       }
 
     int idx1, idx2;
-    double d2,cutoff,zd;
-    vector3 atom1, atom2, wrapped_coords;  // Only used for periodic coords
+    double d2,cutoff;
+
+    // Bin the atoms on a uniform grid with cells at least as wide as the
+    // longest possible bond, so that each atom is only compared with the
+    // atoms in its own and the neighbouring cells. With periodic boundaries
+    // the grid is laid over the fractional coordinates and wraps around.
+    OBUnitCell *unitCell = nullptr;
+    vector<vector3> frac;              // fractional coordinates of zsorted atoms
+    matrix3x3 fracToCart;
+    double maxBond = 2.0 * maxrad + 0.45;
+    int nbins[3] = { 1, 1, 1 };
+    vector<int> atomBin(max);
+    if (IsPeriodic())
+      {
+        unitCell = (OBUnitCell * ) GetData(OBGenericDataType::UnitCell);
+        fracToCart = unitCell->GetOrientationMatrix() * unitCell->GetOrthoMatrix();
+
+        vector<vector3> cellVectors = unitCell->GetCellVectors();
+        double volume = unitCell->GetCellVolume();
+        for (int d = 0; d < 3; ++d) {
+          double width = volume / cross(cellVectors[(d + 1) % 3], cellVectors[(d + 2) % 3]).length();
+          nbins[d] = std::max(1, std::min(100, static_cast<int>(width / maxBond)));
+        }
+
+        frac.resize(max);
+        for (j = 0 ; j < max ; ++j)
+          {
+            idx1 = zsorted[j];
+            vector3 f = unitCell->CartesianToFractional(vector3(c[idx1*3], c[idx1*3+1], c[idx1*3+2]));
+            int bin[3];
+            for (int d = 0; d < 3; ++d) {
+              double x = f[d] - floor(f[d]);
+              bin[d] = std::min(nbins[d] - 1, static_cast<int>(x * nbins[d]));
+            }
+            frac[j] = f;
+            atomBin[j] = (bin[0] * nbins[1] + bin[1]) * nbins[2] + bin[2];
+          }
+      }
+    else if (max > 0)
+      {
+        double lo[3], hi[3];
+        for (int d = 0; d < 3; ++d)
+          lo[d] = hi[d] = c[zsorted[0]*3+d];
+        for (j = 1 ; j < max ; ++j)
+          for (int d = 0; d < 3; ++d) {
+            lo[d] = std::min(lo[d], c[zsorted[j]*3+d]);
+            hi[d] = std::max(hi[d], c[zsorted[j]*3+d]);
+          }
+
+        // widen the cells if sparse, far-flung atoms would need a huge grid
+        double width = maxBond;
+        double maxCells = 8.0 * max + 64.0;
+        for (;;) {
+          double ncells = 1.0;
+          for (int d = 0; d < 3; ++d)
+            ncells *= floor((hi[d] - lo[d]) / width) + 1.0;
+          if (ncells <= maxCells)
+            break;
+          width *= std::max(1.1, cbrt(ncells / maxCells));
+        }
+        for (int d = 0; d < 3; ++d)
+          nbins[d] = static_cast<int>((hi[d] - lo[d]) / width) + 1;
+
+        for (j = 0 ; j < max ; ++j)
+          {
+            idx1 = zsorted[j];
+            int bin[3];
+            for (int d = 0; d < 3; ++d)
+              bin[d] = std::min(nbins[d] - 1, static_cast<int>((c[idx1*3+d] - lo[d]) / width));
+            atomBin[j] = (bin[0] * nbins[1] + bin[1]) * nbins[2] + bin[2];
+          }
+      }
+
+    // atoms of cell b are binAtoms[binStart[b] .. binStart[b+1]), in zsorted order
+    vector<int> binStart(nbins[0] * nbins[1] * nbins[2] + 1, 0);
+    vector<int> binAtoms(max);
+    for (j = 0 ; j < max ; ++j)
+      ++binStart[atomBin[j] + 1];
+    for (size_t b = 1; b < binStart.size(); ++b)
+      binStart[b] += binStart[b - 1];
+    {
+      vector<int> next(binStart.begin(), binStart.end() - 1);
+      for (j = 0 ; j < max ; ++j)
+        binAtoms[next[atomBin[j]]++] = j;
+    }
+
+    vector<int> candidates;
     for (j = 0 ; j < max ; ++j)
       {
-        double maxcutoff = SQUARE(rad[j]+maxrad+0.45);
         idx1 = zsorted[j];
-        for (k = j + 1 ; k < max ; k++ )
+
+        // atoms after j in this and the neighbouring cells, visited in the
+        // same order as a full scan so bonds are added identically
+        candidates.clear();
+        int bin[3] = { atomBin[j] / (nbins[1] * nbins[2]),
+                       (atomBin[j] / nbins[2]) % nbins[1],
+                       atomBin[j] % nbins[2] };
+        int offsets[3][3], noffsets[3];
+        for (int d = 0; d < 3; ++d) {
+          noffsets[d] = 0;
+          for (int o = -1; o <= 1; ++o) {
+            int b = bin[d] + o;
+            if (unitCell)
+              b = (b % nbins[d] + nbins[d]) % nbins[d];
+            else if (b < 0 || b >= nbins[d])
+              continue;
+            if (std::find(offsets[d], offsets[d] + noffsets[d], b) == offsets[d] + noffsets[d])
+              offsets[d][noffsets[d]++] = b;
+          }
+        }
+        for (int x = 0; x < noffsets[0]; ++x)
+          for (int y = 0; y < noffsets[1]; ++y)
+            for (int z = 0; z < noffsets[2]; ++z) {
+              int b = (offsets[0][x] * nbins[1] + offsets[1][y]) * nbins[2] + offsets[2][z];
+              const int *first = &binAtoms[0] + binStart[b];
+              const int *last = &binAtoms[0] + binStart[b + 1];
+              for (const int *a = upper_bound(first, last, j); a != last; ++a)
+                candidates.push_back(*a);
+            }
+        sort(candidates.begin(), candidates.end());
+
+        for (size_t n = 0; n < candidates.size(); ++n)
           {
+            k = candidates[n];
             idx2 = zsorted[k];
 
             // bonded if closer than elemental Rcov + tolerance
@@ -3029,30 +3165,21 @@ namespace OpenBabel
 
             // Use minimum image convention if the unit cell is periodic
             // Otherwise, use a simpler (faster) distance calculation based on raw coordinates
-            if (IsPeriodic())
+            if (unitCell)
               {
-                atom1 = vector3(c[idx1*3], c[idx1*3+1], c[idx1*3+2]);
-                atom2 = vector3(c[idx2*3], c[idx2*3+1], c[idx2*3+2]);
-                OBUnitCell *unitCell = (OBUnitCell * ) GetData(OBGenericDataType::UnitCell);
-                wrapped_coords = unitCell->MinimumImageCartesian(atom1 - atom2);
-                d2 = wrapped_coords.length_2();
+                vector3 df = frac[j] - frac[k];
+                df = unitCell->MinimumImageFractional(df);
+                d2 = (fracToCart * df).length_2();
               }
             else
               {
-                zd  = SQUARE(c[idx1*3+2] - c[idx2*3+2]);
-                // bigger than max cutoff, which is determined using largest radius,
-                // not the radius of k (which might be small, ie H, and cause an early  termination)
-                // since we sort by z, anything beyond k will also fail
-                if (zd > maxcutoff )
-                  break;
-
                 d2  = SQUARE(c[idx1*3]   - c[idx2*3]);
                 if (d2 > cutoff)
                   continue; // x's bigger than cutoff
                 d2 += SQUARE(c[idx1*3+1] - c[idx2*3+1]);
                 if (d2 > cutoff)
                   continue; // x^2 + y^2 bigger than cutoff
-                d2 += zd;
+                d2 += SQUARE(c[idx1*3+2] - c[idx2*3+2]);
               }
 
             if (d2 > cutoff)
@@ -3195,8 +3322,9 @@ namespace OpenBabel
       return;
     if (_dimension != 3) return; // not useful on non-3D structures
 
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::PerceiveBondOrders", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::PerceiveBondOrders", obAuditMsg);
 
     OBAtom *atom, *b, *c;
     vector3 v1, v2;
@@ -3564,8 +3692,9 @@ namespace OpenBabel
 
   vector3 OBMol::Center(int nconf)
   {
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::Center", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::Center", obAuditMsg);
 
     SetConformer(nconf);
 
@@ -3609,8 +3738,9 @@ namespace OpenBabel
     positions in the current conformer are translated. */
   void OBMol::Translate(const vector3 &v, int nconf)
   {
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::Translate", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::Translate", obAuditMsg);
 
     int i,size;
     double x,y,z;
@@ -3652,8 +3782,9 @@ namespace OpenBabel
     double x,y,z;
     double *c = (nconf == OB_CURRENT_CONFORMER)? _c : GetConformer(nconf);
 
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::Rotate", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::Rotate", obAuditMsg);
 
     size = NumAtoms();
     for (i = 0;i < size;++i)
@@ -3746,8 +3877,9 @@ namespace OpenBabel
   ///Converts for instance [N+]([O-])=O to N(=O)=O
   bool OBMol::ConvertDativeBonds()
   {
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::ConvertDativeBonds", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::ConvertDativeBonds", obAuditMsg);
 
     //Look for + and - charges on adjacent atoms
     OBAtom* patom;
@@ -65,8 +65,9 @@ namespace OpenBabel
   bool OBGastChrg::AssignPartialCharges(OBMol &mol)
   {
     //InitialPartialCharges(mol);
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::AssignPartialCharges", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::AssignPartialCharges", obAuditMsg);
 
     // Annotate that partial charges come from Gasteiger
     OBPairData *dp = new OBPairData;
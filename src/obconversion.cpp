@@ -1805,7 +1805,7 @@ Additional options :
         str = nullptr; pFormat = nullptr;
         return false;
       }
-    static string s;
+    static thread_local string s; // one per thread, as a pointer to it is returned
     s =itr->first;
     pFormat = static_cast<OBFormat*>(itr->second);
     if(pFormat)
@@ -87,10 +87,32 @@ namespace OpenBabel
   The default is to only log and output errors of priority
   obMessageLevel::obError or obMessageLevel::obWarning.
 
-  Long-running code may wish to set the size of the in-memory error log
-  using the StartLogging / StopLogging methods and
-  SetMaxLogEntries. Otherwise, the error log may easily fill up,
-  requiring large amounts of memory.
+  The in-memory log is a ring of GetMaxLogEntries() messages (100 by
+  default, see SetMaxLogEntries): once it is full, each new message
+  replaces the oldest one. SetMaxLogEntries(0) gives the largest log,
+  65536 entries; the log is never unbounded. Logging can be turned off
+  entirely with StopLogging.
+
+  ThrowError may be called from several threads at once. Each entry of
+  the ring is claimed with an atomic counter and guarded by its own flag,
+  so threads only wait for each other when they use the same entry, and
+  the per-level counts are atomic. An entry is stamped with the number of
+  the message written to it, so that a message which has been claimed but
+  not yet written is not read back. The settings (output level, stream,
+  log size) should be changed while no other thread is logging.
+
+  Messages are only useful if someone reads them, so code which logs
+  often, such as the obAuditMsg messages of perception methods, checks
+  the output level first and only builds the message when it is wanted:
+
+  \code
+  if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+    obErrorLog.ThrowError(__FUNCTION__, "Ran OpenBabel::FindSSSR", obAuditMsg);
+  \endcode
+
+  The audit messages of Open Babel itself are thrown this way. Unless the
+  output level is at least obAuditMsg they are neither stored in the log
+  nor counted by GetAuditMessageCount.
 
   If you wish to divert error output to a different std::ostream (i.e.,
   for graphical display, or a file log), use the SetOutputStream method
@@ -143,11 +165,13 @@ namespace OpenBabel
   **/
 
   OBMessageHandler::OBMessageHandler() :
-    _outputLevel(obWarning), _outputStream(&clog), _logging(true), _maxEntries(100)
+    _messageTotal(0), _outputLevel(obWarning), _outputStream(&clog),
+    _logging(true), _maxEntries(0)
   {
-    _messageCount[0] = _messageCount[1] = _messageCount[2] = 0;
-    _messageCount[3] = _messageCount[4] = 0;
+    for (int i = 0; i < 5; ++i)
+      _messageCount[i] = 0;
     _filterStreamBuf = _inWrapStreamBuf = nullptr;
+    SetMaxLogEntries(100);
     //  StartErrorWrap(); // (don't turn on error wrapping by default)
   }
 
@@ -159,22 +183,85 @@ namespace OpenBabel
     delete _filterStreamBuf;
   }
 
+  // Wait until entry i of the ring is free and take it
+  static void LockEntry(std::vector<std::atomic<bool> > &busy, size_t i)
+  {
+    while (busy[i].exchange(true, std::memory_order_acquire))
+      ; // another thread is copying this entry -- it will be quick
+  }
+
+  void OBMessageHandler::SetMaxLogEntries(unsigned int max)
+  {
+    if (max == 0 || max > 65536)
+      max = 65536;
+    if (max == _maxEntries)
+      return;
+
+    // keep the most recent messages that fit
+    unsigned long total = _messageTotal;
+    unsigned long first = total > _maxEntries ? total - _maxEntries : 0;
+    if (total - first > max)
+      first = total - max;
+    std::vector<OBError> messages(max);
+    std::vector<unsigned long> stamps(max, 0);
+    for (unsigned long n = first; n < total; ++n) {
+      size_t i = n % _maxEntries;
+      if (_messageStamp[i] == n + 1) {
+        messages[n % max] = _messageList[i];
+        stamps[n % max] = n + 1;
+      }
+    }
+
+    _messageList.swap(messages);
+    _messageStamp.swap(stamps);
+    std::vector<std::atomic<bool> >(max).swap(_messageBusy);
+    _maxEntries = max;
+  }
+
+  void OBMessageHandler::ClearLog()
+  {
+    _messageTotal = 0;
+    std::fill(_messageStamp.begin(), _messageStamp.end(), 0);
+  }
+
+  bool OBMessageHandler::IsLogged(const OBError &err)
+  {
+    unsigned long total = _messageTotal;
+    unsigned long first = total > _maxEntries ? total - _maxEntries : 0;
+    for (unsigned long n = first; n < total; ++n) {
+      size_t i = n % _maxEntries;
+      LockEntry(_messageBusy, i);
+      bool found = _messageStamp[i] == n + 1 && _messageList[i] == err;
+      _messageBusy[i].store(false, std::memory_order_release);
+      if (found)
+        return true;
+    }
+    return false;
+  }
+
   void OBMessageHandler::ThrowError(OBError err, errorQualifier qualifier)
   {
     if (!_logging)
       return;
 
     //Output error message if level sufficiently high and, if onceOnly set, it has not been logged before
-    if (err.GetLevel() <= _outputLevel &&
-      (qualifier!=onceOnly || find(_messageList.begin(), _messageList.end(), err)==_messageList.end()))
+    if (err.GetLevel() <= _outputLevel && (qualifier != onceOnly || !IsLogged(err)))
     {
-      *_outputStream << err;
+      // one write, so that messages from different threads are not mixed
+      *_outputStream << err.message();
     }
 
-    _messageList.push_back(err);
+    // entry n % size holds message n once it is stamped n + 1; a thread
+    // which was slower than a later message for the same entry gives way
+    unsigned long n = _messageTotal++;
+    size_t i = n % _maxEntries;
+    LockEntry(_messageBusy, i);
+    if (_messageStamp[i] < n + 1) {
+      _messageList[i] = err;
+      _messageStamp[i] = n + 1;
+    }
+    _messageBusy[i].store(false, std::memory_order_release);
     _messageCount[err.GetLevel()]++;
-    if (_maxEntries != 0 && _messageList.size() > _maxEntries)
-      _messageList.pop_front();
   }
 
   void OBMessageHandler::ThrowError(const std::string &method,
@@ -191,14 +278,15 @@ namespace OpenBabel
   std::vector<std::string> OBMessageHandler::GetMessagesOfLevel(const obMessageLevel level)
   {
     vector<string> results;
-    deque<OBError>::iterator i;
-    OBError error;
-
-    for (i = _messageList.begin(); i != _messageList.end(); ++i)
+    unsigned long total = _messageTotal;
+    unsigned long first = total > _maxEntries ? total - _maxEntries : 0;
+    for (unsigned long n = first; n < total; ++n) // oldest first
       {
-        error = (*i);
-        if (error.GetLevel() == level)
-          results.push_back( error.message() );
+        size_t i = n % _maxEntries;
+        LockEntry(_messageBusy, i);
+        if (_messageStamp[i] == n + 1 && _messageList[i].GetLevel() == level)
+          results.push_back(_messageList[i].message());
+        _messageBusy[i].store(false, std::memory_order_release);
       }
 
     return results;
@@ -527,8 +527,9 @@ namespace OpenBabel
             mol.Clear();
             pos = datastream.tellg();
           }
-        obErrorLog.ThrowError(__FUNCTION__,
-                              "Prepared an index for " + datafilepath, obAuditMsg);
+        if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+          obErrorLog.ThrowError(__FUNCTION__,
+                                "Prepared an index for " + datafilepath, obAuditMsg);
         //Save index to file
         ofstream dofs((datafilepath + ".obindx").c_str(), ios_base::out|ios_base::binary);
         if(!dofs) return false;
@@ -464,8 +464,9 @@ namespace OpenBabel
       return;
     }
 
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::InternalToCartesian", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::InternalToCartesian", obAuditMsg);
 
     for (atom = mol.BeginAtom(i);atom;atom = mol.NextAtom(i))
       {
@@ -551,8 +552,9 @@ namespace OpenBabel
     OBAtom *atom,*nbr,*ref;
     vector<OBAtom*>::iterator i,j,m;
 
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::CartesianToInternal", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::CartesianToInternal", obAuditMsg);
 
     //set reference atoms
     for (atom = mol.BeginAtom(i);atom;atom = mol.NextAtom(i))
@@ -768,7 +770,7 @@ namespace OpenBabel
 
 
 
-  static double Roots[4];
+  static thread_local double Roots[4];
 
 #define ApproxZero 1E-7
 #define IsZero(x)  ((double)fabs(x)<ApproxZero)
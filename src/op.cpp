@@ -18,6 +18,29 @@ GNU General Public License for more details.
 
 #include <openbabel/babelconfig.h>
 #include <openbabel/op.h>
+#include <openbabel/mol.h>
+#include <openbabel/atom.h>
+#include <openbabel/bond.h>
+#include <openbabel/obiter.h>
+#include <openbabel/generic.h>
+#include <openbabel/obconversion.h>
+#include <openbabel/oberror.h>
+#include <openbabel/stereo/tetrahedral.h>
+#include <openbabel/stereo/cistrans.h>
+#include <openbabel/stereo/squareplanar.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
 
 using namespace std;
 namespace OpenBabel
@@ -26,6 +49,297 @@ namespace OpenBabel
   // macro to implement static OBPlugin::PluginMapType& Map()
   PLUGIN_CPP_FILE(OBOp)
 #endif
+
+  /* The results of ops, kept in a directory between runs.
+
+     Each result is in a file named from a 64-bit hash of its key, which
+     holds the length of the key, the key and the value. The key is compared
+     when the file is read, so a collision of hashes is a miss.
+
+     The files are in 256 groups, by the first byte of the hash, each with
+     an index file listing its files from the least to the most recently
+     used. Adding a file deletes the least recently used ones of its group
+     when the group is over its share of the maximum size. Files are written
+     under a temporary name and renamed, so several processes may share a
+     cache; an index line lost to a concurrent update only leaves a file
+     which is never deleted.
+  */
+  class OBResultCache
+  {
+  public:
+    OBResultCache(const string &dir, double maxBytes): _dir(dir), _maxBytes(maxBytes), _count(0)
+    {
+      if (!_dir.empty() && _dir[_dir.size() - 1] != '/' && _dir[_dir.size() - 1] != '\\')
+        _dir += '/';
+#ifdef _WIN32
+      _mkdir(dir.c_str());
+#else
+      mkdir(dir.c_str(), 0777);
+#endif
+    }
+
+    void SetMaxBytes(double maxBytes)
+    {
+      _maxBytes = maxBytes;
+    }
+
+    bool Find(const string &key, string &value)
+    {
+      unsigned long long hash = Hash(key);
+      string name = FileName(hash);
+      ifstream ifs((_dir + name).c_str(), ios::binary);
+      if (!ifs)
+        return false;
+      string::size_type keySize = 0;
+      if (!(ifs >> keySize) || ifs.get() != '\n' || keySize != key.size())
+        return false;
+      string fileKey(keySize, '\0');
+      if (!ifs.read(&fileKey[0], keySize) || fileKey != key)
+        return false;
+      stringstream ss;
+      ss << ifs.rdbuf();
+      value = ss.str();
+      Used(hash, name, value.size() + key.size());
+      return true;
+    }
+
+    bool Store(const string &key, const string &value)
+    {
+      unsigned long long hash = Hash(key);
+      string name = FileName(hash);
+      stringstream tmpName;
+      tmpName << _dir << name << ".tmp" << ++_count << '-' << rand();
+      {
+        ofstream ofs(tmpName.str().c_str(), ios::binary);
+        if (!ofs)
+          return false;
+        ofs << key.size() << '\n' << key << value;
+        if (!ofs)
+          return false;
+      }
+      string fileName = _dir + name;
+      if (rename(tmpName.str().c_str(), fileName.c_str()) != 0) {
+        // on Windows an existing file is not replaced
+        remove(fileName.c_str());
+        if (rename(tmpName.str().c_str(), fileName.c_str()) != 0) {
+          remove(tmpName.str().c_str());
+          return false;
+        }
+      }
+      Used(hash, name, value.size() + key.size());
+      Evict(hash);
+      return true;
+    }
+
+  private:
+    string _dir;
+    double _maxBytes;
+    unsigned int _count;
+
+    static unsigned long long Hash(const string &s)
+    {
+      // FNV-1a
+      unsigned long long hash = 14695981039346656037ULL;
+      for (string::const_iterator c = s.begin(); c != s.end(); ++c) {
+        hash ^= static_cast<unsigned char>(*c);
+        hash *= 1099511628211ULL;
+      }
+      return hash;
+    }
+
+    static string FileName(unsigned long long hash)
+    {
+      char buffer[32];
+      snprintf(buffer, sizeof(buffer), "%016llx.obc", hash);
+      return buffer;
+    }
+
+    string IndexName(unsigned long long hash) const
+    {
+      char buffer[16];
+      snprintf(buffer, sizeof(buffer), "index-%02x", static_cast<unsigned int>(hash >> 56));
+      return _dir + buffer;
+    }
+
+    // Adds the file to the end of its group's index, as the most recently used
+    void Used(unsigned long long hash, const string &name, string::size_type size)
+    {
+      ofstream ofs(IndexName(hash).c_str(), ios::app);
+      ofs << name << ' ' << size << '\n';
+    }
+
+    // Deletes the least recently used files of the group while it is larger
+    // than its share of the cache, and removes repeated lines from its index
+    void Evict(unsigned long long hash)
+    {
+      string indexName = IndexName(hash);
+      ifstream ifs(indexName.c_str());
+      vector<pair<string, double> > lines;
+      string name;
+      double size;
+      while (ifs >> name >> size)
+        lines.push_back(make_pair(name, size));
+      ifs.close();
+
+      // the last line for each file gives its position in the order of use
+      map<string, unsigned int> last;
+      for (unsigned int i = 0; i < lines.size(); ++i)
+        last[lines[i].first] = i;
+      double total = 0.0;
+      for (map<string, unsigned int>::iterator i = last.begin(); i != last.end(); ++i)
+        total += lines[i->second].second;
+      double share = _maxBytes / 256.0;
+      if (total <= share && lines.size() <= 2 * last.size() + 16)
+        return;
+
+      vector<pair<string, double> > kept;
+      for (unsigned int i = 0; i < lines.size(); ++i) {
+        if (last[lines[i].first] != i)
+          continue;
+        if (total > 0.9 * share) {
+          remove((_dir + lines[i].first).c_str());
+          total -= lines[i].second;
+        }
+        else
+          kept.push_back(lines[i]);
+      }
+
+      stringstream tmpName;
+      tmpName << indexName << ".tmp" << ++_count << '-' << rand();
+      {
+        ofstream ofs(tmpName.str().c_str());
+        for (unsigned int i = 0; i < kept.size(); ++i)
+          ofs << kept[i].first << ' ' << kept[i].second << '\n';
+      }
+      if (rename(tmpName.str().c_str(), indexName.c_str()) != 0) {
+        remove(indexName.c_str());
+        rename(tmpName.str().c_str(), indexName.c_str());
+      }
+    }
+  };
+
+  // The structure of the molecule, as it affects the result of an op
+  static void WriteStructure(ostream &os, OBMol &mol)
+  {
+    os << "dimension " << mol.GetDimension() << " charge " << mol.GetTotalCharge()
+       << " spin " << mol.GetTotalSpinMultiplicity() << '\n';
+    FOR_ATOMS_OF_MOL(atom, mol)
+      os << "atom " << atom->GetAtomicNum() << ' ' << atom->GetIsotope() << ' '
+         << atom->GetFormalCharge() << ' ' << atom->GetSpinMultiplicity() << ' '
+         << atom->GetImplicitHCount() << ' ' << atom->GetX() << ' '
+         << atom->GetY() << ' ' << atom->GetZ() << '\n';
+    FOR_BONDS_OF_MOL(bond, mol)
+      os << "bond " << bond->GetBeginAtomIdx() << ' ' << bond->GetEndAtomIdx() << ' '
+         << bond->GetBondOrder() << ' ' << bond->IsWedge() << bond->IsHash()
+         << bond->IsWedgeOrHash() << '\n';
+
+    // the stereo objects as they are, without perceiving them
+    vector<OBGenericData*> vdata = mol.GetAllData(OBGenericDataType::StereoData);
+    for (vector<OBGenericData*>::iterator data = vdata.begin(); data != vdata.end(); ++data) {
+      OBStereoBase *stereo = dynamic_cast<OBStereoBase*>(*data);
+      if (!stereo)
+        continue;
+      OBStereo::Refs refs;
+      switch (stereo->GetType()) {
+      case OBStereo::Tetrahedral: {
+        OBTetrahedralStereo::Config config = static_cast<OBTetrahedralStereo*>(stereo)->GetConfig();
+        os << "tetrahedral " << config.center << ' ' << config.from << ' ' << config.winding
+           << ' ' << config.view << ' ' << config.specified;
+        refs = config.refs;
+        break;
+      }
+      case OBStereo::CisTrans: {
+        OBCisTransStereo::Config config = static_cast<OBCisTransStereo*>(stereo)->GetConfig();
+        os << "cistrans " << config.begin << ' ' << config.end << ' ' << config.shape
+           << ' ' << config.specified;
+        refs = config.refs;
+        break;
+      }
+      case OBStereo::SquarePlanar: {
+        OBSquarePlanarStereo::Config config = static_cast<OBSquarePlanarStereo*>(stereo)->GetConfig();
+        os << "squareplanar " << config.center << ' ' << config.shape << ' ' << config.specified;
+        refs = config.refs;
+        break;
+      }
+      default:
+        continue;
+      }
+      for (OBStereo::Refs::iterator ref = refs.begin(); ref != refs.end(); ++ref)
+        os << ' ' << *ref;
+      os << '\n';
+    }
+  }
+
+  bool OBOp::DoCached(OBOp* pOp, OBBase* pOb, const char* OptionText, OpMap* pOptions, OBConversion* pConv)
+  {
+    OBMol *pmol = dynamic_cast<OBMol*>(pOb);
+    OBConversion conv;
+    if (!pmol || !conv.SetInAndOutFormats("obbin", "obbin")) {
+      obErrorLog.ThrowError(__FUNCTION__, "The obbin format is needed for --cache", obWarning, onceOnly);
+      return pOp->Do(pOb, OptionText, pOptions, pConv);
+    }
+
+    string dir = pOptions->find("cache")->second;
+    double maxBytes = 1000.0e6;
+    OpMap::const_iterator itr = pOptions->find("cachesize");
+    if (itr != pOptions->end() && atof(itr->second.c_str()) > 0.0)
+      maxBytes = atof(itr->second.c_str()) * 1.0e6;
+
+    stringstream key;
+    key.precision(17);
+    key << "op " << pOp->GetID() << ' ' << (OptionText ? OptionText : "") << '\n';
+    for (itr = pOptions->begin(); itr != pOptions->end(); ++itr)
+      if (itr->first != "cache" && itr->first != "cachesize")
+        key << "option " << itr->first << ' ' << itr->second << '\n';
+    WriteStructure(key, *pmol);
+
+    // One cache for each directory, shared by the threads of the process
+    static mutex cacheMutex;
+    static map<string, OBResultCache*> caches;
+    string value;
+    bool found;
+    {
+      lock_guard<mutex> lock(cacheMutex);
+      OBResultCache *&cache = caches[dir];
+      if (!cache)
+        cache = new OBResultCache(dir, maxBytes);
+      cache->SetMaxBytes(maxBytes);
+      found = cache->Find(key.str(), value);
+    }
+
+    if (found) {
+      // Read into a scratch molecule first, so that the molecule is not
+      // cleared by an entry which cannot be read
+      OBMol check;
+      if (conv.ReadString(&check, value)) {
+        string title = pmol->GetTitle(false);
+        vector<OBGenericData*> kept;
+        vector<OBGenericData*> vdata = pmol->GetAllData(OBGenericDataType::PairData);
+        for (vector<OBGenericData*>::iterator data = vdata.begin(); data != vdata.end(); ++data)
+          kept.push_back((*data)->Clone(nullptr));
+
+        conv.ReadString(pmol, value);
+        pmol->SetTitle(title);
+        for (vector<OBGenericData*>::iterator data = kept.begin(); data != kept.end(); ++data) {
+          if (pmol->HasData((*data)->GetAttribute()))
+            delete *data;
+          else
+            pmol->SetData(*data);
+        }
+        return true;
+      }
+      obErrorLog.ThrowError(__FUNCTION__, "An entry in the cache " + dir + " could not be read", obWarning);
+    }
+
+    if (!pOp->Do(pOb, OptionText, pOptions, pConv))
+      return false; // failures are not cached
+
+    value = conv.WriteString(pmol);
+    lock_guard<mutex> lock(cacheMutex);
+    if (!caches[dir]->Store(key.str(), value))
+      obErrorLog.ThrowError(__FUNCTION__, "Cannot write to the cache directory " + dir, obWarning, onceOnly);
+    return true;
+  }
 }
 
 
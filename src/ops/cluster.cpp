@@ -0,0 +1,202 @@
+/**********************************************************************
+cluster.cpp - A OBOp to cluster molecules by fingerprint similarity
+
+This file is part of the Open Babel project.
+For more information, see <http://openbabel.org/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+***********************************************************************/
+#include <openbabel/babelconfig.h>
+#include <openbabel/op.h>
+#include <openbabel/mol.h>
+#include <openbabel/generic.h>
+#include <openbabel/oberror.h>
+#include <openbabel/tokenst.h>
+#include <openbabel/obconversion.h>
+#include <openbabel/fingerprint.h>
+#include "deferred.h"
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace OpenBabel
+{
+using namespace std;
+
+class OpCluster : public OBOp
+{
+public:
+  OpCluster(const char* ID) : OBOp(ID, false), _threshold(0.7), _leader(false), _addToTitle(false), _pFP(nullptr)
+  {
+    OBConversion::RegisterOptionParam(ID, nullptr, 1, OBConversion::GENOPTIONS);
+  }
+  const char* Description(){ return
+    "[threshold] [fingerprint] [leader] Cluster by fingerprint similarity\n"
+    "The molecules are clustered with the Butina algorithm: the molecule with\n"
+    "the most neighbors (Tanimoto coefficient at least the threshold, default 0.7)\n"
+    "and its neighbors form the first cluster, and so on for the remaining\n"
+    "molecules. With 'leader' the molecules are taken in the input order instead.\n"
+    "The fingerprint is FP2 by default. Each molecule is given a property\n"
+    "'cluster' with the number of its cluster (1 is the largest) and a property\n"
+    "'centroid' which is 1 for the center of the cluster and 0 otherwise.\n"
+    "Follow the options with + to also add the cluster number to the title, e.g.\n"
+    "    obabel lib.sdf -O out.sdf --cluster \"0.6 ECFP4\"\n"
+    "    obabel lib.smi -osmi --cluster 0.8+\n"
+    "All the molecules are held in memory until the end of the conversion.\n"
+    "To cluster the entries of a fastsearch index use FastSearch::Cluster().\n"
+    ; }
+
+  virtual bool WorksWith(OBBase* pOb) const { return dynamic_cast<OBMol*>(pOb) != nullptr; }
+  virtual bool Do(OBBase* pOb, const char* OptionText=nullptr, OpMap* pOptions=nullptr, OBConversion* pConv=nullptr);
+  virtual bool ProcessVec(std::vector<OBBase*>& vec);
+
+private:
+  bool ParseOptions(const char* OptionText);
+  bool GetFingerprint(OBBase* pOb, std::vector<unsigned int>& fp) const;
+
+  double _threshold;
+  bool _leader;
+  bool _addToTitle;
+  OBFingerprint* _pFP;
+};
+
+/////////////////////////////////////////////////////////////////
+OpCluster theOpCluster("cluster"); //Global instance
+
+/////////////////////////////////////////////////////////////////
+bool OpCluster::Do(OBBase* pOb, const char* OptionText, OpMap* pOptions, OBConversion* pConv)
+{
+  if(pConv && pConv->IsFirstInput())
+  {
+    if(!ParseOptions(OptionText))
+      return false;
+    //Make a deferred format and divert the output to it
+    new DeferredFormat(pConv, this); //it will delete itself
+  }
+  return true;
+}
+
+bool OpCluster::ParseOptions(const char* OptionText)
+{
+  _threshold = 0.7;
+  _leader = false;
+  string fpid, text(OptionText ? OptionText : "");
+  _addToTitle = !text.empty() && text[text.size()-1]=='+';
+  if(_addToTitle)
+    text.erase(text.size()-1);
+  std::vector<std::string> vec;
+  tokenize(vec, text);
+  for(unsigned int i = 0; i < vec.size(); ++i)
+  {
+    if(vec[i]=="leader")
+      _leader = true;
+    else if(isdigit(vec[i][0]) || vec[i][0]=='.')
+      _threshold = atof(vec[i].c_str());
+    else
+      fpid = vec[i];
+  }
+
+  _pFP = OBFingerprint::FindFingerprint(fpid.c_str());
+  if(!_pFP)
+  {
+    obErrorLog.ThrowError(__FUNCTION__, "Unknown fingerprint " + fpid, obError, onceOnly);
+    return false;
+  }
+  if(_threshold <= 0.0 || _threshold > 1.0)
+  {
+    obErrorLog.ThrowError(__FUNCTION__, "The threshold of --cluster should be greater than 0 and not more than 1",
+                          obError, onceOnly);
+    return false;
+  }
+  return true;
+}
+
+// Some fingerprints (e.g. FP3) delete the hydrogens, so a copy is used
+// for molecules which have them
+bool OpCluster::GetFingerprint(OBBase* pOb, vector<unsigned int>& fp) const
+{
+  OBMol* pmol = static_cast<OBMol*>(pOb);
+  if(pmol->NumHvyAtoms() == pmol->NumAtoms())
+    return _pFP->GetFingerprint(pmol, fp);
+  OBMol mol(*pmol);
+  return _pFP->GetFingerprint(&mol, fp);
+}
+
+bool OpCluster::ProcessVec(std::vector<OBBase*>& vec)
+{
+  if(vec.empty() || !_pFP)
+    return true;
+
+  // The fingerprints in one buffer. The size is known from the first one,
+  // then the rest are made in parallel.
+  unsigned int n = vec.size();
+  vector<unsigned int> fp;
+  if(!GetFingerprint(vec[0], fp) || fp.empty())
+  {
+    obErrorLog.ThrowError(__FUNCTION__, "Could not make the fingerprints for --cluster", obError);
+    return false;
+  }
+  unsigned int words = fp.size();
+  vector<unsigned int> buffer((size_t)n*words);
+  copy(fp.begin(), fp.end(), buffer.begin());
+  int failures = 0;
+  int numMols = n;
+#ifdef _OPENMP
+  #pragma omp parallel for schedule(dynamic) reduction(+:failures)
+#endif
+  for(int i = 1; i < numMols; ++i)
+  {
+    vector<unsigned int> molfp;
+    if(GetFingerprint(vec[i], molfp) && molfp.size()==words)
+      copy(molfp.begin(), molfp.end(), buffer.begin() + (size_t)i*words);
+    else
+      ++failures;
+  }
+  if(failures)
+  {
+    stringstream ss;
+    ss << "The fingerprints of " << failures << " molecules could not be made and are empty";
+    obErrorLog.ThrowError(__FUNCTION__, ss.str(), obWarning);
+  }
+
+  vector<size_t> offsets;
+  vector<unsigned int> neighbors, clusters, centroids;
+  if(!FastSearch::FindNeighbors(&buffer[0], n, words, _threshold, offsets, neighbors))
+    return false;
+  vector<unsigned int>().swap(buffer);
+  FastSearch::ButinaCluster(offsets, neighbors, clusters, centroids, _leader);
+
+  for(unsigned int i = 0; i < n; ++i)
+  {
+    stringstream ss;
+    ss << clusters[i];
+    OBPairData* dp = new OBPairData;
+    dp->SetAttribute("cluster");
+    dp->SetValue(ss.str());
+    dp->SetOrigin(fileformatInput);
+    vec[i]->SetData(dp);
+    dp = new OBPairData;
+    dp->SetAttribute("centroid");
+    dp->SetValue(centroids[clusters[i]-1]==i ? "1" : "0");
+    dp->SetOrigin(fileformatInput);
+    vec[i]->SetData(dp);
+    if(_addToTitle)
+      vec[i]->SetTitle((string(vec[i]->GetTitle()) + ' ' + ss.str()).c_str());
+  }
+
+  stringstream ss;
+  ss << n << " molecules in " << centroids.size() << " clusters, with "
+     << neighbors.size() / 2 << " pairs of neighbors";
+  obErrorLog.ThrowError(__FUNCTION__, ss.str(), obInfo);
+  return true;
+}
+
+} //namespace
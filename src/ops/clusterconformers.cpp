@@ -0,0 +1,341 @@
+/**********************************************************************
+clusterconformers.cpp - A OBOp to remove redundant conformers by clustering
+
+This file is part of the Open Babel project.
+For more information, see <http://openbabel.org/>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation version 2 of the License.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+***********************************************************************/
+#include <openbabel/babelconfig.h>
+#include <openbabel/op.h>
+#include <openbabel/mol.h>
+#include <openbabel/atom.h>
+#include <openbabel/bond.h>
+#include <openbabel/obiter.h>
+#include <openbabel/oberror.h>
+#include <openbabel/elements.h>
+#include <openbabel/tokenst.h>
+#include <openbabel/obconversion.h>
+#include <openbabel/math/align.h> // ** This requires Eigen to be installed **
+#include "deferred.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace OpenBabel
+{
+using namespace std;
+
+class OpClusterConformers : public OBOp
+{
+public:
+  OpClusterConformers(const char* ID) : OBOp(ID, false), _threshold(-1.0), _torsion(false), _pDeferred(nullptr) {}
+  const char* Description(){ return
+    "<threshold> [rmsd|torsion] Keep one conformer per cluster\n"
+    "The conformers of each molecule are clustered with the Butina algorithm:\n"
+    "the conformer with the most neighbors (closer than the threshold) and its\n"
+    "neighbors form the first cluster, and so on for the remaining conformers.\n"
+    "One conformer of each cluster is kept; if the conformers have energies,\n"
+    "this is the one with the lowest energy, otherwise the cluster center.\n"
+    "The distance is either the symmetry corrected heavy atom RMSD after\n"
+    "superposition (default threshold 0.5 Angstrom), or with 'torsion' the\n"
+    "largest difference between the torsion angles of the rotatable bonds\n"
+    "(default threshold 30 degrees, symmetry is not taken into account).\n"
+    "This option acts after the other options (e.g. --conformer) and each\n"
+    "remaining conformer is output as a separate molecule, e.g.\n"
+    "    obabel mol.sdf -O confs.sdf --conformer --nconf 500 --cluster-conformers 0.5\n"
+    "    obabel confs.sdf -O out.sdf --readconformer --cluster-conformers 45 torsion\n"
+    ; }
+
+  virtual bool WorksWith(OBBase* pOb) const { return dynamic_cast<OBMol*>(pOb) != nullptr; }
+  virtual bool Do(OBBase* pOb, const char* OptionText=nullptr, OpMap* pOptions=nullptr, OBConversion* pConv=nullptr);
+  virtual bool ProcessVec(std::vector<OBBase*>& vec);
+
+private:
+  void ParseOptions(const char* OptionText);
+  void FindNeighbors(OBMol &mol, vector<vector<unsigned int> > &nbrs) const;
+  void Cluster(OBMol &mol) const;
+
+  double _threshold;
+  bool _torsion;
+  OBFormat* _pDeferred;
+};
+
+/////////////////////////////////////////////////////////////////
+OpClusterConformers theOpClusterConformers("cluster-conformers"); //Global instance
+
+/////////////////////////////////////////////////////////////////
+bool OpClusterConformers::Do(OBBase* pOb, const char* OptionText, OpMap* pOptions, OBConversion* pConv)
+{
+  if(OptionText && !strcmp(OptionText, "inactive"))
+    return true;
+
+  OBMol* pmol = dynamic_cast<OBMol*>(pOb);
+  if(!pmol)
+    return false;
+
+  // Called from the API
+  if(!pConv)
+  {
+    ParseOptions(OptionText);
+    Cluster(*pmol);
+    return true;
+  }
+
+  if(!_pDeferred || pConv->GetOutFormat()!=_pDeferred)
+  {
+    //First molecule. As in OpLargest, this op is made inactive for the normal
+    //calls and a DeferredFormat calls it after all the other options have
+    //been applied (e.g. --conformer or --readconformer).
+    ParseOptions(OptionText);
+    pConv->AddOption(GetID(), OBConversion::GENOPTIONS, "inactive");
+    _pDeferred = new DeferredFormat(pConv, this, true); //it will delete itself
+    return true;
+  }
+
+  // All molecules (called from DeferredFormat)
+  Cluster(*pmol);
+  return true; //stored in DeferredFormat
+}
+
+bool OpClusterConformers::ProcessVec(std::vector<OBBase*>& vec)
+{
+  _pDeferred = nullptr; //the DeferredFormat deletes itself after the output
+
+  // Output each remaining conformer as a separate molecule, since the
+  // conversion options (e.g. --writeconformers) are not applied anymore.
+  std::vector<OBBase*> out;
+  for(std::vector<OBBase*>::iterator iter=vec.begin(); iter!=vec.end(); ++iter)
+  {
+    OBMol* pmol = dynamic_cast<OBMol*>(*iter);
+    if(!pmol || pmol->NumConformers() < 2)
+    {
+      out.push_back(*iter);
+      continue;
+    }
+
+    std::vector<double> energies = pmol->GetEnergies();
+    for(int c = 0; c < pmol->NumConformers(); ++c)
+    {
+      OBMol* pconf = new OBMol(*pmol);
+      double *coords = new double [pmol->NumAtoms() * 3];
+      pmol->CopyConformer(coords, c);
+      std::vector<double*> confs(1, coords);
+      pconf->SetConformers(confs);
+      if((unsigned int)c < energies.size())
+      {
+        std::vector<double> energy(1, energies[c]);
+        pconf->SetEnergies(energy);
+        pconf->SetEnergy(energies[c]);
+      }
+      out.push_back(pconf);
+    }
+    delete pmol;
+  }
+  vec.swap(out);
+  return true;
+}
+
+void OpClusterConformers::ParseOptions(const char* OptionText)
+{
+  _torsion = false;
+  _threshold = -1.0;
+  std::vector<std::string> vec;
+  if(OptionText)
+    tokenize(vec, OptionText);
+  for(unsigned int i = 0; i < vec.size(); ++i)
+  {
+    if(vec[i]=="torsion")
+      _torsion = true;
+    else if(vec[i]=="rmsd")
+      _torsion = false;
+    else
+      _threshold = atof(vec[i].c_str());
+  }
+  if(_threshold <= 0.0)
+    _threshold = _torsion ? 30.0 : 0.5;
+}
+
+// Circular difference between two angles in degrees
+static double AngleDifference(double a, double b)
+{
+  double diff = fabs(a - b);
+  while(diff > 360.0)
+    diff -= 360.0;
+  return diff > 180.0 ? 360.0 - diff : diff;
+}
+
+void OpClusterConformers::FindNeighbors(OBMol &mol, vector<vector<unsigned int> > &nbrs) const
+{
+  unsigned int n = mol.NumConformers();
+  nbrs.clear();
+  nbrs.resize(n);
+
+  if(!_torsion)
+  {
+    OBRMSDMatrix matrix;
+    matrix.SetRefMol(mol);
+    for(unsigned int c = 0; c < n; ++c)
+    {
+      mol.SetConformer(c);
+      matrix.AddMol(mol);
+    }
+
+    // Only keep the neighbors, a block of rows at a time
+    const unsigned int blockSize = 64;
+    vector<vector<double> > rows;
+    for(unsigned int first = 0; first < n; first += blockSize)
+    {
+      matrix.ComputeRows(first, first + blockSize, rows);
+      for(unsigned int r = 0; r < rows.size(); ++r)
+        for(unsigned int k = 0; k < rows[r].size(); ++k)
+          if(rows[r][k] <= _threshold)
+          {
+            unsigned int i = first + r;
+            unsigned int j = i + k + 1;
+            nbrs[i].push_back(j);
+            nbrs[j].push_back(i);
+          }
+    }
+    return;
+  }
+
+  // Torsion angles of the rotatable bonds, defined by the lowest index
+  // heavy atom neighbor on each side.
+  vector<vector<unsigned int> > torsions;
+  FOR_BONDS_OF_MOL(bond, mol)
+  {
+    if(!bond->IsRotor())
+      continue;
+    OBAtom *b = bond->GetBeginAtom();
+    OBAtom *c = bond->GetEndAtom();
+    OBAtom *a = nullptr, *d = nullptr;
+    FOR_NBORS_OF_ATOM(nbr, b)
+      if(&*nbr != c && nbr->GetAtomicNum() != OBElements::Hydrogen && (!a || nbr->GetIdx() < a->GetIdx()))
+        a = &*nbr;
+    FOR_NBORS_OF_ATOM(nbr, c)
+      if(&*nbr != b && nbr->GetAtomicNum() != OBElements::Hydrogen && (!d || nbr->GetIdx() < d->GetIdx()))
+        d = &*nbr;
+    if(!a || !d)
+      continue;
+    vector<unsigned int> torsion(4);
+    torsion[0] = a->GetIdx();
+    torsion[1] = b->GetIdx();
+    torsion[2] = c->GetIdx();
+    torsion[3] = d->GetIdx();
+    torsions.push_back(torsion);
+  }
+
+  vector<vector<double> > angles(n, vector<double>(torsions.size()));
+  for(unsigned int c = 0; c < n; ++c)
+  {
+    mol.SetConformer(c);
+    for(unsigned int t = 0; t < torsions.size(); ++t)
+      angles[c][t] = mol.GetTorsion(torsions[t][0], torsions[t][1], torsions[t][2], torsions[t][3]);
+  }
+
+  // The upper triangle, in parallel
+  vector<vector<unsigned int> > upper(n);
+  int numRows = n;
+#ifdef _OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for(int i = 0; i < numRows; ++i)
+    for(unsigned int j = i + 1; j < n; ++j)
+    {
+      double dist = 0.0;
+      for(unsigned int t = 0; t < torsions.size() && dist <= _threshold; ++t)
+        dist = std::max(dist, AngleDifference(angles[i][t], angles[j][t]));
+      if(dist <= _threshold)
+        upper[i].push_back(j);
+    }
+
+  for(unsigned int i = 0; i < n; ++i)
+    for(unsigned int k = 0; k < upper[i].size(); ++k)
+    {
+      nbrs[i].push_back(upper[i][k]);
+      nbrs[upper[i][k]].push_back(i);
+    }
+}
+
+void OpClusterConformers::Cluster(OBMol &mol) const
+{
+  unsigned int n = mol.NumConformers();
+  if(n < 2)
+    return;
+
+  std::vector<double> energies = mol.GetEnergies();
+  bool hasEnergies = energies.size() == n;
+
+  vector<vector<unsigned int> > nbrs;
+  FindNeighbors(mol, nbrs);
+
+  // Conformers by decreasing number of neighbors (then by increasing energy)
+  vector<pair<pair<int, double>, unsigned int> > order;
+  for(unsigned int i = 0; i < n; ++i)
+    order.push_back(make_pair(make_pair(-static_cast<int>(nbrs[i].size()), hasEnergies ? energies[i] : 0.0), i));
+  std::sort(order.begin(), order.end());
+
+  vector<bool> assigned(n, false);
+  vector<unsigned int> keep;
+  for(unsigned int o = 0; o < n; ++o)
+  {
+    unsigned int center = order[o].second;
+    if(assigned[center])
+      continue;
+    assigned[center] = true;
+    unsigned int representative = center;
+    for(unsigned int k = 0; k < nbrs[center].size(); ++k)
+    {
+      unsigned int j = nbrs[center][k];
+      if(assigned[j])
+        continue;
+      assigned[j] = true;
+      if(hasEnergies && energies[j] < energies[representative])
+        representative = j;
+    }
+    keep.push_back(representative);
+  }
+
+  if(hasEnergies)
+  {
+    vector<pair<double, unsigned int> > byEnergy;
+    for(unsigned int k = 0; k < keep.size(); ++k)
+      byEnergy.push_back(make_pair(energies[keep[k]], keep[k]));
+    std::sort(byEnergy.begin(), byEnergy.end());
+    for(unsigned int k = 0; k < keep.size(); ++k)
+      keep[k] = byEnergy[k].second;
+  }
+
+  std::vector<double*> confs;
+  std::vector<double> keptEnergies;
+  for(unsigned int k = 0; k < keep.size(); ++k)
+  {
+    double *coords = new double [mol.NumAtoms() * 3];
+    mol.CopyConformer(coords, keep[k]);
+    confs.push_back(coords);
+    if(hasEnergies)
+      keptEnergies.push_back(energies[keep[k]]);
+  }
+  mol.SetConformers(confs);
+  if(hasEnergies)
+  {
+    mol.SetEnergies(keptEnergies);
+    mol.SetEnergy(keptEnergies[0]);
+  }
+
+  std::stringstream ss;
+  ss << mol.GetTitle() << ": kept " << keep.size() << " of " << n << " conformers";
+  obErrorLog.ThrowError(__FUNCTION__, ss.str(), obInfo);
+}
+
+} //namespace
@@ -88,6 +88,10 @@ namespace OpenBabel
         return dynamic_cast<OBMol*>(pOb) != nullptr;
       }
       virtual bool Do(OBBase* pOb, const char* OptionText, OpMap* pmap, OBConversion*);
+      virtual bool Cacheable(const char* /*OptionText*/, OpMap* pmap) const
+      {
+        return pmap->find("log") == pmap->end() && pmap->find("printrot") == pmap->end();
+      }
   };
 
   //////////////////////////////////////////////////////////
@@ -38,6 +38,7 @@ public:
 
   virtual bool WorksWith(OBBase* pOb) const { return dynamic_cast<OBMol*>(pOb) != nullptr; }
   virtual bool Do(OBBase* pOb, const char* OptionText=nullptr, OpMap* pOptions=nullptr, OBConversion* pConv=nullptr);
+  virtual bool Cacheable(const char* /*OptionText*/, OpMap* /*pOptions*/) const { return true; }
 };
 
 /////////////////////////////////////////////////////////////////
@@ -100,6 +101,13 @@ bool OpGen3D::Do(OBBase* pOb, const char* OptionText, OpMap* pOptions, OBConvers
   else if (speed > 5)
     speed = 5;
 
+#ifdef HAVE_EIGEN
+  // Without the builder, the bounds only depend on the molecule, so they are
+  // set up and smoothed once and each trial only adds a new embedding.
+  OBDistanceGeometry dg;
+  bool isDistGeomSetup = false;
+#endif
+
   bool success = false;
   unsigned int maxIter = 25;
   for (unsigned int trial = 0; trial < maxIter; trial++) {
@@ -114,10 +122,20 @@ bool OpGen3D::Do(OBBase* pOb, const char* OptionText, OpMap* pOptions, OBConvers
     }
 
 #ifdef HAVE_EIGEN
-    OBDistanceGeometry dg;
-    if (useDistGeom) {
-      // use the bond lengths and angles if we ran the builder
-      if (!dg.GetGeometry(molCopy, attemptBuild)) // ensured to have correct stereo
+    if (useDistGeom && attemptBuild) {
+      // use the bond lengths and angles of the builder
+      OBDistanceGeometry builderDG;
+      if (!builderDG.GetGeometry(molCopy, true)) // ensured to have correct stereo
+        continue;
+      speed = 3;
+    } else if (useDistGeom) {
+      molCopy.AddHydrogens();
+      if (!isDistGeomSetup)
+        isDistGeomSetup = dg.Setup(molCopy);
+      if (!isDistGeomSetup)
+        continue;
+      dg.AddConformer();
+      if (!dg.GetLastConformer(molCopy)) // ensured to have correct stereo
         continue;
       speed = 3;
     }
@@ -39,6 +39,11 @@ public:
 
   virtual bool WorksWith(OBBase* pOb) const { return dynamic_cast<OBMol*>(pOb) != nullptr; }
   virtual bool Do(OBBase* pOb, const char* OptionText=nullptr, OpMap* pOptions=nullptr, OBConversion* pConv=nullptr);
+  // the charges are not printed for results from the cache
+  virtual bool Cacheable(const char* /*OptionText*/, OpMap* pOptions) const
+  {
+    return pOptions->find("print") == pOptions->end();
+  }
 
   OBChargeModel *_pChargeModel;
 };
@@ -107,7 +107,9 @@ bool OpSort::Do(OBBase* pOb, const char* OptionText, OpMap* pmap, OBConversion*
 bool OpSort::ProcessVec(std::vector<OBBase*>& vec)
 {
   // Make a vector containing both the OBBase* and the descriptor value and the sort it
-  if(!IsNan(_pDesc->Predict(vec[0], &_pDescOption)))
+  // The values are memoized on the molecules, e.g. from --append or --filter
+  std::string s;
+  if(!IsNan(_pDesc->GetCachedValue(vec[0], s, &_pDescOption)))
   {
     //a numerical descriptor
     //Copy into a pair vector
@@ -115,7 +117,7 @@ bool OpSort::ProcessVec(std::vector<OBBase*>& vec)
     valvec.reserve(vec.size());
     std::vector<OBBase*>::iterator iter;
     for(iter=vec.begin();iter!=vec.end();++iter)
-      valvec.push_back(std::make_pair<OBBase*,double>(&(**iter), _pDesc->Predict(*iter, &_pDescOption)));
+      valvec.push_back(std::make_pair<OBBase*,double>(&(**iter), _pDesc->GetCachedValue(*iter, s, &_pDescOption)));
 
     //Sort
     std::sort(valvec.begin(),valvec.end(), Order<double>(_pDesc, _rev));
@@ -141,7 +143,6 @@ bool OpSort::ProcessVec(std::vector<OBBase*>& vec)
     std::vector<std::pair<OBBase*,std::string> > valvec;
     valvec.reserve(vec.size());
     std::vector<OBBase*>::iterator iter;
-    std::string s;
     for(iter=vec.begin();iter!=vec.end();++iter)
     {
       _pDesc->GetStringValue(*iter, s, &_pDescOption);
@@ -165,8 +165,9 @@ namespace OpenBabel
   {
     atm_typ.resize(mol.NumAtoms()+1);
 
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::PATTY::AssignTypes", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::PATTY::AssignTypes", obAuditMsg);
 
     for (unsigned int i = 0; i < _sp.size(); ++i)
       {
@@ -200,8 +201,9 @@ namespace OpenBabel
   {
     atm_typ.resize(mol.NumAtoms()+1);
 
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::PATTY::AssignTypes", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::PATTY::AssignTypes", obAuditMsg);
 
     for (unsigned int i = 0; i < _sp.size(); ++i)
       {
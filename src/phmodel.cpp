@@ -156,8 +156,9 @@ namespace OpenBabel
 
     mol.SetCorrectedForPH();
 
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::CorrectForPH", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::CorrectForPH", obAuditMsg);
 
     mol.DeleteHydrogens();
 
@@ -306,13 +307,15 @@ namespace OpenBabel
 
   bool OBChemTsfm::Apply(OBMol &mol)
   {
-    if (!_bgn.Match(mol))
+    // the pattern is shared, so the matches are kept in mlist
+    vector<vector<int> > mlist;
+    if (!_bgn.Match(mol, mlist, OBSmartsPattern::AllUnique))
       return(false);
     mol.BeginModify();
-    vector<vector<int> > mlist = _bgn.GetUMapList();
 
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::OBChemTransform", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::OBChemTransform", obAuditMsg);
 
     if (!_vchrg.empty()) //modify charges
       {
@@ -30,6 +30,7 @@ GNU General Public License for more details.
 #include <cmath>
 #include <cstring>
 #include <algorithm>
+#include <unordered_map>
 
 #ifndef M_PI
 #define M_PI 3.1415926535897932384626433832795028841971694
@@ -190,6 +191,13 @@ namespace OpenBabel {
       StatAccept            = 0 ;
 
       Setup                 = false;
+      AtomGridValid         = false;
+    }
+
+    ~PointGroupPrivate()
+    {
+      clear_symmetry_elements() ;
+      free( DistanceFromCenter ) ;
     }
 
     OBMol  *               _mol;
@@ -223,6 +231,34 @@ namespace OpenBabel {
     std::vector< std::pair<int, int> > PairedAtoms;
     bool                   Setup;
 
+    /*
+     *    Atoms sorted by type and distance from the center. Only atoms
+     *    inside the window [ClassBegin[i], ClassEnd[i]) of ClassOrder can be
+     *    images of atom i under any symmetry operation.
+     */
+    std::vector<unsigned int> ClassOrder ;
+    std::vector<unsigned int> ClassBegin ;
+    std::vector<unsigned int> ClassEnd   ;
+
+    /*
+     *    Atoms the axis searches start from. Any proper or improper axis
+     *    moves at least one of them, so candidates need only be built
+     *    from these and their windows. All atoms unless a small enough
+     *    class is found.
+     */
+    std::vector<unsigned int> ReferenceAtoms ;
+    std::vector<char>         IsReferenceAtom ;
+    bool                      ReferenceSubset ;
+
+    /*
+     *    Spatial hash of the atom positions (cell size TolerancePrimary):
+     *    (cell key, atom index) pairs sorted by key, and the position of
+     *    the first pair of each occupied cell
+     */
+    std::vector< std::pair<long long, unsigned int> > AtomGrid;
+    std::unordered_map<long long, unsigned int>      AtomGridCells;
+    bool                   AtomGridValid;
+
     /*
      *    Statistics
      */
@@ -248,6 +284,48 @@ namespace OpenBabel {
       return true;
     }
 
+    bool equivalentAtomsLess(OBAtom &a1, OBAtom &a2)
+    {
+      if (a1.GetAtomicNum() != a2.GetAtomicNum())
+        return a1.GetAtomicNum() < a2.GetAtomicNum();
+      if (a1.GetIsotope() != a2.GetIsotope())
+        return a1.GetIsotope() < a2.GetIsotope();
+      if (a1.GetFormalCharge() != a2.GetFormalCharge())
+        return a1.GetFormalCharge() < a2.GetFormalCharge();
+      return a1.GetSpinMultiplicity() < a2.GetSpinMultiplicity();
+    }
+
+    long long
+    grid_cell( double x )
+    {
+      return ((long long)floor( x / TolerancePrimary ) + (1 << 20)) & 0x1FFFFF ;
+    }
+
+    long long
+    grid_key( long long cx, long long cy, long long cz )
+    {
+      return ((cx & 0x1FFFFF) << 42) | ((cy & 0x1FFFFF) << 21) | (cz & 0x1FFFFF) ;
+    }
+
+    void
+    build_atom_grid( void )
+    {
+      unsigned int i;
+      OBAtom      *atom;
+
+      AtomGrid.resize( _mol->NumAtoms() ) ;
+      for( i = 0 ; i < _mol->NumAtoms() ; i++ ){
+        atom = _mol->GetAtom(i+1);
+        AtomGrid[i].first  = grid_key( grid_cell(atom->x()), grid_cell(atom->y()), grid_cell(atom->z()) ) ;
+        AtomGrid[i].second = i ;
+      }
+      std::sort( AtomGrid.begin(), AtomGrid.end() ) ;
+      AtomGridCells.clear() ;
+      for( i = _mol->NumAtoms() ; i > 0 ; i-- ) /* first entry of each cell */
+        AtomGridCells[ AtomGrid[i-1].first ] = i - 1 ;
+      AtomGridValid = true ;
+    }
+
     int
     establish_pairs( SYMMETRY_ELEMENT *elem )
     {
@@ -256,6 +334,10 @@ namespace OpenBabel {
       double            distance, best_distance ;
       OBAtom            symmetric;
       OBAtom            *atom;
+      long long         cx, cy, cz, key ;
+      int               dx, dy, dz ;
+      std::unordered_map<long long, unsigned int>::const_iterator cell ;
+      unsigned int      p ;
 
       PairedAtoms.clear();
 
@@ -263,6 +345,8 @@ namespace OpenBabel {
         //        fprintf( stderr, "Out of memory for tagging array in establish_pairs()\n" ) ;
         return 0;
       }
+      if( !AtomGridValid )
+        build_atom_grid() ;
       for( i = 0 ; i < _mol->NumAtoms() ; i++ ){
         if( elem->transform[i] >= _mol->NumAtoms() ){ /* No symmetric atom yet          */
           if( verbose > 2 ) printf( "        looking for a pair for %d\n", i ) ;
@@ -271,18 +355,33 @@ namespace OpenBabel {
                                     symmetric.x(), symmetric.y(), symmetric.z() ) ;
           best_j        = i ;
           best_distance = 2*TolerancePrimary ;/* Performance value we'll reject */
-          for( j = 0 ; j < _mol->NumAtoms() ; j++ ){
-
-            atom = _mol->GetAtom(j+1);
-            // START here
-            if( atom_used[j] || !equivalentAtoms(*atom, symmetric) )
+          /*
+           *  Only atoms in the 27 grid cells around the image can be closer
+           *  than TolerancePrimary; ties go to the lowest index, as in a
+           *  full scan.
+           */
+          cx = grid_cell( symmetric.x() ) ;
+          cy = grid_cell( symmetric.y() ) ;
+          cz = grid_cell( symmetric.z() ) ;
+          for( dx = -1 ; dx <= 1 ; dx++ )
+          for( dy = -1 ; dy <= 1 ; dy++ )
+          for( dz = -1 ; dz <= 1 ; dz++ ){
+            key  = grid_key( cx + dx, cy + dy, cz + dz ) ;
+            cell = AtomGridCells.find( key ) ;
+            if( cell == AtomGridCells.end() )
               continue ;
+            for( p = cell->second ; p < AtomGrid.size() && AtomGrid[p].first == key ; p++ ){
+              j    = AtomGrid[p].second ;
+              atom = _mol->GetAtom(j+1);
+              if( atom_used[j] || !equivalentAtoms(*atom, symmetric) )
+                continue ;
 
-            distance = symmetric.GetDistance(atom) ;
-            if( verbose > 2 ) printf( "        distance to %d is %g\n", j, distance ) ;
-            if( distance < best_distance ){
-              best_j        = j ;
-              best_distance = distance ;
+              distance = (symmetric.GetVector() - atom->GetVector()).length() ;
+              if( verbose > 2 ) printf( "        distance to %d is %g\n", j, distance ) ;
+              if( distance < best_distance || ( distance == best_distance && j < best_j ) ){
+                best_j        = j ;
+                best_distance = distance ;
+              }
             }
           }
           if( best_distance > TolerancePrimary ){ /* Too bad, there is no symmetric atom */
@@ -363,6 +462,34 @@ namespace OpenBabel {
       return code ;
     }
 
+    /*
+     *  Cheap duplicate test, done before the correspondence table of a new
+     *  element is built: if elem moves every atom to within ToleranceSame of
+     *  its image under an already accepted element, both would produce the
+     *  same table.
+     */
+    int
+    same_as_known( SYMMETRY_ELEMENT *elem, SYMMETRY_ELEMENT **known, int count )
+    {
+      int               k ;
+      unsigned int      i ;
+      OBAtom            symmetric ;
+
+      for( k = 0 ; k < count ; k++ ){
+        if( ( known[k]->order != elem->order ) || ( known[k]->nparam != elem->nparam ) ||
+            ( known[k]->transform_atom != elem->transform_atom ) )
+          continue ;
+        for( i = 0 ; i < _mol->NumAtoms() ; i++ ){
+          elem->transform_atom( elem, _mol->GetAtom(i+1), &symmetric ) ;
+          if( (symmetric.GetVector() - _mol->GetAtom(known[k]->transform[i]+1)->GetVector()).length() > ToleranceSame )
+            break ;
+        }
+        if( i == _mol->NumAtoms() )
+          return 1 ;
+      }
+      return 0 ;
+    }
+
     SYMMETRY_ELEMENT *
     alloc_symmetry_element( void )
     {
@@ -406,7 +533,7 @@ namespace OpenBabel {
         j = elem->transform[i] ;
         elem->transform_atom( elem, _mol->GetAtom(i+1), &symmetric ) ;
 
-        r = symmetric.GetDistance(_mol->GetAtom(j+1));
+        r = (symmetric.GetVector() - _mol->GetAtom(j+1)->GetVector()).length();
         if( r > ToleranceFinal ){
           if( verbose > 0 ) printf( "        distance to symmetric atom (%g) is too big for %d\n", r, i ) ;
           return -1 ;
@@ -459,7 +586,7 @@ namespace OpenBabel {
       for( i = 0, target = maxr = 0 ; i < _mol->NumAtoms() ; i++ ){
         elem->transform_atom( elem, _mol->GetAtom(i+1), &symmetric ) ;
         j = elem->transform[i] ;
-        r = symmetric.GetDistance(_mol->GetAtom(j+1));
+        r = (symmetric.GetVector() - _mol->GetAtom(j+1)->GetVector()).length();
         if( r > maxr ) maxr = r ;
         target += r ;
       }
@@ -610,6 +737,13 @@ namespace OpenBabel {
       int               i ;
 
 
+      if( build_table && ( same_as_known( elem, Planes, PlanesCount ) ||
+                           same_as_known( elem, NormalAxes, NormalAxesCount ) ||
+                           same_as_known( elem, ImproperAxes, ImproperAxesCount ) ) ){
+        StatDups++ ;
+        if( verbose > 0 ) printf( "        transformation is identical to a known element\n" ) ;
+        return -1 ;
+      }
       if( build_table && (establish_pairs( elem ) < 0) ){
         StatPairs++ ;
         if( verbose > 0 ) printf( "        no transformation correspondence table can be constructed\n" ) ;
@@ -922,8 +1056,8 @@ namespace OpenBabel {
       for( i = 0 ; i < _mol->NumAtoms() ; i++ ){
 
         rel[0] = _mol->GetAtom(i+1)->x() - CenterOfSomething[0];
-        rel[1] = _mol->GetAtom(i+1)->z() - CenterOfSomething[1];
-        rel[2] = _mol->GetAtom(i+1)->y() - CenterOfSomething[2];
+        rel[1] = _mol->GetAtom(i+1)->y() - CenterOfSomething[1];
+        rel[2] = _mol->GetAtom(i+1)->z() - CenterOfSomething[2];
 
         s = rel[0]*dir[0] + rel[1]*dir[1] + rel[2]*dir[2];
 
@@ -972,6 +1106,7 @@ namespace OpenBabel {
       int                k ;
       double             ris, rjs ;
       double             r, center[ DIMENSION ] ;
+      OBAtom             symmetric ;
 
       if( verbose > 0 )
         printf( "Trying c2 axis for the pair (%d,%d) with the support (%g,%g,%g)\n",
@@ -1045,6 +1180,14 @@ namespace OpenBabel {
         for( k = 0 ; k < DIMENSION ; k++ )
           axis->direction[k] = center[k]/r ;
       }
+      /* The axis must at least exchange the pair it was built from */
+      rotate_atom( axis, _mol->GetAtom(i+1), &symmetric ) ;
+      if( (symmetric.GetVector() - _mol->GetAtom(j+1)->GetVector()).length() > TolerancePrimary ){
+        StatEarly++ ;
+        if( verbose > 0 ) printf( "    axis does not exchange the pair\n" ) ;
+        destroy_symmetry_element( axis ) ;
+        return nullptr;
+      }
       if( refine_symmetry_element( axis, 1 ) < 0 ){
         if( verbose > 0 ) printf( "    refinement failed for the c2 axis\n" ) ;
         destroy_symmetry_element( axis ) ;
@@ -1310,13 +1453,16 @@ namespace OpenBabel {
         coord_sum[j] = 0 ;
       for( i = 0 ; i < _mol->NumAtoms() ; i++ ){
         atom = _mol->GetAtom(i+1);
-        coord_sum[0] = atom->x() + atom->y() + atom->z();
+        coord_sum[0] += atom->x();
+        coord_sum[1] += atom->y();
+        coord_sum[2] += atom->z();
       }
       for( j = 0 ; j < DIMENSION ; j++ )
         CenterOfSomething[j] = coord_sum[j]/_mol->NumAtoms() ;
       if( verbose > 0 )
         printf( "Center of something is at %15.10f, %15.10f, %15.10f\n",
                 CenterOfSomething[0], CenterOfSomething[1], CenterOfSomething[2] ) ;
+      free( DistanceFromCenter ) ;
       DistanceFromCenter = (double *) calloc( _mol->NumAtoms(), sizeof( double ) ) ;
       if (DistanceFromCenter == nullptr) {
         //        fprintf( stderr, "Unable to allocate array for the distances\n" ) ;
@@ -1330,12 +1476,93 @@ namespace OpenBabel {
 
         DistanceFromCenter[i] = r ;
       }
+      build_equivalence_classes() ;
     }
 
+    /*
+     *   Any symmetry element maps an atom onto an atom of the same type
+     *   at the same distance from the center. Sort the atoms by type and
+     *   distance, and record for each atom the window of ClassOrder holding
+     *   its candidate images, so that the searches below only pair up
+     *   atoms which can actually be exchanged.
+     */
+    void
+    build_equivalence_classes( void )
+    {
+      unsigned int        n = _mol->NumAtoms() ;
+      unsigned int        p, run, end ;
+      std::vector<double> sorted( n ) ;
+
+      ClassOrder.resize( n ) ;
+      ClassBegin.resize( n ) ;
+      ClassEnd.resize( n ) ;
+      for( p = 0 ; p < n ; p++ )
+        ClassOrder[p] = p ;
+      std::sort( ClassOrder.begin(), ClassOrder.end(), ClassLess( this ) ) ;
+      for( p = 0 ; p < n ; p++ )
+        sorted[p] = DistanceFromCenter[ ClassOrder[p] ] ;
+
+      for( run = 0 ; run < n ; run = end ){
+        for( end = run + 1 ; end < n ; end++ )
+          if( !equivalentAtoms(*_mol->GetAtom(ClassOrder[run]+1), *_mol->GetAtom(ClassOrder[end]+1)) )
+            break ;
+        for( p = run ; p < end ; p++ ){
+          ClassBegin[ ClassOrder[p] ] = std::lower_bound( sorted.begin() + run, sorted.begin() + end,
+                                                          sorted[p] - TolerancePrimary ) - sorted.begin() ;
+          ClassEnd[ ClassOrder[p] ]   = std::upper_bound( sorted.begin() + run, sorted.begin() + end,
+                                                          sorted[p] + TolerancePrimary ) - sorted.begin() ;
+        }
+      }
+
+      /*
+       *  An axis through the center holds at most two atoms of a class
+       *  lying away from the center, so it moves one of any three of them.
+       *  Take three atoms of the smallest such class as the references.
+       */
+      unsigned int best = n, best_size = n + 1 ;
+      for( p = 0 ; p < n ; p++ ){
+        if( DistanceFromCenter[p] <= SQUARE( TolerancePrimary ) || ClassEnd[p] - ClassBegin[p] < 3 )
+          continue ;
+        if( ClassEnd[p] - ClassBegin[p] < best_size ){
+          best      = p ;
+          best_size = ClassEnd[p] - ClassBegin[p] ;
+        }
+      }
+      ReferenceAtoms.clear() ;
+      IsReferenceAtom.assign( n, 0 ) ;
+      ReferenceSubset = ( best < n ) ;
+      for( p = 0 ; p < n ; p++ ){
+        if( ReferenceSubset ){
+          if( p == 3 )
+            break ;
+          run = ClassOrder[ ClassBegin[best] + p ] ;
+        }
+        else
+          run = p ;
+        ReferenceAtoms.push_back( run ) ;
+        IsReferenceAtom[run] = 1 ;
+      }
+    }
+
+    struct ClassLess
+    {
+      PointGroupPrivate *d ;
+      ClassLess( PointGroupPrivate *pg ) : d( pg ) {}
+      bool operator()( unsigned int i, unsigned int j ) const
+      {
+        OBAtom *a1 = d->_mol->GetAtom(i+1), *a2 = d->_mol->GetAtom(j+1) ;
+        if( !d->equivalentAtoms(*a1, *a2) )
+          return d->equivalentAtomsLess(*a1, *a2) ;
+        if( d->DistanceFromCenter[i] != d->DistanceFromCenter[j] )
+          return d->DistanceFromCenter[i] < d->DistanceFromCenter[j] ;
+        return i < j ;
+      }
+    };
+
     void
     find_planes(void)
     {
-      unsigned int i, j;
+      unsigned int i, j, p;
       SYMMETRY_ELEMENT * plane ;
 
       plane = init_ultimate_plane() ;
@@ -1350,8 +1577,9 @@ namespace OpenBabel {
         Planes[ PlanesCount - 1 ] = plane ;
       }
       for( i = 1 ; i < _mol->NumAtoms() ; i++ ){
-        for( j = 0 ; j < i ; j++ ){
-          if( !equivalentAtoms(*_mol->GetAtom(i+1), *_mol->GetAtom(j+1)) )
+        for( p = ClassBegin[i] ; p < ClassEnd[i] ; p++ ){
+          j = ClassOrder[p] ;
+          if( j >= i )
             continue ;
           if ((plane = init_mirror_plane(i, j)) != nullptr) {
             PlanesCount++ ;
@@ -1397,7 +1625,7 @@ namespace OpenBabel {
     void
     find_c2_axes(void)
     {
-      unsigned int       i, j, k, l;
+      unsigned int       i, j, k, l, p, q, r_idx;
       double             center[ DIMENSION ] ;
       double *           distances = (double*)calloc( _mol->NumAtoms(), sizeof( double ) ) ;
       double             r ;
@@ -1408,20 +1636,20 @@ namespace OpenBabel {
         //        fprintf( stderr, "Out of memory in find_c2_axes()\n" ) ;
         return;
       }
-      for( i = 1 ; i < _mol->NumAtoms() ; i++ ){
-        for( j = 0 ; j < i ; j++ ){
-          if( !equivalentAtoms(*_mol->GetAtom(i+1), *_mol->GetAtom(j+1)) )
-            continue ;
-          if( fabs( DistanceFromCenter[i] - DistanceFromCenter[j] ) > TolerancePrimary )
-            continue ; /* A very cheap, but quite effective check */
+      for( r_idx = 0 ; r_idx < ReferenceAtoms.size() ; r_idx++ ){
+        i = ReferenceAtoms[r_idx] ;
+        for( p = ClassBegin[i] ; p < ClassEnd[i] ; p++ ){
+          j = ClassOrder[p] ;
+          if( j == i || ( j < i && IsReferenceAtom[j] ) )
+            continue ; /* Same type and distance from center by construction */
           /*
            *   First, let's try to get it cheap and use CenterOfSomething
            */
           a1 = _mol->GetAtom(i+1);
           a2 = _mol->GetAtom(j+1);
           center[0] = (a1->x() + a2->x()) / 2.0;
-          center[1] = (a1->y() + a2->z()) / 2.0;
-          center[2] = (a1->z() + a2->y()) / 2.0;
+          center[1] = (a1->y() + a2->y()) / 2.0;
+          center[2] = (a1->z() + a2->z()) / 2.0;
 
           r = (vector3(center[0], center[1], center[2])
                - vector3(CenterOfSomething[0], CenterOfSomething[1], CenterOfSomething[2])).length();
@@ -1466,12 +1694,10 @@ namespace OpenBabel {
           }
           for( k = 0 ; k < _mol->NumAtoms() ; k++ ){
             a3 = _mol->GetAtom(k+1);
-            for( l = 0 ; l < _mol->NumAtoms() ; l++ ){
+            for( q = ClassBegin[k] ; q < ClassEnd[k] ; q++ ){
+              l  = ClassOrder[q] ;
               a4 = _mol->GetAtom(l+1);
-              if( !equivalentAtoms(*a3, *a4) )
-                continue ;
-              if( fabs( DistanceFromCenter[k] - DistanceFromCenter[l] ) > TolerancePrimary ||
-                  fabs( distances[k] - distances[l] ) > TolerancePrimary )
+              if( fabs( distances[k] - distances[l] ) > TolerancePrimary )
                 continue ; /* We really need this one to run reasonably fast! */
 
               center[0] = (a3->x() + a4->x()) / 2.0;
@@ -1498,20 +1724,18 @@ namespace OpenBabel {
     void
     find_higher_axes(void)
     {
-      unsigned int i, j, k;
+      unsigned int i, j, k, p, q, r_idx;
       SYMMETRY_ELEMENT * axis ;
 
-      for( i = 0 ; i < _mol->NumAtoms() ; i++ ){
-        for( j = i + 1 ; j < _mol->NumAtoms() ; j++ ){
-          if( !equivalentAtoms(*_mol->GetAtom(i+1), *_mol->GetAtom(j+1)) )
+      for( r_idx = 0 ; r_idx < ReferenceAtoms.size() ; r_idx++ ){
+        i = ReferenceAtoms[r_idx] ;
+        for( p = ClassBegin[i] ; p < ClassEnd[i] ; p++ ){
+          j = ClassOrder[p] ;
+          if( j == i || ( !ReferenceSubset && j < i ) )
             continue ;
-          if( fabs( DistanceFromCenter[i] - DistanceFromCenter[j] ) > TolerancePrimary )
-            continue ; /* A very cheap, but quite effective check */
-          for( k = 0 ; k < _mol->NumAtoms() ; k++ ){
-            if( !equivalentAtoms(*_mol->GetAtom(i+1), *_mol->GetAtom(k+1)) )
-              continue ;
-            if( ( fabs( DistanceFromCenter[i] - DistanceFromCenter[k] ) > TolerancePrimary ) ||
-                ( fabs( DistanceFromCenter[j] - DistanceFromCenter[k] ) > TolerancePrimary ) )
+          for( q = ClassBegin[i] ; q < ClassEnd[i] ; q++ ){
+            k = ClassOrder[q] ;
+            if( fabs( DistanceFromCenter[j] - DistanceFromCenter[k] ) > TolerancePrimary )
               continue ;
             if ((axis = init_higher_axis(i, j, k)) != nullptr) {
               NormalAxesCount++ ;
@@ -1530,12 +1754,24 @@ namespace OpenBabel {
     void
     find_improper_axes(void)
     {
-      unsigned int i, j, k;
+      unsigned int i, j, k, p, q, r_idx;
       SYMMETRY_ELEMENT * axis ;
 
-      for( i = 0 ; i < _mol->NumAtoms() ; i++ ){
-        for( j = i + 1 ; j < _mol->NumAtoms() ; j++ ){
-          for( k = 0 ; k < _mol->NumAtoms() ; k++ ){
+      /*
+       *  Consecutive images under an improper rotation share type and
+       *  distance from the center, so the same screening as for the
+       *  proper axes applies.
+       */
+      for( r_idx = 0 ; r_idx < ReferenceAtoms.size() ; r_idx++ ){
+        i = ReferenceAtoms[r_idx] ;
+        for( p = ClassBegin[i] ; p < ClassEnd[i] ; p++ ){
+          j = ClassOrder[p] ;
+          if( j == i || ( !ReferenceSubset && j < i ) )
+            continue ;
+          for( q = ClassBegin[i] ; q < ClassEnd[i] ; q++ ){
+            k = ClassOrder[q] ;
+            if( fabs( DistanceFromCenter[j] - DistanceFromCenter[k] ) > TolerancePrimary )
+              continue ;
             if ((axis = init_improper_axis(i, j, k)) != nullptr) {
               ImproperAxesCount++ ;
               ImproperAxes = (SYMMETRY_ELEMENT **) realloc( ImproperAxes, sizeof( SYMMETRY_ELEMENT* ) * ImproperAxesCount ) ;
@@ -1658,9 +1894,47 @@ namespace OpenBabel {
       StatTotal = StatEarly = StatPairs = StatDups = StatOrder = StatOpt = StatAccept = 0 ;
     }
 
+    /*
+     *   Forget the elements found by a previous search, e.g. for another
+     *   molecule analysed with the same object
+     */
+    void
+    clear_symmetry_elements( void )
+    {
+      int i ;
+
+      for( i = 0 ; i < PlanesCount ; i++ )
+        destroy_symmetry_element( Planes[i] ) ;
+      for( i = 0 ; i < InversionCentersCount ; i++ )
+        destroy_symmetry_element( InversionCenters[i] ) ;
+      for( i = 0 ; i < NormalAxesCount ; i++ )
+        destroy_symmetry_element( NormalAxes[i] ) ;
+      for( i = 0 ; i < ImproperAxesCount ; i++ )
+        destroy_symmetry_element( ImproperAxes[i] ) ;
+      free( Planes ) ;
+      free( InversionCenters ) ;
+      free( NormalAxes ) ;
+      free( ImproperAxes ) ;
+      free( NormalAxesCounts ) ;
+      free( ImproperAxesCounts ) ;
+      Planes                = nullptr ;
+      MolecularPlane        = nullptr ;
+      InversionCenters      = nullptr ;
+      NormalAxes            = nullptr ;
+      ImproperAxes          = nullptr ;
+      NormalAxesCounts      = nullptr ;
+      ImproperAxesCounts    = nullptr ;
+      PlanesCount           = 0 ;
+      InversionCentersCount = 0 ;
+      NormalAxesCount       = 0 ;
+      ImproperAxesCount     = 0 ;
+      BadOptimization       = 0 ;
+    }
+
     void
     find_symmetry_elements( void )
     {
+      clear_symmetry_elements() ;
       find_center_of_something() ;
       if( verbose > -1 ){
         printf( "Looking for the inversion center\n" ) ;
@@ -1836,6 +2110,7 @@ namespace OpenBabel {
           a->SetVector(a->GetVector() + displacement);
           b->SetVector(b->GetVector() - displacement);
         }
+      AtomGridValid = false; // the atoms moved
     }
 
   }; // end class PointGroupPrivate
@@ -1855,6 +2130,7 @@ namespace OpenBabel {
     d->_mol = mol;
     d->_mol->Center();
     d->Setup = true;
+    d->AtomGridValid = false;
   }
 
   //! @todo Remove this on next ABI break
@@ -1936,6 +2212,9 @@ namespace OpenBabel {
       // fall back to a subgroup below
     }
 
+    if (perceived != Unknown) // linear and cubic groups contain dihedral subgroups
+      return perceived;
+
     // Find the maximum rotational axis (if present)
     unsigned int maxAxis = 0;
     unsigned int maxImproperAxis = 0;
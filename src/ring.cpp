@@ -91,8 +91,9 @@ namespace OpenBabel
     if (HasSSSRPerceived())
       return;
     SetSSSRPerceived();
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::FindSSSR", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::FindSSSR", obAuditMsg);
 
     // Delete any old data before we start finding new rings
     // The following procedure is slow
@@ -238,8 +239,9 @@ namespace OpenBabel
     if (HasLSSRPerceived())
       return;
     SetLSSRPerceived();
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::FindLSSR", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::FindLSSR", obAuditMsg);
 
     // Delete any old data before we start finding new rings
     // The following procedure is slow
@@ -91,8 +91,9 @@ namespace OpenBabel
     // This function will set OBBond::IsRotor().
     mol.FindRingAtomsAndBonds();
 
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::FindRotors", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::FindRotors", obAuditMsg);
 
     //
     // Score the bonds using the graph theoretical distance (GTD).
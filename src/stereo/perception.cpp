@@ -1851,7 +1851,8 @@ namespace OpenBabel {
     if (mol->HasChiralityPerceived())
       return;
 
-    obErrorLog.ThrowError(__FUNCTION__, "Ran OpenBabel::StereoFrom0D", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__, "Ran OpenBabel::StereoFrom0D", obAuditMsg);
 
     std::vector<unsigned int> symmetry_classes = FindSymmetry(mol);
     OBStereoUnitSet stereogenicUnits = FindStereogenicUnits(mol, symmetry_classes);
@@ -1865,7 +1866,8 @@ namespace OpenBabel {
       const OBStereoUnitSet &stereoUnits, bool addToMol)
   {
     std::vector<OBTetrahedralStereo*> configs;
-    obErrorLog.ThrowError(__FUNCTION__, "Ran OpenBabel::TetrahedralFrom0D", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__, "Ran OpenBabel::TetrahedralFrom0D", obAuditMsg);
 
     // Delete any existing stereo objects that are not a member of 'centers'
     // and make a map of the remaining ones
@@ -1890,7 +1892,8 @@ namespace OpenBabel {
           configs.push_back(ts);
         } else {
           // According to OpenBabel, this is not a tetrahedral stereo
-          obErrorLog.ThrowError(__FUNCTION__, "Removed spurious TetrahedralStereo object", obAuditMsg);
+          if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+            obErrorLog.ThrowError(__FUNCTION__, "Removed spurious TetrahedralStereo object", obAuditMsg);
           mol->DeleteData(ts);
         }
       }
@@ -1938,7 +1941,8 @@ namespace OpenBabel {
       bool addToMol)
   {
     std::vector<OBCisTransStereo*> configs;
-    obErrorLog.ThrowError(__FUNCTION__, "Ran OpenBabel::CisTransFrom0D", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__, "Ran OpenBabel::CisTransFrom0D", obAuditMsg);
 
     std::vector<unsigned long> bonds;
     for (OBStereoUnitSet::const_iterator u = stereoUnits.begin(); u != stereoUnits.end(); ++u)
@@ -1971,7 +1975,8 @@ namespace OpenBabel {
 
         if (std::find(bonds.begin(), bonds.end(), id) == bonds.end()) {
           // According to OpenBabel, this is not a cis trans stereo
-          obErrorLog.ThrowError(__FUNCTION__, "Removed spurious CisTransStereo object", obAuditMsg);
+          if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+            obErrorLog.ThrowError(__FUNCTION__, "Removed spurious CisTransStereo object", obAuditMsg);
           mol->DeleteData(ct);
         }
         else {
@@ -2073,7 +2078,8 @@ namespace OpenBabel {
     if (mol->HasChiralityPerceived() && !force)
       return;
 
-    obErrorLog.ThrowError(__FUNCTION__, "Ran OpenBabel::StereoFrom3D", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__, "Ran OpenBabel::StereoFrom3D", obAuditMsg);
 
     std::vector<unsigned int> symmetry_classes = FindSymmetry(mol);
     OBStereoUnitSet stereogenicUnits = FindStereogenicUnits(mol, symmetry_classes);
@@ -2100,7 +2106,8 @@ namespace OpenBabel {
   {
     std::vector<OBTetrahedralStereo*> configs;
     OBUnitCell *uc = (OBUnitCell*)mol->GetData(OBGenericDataType::UnitCell);
-    obErrorLog.ThrowError(__FUNCTION__, "Ran OpenBabel::TetrahedralFrom3D", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__, "Ran OpenBabel::TetrahedralFrom3D", obAuditMsg);
 
     // find all tetrahedral centers
     std::vector<unsigned long> centers;
@@ -2202,7 +2209,8 @@ namespace OpenBabel {
   {
     std::vector<OBCisTransStereo*> configs;
     OBUnitCell *uc = (OBUnitCell*)mol->GetData(OBGenericDataType::UnitCell);
-    obErrorLog.ThrowError(__FUNCTION__, "Ran OpenBabel::CisTransFrom3D", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__, "Ran OpenBabel::CisTransFrom3D", obAuditMsg);
 
     // find all cis/trans bonds
     std::vector<unsigned long> bonds;
@@ -2355,7 +2363,8 @@ namespace OpenBabel {
     if (mol->HasChiralityPerceived() && !force)
       return;
 
-    obErrorLog.ThrowError(__FUNCTION__, "Ran OpenBabel::StereoFrom2D", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__, "Ran OpenBabel::StereoFrom2D", obAuditMsg);
 
     std::vector<unsigned int> symmetry_classes = FindSymmetry(mol);
     OBStereoUnitSet stereogenicUnits = FindStereogenicUnits(mol, symmetry_classes);
@@ -2412,7 +2421,8 @@ namespace OpenBabel {
       const OBStereoUnitSet &stereoUnits, bool addToMol)
   {
     std::vector<OBTetrahedralStereo*> configs;
-    obErrorLog.ThrowError(__FUNCTION__, "Ran OpenBabel::TetrahedralFrom2D", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__, "Ran OpenBabel::TetrahedralFrom2D", obAuditMsg);
 
     // find all tetrahedral centers
     std::vector<unsigned long> centers;
@@ -2674,7 +2684,8 @@ namespace OpenBabel {
   {
     std::vector<OBCisTransStereo*> configs;
     std::map<OBBond*, enum OBStereo::BondDirection>::const_iterator ud_cit;
-    obErrorLog.ThrowError(__FUNCTION__, "Ran OpenBabel::CisTransFrom2D", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__, "Ran OpenBabel::CisTransFrom2D", obAuditMsg);
 
     // find all cis/trans bonds
     std::vector<unsigned long> bonds;
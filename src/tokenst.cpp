@@ -23,6 +23,7 @@ GNU General Public License for more details.
 #include <string>
 #include <limits>
 #include <cstring>
+#include <cstdlib>
 #include <openbabel/tokenst.h>
 
 using namespace std;
@@ -148,6 +149,70 @@ namespace OpenBabel
     return txt;
   }
 
+  //! Parse a number like strtod() in the C locale, giving the same result.
+  //! Numbers with at most 15 significant digits and a small exponent, as
+  //! written in numeric data files such as grids, are converted directly
+  //! (one exact multiplication or division); anything else is passed on
+  //! to strtod().
+  double ParseDouble(const char *str, char **endptr)
+  {
+    static const double powersOfTen[] = {
+      1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    const char *p = str;
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')
+      ++p;
+    bool negative = *p == '-';
+    if (*p == '-' || *p == '+')
+      ++p;
+
+    unsigned long long mantissa = 0;
+    int significant = 0, exponent = 0, ndigits = 0;
+    for (; *p >= '0' && *p <= '9'; ++p, ++ndigits)
+      if (mantissa || *p != '0') {
+        if (++significant <= 19)
+          mantissa = mantissa * 10 + (*p - '0');
+      }
+    if (*p == '.')
+      for (++p; *p >= '0' && *p <= '9'; ++p, ++ndigits)
+        if (mantissa || *p != '0') {
+          if (++significant <= 19)
+            mantissa = mantissa * 10 + (*p - '0');
+          --exponent;
+        }
+        else
+          --exponent;
+    if (ndigits == 0 || significant > 15 || *p == 'x' || *p == 'X')
+      return strtod(str, endptr);
+
+    if (*p == 'e' || *p == 'E') {
+      const char *q = p + 1;
+      bool negativeExponent = *q == '-';
+      if (*q == '-' || *q == '+')
+        ++q;
+      if (*q >= '0' && *q <= '9') {
+        int e = 0;
+        for (; *q >= '0' && *q <= '9'; ++q)
+          if (e < 10000)
+            e = e * 10 + (*q - '0');
+        exponent += negativeExponent ? -e : e;
+        p = q;
+      }
+    }
+    if (mantissa && (exponent < -22 || exponent > 22))
+      return strtod(str, endptr);
+
+    double value = static_cast<double>(mantissa);
+    if (mantissa && exponent < 0)
+      value /= powersOfTen[-exponent];
+    else if (mantissa)
+      value *= powersOfTen[exponent];
+    if (endptr)
+      *endptr = const_cast<char*>(p);
+    return negative ? -value : value;
+  }
+
   //!Read and discard all characters from input stream up to the occurrence of a string
   //! \param ifs The input file stream.
   //! \param txt (which is also discarded), or the end of the stream.
@@ -137,8 +137,9 @@ namespace OpenBabel
     if (!_init)
       Init();
 
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::AssignTypes", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::AssignTypes", obAuditMsg);
 
     mol.SetAtomTypesPerceived();
 
@@ -185,8 +186,9 @@ namespace OpenBabel
     aromtyper.AssignAromaticFlags(mol);
 
     mol.SetHybridizationPerceived();
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::AssignHybridization", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::AssignHybridization", obAuditMsg);
 
     OBAtom *atom;
     vector<OBAtom*>::iterator k;
@@ -288,8 +290,9 @@ namespace OpenBabel
     if (!_init)
       Init();
 
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OBRing::AssignTypes", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OBRing::AssignTypes", obAuditMsg);
 
     mol.SetRingTypesPerceived();
 
@@ -672,8 +675,9 @@ namespace OpenBabel
     if (mol.HasAromaticPerceived())
       return;
     mol.SetAromaticPerceived();
-    obErrorLog.ThrowError(__FUNCTION__,
-                          "Ran OpenBabel::AssignAromaticFlags", obAuditMsg);
+    if (obErrorLog.GetOutputLevel() >= obAuditMsg)
+      obErrorLog.ThrowError(__FUNCTION__,
+                            "Ran OpenBabel::AssignAromaticFlags", obAuditMsg);
 
     OBAromaticTyperMolState molstate(mol);
     molstate.AssignAromaticFlags();
@@ -1,5 +1,6 @@
 #include "obtest.h"
 #include <openbabel/atom.h>
+#include <openbabel/obiter.h>
 #include <openbabel/obconversion.h>
 #include <openbabel/math/align.h>
 #include <openbabel/math/matrix3x3.h>
@@ -387,6 +388,95 @@ void test_QCP()
 
 }
 
+void test_RMSDMatrix()
+{
+  OBConversion conv;
+  OB_REQUIRE( conv.SetInFormat("smi") );
+
+  OBMol mol;
+  OB_REQUIRE( conv.ReadString(&mol, "CC(C)(C)c1ccc(O)cc1") );
+  mol.AddHydrogens();
+
+  OBBuilder builder;
+  OB_REQUIRE( builder.Build(mol) );
+
+  // Perturbed and rotated copies of the molecule
+  vector<OBMol> mols;
+  for (int i = 0; i < 6; ++i) {
+    OBMol copy = mol;
+    FOR_ATOMS_OF_MOL (atom, copy) {
+      double t = (i + 1) * 7.0 + atom->GetIdx();
+      atom->SetVector(atom->GetVector() + vector3(sin(t), cos(1.3 * t), sin(2.1 * t)) * 0.3);
+    }
+    matrix3x3 rot;
+    rot.SetupRotMat(i * 30.0, i * 20.0, i * 10.0);
+    double m[9];
+    rot.GetArray(m);
+    copy.Rotate(m);
+    mols.push_back(copy);
+  }
+
+  OBRMSDMatrix matrix;
+  matrix.SetRefMol(mols[0]);
+  for (unsigned int i = 0; i < mols.size(); ++i)
+    OB_ASSERT( matrix.AddMol(mols[i]) );
+
+  // A copy with the atoms in a different order
+  OBMol shuffled = mols[3];
+  vector<int> order;
+  for (int i = shuffled.NumAtoms(); i > 0; --i)
+    order.push_back(i);
+  shuffled.RenumberAtoms(order);
+  OB_ASSERT( matrix.AddMol(shuffled) );
+
+  // A different molecule
+  OBMol other;
+  OB_REQUIRE( conv.ReadString(&other, "CC(C)(C)c1ccc(N)cc1") );
+  OB_ASSERT( !matrix.AddMol(other) );
+  OB_ASSERT( matrix.NumMols() == mols.size() + 2 );
+
+  vector<double> rmsds;
+  matrix.Compute(rmsds);
+  unsigned int n = matrix.NumMols();
+  OB_ASSERT( rmsds.size() == n * (n - 1) / 2 );
+
+  vector<vector<double> > rows;
+  matrix.ComputeRows(0, n, rows);
+  OB_ASSERT( rows.size() == n );
+
+  unsigned int k = 0;
+  for (unsigned int i = 0; i < n; ++i) {
+    OB_ASSERT( matrix.GetRMSD(i, i) == 0.0 );
+    OB_ASSERT( rows[i].size() == n - i - 1 );
+    for (unsigned int j = i + 1; j < n; ++j, ++k) {
+      OB_ASSERT( rmsds[k] == rows[i][j - i - 1] );
+      OB_ASSERT( rmsds[k] == matrix.GetRMSD(j, i) );
+    }
+  }
+
+  // Compare with OBAlign (heavy atoms, symmetry)
+  for (unsigned int i = 0; i < mols.size(); ++i)
+    for (unsigned int j = i + 1; j < mols.size(); ++j) {
+      OBAlign align(mols[i], mols[j], false, true);
+      align.Align();
+      OB_ASSERT( fabs(align.GetRMSD() - matrix.GetRMSD(i, j)) < 1.0E-6 );
+    }
+
+  for (unsigned int i = 0; i < mols.size(); ++i)
+    OB_ASSERT( fabs(matrix.GetRMSD(i, 3) - matrix.GetRMSD(i, n - 2)) < 1.0E-6 );
+
+  OB_ASSERT( matrix.GetRMSD(0, n - 1) == HUGE_VAL );
+
+  // Without superposition
+  OBRMSDMatrix noMinimize(false, true, false);
+  noMinimize.SetRefMol(mols[0]);
+  for (unsigned int i = 0; i < mols.size(); ++i)
+    noMinimize.AddMol(mols[i]);
+  for (unsigned int i = 0; i < mols.size(); ++i)
+    for (unsigned int j = i + 1; j < mols.size(); ++j)
+      OB_ASSERT( noMinimize.GetRMSD(i, j) >= matrix.GetRMSD(i, j) - 1.0E-6 );
+}
+
 int aligntest(int argc, char* argv[])
 {
   int defaultchoice = 1;
@@ -425,6 +515,9 @@ int aligntest(int argc, char* argv[])
     test_alignWithoutHydrogens();
     test_alignWithSymWithoutHydrogens();
     break;
+  case 6:
+    test_RMSDMatrix();
+    break;
   default:
     cout << "Test number " << choice << " does not exist!\n";
     return -1;
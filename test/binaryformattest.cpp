@@ -0,0 +1,293 @@
+#include "obtest.h"
+
+#include <openbabel/mol.h>
+#include <openbabel/atom.h>
+#include <openbabel/bond.h>
+#include <openbabel/obiter.h>
+#include <openbabel/residue.h>
+#include <openbabel/ring.h>
+#include <openbabel/generic.h>
+#include <openbabel/obconversion.h>
+#include <openbabel/stereo/stereo.h>
+#include <openbabel/stereo/tetrahedral.h>
+#include <openbabel/stereo/cistrans.h>
+
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace std;
+using namespace OpenBabel;
+
+void testRoundTrip()
+{
+  OBConversion conv;
+  OB_REQUIRE(conv.SetInAndOutFormats("smi", "obbin"));
+  OBMol mol;
+  OB_REQUIRE(conv.ReadString(&mol, "C[C@H](O)/C=C/c1ccc(N)cc1 example"));
+
+  // a second conformer, which is the current one
+  unsigned int n = mol.NumAtoms() * 3;
+  double *c = new double[n];
+  for (unsigned int i = 0; i < n; ++i)
+    c[i] = 0.5 * i;
+  mol.AddConformer(c);
+  mol.SetConformer(1);
+
+  OBResidue *res = mol.NewResidue();
+  res->SetName("LIG");
+  res->SetNum("7");
+  res->SetChain('B');
+  FOR_ATOMS_OF_MOL(atom, mol) {
+    res->AddAtom(&*atom);
+    res->SetAtomID(&*atom, atom->GetIdx() == 1 ? " CA " : " X  ");
+  }
+  OBPairData *pd = new OBPairData;
+  pd->SetAttribute("activity");
+  pd->SetValue("7.2");
+  mol.SetData(pd);
+
+  // everything is perceived before writing, then some results are changed
+  // so that it can be seen whether they are perceived again on reading
+  conv.AddOption("a", OBConversion::OUTOPTIONS);
+  string record = conv.WriteString(&mol);
+  OB_REQUIRE(!record.empty());
+  OB_ASSERT(mol.HasAromaticPerceived());
+  OB_ASSERT(mol.HasPartialChargesPerceived());
+  OB_ASSERT(mol.HasHybridizationPerceived());
+
+  mol.GetAtom(1)->SetType("XX");
+  mol.GetAtom(2)->SetPartialCharge(0.125);
+  record = conv.WriteString(&mol);
+
+  OBMol mol2;
+  OB_REQUIRE(conv.SetInFormat("obbin"));
+  OB_REQUIRE(conv.ReadString(&mol2, record));
+  OB_COMPARE(mol2.GetFlags(), mol.GetFlags());
+  OB_COMPARE(string(mol2.GetTitle()), string("example"));
+  OB_COMPARE(mol2.NumAtoms(), mol.NumAtoms());
+  OB_COMPARE(mol2.NumBonds(), mol.NumBonds());
+  OB_COMPARE(string(mol2.GetAtom(1)->GetType()), string("XX"));
+  OB_COMPARE(mol2.GetAtom(2)->GetPartialCharge(), 0.125);
+  FOR_ATOMS_OF_MOL(atom, mol) {
+    OBAtom *atom2 = mol2.GetAtom(atom->GetIdx());
+    OB_COMPARE(atom2->GetAtomicNum(), atom->GetAtomicNum());
+    OB_COMPARE(atom2->GetImplicitHCount(), atom->GetImplicitHCount());
+    OB_COMPARE(atom2->IsAromatic(), atom->IsAromatic());
+    OB_COMPARE(atom2->IsInRing(), atom->IsInRing());
+    OB_COMPARE(atom2->GetHyb(), atom->GetHyb());
+    OB_COMPARE(string(atom2->GetType()), string(atom->GetType()));
+    OB_COMPARE(atom2->GetPartialCharge(), atom->GetPartialCharge());
+    OB_ASSERT(atom2->GetVector().IsApprox(atom->GetVector(), 1.0e-12));
+  }
+  FOR_BONDS_OF_MOL(bond, mol) {
+    OBBond *bond2 = mol2.GetBond(bond->GetIdx());
+    OB_COMPARE(bond2->GetBeginAtomIdx(), bond->GetBeginAtomIdx());
+    OB_COMPARE(bond2->GetBondOrder(), bond->GetBondOrder());
+    OB_COMPARE(bond2->IsAromatic(), bond->IsAromatic());
+  }
+
+  OB_COMPARE(mol2.NumConformers(), 2);
+  OB_ASSERT(mol2.GetCoordinates() == mol2.GetConformer(1));
+  OB_COMPARE(mol2.GetConformer(1)[4], 2.0);
+  OB_COMPARE(mol2.GetSSSR().size(), 1u);
+  OB_COMPARE(mol2.GetSSSR()[0]->Size(), 6u);
+
+  OB_REQUIRE(mol2.NumResidues() == 1);
+  OBResidue *res2 = mol2.GetResidue(0);
+  OB_COMPARE(res2->GetName(), string("LIG"));
+  OB_COMPARE(res2->GetNum(), 7);
+  OB_COMPARE(res2->GetChain(), 'B');
+  OB_COMPARE(res2->GetAtomID(mol2.GetAtom(1)), string(" CA "));
+  OB_COMPARE(mol2.GetAtom(3)->GetResidue(), res2);
+
+  OBPairData *pd2 = dynamic_cast<OBPairData*>(mol2.GetData("activity"));
+  OB_REQUIRE(pd2 != nullptr);
+  OB_COMPARE(pd2->GetValue(), string("7.2"));
+
+  OBStereoFacade facade(&mol2, false);
+  OB_REQUIRE(facade.HasTetrahedralStereo(1));
+  OB_ASSERT(facade.GetTetrahedralStereo(1)->GetConfig()
+            == OBStereoFacade(&mol, false).GetTetrahedralStereo(1)->GetConfig());
+  OB_COMPARE(facade.NumCisTransStereo(), 1u);
+
+  conv.SetOutFormat("can");
+  OB_COMPARE(conv.WriteString(&mol2, true), conv.WriteString(&mol, true));
+
+  // after a deletion the atom ids are no longer the indexes, they are
+  // renumbered together with the stereo refs
+  OB_REQUIRE(conv.SetInAndOutFormats("smi", "obbin"));
+  OB_REQUIRE(conv.ReadString(&mol, "[Na+].C[C@H](O)/C=C/Cl"));
+  mol.DeleteAtom(mol.GetAtom(1));
+  OB_ASSERT(mol.GetAtom(mol.NumAtoms())->GetId() == mol.NumAtoms());
+  record = conv.WriteString(&mol);
+  OB_REQUIRE(conv.SetInAndOutFormats("obbin", "can"));
+  OB_REQUIRE(conv.ReadString(&mol2, record));
+  OB_COMPARE(conv.WriteString(&mol2, true), conv.WriteString(&mol, true));
+}
+
+static string Varint(unsigned long value)
+{
+  string s;
+  for (; value >= 0x80; value >>= 7)
+    s += static_cast<char>((value & 0x7f) | 0x80);
+  return s + static_cast<char>(value);
+}
+
+void testRecords()
+{
+  OBConversion conv;
+  OB_REQUIRE(conv.SetInAndOutFormats("smi", "obbin"));
+  stringstream ss;
+  const char *smiles[] = { "C first", "CC second", "CCC third", "CCCC fourth" };
+  for (int i = 0; i < 4; ++i) {
+    OBMol mol;
+    OB_REQUIRE(conv.ReadString(&mol, smiles[i]));
+    OB_REQUIRE(conv.Write(&mol, &ss));
+  }
+  string records = ss.str();
+
+  // records are skipped without being read
+  OBFormat *format = OBConversion::FindFormat("obbin");
+  OB_REQUIRE(format != nullptr);
+  conv.SetInFormat(format);
+  ss.str(records);
+  conv.SetInStream(&ss, false);
+  OB_COMPARE(format->SkipObjects(2, &conv), 1);
+  OBMol mol;
+  OB_REQUIRE(conv.Read(&mol));
+  OB_COMPARE(string(mol.GetTitle()), string("third"));
+  OB_COMPARE(mol.NumAtoms(), 3u);
+  OB_REQUIRE(conv.Read(&mol));
+  OB_COMPARE(string(mol.GetTitle()), string("fourth"));
+  OB_ASSERT(!conv.Read(&mol));
+
+  // the first record: magic, version, payload length and payload
+  ss.clear();
+  ss.str(records);
+  conv.SetInStream(&ss, false);
+  OB_REQUIRE(conv.Read(&mol));
+  string::size_type length = ss.tellg();
+  string first = records.substr(0, length);
+  OB_REQUIRE(first[4] == 1 && static_cast<unsigned char>(first[5]) < 0x80);
+  string payload = first.substr(6);
+
+  // sections of a later version are skipped
+  string extended = payload + Varint(99) + Varint(3) + "new";
+  string record = first.substr(0, 5) + Varint(extended.size()) + extended;
+  OB_REQUIRE(conv.ReadString(&mol, record));
+  OB_COMPARE(string(mol.GetTitle()), string("first"));
+
+  obErrorLog.StopLogging();
+  // but records of a later version are not read
+  record = first;
+  record[4] = 2;
+  OB_ASSERT(!conv.ReadString(&mol, record));
+  // nor truncated or corrupt ones
+  OB_ASSERT(!conv.ReadString(&mol, first.substr(0, first.size() - 3)));
+  record = first.substr(0, 5) + Varint(payload.size() - 3) + payload.substr(0, payload.size() - 3);
+  OB_ASSERT(!conv.ReadString(&mol, record));
+  OB_COMPARE(mol.NumAtoms(), 0u);
+  OB_ASSERT(!conv.ReadString(&mol, "CCO"));
+  obErrorLog.StartLogging();
+}
+
+// A record of @p payload, which follows the header of the record @p first
+static string Record(const string &first, const string &payload)
+{
+  return first.substr(0, 5) + Varint(payload.size()) + payload;
+}
+
+void testCorruptSections()
+{
+  OBConversion conv;
+  OB_REQUIRE(conv.SetInAndOutFormats("smi", "obbin"));
+  OBMol mol;
+  OB_REQUIRE(conv.ReadString(&mol, "CC ethane"));
+  string first = conv.WriteString(&mol);
+  OB_REQUIRE(static_cast<unsigned char>(first[5]) < 0x80);
+  string payload = first.substr(6);
+  OB_REQUIRE(conv.SetInFormat("obbin"));
+  OB_REQUIRE(conv.ReadString(&mol, Record(first, payload)));
+  OB_COMPARE(mol.NumAtoms(), 2u);
+
+  obErrorLog.StopLogging();
+  // a bond index past the last bond (section 4 lists the bonds of an atom)
+  string neighbors = Varint(0) + Varint(1) + Varint(7);
+  OB_ASSERT(!conv.ReadString(&mol, Record(first, payload + Varint(4) + Varint(neighbors.size()) + neighbors)));
+  OB_COMPARE(mol.NumAtoms(), 0u);
+  // a truncated list of bonds
+  neighbors = Varint(0) + Varint(1);
+  OB_ASSERT(!conv.ReadString(&mol, Record(first, payload + Varint(4) + Varint(neighbors.size()) + neighbors)));
+  OB_COMPARE(mol.NumAtoms(), 0u);
+
+  // a huge number of conformers (section 5) before any atoms
+  string conformers = Varint(0x80000000ul) + Varint(0) + Varint(0);
+  OB_ASSERT(!conv.ReadString(&mol, Record(first, Varint(5) + Varint(conformers.size()) + conformers + payload)));
+  OB_COMPARE(mol.NumAtoms(), 0u);
+  // or a huge number of energies
+  conformers = Varint(1) + string(48, '\0') + Varint(0) + Varint(0x80000000ul);
+  OB_ASSERT(!conv.ReadString(&mol, Record(first, payload + Varint(5) + Varint(conformers.size()) + conformers)));
+  OB_COMPARE(mol.NumAtoms(), 0u);
+
+  // an atom id (section 2) which would grow the id table of the molecule
+  string atoms = Varint(1) + Varint(0x80000000ul) + string(16, '\0');
+  OB_ASSERT(!conv.ReadString(&mol, Record(first, Varint(2) + Varint(atoms.size()) + atoms)));
+  OB_COMPARE(mol.NumAtoms(), 0u);
+  // a ring path (section 7) longer than the section
+  string rings = Varint(0) + Varint(0) + Varint(1) + Varint(0) + Varint(0x80000000ul) + Varint(0);
+  OB_ASSERT(!conv.ReadString(&mol, Record(first, payload + Varint(7) + Varint(rings.size()) + rings)));
+  OB_COMPARE(mol.NumAtoms(), 0u);
+  // a tetrahedral center (section 8) with the wrong number of refs
+  string stereo = Varint(0) + Varint(1) + Varint(2) + Varint(1) + Varint(1) + Varint(0) + Varint(0) + Varint(1);
+  OB_ASSERT(!conv.ReadString(&mol, Record(first, payload + Varint(8) + Varint(stereo.size()) + stereo)));
+  OB_COMPARE(mol.NumAtoms(), 0u);
+  // or a ref past the last atom
+  stereo = Varint(0) + Varint(1) + Varint(3) + Varint(1) + Varint(1) + Varint(9) + Varint(0) + Varint(0) + Varint(1);
+  OB_ASSERT(!conv.ReadString(&mol, Record(first, payload + Varint(8) + Varint(stereo.size()) + stereo)));
+  OB_COMPARE(mol.NumAtoms(), 0u);
+  // while the same center with valid refs is read
+  stereo = Varint(0) + Varint(1) + Varint(3) + Varint(1) + Varint(1) + Varint(1) + Varint(0) + Varint(0) + Varint(1);
+  OB_ASSERT(conv.ReadString(&mol, Record(first, payload + Varint(8) + Varint(stereo.size()) + stereo)));
+  OB_COMPARE(mol.NumAtoms(), 2u);
+  obErrorLog.StartLogging();
+}
+
+int binaryformattest(int argc, char* argv[])
+{
+  int defaultchoice = 1;
+
+  int choice = defaultchoice;
+
+  if (argc > 1) {
+    if(sscanf(argv[1], "%d", &choice) != 1) {
+      printf("Couldn't parse that input as a number\n");
+      return -1;
+    }
+  }
+
+  // Define location of file formats for testing
+#ifdef FORMATDIR
+  char env[BUFF_SIZE];
+  snprintf(env, BUFF_SIZE, "BABEL_LIBDIR=%s", FORMATDIR);
+  putenv(env);
+#endif
+
+  switch(choice) {
+  case 1:
+    testRoundTrip();
+    break;
+  case 2:
+    testRecords();
+    break;
+  case 3:
+    testCorruptSections();
+    break;
+  default:
+    cout << "Test number " << choice << " does not exist!\n";
+    return -1;
+  }
+
+  return 0;
+}
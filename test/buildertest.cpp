@@ -1,5 +1,7 @@
 #include "obtest.h"
 #include <openbabel/mol.h>
+#include <openbabel/bond.h>
+#include <openbabel/obiter.h>
 #include <openbabel/obconversion.h>
 #include <openbabel/builder.h>
 #include <openbabel/forcefield.h>
@@ -99,6 +101,28 @@ bool doSMILESBuilderTest(string smiles)
   return (mol.Has3D() && mol.HasNonZeroCoords());
 }
 
+// The ring fragments matched for a ring system are reused for the next
+// molecules with the same ring system
+bool doRingFragmentCacheTest()
+{
+  const char* smiles[] = { "C1CCC2CCCCC2C1CCO", "OCCCCCN", "NCC1CCC2CCCCC2C1", "C1CCC2CCCCC2C1CCO" };
+
+  OBConversion conv;
+  OB_REQUIRE(conv.SetInFormat("smi"));
+  OBBuilder builder;
+  for (unsigned int i = 0; i < 4; ++i) {
+    OBMol mol;
+    OB_REQUIRE(conv.ReadString(&mol, smiles[i]));
+    OB_REQUIRE(builder.Build(mol, false));
+    OB_REQUIRE(mol.Has3D() && mol.HasNonZeroCoords());
+    FOR_BONDS_OF_MOL (bond, mol) {
+      double length = bond->GetLength();
+      OB_ASSERT( length > 1.3 && length < 1.7 );
+    }
+  }
+  return true;
+}
+
 int buildertest(int argc, char* argv[])
 {
   int defaultchoice = 1;
@@ -151,6 +175,9 @@ int buildertest(int argc, char* argv[])
     // from Hubertus van Dam -- #2144
     OB_ASSERT( doSMILESBuilderTest("OC1(C2=CN(CC3=CC=CC=C3F)N=N2)CCOC1") );
     break;
+  case 7:
+    OB_ASSERT( doRingFragmentCacheTest() );
+    break;
   default:
     cout << "Test number " << choice << " does not exist!\n";
     return -1;
@@ -0,0 +1,114 @@
+#include "obtest.h"
+#include <openbabel/mol.h>
+#include <openbabel/obconversion.h>
+#include <openbabel/builder.h>
+#include <openbabel/op.h>
+
+#include <cmath>
+
+using namespace std;
+using namespace OpenBabel;
+
+// Two groups of conformers: small perturbations of the structure, and of
+// the structure scaled by 1.5 (same torsion angles, large RMSD). The
+// energies decrease from the first conformer to the last.
+static OBMol ConformerGroups()
+{
+  OBConversion conv;
+  OBMol mol;
+  OB_REQUIRE( conv.SetInFormat("smi") );
+  OB_REQUIRE( conv.ReadString(&mol, "CCCCOc1ccc(CC(=O)NC)cc1") );
+  OBBuilder builder;
+  OB_REQUIRE( builder.Build(mol) );
+
+  unsigned int N = mol.NumAtoms();
+  vector<double*> confs;
+  vector<double> energies;
+  for (int i = 0; i < 6; ++i) {
+    double *coords = new double[3 * N];
+    for (unsigned int k = 0; k < 3 * N; ++k)
+      coords[k] = mol.GetCoordinates()[k] * (i % 2 ? 1.5 : 1.0) + 0.01 * sin(i * 3.0 + k);
+    confs.push_back(coords);
+    energies.push_back(10.0 - i);
+  }
+  mol.SetConformers(confs);
+  mol.SetEnergies(energies);
+  return mol;
+}
+
+void test_clusterRMSD()
+{
+  OBOp *pOp = OBOp::FindType("cluster-conformers");
+  OB_REQUIRE( pOp );
+
+  OBMol mol = ConformerGroups();
+  OBMol copy = mol;
+  OB_ASSERT( pOp->Do(&copy, "0.5") );
+  OB_ASSERT( copy.NumConformers() == 2 );
+  // the lowest energy conformer of each cluster, by increasing energy
+  vector<double> kept = copy.GetEnergies();
+  OB_REQUIRE( kept.size() == 2 );
+  OB_ASSERT( kept[0] == 5.0 );
+  OB_ASSERT( kept[1] == 6.0 );
+  OB_ASSERT( copy.GetConformer(0)[0] == mol.GetConformer(5)[0] );
+}
+
+void test_clusterTorsion()
+{
+  OBOp *pOp = OBOp::FindType("cluster-conformers");
+  OB_REQUIRE( pOp );
+
+  // scaling the structure leaves the torsion angles unchanged
+  OBMol mol = ConformerGroups();
+  OB_ASSERT( pOp->Do(&mol, "30 torsion") );
+  OB_ASSERT( mol.NumConformers() == 1 );
+}
+
+void test_clusterThreshold()
+{
+  OBOp *pOp = OBOp::FindType("cluster-conformers");
+  OB_REQUIRE( pOp );
+
+  // every conformer is a cluster of its own
+  OBMol mol = ConformerGroups();
+  OB_ASSERT( pOp->Do(&mol, "0.001") );
+  OB_ASSERT( mol.NumConformers() == 6 );
+}
+
+int clusterconformerstest(int argc, char* argv[])
+{
+  int defaultchoice = 1;
+
+  int choice = defaultchoice;
+
+  if (argc > 1) {
+    if(sscanf(argv[1], "%d", &choice) != 1) {
+      printf("Couldn't parse that input as a number\n");
+      return -1;
+    }
+  }
+
+  // Define location of file formats for testing
+  #ifdef FORMATDIR
+    char env[BUFF_SIZE];
+    snprintf(env, BUFF_SIZE, "BABEL_LIBDIR=%s", FORMATDIR);
+    putenv(env);
+  #endif
+
+  switch(choice) {
+  case 1:
+    test_clusterRMSD();
+    break;
+  case 2:
+    test_clusterTorsion();
+    break;
+  case 3:
+    test_clusterThreshold();
+    break;
+  default:
+    cout << "Test number " << choice << " does not exist!\n";
+    return -1;
+  }
+
+  return 0;
+}
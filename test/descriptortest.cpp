@@ -0,0 +1,133 @@
+#include "obtest.h"
+
+#include <openbabel/mol.h>
+#include <openbabel/obutil.h>
+#include <openbabel/obconversion.h>
+#include <openbabel/descriptor.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace OpenBabel;
+
+static double Predict(const char* id, OBMol& mol)
+{
+  OBDescriptor* pDesc = OBDescriptor::FindType(id);
+  OB_REQUIRE(pDesc != nullptr);
+  OBMol copy(mol);
+  return pDesc->Predict(&copy);
+}
+
+void testBatch()
+{
+  OBConversion conv;
+  OB_REQUIRE(conv.SetInFormat("smi"));
+  OBMol mol;
+  OB_REQUIRE(conv.ReadString(&mol, "CC(=O)Nc1ccc(O)cc1 paracetamol"));
+  double logP = Predict("logP", mol);
+  double MR = Predict("MR", mol);
+  double TPSA = Predict("TPSA", mol);
+
+  obErrorLog.StopLogging();
+  OBDescriptorBatch batch("logP MR unknown TPSA");
+  obErrorLog.StartLogging();
+  OB_REQUIRE(batch.Size() == 3);
+  OB_COMPARE(batch.GetID(2), string("TPSA"));
+
+  // the values with shared work are those of the descriptors on their own
+  vector<double> values;
+  vector<string> svalues;
+  batch.Evaluate(&mol, values, svalues);
+  OB_REQUIRE(values.size() == 3);
+  OB_ASSERT(IsNear(values[0], logP));
+  OB_ASSERT(IsNear(values[1], MR));
+  OB_ASSERT(IsNear(values[2], TPSA));
+  for (unsigned int i = 0; i < batch.Size(); ++i) {
+    OB_COMPARE(batch.GetCount(i), 1u);
+    OB_ASSERT(batch.GetTime(i) >= 0.0);
+  }
+  // nor is the molecule changed
+  OB_COMPARE(mol.NumAtoms(), 11u);
+
+  // a second evaluation uses the memoized values
+  batch.Evaluate(&mol, values, svalues);
+  OB_COMPARE(batch.GetCount(0), 1u);
+  OB_ASSERT(IsNear(values[0], logP));
+  string s;
+  OB_ASSERT(IsNear(OBDescriptor::FindType("MR")->GetCachedValue(&mol, s), MR));
+
+  // and the copy of the molecule has them too
+  OBMol copy(mol);
+  batch.Evaluate(&copy, values, svalues);
+  OB_COMPARE(batch.GetCount(0), 1u);
+
+  // but they are calculated again when the structure changes
+  mol.AddHydrogens();
+  batch.Evaluate(&mol, values, svalues);
+  OB_COMPARE(batch.GetCount(0), 2u);
+  OB_ASSERT(IsNear(values[0], logP));
+  OB_REQUIRE(conv.ReadString(&mol, "c1ccccc1O phenol"));
+  batch.Evaluate(&mol, values, svalues);
+  OB_COMPARE(batch.GetCount(2), 3u);
+  OB_ASSERT(IsNear(values[2], Predict("TPSA", mol)));
+  OB_ASSERT(IsNear(values[0], Predict("logP", mol)));
+}
+
+void testGetValues()
+{
+  OBConversion conv;
+  OB_REQUIRE(conv.SetInFormat("smi"));
+  OBMol mol;
+  OB_REQUIRE(conv.ReadString(&mol, "OC(=O)c1ccccc1OC(C)=O aspirin"));
+  double logP = Predict("logP", mol);
+  double MW = Predict("MW", mol);
+
+  string values = OBDescriptor::GetValues(&mol, "logP MW");
+  OB_REQUIRE(!values.empty());
+
+  // the memoized values are used by later descriptors, e.g. in --sort
+  string s;
+  OB_ASSERT(IsNear(OBDescriptor::FindType("logP")->GetCachedValue(&mol, s), logP));
+  OB_ASSERT(IsNear(OBDescriptor::FindType("MW")->GetCachedValue(&mol, s), MW));
+  OBDescriptorData* data = OBDescriptorData::Get(&mol, false);
+  OB_REQUIRE(data != nullptr);
+  OB_ASSERT(!data->IsSharing());
+  OB_ASSERT(data->GetShared("OBGroupContrib") == nullptr);
+}
+
+int descriptortest(int argc, char* argv[])
+{
+  int defaultchoice = 1;
+
+  int choice = defaultchoice;
+
+  if (argc > 1) {
+    if(sscanf(argv[1], "%d", &choice) != 1) {
+      printf("Couldn't parse that input as a number\n");
+      return -1;
+    }
+  }
+
+  // Define location of file formats for testing
+#ifdef FORMATDIR
+  char env[BUFF_SIZE];
+  snprintf(env, BUFF_SIZE, "BABEL_LIBDIR=%s", FORMATDIR);
+  putenv(env);
+#endif
+
+  switch(choice) {
+  case 1:
+    testBatch();
+    break;
+  case 2:
+    testGetValues();
+    break;
+  default:
+    cout << "Test number " << choice << " does not exist!\n";
+    return -1;
+  }
+
+  return 0;
+}
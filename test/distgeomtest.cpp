@@ -0,0 +1,90 @@
+#include "obtest.h"
+#include <openbabel/mol.h>
+#include <openbabel/atom.h>
+#include <openbabel/obconversion.h>
+#include <openbabel/distgeom.h>
+
+#include <cmath>
+
+using namespace std;
+using namespace OpenBabel;
+
+// RMS deviation of two coordinate arrays, without aligning them
+static double Deviation(const double *a, const double *b, unsigned int numAtoms)
+{
+  double sum = 0.0;
+  for (unsigned int i = 0; i < 3 * numAtoms; ++i)
+    sum += (a[i] - b[i]) * (a[i] - b[i]);
+  return sqrt(sum / numAtoms);
+}
+
+void test_AddConformers()
+{
+  OBConversion conv;
+  OB_REQUIRE(conv.SetInFormat("smi"));
+  OBMol mol;
+  OB_REQUIRE(conv.ReadString(&mol, "OCCCCCCN"));
+  mol.AddHydrogens();
+
+  OBDistanceGeometry dg;
+  OB_REQUIRE(dg.Setup(mol));
+  OBMol start(mol);
+  dg.GetConformers(start);
+  int before = start.NumConformers();
+
+  // all embeddings of a simple chain satisfy the bounds
+  const unsigned int numConformers = 5;
+  OB_COMPARE(dg.AddConformers(numConformers), numConformers);
+  OB_ASSERT(dg.WasSuccessful());
+
+  dg.GetConformers(mol);
+  OB_COMPARE(mol.NumConformers(), before + static_cast<int>(numConformers));
+
+  // the embeddings start from different random coordinates
+  unsigned int numAtoms = mol.NumAtoms();
+  for (int i = before; i < mol.NumConformers(); ++i) {
+    for (int j = i + 1; j < mol.NumConformers(); ++j)
+      OB_ASSERT(Deviation(mol.GetConformer(i), mol.GetConformer(j), numAtoms) > 0.1);
+    // and are sensible geometries: the C-O bond is about 1.4 A
+    mol.SetConformer(i);
+    double distance = mol.GetAtom(1)->GetDistance(mol.GetAtom(2));
+    OB_ASSERT(distance > 1.2 && distance < 1.6);
+  }
+
+  // the last embedding can be copied on its own
+  OBMol last(start);
+  OB_ASSERT(dg.GetLastConformer(last));
+  OB_ASSERT(Deviation(last.GetCoordinates(), mol.GetConformer(mol.NumConformers() - 1), numAtoms) < 1.0e-6);
+}
+
+int distgeomtest(int argc, char* argv[])
+{
+  int defaultchoice = 1;
+
+  int choice = defaultchoice;
+
+  if (argc > 1) {
+    if(sscanf(argv[1], "%d", &choice) != 1) {
+      printf("Couldn't parse that input as a number\n");
+      return -1;
+    }
+  }
+
+  // Define location of file formats for testing
+  #ifdef FORMATDIR
+    char env[BUFF_SIZE];
+    snprintf(env, BUFF_SIZE, "BABEL_LIBDIR=%s", FORMATDIR);
+    putenv(env);
+  #endif
+
+  switch(choice) {
+  case 1:
+    test_AddConformers();
+    break;
+  default:
+    cout << "Test number " << choice << " does not exist!\n";
+    return -1;
+  }
+
+  return 0;
+}
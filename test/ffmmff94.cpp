@@ -29,6 +29,7 @@ GNU General Public License for more details.
 #include <openbabel/mol.h>
 #include <openbabel/obconversion.h>
 #include <openbabel/forcefield.h>
+#include <openbabel/griddata.h>
 #include <openbabel/obutil.h>
 
 using namespace std;
@@ -163,6 +164,85 @@ void TestFile(string filename, string results_file, string method, double epsilo
     }
 } // end TestFile
 
+void TestProbeGrid(string filename)
+{
+  std::ifstream ifs;
+  if (!SafeOpen(ifs, filename.c_str()))
+    {
+      cout << "Bail out! Cannot read file " << filename << endl;
+      return;
+    }
+
+  OBMol mol;
+  OBConversion conv(&ifs, &cout);
+  OB_REQUIRE(conv.SetInFormat("SDF"));
+  OB_REQUIRE(conv.Read(&mol));
+
+  OBForceField* pFF = OBForceField::FindForceField("MMFF94");
+  OB_REQUIRE(pFF != nullptr);
+  pFF->SetLogLevel(OBFF_LOGLVL_NONE);
+  OB_REQUIRE(pFF->Setup(mol));
+  double energy = pFF->Energy(false);
+  OBFFConstraints constraints;
+  constraints.AddAtomConstraint(1);
+  pFF->SetConstraints(constraints);
+
+  OBGridData *full = pFF->GetGrid(0.5, 3.0, "7", -0.57);
+  OBGridData *all = pFF->GetGrid(0.5, 3.0, "7", -0.57, 1000.0);
+  OBGridData *cut = pFF->GetGrid(0.5, 3.0, "7", -0.57, 6.0, true);
+  OB_REQUIRE(full && all && cut);
+
+  // the force field is still set up for the molecule
+  OB_ASSERT(fabs(pFF->Energy(false) - energy) < 1.0e-6);
+  // and keeps its constraints
+  OB_COMPARE(pFF->GetConstraints().Size(), 1);
+  constraints.Clear();
+  pFF->SetConstraints(constraints);
+
+  OB_COMPARE(full->GetNumberOfPoints(), cut->GetNumberOfPoints());
+  OB_ASSERT(!full->GetFloatPrecision());
+  OB_ASSERT(cut->GetFloatPrecision());
+
+  vector<double> fullValues = full->GetValues();
+  vector<double> allValues = all->GetValues();
+  vector<double> cutValues = cut->GetValues();
+  unsigned int inside = 0, differ = 0;
+  for (size_t i = 0; i < fullValues.size(); ++i) {
+    if (fullValues[i] > 1.0e90) {
+      ++inside;
+      OB_ASSERT(cutValues[i] > 1.0e30);
+      continue;
+    }
+    OB_ASSERT(fabs(allValues[i] - fullValues[i]) < 1.0e-6 * std::max(1.0, fabs(fullValues[i])));
+    // only atoms more than 6 A away are left out
+    if (fabs(cutValues[i] - fullValues[i]) > 1.0e-4 * std::max(1.0, fabs(fullValues[i])))
+      ++differ;
+  }
+  OB_ASSERT(inside > 0);
+  OB_ASSERT(differ < fullValues.size() / 2);
+
+  // float storage interpolates like the double one
+  OBGridData grid;
+  grid.SetNumberOfPoints(4, 5, 6);
+  grid.SetLimits(vector3(0.0, 0.0, 0.0), vector3(0.5, 0.0, 0.0), vector3(0.0, 0.5, 0.0), vector3(0.0, 0.0, 0.5));
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 5; ++j)
+      for (int k = 0; k < 6; ++k)
+        grid.SetValue(i, j, k, i + 2.0 * j - 0.5 * k);
+  vector3 pos(0.6, 1.1, 0.9);
+  double value = grid.GetValue(pos);
+  grid.SetFloatPrecision(true);
+  OB_ASSERT(fabs(grid.GetValue(pos) - value) < 1.0e-5);
+  OB_ASSERT(fabs(grid.GetValue(3, 4, 5) - (3.0 + 8.0 - 2.5)) < 1.0e-6);
+  grid.SetValue(1, 1, 1, 0.25);
+  grid.SetFloatPrecision(false);
+  OB_ASSERT(fabs(grid.GetValue(1, 1, 1) - 0.25) < 1.0e-12);
+
+  delete full;
+  delete all;
+  delete cut;
+}
+
 int ffmmff94(int argc, char* argv[])
 {
   int defaultchoice = 1;
@@ -217,6 +297,9 @@ int ffmmff94(int argc, char* argv[])
   case 6:
     TestFile(testdatadir + "more-mmff94.sdf", testdatadir + "more-mmff94e4sresults.txt", "MMFF94", 4.0);
     break;
+  case 7:
+    TestProbeGrid(testdatadir + "forcefield.sdf");
+    break;
   default:
     cout << "Test number " << choice << " does not exist!\n";
     return -1;
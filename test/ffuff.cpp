@@ -30,6 +30,7 @@ GNU General Public License for more details.
 #include <openbabel/obconversion.h>
 #include <openbabel/forcefield.h>
 #include <openbabel/obutil.h>
+#include <openbabel/griddata.h>
 
 using namespace std;
 using namespace OpenBabel;
@@ -147,6 +148,27 @@ int ffuff(int argc, char* argv[])
         }
       else
         cout << "ok " << ++currentTest << " # gradients \n";
+
+      // probe grid on the first molecule, which adds the probe to the molecule
+      if (currentTest == 2) {
+        OBGridData *grid = pFF->GetGrid(1.0, 2.0, "N_3", -0.5);
+        OBGridData *cut = pFF->GetGrid(1.0, 2.0, "N_3", -0.5, 6.0);
+        bool inside = false, same = grid && cut;
+        if (same) {
+          vector<double> values = grid->GetValues();
+          vector<double> cutValues = cut->GetValues();
+          for (size_t i = 0; i < values.size(); ++i) {
+            inside = inside || values[i] > 1.0e90;
+            same = same && fabs(values[i] - cutValues[i]) < 1.0e-6 * std::max(1.0, fabs(values[i]));
+          }
+        }
+        if (!inside || !same || fabs(pFF->Energy(false) - energy) > 1.0e-6)
+          cout << "not ok " << ++currentTest << " # probe grid for molecule " << mol.GetTitle() << "\n";
+        else
+          cout << "ok " << ++currentTest << " # probe grid \n";
+        delete grid;
+        delete cut;
+      }
     }
 
   // return number of tests run
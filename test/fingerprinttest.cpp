@@ -0,0 +1,250 @@
+#include "obtest.h"
+
+#include <openbabel/mol.h>
+#include <openbabel/obconversion.h>
+#include <openbabel/fingerprint.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace OpenBabel;
+
+typedef OBFingerprint::FeatureCount FeatureCount;
+
+static OBMol Read(const string &smiles)
+{
+  OBConversion conv;
+  conv.SetInFormat("smi");
+  OBMol mol;
+  conv.ReadString(&mol, smiles);
+  return mol;
+}
+
+static unsigned int Total(const vector<FeatureCount> &features)
+{
+  unsigned int total = 0;
+  for (unsigned int i = 0; i < features.size(); ++i)
+    total += features[i].second;
+  return total;
+}
+
+void testCounts()
+{
+  OBFingerprint *pFP = OBFingerprint::FindFingerprint("ECFP4");
+  OB_REQUIRE(pFP != nullptr);
+
+  // The environments of radius 2 of propane contain both bonds, as does that
+  // of radius 1 of the middle atom, so are left out. The ends are the same.
+  OBMol mol = Read("CCC");
+  vector<FeatureCount> features;
+  OB_REQUIRE(pFP->GetCountFingerprint(&mol, features));
+  OB_COMPARE(features.size(), 4u);
+  OB_COMPARE(Total(features), 6u);
+  for (unsigned int i = 1; i < features.size(); ++i)
+    OB_ASSERT(features[i-1].first < features[i].first);
+
+  // Every feature is in the folded fingerprint
+  mol = Read("CC(=O)Oc1ccccc1C(=O)O");
+  OB_REQUIRE(pFP->GetCountFingerprint(&mol, features));
+  OB_COMPARE(Total(features) > mol.NumHvyAtoms(), true);
+  vector<unsigned int> fp;
+  OB_REQUIRE(pFP->GetFingerprint(&mol, fp, 1024));
+  vector<FeatureCount> folded(features);
+  OBFingerprint::FoldFeatures(folded, 1024);
+  OB_COMPARE(Total(folded), Total(features));
+  for (unsigned int i = 0; i < folded.size(); ++i) {
+    OB_ASSERT(folded[i].first < 1024);
+    OB_ASSERT(pFP->GetBit(fp, folded[i].first));
+  }
+
+  // Fingerprints made from patterns do not have counts
+  OB_ASSERT(!OBFingerprint::FindFingerprint("FP2")->GetCountFingerprint(&mol, features));
+}
+
+void testRadius()
+{
+  // Any radius can be defined in plugindefines.txt
+  OBFingerprint *pFP12 = OBFingerprint::FindFingerprint("ECFP12");
+  OB_REQUIRE(pFP12 != nullptr);
+  OBFingerprint *pFP10 = OBFingerprint::FindFingerprint("ECFP10");
+  OB_REQUIRE(pFP10 != nullptr);
+
+  vector<FeatureCount> features12, features10;
+  OBMol mol = Read("CCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCC");
+  OB_REQUIRE(pFP12->GetCountFingerprint(&mol, features12));
+  OB_REQUIRE(pFP10->GetCountFingerprint(&mol, features10));
+  OB_ASSERT(features12.size() > features10.size());
+  vector<unsigned int> fp;
+  OB_REQUIRE(pFP12->GetFingerprint(&mol, fp));
+  OB_COMPARE(fp.size() * OBFingerprint::Getbitsperint(), 4096u);
+
+  // Past the size of the molecule there is nothing more
+  mol = Read("CC(C)C");
+  OB_REQUIRE(pFP12->GetCountFingerprint(&mol, features12));
+  OB_REQUIRE(pFP10->GetCountFingerprint(&mol, features10));
+  OB_ASSERT(features12 == features10);
+
+  // FCFP does not distinguish atoms of the same functional classes
+  OBFingerprint *pFCFP = OBFingerprint::FindFingerprint("FCFP0");
+  OB_REQUIRE(pFCFP != nullptr);
+  mol = Read("CCl.CBr.CO");
+  OB_REQUIRE(pFCFP->GetCountFingerprint(&mol, features10));
+  OB_COMPARE(features10.size(), 3u); // no class, halogen, and the hydroxyl donor and acceptor
+  OB_REQUIRE(OBFingerprint::FindFingerprint("ECFP0")->GetCountFingerprint(&mol, features10));
+  OB_COMPARE(features10.size(), 4u);
+}
+
+void testBulk()
+{
+  const char *smiles[] = { "c1ccccc1O", "CCN(CC)CC", "OC(=O)CCl", "C" };
+  vector<OBMol> mols;
+  for (unsigned int i = 0; i < 4; ++i)
+    mols.push_back(Read(smiles[i]));
+  vector<OBBase*> objects;
+  for (unsigned int i = 0; i < mols.size(); ++i)
+    objects.push_back(&mols[i]);
+
+  const char *ids[] = { "FP2", "ECFP4" };
+  for (unsigned int t = 0; t < 2; ++t) {
+    OBFingerprint *pFP = OBFingerprint::FindFingerprint(ids[t]);
+    OB_REQUIRE(pFP != nullptr);
+    vector<unsigned int> buffer, fp;
+    unsigned int words;
+    OB_REQUIRE(pFP->GetFingerprints(objects, buffer, words, 512));
+    OB_COMPARE(words * OBFingerprint::Getbitsperint(), 512u);
+    OB_COMPARE(buffer.size(), 4 * words);
+    for (unsigned int i = 0; i < 4; ++i) {
+      fp.clear();
+      OB_REQUIRE(pFP->GetFingerprint(objects[i], fp, 512));
+      OB_ASSERT(equal(fp.begin(), fp.end(), buffer.begin() + i * words));
+    }
+  }
+
+  OBFingerprint *pFP = OBFingerprint::FindFingerprint("ECFP4");
+  vector<FeatureCount> features, single;
+  vector<size_t> offsets;
+  OB_REQUIRE(pFP->GetCountFingerprints(objects, features, offsets));
+  OB_COMPARE(offsets.size(), 5u);
+  OB_COMPARE(offsets.back(), features.size());
+  for (unsigned int i = 0; i < 4; ++i) {
+    OB_REQUIRE(pFP->GetCountFingerprint(objects[i], single));
+    OB_ASSERT(vector<FeatureCount>(features.begin() + offsets[i],
+                                   features.begin() + offsets[i+1]) == single);
+  }
+}
+
+void testCluster()
+{
+  // the first 200 molecules of nci.smi
+  OBConversion conv;
+  OB_REQUIRE(conv.SetInFormat("smi"));
+  ifstream ifs(OBTestUtil::GetFilename("nci.smi").c_str());
+  OB_REQUIRE(ifs.good());
+  vector<OBMol> mols(200);
+  for (unsigned int i = 0; i < mols.size(); ++i)
+    OB_REQUIRE(conv.Read(&mols[i], &ifs));
+  vector<OBBase*> objects;
+  for (unsigned int i = 0; i < mols.size(); ++i)
+    objects.push_back(&mols[i]);
+  OBFingerprint *pFP = OBFingerprint::FindFingerprint("FP2");
+  vector<unsigned int> buffer;
+  unsigned int words;
+  OB_REQUIRE(pFP->GetFingerprints(objects, buffer, words, 256));
+  unsigned int n = mols.size();
+
+  // the neighbors are the same as those from comparing all the pairs
+  const double threshold = 0.6;
+  vector<size_t> offsets;
+  vector<unsigned int> neighbors;
+  OB_REQUIRE(FastSearch::FindNeighbors(&buffer[0], n, words, threshold, offsets, neighbors));
+  OB_COMPARE(offsets.size(), n + 1);
+  vector<unsigned int> fpi(words), fpj(words);
+  size_t total = 0;
+  for (unsigned int i = 0; i < n; ++i) {
+    fpi.assign(buffer.begin() + i * words, buffer.begin() + (i + 1) * words);
+    vector<unsigned int> expected;
+    for (unsigned int j = 0; j < n; ++j) {
+      fpj.assign(buffer.begin() + j * words, buffer.begin() + (j + 1) * words);
+      if (j != i && OBFingerprint::Tanimoto(fpi, fpj) >= threshold)
+        expected.push_back(j);
+    }
+    OB_ASSERT(vector<unsigned int>(neighbors.begin() + offsets[i],
+                                   neighbors.begin() + offsets[i+1]) == expected);
+    total += expected.size();
+  }
+  OB_COMPARE(neighbors.size(), total);
+  OB_ASSERT(total > 0);
+
+  // every molecule is in one cluster, and is a neighbor of its center
+  vector<unsigned int> clusters, centroids;
+  unsigned int numClusters = FastSearch::ButinaCluster(offsets, neighbors, clusters, centroids);
+  OB_COMPARE(numClusters, centroids.size());
+  OB_ASSERT(numClusters > 1 && numClusters < n);
+  vector<unsigned int> sizes(numClusters + 1, 0);
+  for (unsigned int i = 0; i < n; ++i) {
+    OB_REQUIRE(clusters[i] >= 1 && clusters[i] <= numClusters);
+    ++sizes[clusters[i]];
+    unsigned int center = centroids[clusters[i] - 1];
+    OB_ASSERT(i == center || binary_search(neighbors.begin() + offsets[center],
+                                           neighbors.begin() + offsets[center+1], i));
+  }
+  // the first center has the most neighbors
+  for (unsigned int i = 0; i < n; ++i)
+    OB_ASSERT(offsets[i+1] - offsets[i] <= offsets[centroids[0]+1] - offsets[centroids[0]]);
+  OB_COMPARE(sizes[1], offsets[centroids[0]+1] - offsets[centroids[0]] + 1);
+
+  // leader clustering takes the centers in order
+  OB_REQUIRE(FastSearch::ButinaCluster(offsets, neighbors, clusters, centroids, true) > 1);
+  OB_COMPARE(centroids[0], 0u);
+  for (unsigned int c = 1; c < centroids.size(); ++c)
+    OB_ASSERT(centroids[c] > centroids[c-1]);
+
+  obErrorLog.StopLogging();
+  OB_ASSERT(!FastSearch::FindNeighbors(&buffer[0], n, words, 0.0, offsets, neighbors));
+  obErrorLog.StartLogging();
+}
+
+int fingerprinttest(int argc, char* argv[])
+{
+  int defaultchoice = 1;
+
+  int choice = defaultchoice;
+
+  if (argc > 1) {
+    if(sscanf(argv[1], "%d", &choice) != 1) {
+      printf("Couldn't parse that input as a number\n");
+      return -1;
+    }
+  }
+
+  // Define location of file formats for testing
+#ifdef FORMATDIR
+  char env[BUFF_SIZE];
+  snprintf(env, BUFF_SIZE, "BABEL_LIBDIR=%s", FORMATDIR);
+  putenv(env);
+#endif
+
+  switch(choice) {
+  case 1:
+    testCounts();
+    break;
+  case 2:
+    testRadius();
+    break;
+  case 3:
+    testBulk();
+    break;
+  case 4:
+    testCluster();
+    break;
+  default:
+    cout << "Test number " << choice << " does not exist!\n";
+    return -1;
+  }
+
+  return 0;
+}
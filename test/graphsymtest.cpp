@@ -6,6 +6,7 @@
 #include <openbabel/stereo/cistrans.h>
 #include <openbabel/graphsym.h>
 #include <openbabel/atom.h>
+#include <openbabel/bond.h>
 #include <openbabel/obiter.h>
 
 #include <openbabel/canon.h>
@@ -113,6 +114,74 @@ void countGraphSymClassesTest(const std::string &filename, int numberOfClasses)
   }
 }
 
+void cachedGraphSymTest()
+{
+  cout << "Testing cached symmetry classes" << endl;
+  OBMol mol;
+  OBConversion conv;
+  OB_REQUIRE( conv.SetInFormat("smi") );
+  OB_REQUIRE( conv.ReadString(&mol, "OCC(O)CO") );
+
+  std::vector<unsigned int> symclasses1, symclasses2;
+  OBGraphSym gs1(&mol);
+  int n1 = gs1.GetSymmetry(symclasses1);
+  OB_ASSERT( n1 == 4 );
+  OB_ASSERT( mol.GetData("OpenBabel Symmetry Classes") != nullptr );
+
+  // a second lookup returns the cached classes
+  OBGraphSym gs2(&mol);
+  OB_ASSERT( gs2.GetSymmetry(symclasses2) == n1 );
+  OB_ASSERT( symclasses1 == symclasses2 );
+
+  // fragments are cached separately
+  OBBitVec frag;
+  frag.SetBitOn(1);
+  frag.SetBitOn(2);
+  frag.SetBitOn(3);
+  OBGraphSym gs3(&mol, &frag);
+  std::vector<unsigned int> fragclasses;
+  OB_ASSERT( gs3.GetSymmetry(fragclasses) == 3 );
+  OB_ASSERT( fragclasses[4] == OBGraphSym::NoSymmetryClass );
+  OBGraphSym gs4(&mol);
+  OB_ASSERT( gs4.GetSymmetry(symclasses2) == n1 );
+  OB_ASSERT( symclasses1 == symclasses2 );
+
+  // changing the structure invalidates the cached classes
+  mol.GetAtom(1)->SetAtomicNum(7);
+  OBGraphSym gs5(&mol);
+  OB_ASSERT( gs5.GetSymmetry(symclasses2) == 6 );
+
+  OBMol copy;
+  OB_REQUIRE( conv.ReadString(&copy, "NCC(O)CO") );
+  std::vector<unsigned int> symclasses3;
+  OBGraphSym gs6(&copy);
+  gs6.GetSymmetry(symclasses3);
+  OB_ASSERT( symclasses2 == symclasses3 );
+
+  // so does a change of the bond aromaticity, which keeps the bond orders
+  OB_REQUIRE( conv.ReadString(&mol, "OCC(O)CO") );
+  OBGraphSym gs7(&mol);
+  OB_ASSERT( gs7.GetSymmetry(symclasses1) == 4 );
+  mol.GetBond(1)->SetAromatic();
+  OBGraphSym gs8(&mol);
+  OB_ASSERT( gs8.GetSymmetry(symclasses2) == 6 );
+
+  // more fragments than the cache holds still give the right classes
+  OB_REQUIRE( conv.ReadString(&mol, "CCCCCCCCCCCCCCCCCCCC") );
+  for (unsigned int end = 2; end <= 20; ++end)
+    for (unsigned int begin = 1; begin < end; ++begin) {
+      OBBitVec chain;
+      chain.SetRangeOn(begin, end);
+      OBGraphSym gs(&mol, &chain);
+      OB_ASSERT( gs.GetSymmetry(symclasses1) == static_cast<int>(end - begin + 2) / 2 );
+    }
+  OBBitVec chain;
+  chain.SetRangeOn(1, 3);
+  OBGraphSym gs9(&mol, &chain);
+  OB_ASSERT( gs9.GetSymmetry(symclasses1) == 2 );
+  OB_ASSERT( symclasses1[3] == OBGraphSym::NoSymmetryClass );
+}
+
 int graphsymtest(int argc, char* argv[])
 {
   int defaultchoice = 1;
@@ -235,6 +304,9 @@ int graphsymtest(int argc, char* argv[])
     //countGraphSymClassesTest("stereo/razinger_fig7_68.mol", 3); // missing
     countGraphSymClassesTest("stereo/razinger_fig7_69.mol", 2);
     break;
+  case 6:
+    cachedGraphSymTest();
+    break;
   default:
     cout << "Test number " << choice << " does not exist!\n";
     return -1;
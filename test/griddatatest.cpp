@@ -0,0 +1,164 @@
+#include "obtest.h"
+
+#include <openbabel/mol.h>
+#include <openbabel/obconversion.h>
+#include <openbabel/griddata.h>
+#include <openbabel/tokenst.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+using namespace OpenBabel;
+
+static void CompareWithStrtod(const char *str)
+{
+  char *end1, *end2;
+  double expected = strtod(str, &end1);
+  double value = ParseDouble(str, &end2);
+  // same bits, so that 0.0 and -0.0 are told apart
+  OB_ASSERT(memcmp(&expected, &value, sizeof(double)) == 0);
+  OB_COMPARE(end2 - str, end1 - str);
+}
+
+void testParseDouble()
+{
+  const char *strings[] = {
+    "0", "-0", "+0.0", "1", "-1", "1.5", " \t 42.25", "3.", ".5", "-.5e-3",
+    "1e22", "1e23", "1e-22", "1e-23", "4.9e-324", "1.7976931348623157e308",
+    "0.1", "0.30000000000000004", "123456789012345", "1234567890123456789",
+    "0.0000000000000000000000000001", "1.0E+00", "-2.50000e-05", "7e", "7e+",
+    "7e-x", "1.5.5", "1,5", "abc", "", "-", ".", "e5", "0x1p3", "inf", "nan",
+    "00000000000000000000000012.5", "1.000000000000000000000000",
+    " 1.23456E-05", "-9.87654E+02"
+  };
+  for (unsigned int i = 0; i < sizeof(strings) / sizeof(strings[0]); ++i)
+    CompareWithStrtod(strings[i]);
+
+  // numbers as they are written by programs producing cube and dx files
+  srand(17);
+  char buffer[64];
+  for (int i = 0; i < 100000; ++i) {
+    double x = (rand() - RAND_MAX / 2) * pow(10.0, rand() % 40 - 20) / RAND_MAX;
+    snprintf(buffer, sizeof(buffer), i % 2 ? "%.*E" : "%.*f", rand() % 17, x);
+    CompareWithStrtod(buffer);
+  }
+}
+
+void testCubeValues()
+{
+  // two interleaved cubes on a 2x2x3 grid
+  stringstream cube;
+  cube << "comment\ncomment\n"
+       << "   -1    0.000000    0.000000    0.000000\n"
+       << "    2    0.500000    0.000000    0.000000\n"
+       << "    2    0.000000    0.500000    0.000000\n"
+       << "    3    0.000000    0.000000    0.500000\n"
+       << "    1    1.000000    0.000000    0.000000    0.000000\n"
+       << "    2    5    6\n";
+  for (int i = 0; i < 12; ++i) {
+    cube << " " << 0.25 * i << " " << -0.5 * i;
+    if (i % 3 == 2)
+      cube << "\n";
+  }
+
+  OBConversion conv;
+  OB_REQUIRE(conv.SetInFormat("cube"));
+  for (int precision = 0; precision < 2; ++precision) {
+    if (precision)
+      conv.AddOption("p", OBConversion::INOPTIONS);
+    OBMol mol;
+    OB_REQUIRE(conv.ReadString(&mol, cube.str()));
+    vector<OBGenericData*> grids = mol.GetAllData(OBGenericDataType::GridData);
+    OB_REQUIRE(grids.size() == 2);
+    OBGridData *mo5 = static_cast<OBGridData*>(grids[0]);
+    OBGridData *mo6 = static_cast<OBGridData*>(grids[1]);
+    OB_COMPARE(mo5->GetFloatPrecision(), precision == 1);
+    OB_COMPARE(mo5->GetAttribute(), "MO 5");
+    OB_COMPARE(mo5->GetNumberOfPoints(), 12);
+    // the last axis varies fastest
+    OB_COMPARE(mo5->GetValue(0, 0, 1), 0.25);
+    OB_COMPARE(mo5->GetValue(1, 1, 2), 2.75);
+    OB_COMPARE(mo6->GetValue(1, 1, 2), -5.5);
+    OB_COMPARE(mo6->GetMinValue(), -5.5);
+    OB_COMPARE(mo6->GetMaxValue(), 0.0);
+  }
+}
+
+void testDXValues()
+{
+  stringstream dx;
+  dx << "# comment\n"
+     << "object 1 class gridpositions counts 2 2 2\n"
+     << "origin 0.0 0.0 0.0\n"
+     << "delta 1.0 0.0 0.0\n"
+     << "delta 0.0 1.0 0.0\n"
+     << "delta 0.0 0.0 1.0\n"
+     << "object 2 class gridconnections counts 2 2 2\n"
+     << "object 3 class array type double rank 0 times 8 data follows\n"
+     << "1.0e+00 2.0e+00 -3.5e-01\n"
+     << "4.0e+00 5.0e+00 6.0e+00\n"
+     << "7.0e+00 8.0e+00\n"
+     << "attribute \"dep\" string \"positions\"\n"
+     << "object \"regular positions regular connections\" class field\n"
+     << "component \"positions\" value 1\n"
+     << "component \"connections\" value 2\n"
+     << "component \"data\" value 3\n";
+
+  OBConversion conv;
+  OB_REQUIRE(conv.SetInFormat("dx"));
+  for (int precision = 0; precision < 2; ++precision) {
+    if (precision)
+      conv.AddOption("p", OBConversion::INOPTIONS);
+    OBMol mol;
+    OB_REQUIRE(conv.ReadString(&mol, dx.str()));
+    OBGridData *grid = static_cast<OBGridData*>(mol.GetData(OBGenericDataType::GridData));
+    OB_REQUIRE(grid != nullptr);
+    OB_COMPARE(grid->GetFloatPrecision(), precision == 1);
+    OB_COMPARE(grid->GetNumberOfPoints(), 8);
+    OB_ASSERT(fabs(grid->GetValue(0, 0, 0) - 1.0) < 1.0e-6);
+    OB_ASSERT(fabs(grid->GetValue(1, 1, 1) - 8.0) < 1.0e-6);
+    OB_ASSERT(fabs(grid->GetMinValue() + 0.35) < 1.0e-6);
+  }
+}
+
+int griddatatest(int argc, char* argv[])
+{
+  int defaultchoice = 1;
+
+  int choice = defaultchoice;
+
+  if (argc > 1) {
+    if(sscanf(argv[1], "%d", &choice) != 1) {
+      printf("Couldn't parse that input as a number\n");
+      return -1;
+    }
+  }
+
+  // Define location of file formats for testing
+#ifdef FORMATDIR
+  char env[BUFF_SIZE];
+  snprintf(env, BUFF_SIZE, "BABEL_LIBDIR=%s", FORMATDIR);
+  putenv(env);
+#endif
+
+  switch(choice) {
+  case 1:
+    testParseDouble();
+    break;
+  case 2:
+    testCubeValues();
+    break;
+  case 3:
+    testDXValues();
+    break;
+  default:
+    cout << "Test number " << choice << " does not exist!\n";
+    return -1;
+  }
+
+  return 0;
+}
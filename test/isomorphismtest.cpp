@@ -7,6 +7,8 @@
 #include <openbabel/elements.h>
 #include <openbabel/obiter.h>
 
+#include <algorithm>
+
 using namespace std;
 using namespace OpenBabel;
 
@@ -275,6 +277,79 @@ void testIsomorphism9()
   delete mapper;
 }
 
+std::vector<std::vector<unsigned int> > sortedMappings(const OBIsomorphismMapper::Mappings &maps)
+{
+  std::vector<std::vector<unsigned int> > result;
+  for (std::size_t i = 0; i < maps.size(); ++i) {
+    OBIsomorphismMapper::Mapping map(maps[i]);
+    std::sort(map.begin(), map.end());
+    std::vector<unsigned int> values;
+    for (std::size_t j = 0; j < map.size(); ++j)
+      values.push_back(map[j].second);
+    result.push_back(values);
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+void testVF2PP(const std::string &smiles, const std::string &smarts)
+{
+  cout << "testVF2PP: " << smiles << " " << smarts << endl;
+  OBMol mol;
+  OBConversion conv;
+  conv.SetInFormat("smi");
+  OB_REQUIRE( conv.ReadString(&mol, smiles) );
+
+  OBQuery *query = smarts.empty() ? CompileMoleculeQuery(&mol) : CompileSmilesQuery(smarts);
+  OBIsomorphismMapper *vf2 = OBIsomorphismMapper::GetInstance(query, "VF2");
+  OBIsomorphismMapper *vf2pp = OBIsomorphismMapper::GetInstance(query, "VF2++");
+
+  OBIsomorphismMapper::Mappings maps1, maps2;
+  vf2->MapAll(&mol, maps1);
+  vf2pp->MapAll(&mol, maps2);
+  OB_ASSERT( maps1.size() == maps2.size() );
+  OB_ASSERT( sortedMappings(maps1) == sortedMappings(maps2) );
+
+  vf2->MapUnique(&mol, maps1);
+  vf2pp->MapUnique(&mol, maps2);
+  OB_ASSERT( maps1.size() == maps2.size() );
+
+  OBIsomorphismMapper::Mapping map;
+  vf2pp->MapFirst(&mol, map);
+  OB_ASSERT( map.size() == (maps1.empty() ? 0 : query->NumAtoms()) );
+
+  delete vf2;
+  delete vf2pp;
+  delete query;
+}
+
+void testVF2PPMapper()
+{
+  testVF2PP("CC1CCC(C)CC1", "");
+  testVF2PP("CC1CCC(C)CC1", "C1(C)CCC(C)CC1");
+  testVF2PP("Cc1ccc(C)cc1", "c1ccccc1");
+  testVF2PP("C1CC1CC1CC1", "C1CC1");
+  testVF2PP("C12C(C2)C1", "C1CC1");
+  testVF2PP("Cc1onc(C)c1", "");
+  testVF2PP("CC(C)(C)c1cc(cc(c1)C(C)(C)C)C(C)(C)C", "");
+  testVF2PP("C12C3C4C1C5C2C3C45", "");
+  testVF2PP("OC(=O)CC(O)(CC(=O)O)C(=O)O", "C(=O)O");
+  testVF2PP("c1ccccc1.c1ccccc1", "c1ccccc1");
+  testVF2PP("CCO", "N");
+
+  // automorphisms of cubane (order 48) and neopentane (order 24)
+  OBMol mol;
+  OBConversion conv;
+  conv.SetInFormat("smi");
+  conv.ReadString(&mol, "C12C3C4C1C5C2C3C45");
+  Automorphisms aut;
+  FindAutomorphisms(&mol, aut);
+  OB_ASSERT( aut.size() == 48 );
+  conv.ReadString(&mol, "CC(C)(C)C");
+  FindAutomorphisms(&mol, aut);
+  OB_ASSERT( aut.size() == 24 );
+}
+
 int isomorphismtest(int argc, char* argv[])
 {
   int defaultchoice = 1;
@@ -324,6 +399,9 @@ int isomorphismtest(int argc, char* argv[])
   case 9:
     testIsomorphism9();
     break;
+  case 10:
+    testVF2PPMapper();
+    break;
   default:
     cout << "Test number " << choice << " does not exist!\n";
     return -1;
@@ -0,0 +1,96 @@
+#include "obtest.h"
+
+#include <openbabel/oberror.h>
+
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+using namespace OpenBabel;
+
+static string Message(int i)
+{
+  stringstream ss;
+  ss << "message " << i;
+  return ss.str();
+}
+
+void testRing()
+{
+  OBMessageHandler handler;
+  stringstream output;
+  handler.SetOutputStream(&output);
+  OB_COMPARE(handler.GetMaxLogEntries(), 100u);
+
+  handler.SetMaxLogEntries(10);
+  for (int i = 0; i < 25; ++i)
+    handler.ThrowError("testRing", Message(i), i % 2 ? obWarning : obInfo);
+
+  // only the last ten are kept, oldest first, but all of them are counted
+  vector<string> warnings = handler.GetMessagesOfLevel(obWarning);
+  OB_COMPARE(warnings.size(), 5u);
+  OB_ASSERT(warnings[0].find("message 15\n") != string::npos);
+  OB_ASSERT(warnings[4].find("message 23\n") != string::npos);
+  OB_COMPARE(handler.GetMessagesOfLevel(obInfo).size(), 5u);
+  OB_COMPARE(handler.GetWarningMessageCount(), 12u);
+  OB_COMPARE(handler.GetInfoMessageCount(), 13u);
+
+  // obInfo is above the default output level of obWarning
+  OB_ASSERT(output.str().find("message 23\n") != string::npos);
+  OB_ASSERT(output.str().find("message 24\n") == string::npos);
+
+  // a smaller log keeps the most recent messages
+  handler.SetMaxLogEntries(4);
+  warnings = handler.GetMessagesOfLevel(obWarning);
+  OB_COMPARE(warnings.size(), 2u);
+  OB_ASSERT(warnings[0].find("message 21\n") != string::npos);
+
+  // onceOnly messages are only written if they are not in the log
+  output.str("");
+  handler.ThrowError("testRing", Message(23), obWarning, onceOnly);
+  OB_COMPARE(output.str().size(), 0u);
+  handler.ThrowError("testRing", Message(3), obWarning, onceOnly);
+  OB_ASSERT(output.str().find("message 3\n") != string::npos);
+
+  handler.ClearLog();
+  OB_COMPARE(handler.GetMessagesOfLevel(obWarning).size(), 0u);
+  // the entries are reused from the start after clearing
+  handler.ThrowError("testRing", Message(30), obWarning);
+  warnings = handler.GetMessagesOfLevel(obWarning);
+  OB_COMPARE(warnings.size(), 1u);
+  OB_ASSERT(warnings[0].find("message 30\n") != string::npos);
+
+  // 0 is the largest log rather than an unbounded one
+  handler.SetMaxLogEntries(0);
+  OB_COMPARE(handler.GetMaxLogEntries(), 65536u);
+  OB_COMPARE(handler.GetMessagesOfLevel(obWarning).size(), 1u);
+
+  handler.StopLogging();
+  handler.ThrowError("testRing", Message(100), obError);
+  OB_COMPARE(handler.GetErrorMessageCount(), 0u);
+}
+
+int messagehandlertest(int argc, char* argv[])
+{
+  int defaultchoice = 1;
+
+  int choice = defaultchoice;
+
+  if (argc > 1) {
+    if(sscanf(argv[1], "%d", &choice) != 1) {
+      printf("Couldn't parse that input as a number\n");
+      return -1;
+    }
+  }
+
+  switch(choice) {
+  case 1:
+    testRing();
+    break;
+  default:
+    cout << "Test number " << choice << " does not exist!\n";
+    return -1;
+  }
+
+  return 0;
+}
@@ -235,6 +235,38 @@ int mol(int argc, char* argv[])
       std::cout << "not ok 15 # CalcTorsionAngle " << dihedral << "!= 180.0" << std::endl;
   }
 
-  cout << "1..15\n"; // total number of tests for Perl's "prove" tool
+  // ConnectTheDots on a thin slab of waters (many atoms share each z)
+  // plus one far-away atom, which must not blow up the neighbour grid
+  OBMol slab;
+  slab.BeginModify();
+  for (int i = 0; i < 40; ++i)
+    for (int j = 0; j < 40; ++j)
+      for (int k = 0; k < 2; ++k) {
+        double x = 3.1 * i, y = 3.1 * j, z = 3.1 * k;
+        OBAtom *o = slab.NewAtom();
+        o->SetAtomicNum(8);
+        o->SetVector(x, y, z);
+        OBAtom *h = slab.NewAtom();
+        h->SetAtomicNum(1);
+        h->SetVector(x + 0.96, y, z);
+        h = slab.NewAtom();
+        h->SetAtomicNum(1);
+        h->SetVector(x - 0.24, y + 0.93, z);
+      }
+  OBAtom *far = slab.NewAtom();
+  far->SetAtomicNum(18);
+  far->SetVector(1.0e5, -1.0e5, 1.0e5);
+  slab.EndModify();
+  slab.ConnectTheDots();
+  bool waterBonds = slab.NumBonds() == 2 * 40 * 40 * 2;
+  for (unsigned int idx = 1; waterBonds && idx < slab.NumAtoms(); idx += 3)
+    waterBonds = slab.GetBond(idx, idx + 1) && slab.GetBond(idx, idx + 2);
+  if (waterBonds) {
+    cout << "ok 16" << endl;
+  } else {
+    cout << "not ok 16 # ConnectTheDots found " << slab.NumBonds() << " bonds" << endl;
+  }
+
+  cout << "1..16\n"; // total number of tests for Perl's "prove" tool
   return(0);
 }
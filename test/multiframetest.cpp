@@ -0,0 +1,184 @@
+#include "obtest.h"
+
+#include <openbabel/mol.h>
+#include <openbabel/atom.h>
+#include <openbabel/obconversion.h>
+
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+using namespace OpenBabel;
+
+static string PDBModel(int model, double shift)
+{
+  stringstream ss;
+  ss << "MODEL     " << model << "\n";
+  char line[100];
+  const char *names[] = { " O  ", " H1 ", " H2 " };
+  const double xyz[3][3] = { { 0.0, 0.0, 0.0 }, { 0.96, 0.0, 0.0 }, { -0.24, 0.93, 0.0 } };
+  for (int i = 0; i < 3; ++i) {
+    snprintf(line, sizeof(line), "HETATM%5d %s HOH A   1    %8.3f%8.3f%8.3f  1.00  0.00           %c\n",
+             i + 1, names[i], xyz[i][0] + shift, xyz[i][1], xyz[i][2], i ? 'H' : 'O');
+    ss << line;
+  }
+  ss << "ENDMDL\n";
+  return ss.str();
+}
+
+static string XYZFrame(int natoms, double shift)
+{
+  stringstream ss;
+  ss << natoms << "\nframe\n";
+  for (int i = 0; i < natoms; ++i)
+    ss << (i ? "H " : "O ") << (i == 1 ? 0.96 : 0.0) + shift << " " << (i == 2 ? 0.93 : 0.0) << " 0.0\n";
+  return ss.str();
+}
+
+// every frame but the first was read as a conformer shifted by 0.1 * frame
+static void CheckConformers(OBMol &mol, int nconformers)
+{
+  OB_COMPARE(mol.NumConformers(), nconformers);
+  OB_COMPARE(mol.NumBonds(), 2);
+  for (int i = 0; i < mol.NumConformers(); ++i)
+    OB_ASSERT(fabs(mol.GetConformer(i)[0] - 0.1 * i) < 1.0e-6);
+  // the current coordinates are those of the first frame
+  OB_ASSERT(fabs(mol.GetAtom(1)->GetX()) < 1.0e-6);
+}
+
+void testPDBModels()
+{
+  string pdb;
+  for (int i = 0; i < 4; ++i)
+    pdb += PDBModel(i + 1, 0.1 * i);
+  pdb += "END\n";
+
+  OBConversion conv;
+  OB_REQUIRE(conv.SetInFormat("pdb"));
+  OBMol mol;
+  OB_REQUIRE(conv.ReadString(&mol, pdb));
+  OB_COMPARE(mol.NumConformers(), 1);
+
+  conv.AddOption("m", OBConversion::INOPTIONS);
+  OB_REQUIRE(conv.ReadString(&mol, pdb));
+  CheckConformers(mol, 4);
+}
+
+void testXYZFrames()
+{
+  // three frames of water, then a frame with a different number of atoms
+  string xyz;
+  for (int i = 0; i < 3; ++i)
+    xyz += XYZFrame(3, 0.1 * i);
+  xyz += "\n" + XYZFrame(2, 0.0);
+
+  OBConversion conv;
+  OB_REQUIRE(conv.SetInFormat("xyz"));
+  conv.AddOption("m", OBConversion::INOPTIONS);
+  OBMol mol;
+  OB_REQUIRE(conv.ReadString(&mol, xyz));
+  CheckConformers(mol, 3);
+
+  // the last frame is left for the next read
+  OB_REQUIRE(conv.Read(&mol));
+  OB_COMPARE(mol.NumAtoms(), 2);
+  OB_COMPARE(mol.NumConformers(), 1);
+  OB_ASSERT(!conv.Read(&mol));
+}
+
+// A stream buffer which can not be repositioned, like standard input
+class UnseekableBuf : public std::streambuf
+{
+public:
+  UnseekableBuf(const string &text) : _text(text)
+  {
+    setg(&_text[0], &_text[0], &_text[0] + _text.size());
+  }
+private:
+  string _text;
+};
+
+void testUnseekableStreams()
+{
+  // a frame which does not match is read as the next molecule, without
+  // rewinding the stream
+  string pdb;
+  for (int i = 0; i < 3; ++i)
+    pdb += PDBModel(i + 1, 0.1 * i);
+  pdb += "MODEL        4\n"
+         "HETATM    1  O   HOH A   1       0.000   0.000   0.000  1.00  0.00           O\n"
+         "HETATM    2  H1  HOH A   1       0.960   0.000   0.000  1.00  0.00           H\n"
+         "ENDMDL\nEND\n";
+  UnseekableBuf pdbBuf(pdb);
+  istream pdbStream(&pdbBuf);
+  OBConversion conv;
+  OB_REQUIRE(conv.SetInFormat("pdb"));
+  conv.AddOption("m", OBConversion::INOPTIONS);
+  OBMol mol;
+  OB_REQUIRE(conv.Read(&mol, &pdbStream));
+  CheckConformers(mol, 3);
+  OB_REQUIRE(conv.Read(&mol));
+  OB_COMPARE(mol.NumAtoms(), 2);
+  OB_COMPARE(mol.NumConformers(), 1);
+
+  string xyz;
+  for (int i = 0; i < 3; ++i)
+    xyz += XYZFrame(3, 0.1 * i);
+  xyz += XYZFrame(2, 0.0);
+  UnseekableBuf xyzBuf(xyz);
+  istream xyzStream(&xyzBuf);
+  OB_REQUIRE(conv.SetInFormat("xyz"));
+  OB_REQUIRE(conv.Read(&mol, &xyzStream));
+  CheckConformers(mol, 3);
+  OB_REQUIRE(conv.Read(&mol));
+  OB_COMPARE(mol.NumAtoms(), 2);
+  OB_ASSERT(!conv.Read(&mol));
+
+  // but it is not read from another stream
+  UnseekableBuf againBuf(xyz);
+  istream againStream(&againBuf);
+  OB_REQUIRE(conv.Read(&mol, &againStream));
+  OBConversion other;
+  OB_REQUIRE(other.SetInFormat("xyz"));
+  OB_REQUIRE(other.ReadString(&mol, XYZFrame(3, 0.0)));
+  OB_COMPARE(mol.NumAtoms(), 3);
+}
+
+int multiframetest(int argc, char* argv[])
+{
+  int defaultchoice = 1;
+
+  int choice = defaultchoice;
+
+  if (argc > 1) {
+    if(sscanf(argv[1], "%d", &choice) != 1) {
+      printf("Couldn't parse that input as a number\n");
+      return -1;
+    }
+  }
+
+  // Define location of file formats for testing
+#ifdef FORMATDIR
+  char env[BUFF_SIZE];
+  snprintf(env, BUFF_SIZE, "BABEL_LIBDIR=%s", FORMATDIR);
+  putenv(env);
+#endif
+
+  switch(choice) {
+  case 1:
+    testPDBModels();
+    break;
+  case 2:
+    testXYZFrames();
+    break;
+  case 3:
+    testUnseekableStreams();
+    break;
+  default:
+    cout << "Test number " << choice << " does not exist!\n";
+    return -1;
+  }
+
+  return 0;
+}
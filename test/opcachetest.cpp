@@ -0,0 +1,164 @@
+#include "obtest.h"
+
+#include <openbabel/mol.h>
+#include <openbabel/atom.h>
+#include <openbabel/obiter.h>
+#include <openbabel/generic.h>
+#include <openbabel/obconversion.h>
+#include <openbabel/op.h>
+
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace std;
+using namespace OpenBabel;
+
+// Counts the molecules it really works on, and changes them in a way that
+// can be seen in a result from the cache
+class OpCount : public OBOp
+{
+public:
+  OpCount(const char* ID) : OBOp(ID, false), count(0) {}
+  const char* Description() { return "Test op (not displayed in GUI)"; }
+  virtual bool WorksWith(OBBase* pOb) const { return dynamic_cast<OBMol*>(pOb) != nullptr; }
+  virtual bool Cacheable(const char*, OpMap*) const { return true; }
+  virtual bool Do(OBBase* pOb, const char* OptionText, OpMap*, OBConversion*)
+  {
+    OBMol *pmol = static_cast<OBMol*>(pOb);
+    ++count;
+    FOR_ATOMS_OF_MOL(atom, pmol)
+      atom->SetPartialCharge(atof(OptionText) * atom->GetIdx());
+    pmol->SetPartialChargesPerceived();
+    OBPairData *pd = new OBPairData;
+    pd->SetAttribute("result");
+    pd->SetValue(OptionText);
+    pmol->SetData(pd);
+    return true;
+  }
+  int count;
+};
+OpCount theOpCount("_testcount");
+
+static bool Apply(OBMol &mol, const string &smiles, map<string, string> &options)
+{
+  OBConversion conv;
+  conv.SetInFormat("smi");
+  if (!conv.ReadString(&mol, smiles))
+    return false;
+  return OBOp::DoOps(&mol, &options, &conv);
+}
+
+// Deletes the files listed in the index files, then the directory
+static void RemoveCache(const string &dir)
+{
+  for (int i = 0; i < 256; ++i) {
+    char index[16];
+    snprintf(index, sizeof(index), "/index-%02x", i);
+    ifstream ifs((dir + index).c_str());
+    string name, size;
+    while (ifs >> name >> size)
+      remove((dir + '/' + name).c_str());
+    ifs.close();
+    remove((dir + index).c_str());
+  }
+  remove(dir.c_str());
+}
+
+void testCache()
+{
+  OB_REQUIRE(OBConversion::FindFormat("obbin") != nullptr);
+  stringstream dir;
+  dir << "opcachetest-" << time(nullptr) << '-' << clock();
+
+  map<string, string> options;
+  options["_testcount"] = "0.5";
+  options["cache"] = dir.str();
+  OBMol mol;
+  OB_REQUIRE(Apply(mol, "CCO ethanol", options));
+  OB_COMPARE(theOpCount.count, 1);
+  OB_REQUIRE(Apply(mol, "CCO ethanol", options));
+  OB_COMPARE(theOpCount.count, 1);
+  OB_COMPARE(mol.GetAtom(3)->GetPartialCharge(), 1.5);
+  OB_COMPARE(mol.GetData("result")->GetValue(), string("0.5"));
+
+  // the title and pair data are kept, but are not part of the key
+  OBMol other;
+  OBConversion conv;
+  conv.SetInFormat("smi");
+  OB_REQUIRE(conv.ReadString(&other, "CCO other"));
+  OBPairData *pd = new OBPairData;
+  pd->SetAttribute("source");
+  pd->SetValue("vendor");
+  other.SetData(pd);
+  OB_REQUIRE(OBOp::DoOps(&other, &options, &conv));
+  OB_COMPARE(theOpCount.count, 1);
+  OB_COMPARE(string(other.GetTitle()), string("other"));
+  OB_REQUIRE(other.HasData("source"));
+  OB_COMPARE(other.GetData("result")->GetValue(), string("0.5"));
+
+  // a different structure, atom order or option is a miss
+  OB_REQUIRE(Apply(mol, "OCC", options));
+  OB_COMPARE(theOpCount.count, 2);
+  OB_REQUIRE(Apply(mol, "C[C@H](N)O", options));
+  OB_REQUIRE(Apply(mol, "C[C@@H](N)O", options));
+  OB_COMPARE(theOpCount.count, 4);
+  options["_testcount"] = "0.25";
+  OB_REQUIRE(Apply(mol, "CCO", options));
+  OB_COMPARE(theOpCount.count, 5);
+  OB_COMPARE(mol.GetAtom(3)->GetPartialCharge(), 0.75);
+  options["ff"] = "UFF";
+  OB_REQUIRE(Apply(mol, "CCO", options));
+  OB_COMPARE(theOpCount.count, 6);
+
+  // results larger than the cache are not kept
+  options["cachesize"] = "0.0001";
+  OB_REQUIRE(Apply(mol, "CCCC", options));
+  OB_REQUIRE(Apply(mol, "CCCC", options));
+  OB_COMPARE(theOpCount.count, 8);
+  options.erase("cachesize");
+  OB_REQUIRE(Apply(mol, "CCO", options));
+  OB_COMPARE(theOpCount.count, 8);
+
+  // without --cache the op is always done
+  options.erase("cache");
+  OB_REQUIRE(Apply(mol, "CCO", options));
+  OB_COMPARE(theOpCount.count, 9);
+
+  RemoveCache(dir.str());
+}
+
+int opcachetest(int argc, char* argv[])
+{
+  int defaultchoice = 1;
+
+  int choice = defaultchoice;
+
+  if (argc > 1) {
+    if(sscanf(argv[1], "%d", &choice) != 1) {
+      printf("Couldn't parse that input as a number\n");
+      return -1;
+    }
+  }
+
+  // Define location of file formats for testing
+#ifdef FORMATDIR
+  char env[BUFF_SIZE];
+  snprintf(env, BUFF_SIZE, "BABEL_LIBDIR=%s", FORMATDIR);
+  putenv(env);
+#endif
+
+  switch(choice) {
+  case 1:
+    testCache();
+    break;
+  default:
+    cout << "Test number " << choice << " does not exist!\n";
+    return -1;
+  }
+
+  return 0;
+}
@@ -228,6 +228,69 @@ void testPeriodicNoncubic() {
 
 
 
+void testPeriodicBondingSupercell() {
+  // Diamond silicon in its primitive rhombohedral cell, repeated n times
+  // along each axis: every atom has four bonds, some through the cell faces
+  for (int n = 2; n <= 5; ++n) {
+    OBMol mol;
+    OBUnitCell *uc = new OBUnitCell;
+    uc->SetData(3.840 * n, 3.840 * n, 3.840 * n, 60.0, 60.0, 60.0);
+    mol.SetData(uc);
+    mol.SetPeriodicMol();
+
+    mol.BeginModify();
+    for (int i = 0; i < n; ++i)
+      for (int j = 0; j < n; ++j)
+        for (int k = 0; k < n; ++k)
+          for (int b = 0; b < 2; ++b) {
+            OBAtom *atom = mol.NewAtom();
+            atom->SetAtomicNum(14);
+            atom->SetVector(uc->FractionalToCartesian(
+              vector3((i + 0.25 * b) / n, (j + 0.25 * b) / n, (k + 0.25 * b) / n)));
+          }
+    mol.EndModify();
+
+    mol.ConnectTheDots();
+    OB_COMPARE(mol.NumBonds(), 4 * mol.NumAtoms() / 2);
+    FOR_ATOMS_OF_MOL(atom, mol)
+      OB_COMPARE(atom->GetExplicitDegree(), 4);
+    FOR_BONDS_OF_MOL(bond, mol)
+      OB_ASSERT( fabs(bond->GetLength() - 2.3515) < 0.01 );
+  }
+}
+
+
+void testFillUnitCellDuplicates() {
+  OBMol mol;
+  OBUnitCell *uc = new OBUnitCell;
+  uc->SetData(10.0, 10.0, 10.0, 90.0, 90.0, 90.0);
+  uc->SetSpaceGroup(2); // P-1: x,y,z and -x,-y,-z
+  mol.SetData(uc);
+
+  double positions[][4] = {
+    { 6, 0.0, 0.0, 0.0 },         // on the inversion centre
+    { 7, 0.5, 0.25, 0.99998 },    // inverted copy lies across the cell face
+    { 8, 0.99999, 0.5, 0.5 },     // on the inversion centre, up to rounding
+    { 8, 0.00001, 0.5, 0.5 },     // duplicate of the previous atom
+    { 9, 0.0, 0.0, 0.0 }          // same place, different element
+  };
+  for (int i = 0; i < 5; ++i) {
+    OBAtom *atom = mol.NewAtom();
+    atom->SetAtomicNum(static_cast<int>(positions[i][0]));
+    atom->SetVector(uc->FractionalToCartesian(
+      vector3(positions[i][1], positions[i][2], positions[i][3])));
+  }
+
+  uc->FillUnitCell(&mol);
+  OB_COMPARE(mol.NumAtoms(), 5);
+  unsigned int nitrogens = 0;
+  FOR_ATOMS_OF_MOL(atom, mol)
+    if (atom->GetAtomicNum() == 7)
+      ++nitrogens;
+  OB_COMPARE(nitrogens, 2);
+}
+
+
 int periodictest(int argc, char* argv[])
 {
   int defaultchoice = 1;
@@ -261,6 +324,12 @@ int periodictest(int argc, char* argv[])
   case 4:
     testPeriodicNoncubic();
     break;
+  case 5:
+    testPeriodicBondingSupercell();
+    break;
+  case 6:
+    testFillUnitCellDuplicates();
+    break;
   default:
     cout << "Test number " << choice << " does not exist!\n";
     return -1;
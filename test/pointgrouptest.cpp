@@ -0,0 +1,189 @@
+#include "obtest.h"
+
+#include <openbabel/mol.h>
+#include <openbabel/atom.h>
+#include <openbabel/pointgroup.h>
+
+#include <cmath>
+#include <ctime>
+#include <iostream>
+
+using namespace std;
+using namespace OpenBabel;
+
+static void AddAtom(OBMol &mol, int atomicNum, double x, double y, double z)
+{
+  OBAtom *atom = mol.NewAtom();
+  atom->SetAtomicNum(atomicNum);
+  atom->SetVector(x, y, z);
+}
+
+// atoms of a ring of radius r in the xy plane at height z
+static void AddRing(OBMol &mol, int atomicNum, int n, double r, double z, double phase = 0.0)
+{
+  for (int k = 0; k < n; ++k) {
+    double t = 2.0 * M_PI * k / n + phase;
+    AddAtom(mol, atomicNum, r * cos(t), r * sin(t), z);
+  }
+}
+
+// fcc cluster cut from a box of half-width n (x, y) and m (z) lattice steps
+static void AddFCC(OBMol &mol, int atomicNum, int n, int m)
+{
+  for (int i = -n; i <= n; ++i)
+    for (int j = -n; j <= n; ++j)
+      for (int k = -m; k <= m; ++k)
+        if ((i + j + k) % 2 == 0)
+          AddAtom(mol, atomicNum, 2.04 * i, 2.04 * j, 2.04 * k);
+}
+
+static OBPointGroup::Symbol PointGroup(OBMol &mol)
+{
+  OBPointGroup pg;
+  pg.Setup(&mol);
+  return pg.IdentifyPointGroupSymbol();
+}
+
+void testSmallMolecules()
+{
+  OBMol water;
+  AddAtom(water, 8, 0.0, 0.0, 0.1173);
+  AddAtom(water, 1, 0.0, 0.7572, -0.4692);
+  AddAtom(water, 1, 0.0, -0.7572, -0.4692);
+  OB_COMPARE(PointGroup(water), OBPointGroup::C2v);
+
+  OBMol ammonia;
+  AddAtom(ammonia, 7, 0.0, 0.0, 0.1);
+  AddRing(ammonia, 1, 3, 0.94, -0.28);
+  OB_COMPARE(PointGroup(ammonia), OBPointGroup::C3v);
+
+  OBMol methane;
+  AddAtom(methane, 6, 0.0, 0.0, 0.0);
+  AddAtom(methane, 1, 0.63, 0.63, 0.63);
+  AddAtom(methane, 1, 0.63, -0.63, -0.63);
+  AddAtom(methane, 1, -0.63, 0.63, -0.63);
+  AddAtom(methane, 1, -0.63, -0.63, 0.63);
+  OB_COMPARE(PointGroup(methane), OBPointGroup::Td);
+
+  OBMol sf6;
+  AddAtom(sf6, 16, 0.0, 0.0, 0.0);
+  AddAtom(sf6, 9, 1.56, 0.0, 0.0);
+  AddAtom(sf6, 9, -1.56, 0.0, 0.0);
+  AddAtom(sf6, 9, 0.0, 1.56, 0.0);
+  AddAtom(sf6, 9, 0.0, -1.56, 0.0);
+  AddAtom(sf6, 9, 0.0, 0.0, 1.56);
+  AddAtom(sf6, 9, 0.0, 0.0, -1.56);
+  OB_COMPARE(PointGroup(sf6), OBPointGroup::Oh);
+
+  OBMol benzene;
+  AddRing(benzene, 6, 6, 1.39, 0.0);
+  AddRing(benzene, 1, 6, 2.47, 0.0);
+  OB_COMPARE(PointGroup(benzene), OBPointGroup::D6h);
+
+  OBMol ethane; // staggered
+  AddAtom(ethane, 6, 0.0, 0.0, 0.77);
+  AddAtom(ethane, 6, 0.0, 0.0, -0.77);
+  AddRing(ethane, 1, 3, 1.02, 1.16);
+  AddRing(ethane, 1, 3, 1.02, -1.16, M_PI / 3.0);
+  OB_COMPARE(PointGroup(ethane), OBPointGroup::D3d);
+
+  OBMol ferrocene; // staggered
+  AddAtom(ferrocene, 26, 0.0, 0.0, 0.0);
+  AddRing(ferrocene, 6, 5, 1.2, 1.65);
+  AddRing(ferrocene, 6, 5, 1.2, -1.65, M_PI / 5.0);
+  AddRing(ferrocene, 1, 5, 2.2, 1.7);
+  AddRing(ferrocene, 1, 5, 2.2, -1.7, M_PI / 5.0);
+  OB_COMPARE(PointGroup(ferrocene), OBPointGroup::D5d);
+
+  OBMol hcl;
+  AddAtom(hcl, 1, 0.0, 0.0, 0.0);
+  AddAtom(hcl, 17, 0.0, 0.0, 1.27);
+  OB_COMPARE(PointGroup(hcl), OBPointGroup::Cinfv);
+
+  OBMol co2;
+  AddAtom(co2, 6, 0.0, 0.0, 0.0);
+  AddAtom(co2, 8, 0.0, 0.0, 1.16);
+  AddAtom(co2, 8, 0.0, 0.0, -1.16);
+  OB_COMPARE(PointGroup(co2), OBPointGroup::Dinfh);
+
+  OBMol chfclbr;
+  AddAtom(chfclbr, 6, 0.0, 0.0, 0.0);
+  AddAtom(chfclbr, 1, 0.6, 0.6, 0.6);
+  AddAtom(chfclbr, 9, 0.8, -0.8, -0.8);
+  AddAtom(chfclbr, 17, -1.0, 1.0, -1.0);
+  AddAtom(chfclbr, 35, -1.1, -1.1, 1.1);
+  OB_COMPARE(PointGroup(chfclbr), OBPointGroup::C1);
+}
+
+void testReuseAndSymmetrize()
+{
+  // One OBPointGroup used for several molecules, as obsym does
+  OBPointGroup pg;
+
+  OBMol benzene;
+  AddRing(benzene, 6, 6, 1.39, 0.0);
+  AddRing(benzene, 1, 6, 2.47, 0.0);
+  // slightly distorted ring
+  benzene.GetAtom(1)->SetVector(1.395, 0.003, 0.0);
+  pg.Setup(&benzene);
+  OB_COMPARE(pg.IdentifyPointGroupSymbol(), OBPointGroup::D6h);
+  pg.Symmetrize(&benzene);
+  OB_ASSERT(fabs(benzene.GetAtom(1)->GetVector().length()
+                 - benzene.GetAtom(2)->GetVector().length()) < 0.01);
+
+  OBMol water;
+  AddAtom(water, 8, 0.0, 0.0, 0.1173);
+  AddAtom(water, 1, 0.0, 0.7572, -0.4692);
+  AddAtom(water, 1, 0.0, -0.7572, -0.4692);
+  pg.Setup(&water);
+  OB_COMPARE(pg.IdentifyPointGroupSymbol(), OBPointGroup::C2v);
+}
+
+void testClusterScaling()
+{
+  // Nanoparticle-sized inputs; the search should scale far better than
+  // the O(N^4) of trying every atom triple and pair of pairs.
+  for (int n = 2; n <= 4; ++n) {
+    OBMol cluster;
+    AddFCC(cluster, 79, n, n);
+    clock_t start = clock();
+    OB_COMPARE(PointGroup(cluster), OBPointGroup::Oh);
+    cout << "fcc cluster with " << cluster.NumAtoms() << " atoms: "
+         << double(clock() - start) / CLOCKS_PER_SEC << " s" << endl;
+  }
+
+  OBMol rod;
+  AddFCC(rod, 47, 3, 5);
+  OB_COMPARE(PointGroup(rod), OBPointGroup::D4h);
+}
+
+int pointgrouptest(int argc, char* argv[])
+{
+  int defaultchoice = 1;
+
+  int choice = defaultchoice;
+
+  if (argc > 1) {
+    if(sscanf(argv[1], "%d", &choice) != 1) {
+      printf("Couldn't parse that input as a number\n");
+      return -1;
+    }
+  }
+
+  switch(choice) {
+  case 1:
+    testSmallMolecules();
+    break;
+  case 2:
+    testReuseAndSymmetrize();
+    break;
+  case 3:
+    testClusterScaling();
+    break;
+  default:
+    cout << "Test number " << choice << " does not exist!\n";
+    return -1;
+  }
+
+  return 0;
+}
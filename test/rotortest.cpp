@@ -4,6 +4,10 @@
 #include <openbabel/rotor.h>
 #include <openbabel/bond.h>
 #include <openbabel/obutil.h>
+#include <openbabel/forcefield.h>
+#include <openbabel/elements.h>
+#include <openbabel/obiter.h>
+#include <openbabel/atom.h>
 
 #include <iostream>
 #include <string>
@@ -179,6 +183,86 @@ void testOBRotorListFixedBonds()
 }
 
 
+// The smallest distance of two atoms more than three bonds apart, as a
+// fraction of the sum of their van der Waals radii
+static double MinContact(OBMol &mol)
+{
+  double contact = 1.0e10;
+  FOR_PAIRS_OF_MOL(pair, mol) {
+    OBAtom *a = mol.GetAtom((*pair)[0]);
+    OBAtom *b = mol.GetAtom((*pair)[1]);
+    if (a->IsConnected(b) || a->IsOneThree(b) || a->IsOneFour(b))
+      continue;
+    double vdw = OBElements::GetVdwRad(a->GetAtomicNum()) + OBElements::GetVdwRad(b->GetAtomicNum());
+    contact = min(contact, a->GetDistance(b) / vdw);
+  }
+  return contact;
+}
+
+void testRotorClashScreen()
+{
+  OBMolPtr mol = OBTestUtil::ReadFile("octane.cml");
+  OBForceField *pFF = OBForceField::FindForceField("MMFF94");
+  OB_REQUIRE(pFF != nullptr);
+
+  // each search uses a new instance, as a used one keeps the conformers of
+  // its last search
+  OBForceField *fullFF = pFF->MakeNewInstance();
+  OB_ASSERT(fullFF->GetRotorClashFactor() < 0.0);
+  fullFF->SetRotorClashFactor(0.0);
+  OBMol all(*mol);
+  OB_REQUIRE(fullFF->Setup(all));
+  fullFF->SystematicRotorSearchInitialize(0);
+  OB_REQUIRE(fullFF->GetConformers(all));
+  delete fullFF;
+  OB_COMPARE(all.NumConformers(), 243);
+  bool clashes = false;
+  for (int i = 0; i < all.NumConformers(); ++i) {
+    all.SetConformer(i);
+    clashes |= MinContact(all) < 0.5;
+  }
+  OB_ASSERT(clashes);
+
+  // with pruning, the rotamers with clashes are left out, and the others are
+  // in the same order
+  OBForceField *prunedFF = pFF->MakeNewInstance();
+  prunedFF->SetRotorClashFactor(0.5);
+  OBMol pruned(*mol);
+  OB_REQUIRE(prunedFF->Setup(pruned));
+  prunedFF->SystematicRotorSearchInitialize(0);
+  OB_REQUIRE(prunedFF->GetConformers(pruned));
+  delete prunedFF;
+  OB_ASSERT(pruned.NumConformers() > 1);
+  OB_ASSERT(pruned.NumConformers() < all.NumConformers());
+  int j = 0;
+  for (int i = 0; i < pruned.NumConformers(); ++i) {
+    pruned.SetConformer(i);
+    OB_ASSERT(MinContact(pruned) >= 0.5);
+    for (; j < all.NumConformers(); ++j) {
+      all.SetConformer(j);
+      if (all.GetAtom(1)->GetVector().IsApprox(pruned.GetAtom(1)->GetVector(), 1.0e-6) &&
+          all.GetAtom(8)->GetVector().IsApprox(pruned.GetAtom(8)->GetVector(), 1.0e-6))
+        break;
+    }
+    OB_ASSERT(j < all.NumConformers());
+  }
+
+  // by default, only the search without geometry optimization is pruned
+  OBForceField *defaultFF = pFF->MakeNewInstance();
+  OBMol rigid(*mol);
+  OB_REQUIRE(defaultFF->Setup(rigid));
+  defaultFF->SystematicRotorSearchInitialize(0);
+  OB_REQUIRE(defaultFF->GetConformers(rigid));
+  OB_COMPARE(rigid.NumConformers(), pruned.NumConformers());
+  OBMol optimized(*mol);
+  OB_REQUIRE(defaultFF->Setup(optimized));
+  defaultFF->SystematicRotorSearchInitialize(10);
+  OB_REQUIRE(defaultFF->GetConformers(optimized));
+  delete defaultFF;
+  OB_COMPARE(optimized.NumConformers(), all.NumConformers());
+}
+
+
 int rotortest(int argc, char* argv[])
 {
   int defaultchoice = 1;
@@ -213,6 +297,10 @@ int rotortest(int argc, char* argv[])
   case 4:
     testOBRotorListFixedBonds();
     break;
+  // OBForceField rotor searches
+  case 5:
+    testRotorClashScreen();
+    break;
   default:
     cout << "Test number " << choice << " does not exist!\n";
     return -1;
@@ -420,6 +420,19 @@ int shuffletest(int argc, char* argv[])
     OB_ASSERT( doShuffleTestFile("stereo/canon_cistrans15.mol") );
     OB_ASSERT( doShuffleTestFile("stereo/canon_cistrans16.mol") );
     break;
+  case 6:
+    // Highly symmetric cages (large automorphism groups)
+    OB_ASSERT( doShuffleTest("C12C3C4C1C5C2C3C45") );
+    OB_ASSERT( doShuffleTest("C1C2CC3CC1CC(C2)C3") );
+    OB_ASSERT( doShuffleTest("C12C3C4C5C1C6C7C2C8C3C9C4C1C5C6C2C7C8C9C12") );
+    OB_ASSERT( doShuffleTest("C12=C3C4=C5C6=C1C7=C8C9=C1C%10=C%11C(=C29)C3=C2C3=C4C4=C5C5=C9C6=C7C6=C7C8=C1C1=C8C%10=C%10C%11=C2C2=C3C3=C4C4=C5C5=C%11C%12=C(C6=C95)C7=C1C1=C%12C5=C%11C4=C3C3=C5C(=C81)C%10=C23") );
+    // Symmetric molecules with specified stereochemistry
+    OB_ASSERT( doShuffleTest("O[C@H]1[C@H](O)[C@@H](O)[C@H](O)[C@@H](O)[C@@H]1O") );
+    OB_ASSERT( doShuffleTest("O[C@H]1[C@@H](O)[C@H](O)[C@@H](O)[C@H](O)[C@@H]1O") );
+    OB_ASSERT( doShuffleTest("C[C@H](O)[C@@H](C)O") );
+    OB_ASSERT( doShuffleTest("C/C=C/C1CC(/C=C/C)CC(/C=C\\C)C1") );
+    OB_ASSERT( doShuffleTest("F[C@H]1C2C3C4C1C5C2C3C45") );
+    break;
   default:
     cout << "Test number " << choice << " does not exist!\n";
     return -1;
@@ -16,7 +16,10 @@ and so you can quickly develop the tests and try them out.
 
 import os
 import re
+import shutil
 import sys
+import tempfile
+import time
 import unittest
 
 from subprocess import CalledProcessError, Popen, PIPE, check_output, STDOUT
@@ -130,6 +133,38 @@ class TestOBabel(BaseTest):
         output, error = run_exec("CC(=O)Cl", "obabel -ismi -oinchi")
         self.assertEqual(output.rstrip(), "InChI=1S/C2H3ClO/c1-2(3)4/h1H3")
 
+    def testFP2(self):
+        # The bits and the fragments they come from. The three rings of the
+        # bicyclooctane are each found from every atom in both directions.
+        self.canFindExecutable("obabel")
+        output, error = run_exec("C1CC2CCC1C(Cl)C2=O",
+                                 "obabel -ismi -ofpt -xfFP2 -xh")
+        self.assertEqual(output.split("\n")[1:7], [
+            "00030000 01000000 00000000 00000000 00100000 00000000 ",
+            "00000000 00000000 00000000 00000000 00000000 40001000 ",
+            "04008008 00000000 00000000 00000000 00000000 00000000 ",
+            "02002000 00000001 00000000 00000300 00000000 00000010 ",
+            "00000000 08000000 00000000 00000000 00000004 00000000 ",
+            "00020000 00820800 "])
+        output, error = run_exec("C1CC2CCC1C(Cl)C2=O",
+                                 "obabel -ismi -ofpt -xfFP2 -xs")
+        fragments = output.split("\n")[1:-1]
+        self.assertEqual(len(fragments), 21)
+        self.assertEqual(fragments[0], "0 6 1 6 <670>")
+        self.assertEqual([f for f in fragments if f[0] != "0"],
+                         ["1 6 1 6 1 6 1 6 1 6 1 6 <441>"])
+
+    def testCluster(self):
+        # Ethanol and its neighbors propanol and acetic acid are the first
+        # cluster, butanol is on its own and benzene is with toluene
+        self.canFindExecutable("obabel")
+        smiles = "CCO a\nCCCO b\nCCCCO c\nc1ccccc1 d\nc1ccccc1C e\nCC(=O)O f\n"
+        output, error = run_exec(smiles, "obabel -ismi -osmi --cluster 0.5+")
+        self.assertEqual([line.split()[-1] for line in output.rstrip().split("\n")],
+                         ["1", "1", "2", "3", "3", "1"])
+        output, error = run_exec(smiles, "obabel -ismi -osdf --cluster 0.5")
+        self.assertEqual(output.count("<centroid>\n1\n"), 3)
+
     def testRSMItoRSMI(self):
         # Check possible combinations of missing rxn components
         data = ["O>N>S", "O>>S", "O>N>", "O>>",
@@ -521,5 +556,66 @@ charge 1
         # mol2 displays element twice
         self.assertEqual(output.count('H'), 12)
 
+@unittest.skipIf(sys.platform.startswith("win"), "--serve needs Unix sockets")
+class TestServe(BaseTest):
+    """Tests of obabel --serve and --client"""
+
+    def setUp(self):
+        self.canFindExecutable("obabel")
+        self.folder = tempfile.mkdtemp()
+        self.socket = os.path.join(self.folder, "obabel.sock")
+        self.server = Popen([executable("obabel"), "--serve", self.socket],
+                            stdout=PIPE, stderr=PIPE)
+        self.addCleanup(self.stopServer)
+        for i in range(200):
+            if os.path.exists(self.socket):
+                break
+            time.sleep(0.05)
+        self.assertTrue(os.path.exists(self.socket), "The server did not start")
+
+    def stopServer(self):
+        self.server.terminate()
+        self.server.communicate()
+        self.assertFalse(os.path.exists(self.socket))
+        shutil.rmtree(self.folder)
+
+    def testConvert(self):
+        output, error = run_exec("CC(=O)Cl", "obabel --client %s -ismi -oinchi"
+                                 % self.socket)
+        self.assertEqual(output.rstrip(), "InChI=1S/C2H3ClO/c1-2(3)4/h1H3")
+        self.assertConverted(error, 1)
+
+    def testFiles(self):
+        # file names are relative to the working directory of the client
+        infile = self.getTestFile("cantest.sdf")
+        output, error = run_exec("obabel --client %s %s -osmi -l 3"
+                                 % (self.socket, infile))
+        self.assertEqual(len(output.rstrip().split("\n")), 3)
+        self.assertConverted(error, 3)
+
+    def testErrors(self):
+        p = Popen([executable("obabel"), "--client", self.socket,
+                   "-:CCO", "-onosuchformat"], stdout=PIPE, stderr=PIPE)
+        output, error = p.communicate()
+        self.assertEqual(p.returncode, 1)
+        self.assertIn("cannot write output format", error.decode())
+        # the error log of one request is not seen by the next
+        output, error = run_exec("obabel --client %s -:CCO -ocan" % self.socket)
+        self.assertNotIn("cannot write", error)
+
+    def testConcurrent(self):
+        smiles = ["C" * n for n in range(1, 9)]
+        clients = [Popen([executable("obabel"), "--client", self.socket,
+                          "-ismi", "-osmi", "--append", "MW"],
+                         stdin=PIPE, stdout=PIPE, stderr=PIPE)
+                   for smi in smiles]
+        for smi, client in zip(smiles, clients):
+            client.stdin.write(smi.encode())
+            client.stdin.close()
+        for smi, client in zip(smiles, clients):
+            output = client.stdout.read().decode()
+            client.wait()
+            self.assertEqual(output.split()[0], smi)
+
 if __name__ == "__main__":
     unittest.main()
@@ -145,6 +145,36 @@ class TestPcJsonFormat(PybelWrapper):
         self.assertEqual(output['PC_Compounds'][0]['stereo'][0]['planar']['right'], 4)
         self.assertEqual(output['PC_Compounds'][0]['stereo'][0]['planar']['left'], 3)
 
+    def test_read_records(self):
+        """Test reading compounds one at a time from a larger file."""
+        compounds = []
+        for name in ['CID_2244_2D.json', 'CID_6137_2D.json', 'CID_1038_2D.json']:
+            with open(os.path.join(filedir, name)) as f:
+                compounds.append(json.load(f)['PC_Compounds'][0])
+        # members before and after the array are passed over
+        content = {'note': {'PC_Compounds': 'not here'}, 'PC_Compounds': compounds, 'count': [3]}
+        conv = pybel.ob.OBConversion()
+        self.assertTrue(conv.SetInFormat('pcjson'))
+        mol = pybel.ob.OBMol()
+        titles = []
+        notatend = conv.ReadString(mol, json.dumps(content, indent=1))
+        while notatend:
+            titles.append(mol.GetTitle())
+            notatend = conv.Read(mol)
+        self.assertEqual(titles, ['2244', '6137', '1038'])
+
+    def test_read_after_partial_read(self):
+        """Test reading a file after only the first record of another was read."""
+        compounds = []
+        for name in ['CID_2244_2D.json', 'CID_6137_2D.json']:
+            with open(os.path.join(filedir, name)) as f:
+                compounds.append(json.load(f)['PC_Compounds'][0])
+        mol = pybel.readstring("pcjson", json.dumps({'PC_Compounds': compounds}))
+        self.assertEqual(mol.title, '2244')
+        mols = list(pybel.readfile("pcjson", os.path.join(filedir, 'CID_1038_2D.json')))
+        self.assertEqual(len(mols), 1)
+        self.assertEqual(mols[0].title, '1038')
+
     def test_read(self):
         """Test reading a PubChem JSON file."""
 
@@ -0,0 +1,181 @@
+#include "obtest.h"
+
+#include <openbabel/mol.h>
+#include <openbabel/atom.h>
+#include <openbabel/obiter.h>
+#include <openbabel/data.h>
+#include <openbabel/obconversion.h>
+#include <openbabel/oberror.h>
+#include <openbabel/fingerprint.h>
+#include <openbabel/descriptor.h>
+#include <openbabel/forcefield.h>
+#include <openbabel/builder.h>
+
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace OpenBabel;
+
+static const char *smiles[] = {
+  "CC(=O)Oc1ccccc1C(=O)O", "CN1CCC[C@H]1c1cccnc1", "Cn1cnc2c1c(=O)n(C)c(=O)n2C",
+  "CC(C)Cc1ccc(cc1)C(C)C(=O)O", "OC[C@H]1OC(O)[C@H](O)[C@@H](O)[C@@H]1O",
+  "c1ccc2c(c1)ccc1ccccc12", "CC(=O)Nc1ccc(O)cc1", "NC(Cc1c[nH]c2ccccc12)C(=O)O",
+  "O=C1CCCCC1", "ClC(Cl)(Cl)Cl", "CCN(CC)CCOC(=O)c1ccc(N)cc1", "C1CC2CCC1CC2"
+};
+static const unsigned int numMolecules = sizeof(smiles) / sizeof(smiles[0]);
+
+struct Result
+{
+  string canonical;
+  vector<unsigned int> fp2, fp3, ecfp;
+  double logP;
+  double energy;
+  string types[2];
+};
+
+static bool operator==(const Result &a, const Result &b)
+{
+  return a.canonical == b.canonical && a.fp2 == b.fp2 && a.fp3 == b.fp3
+    && a.ecfp == b.ecfp && a.logP == b.logP && fabs(a.energy - b.energy) < 1.0e-6
+    && a.types[0] == b.types[0] && a.types[1] == b.types[1];
+}
+
+// Everything that is done to one molecule, with objects owned by the caller
+// and the shared plugin instances, except for the force field which is a copy.
+// The 3D structure is read from an SDF string made beforehand.
+static Result Calculate(OBConversion &conv, OBForceField *pFF, unsigned int i,
+                        const string &sdf)
+{
+  Result result;
+  OBMol mol;
+  conv.SetInAndOutFormats("smi", "can");
+  conv.ReadString(&mol, smiles[i]);
+  result.canonical = conv.WriteString(&mol, true);
+
+  OBFingerprint::FindFingerprint("FP2")->GetFingerprint(&mol, result.fp2);
+  OBFingerprint::FindFingerprint("ECFP4")->GetFingerprint(&mol, result.ecfp);
+  result.logP = OBDescriptor::FindType("logP")->Predict(&mol);
+
+  // the type translation chosen by one thread does not affect the others
+  for (int t = 0; t < 2; ++t) {
+    ttab.SetFromType("INT");
+    ttab.SetToType(t ? "SYB" : "MMD");
+    FOR_ATOMS_OF_MOL(atom, mol) {
+      string type;
+      ttab.Translate(type, atom->GetType());
+      result.types[t] += type + " ";
+      this_thread::yield();
+    }
+  }
+
+  // this deletes the hydrogens, so is done last
+  OBFingerprint::FindFingerprint("FP3")->GetFingerprint(&mol, result.fp3);
+
+  OBMol mol3d;
+  conv.SetInFormat("sdf");
+  conv.ReadString(&mol3d, sdf);
+  result.energy = pFF->Setup(mol3d) ? pFF->Energy(false) : 0.0;
+  return result;
+}
+
+static void Work(const vector<string> *sdfs, const vector<Result> *expected,
+                 int rounds, atomic<int> *failures)
+{
+  OBConversion conv;
+  OBForceField *pFF = OBForceField::FindForceField("MMFF94")->MakeNewInstance();
+  for (int round = 0; round < rounds; ++round)
+    for (unsigned int i = 0; i < numMolecules; ++i) {
+      if (!(Calculate(conv, pFF, i, (*sdfs)[i]) == (*expected)[i]))
+        ++*failures;
+
+      // the builder's fragment tables are shared
+      OBMol mol;
+      conv.SetInFormat("smi");
+      conv.ReadString(&mol, smiles[i]);
+      OBBuilder builder;
+      if (!builder.Build(mol) || mol.GetDimension() != 3)
+        ++*failures;
+
+      obErrorLog.ThrowError(__FUNCTION__, "calculated " + (*expected)[i].canonical, obDebug);
+    }
+  delete pFF;
+}
+
+void testConcurrentCalculations()
+{
+  // the plugins are loaded before the threads are started
+  OBConversion conv;
+  OBForceField *pFF = OBForceField::FindForceField("MMFF94");
+  OB_REQUIRE(pFF != nullptr);
+  OB_REQUIRE(OBFingerprint::FindFingerprint("FP3") != nullptr);
+  OB_REQUIRE(OBDescriptor::FindType("logP") != nullptr);
+
+  vector<string> sdfs;
+  for (unsigned int i = 0; i < numMolecules; ++i) {
+    OBMol mol;
+    conv.SetInAndOutFormats("smi", "sdf");
+    OB_REQUIRE(conv.ReadString(&mol, smiles[i]));
+    OBBuilder builder;
+    OB_REQUIRE(builder.Build(mol));
+    sdfs.push_back(conv.WriteString(&mol));
+  }
+
+  vector<Result> expected;
+  for (unsigned int i = 0; i < numMolecules; ++i)
+    expected.push_back(Calculate(conv, pFF, i, sdfs[i]));
+  OB_ASSERT(expected[0].types[0] != expected[0].types[1]);
+  OB_ASSERT(fabs(expected[0].energy) > 1.0e-6);
+
+  obErrorLog.ClearLog();
+  unsigned int debugMessages = obErrorLog.GetDebugMessageCount();
+
+  const int numThreads = 4, rounds = 2;
+  atomic<int> failures(0);
+  vector<thread> threads;
+  for (int t = 0; t < numThreads; ++t)
+    threads.push_back(thread(Work, &sdfs, &expected, rounds, &failures));
+  for (int t = 0; t < numThreads; ++t)
+    threads[t].join();
+
+  OB_COMPARE(failures.load(), 0);
+  // no message is lost, though the library may have sent some of its own
+  OB_ASSERT(obErrorLog.GetDebugMessageCount() - debugMessages
+            >= numThreads * rounds * numMolecules);
+}
+
+int threadstest(int argc, char* argv[])
+{
+  int defaultchoice = 1;
+
+  int choice = defaultchoice;
+
+  if (argc > 1) {
+    if(sscanf(argv[1], "%d", &choice) != 1) {
+      printf("Couldn't parse that input as a number\n");
+      return -1;
+    }
+  }
+
+  // Define location of file formats for testing
+#ifdef FORMATDIR
+  char env[BUFF_SIZE];
+  snprintf(env, BUFF_SIZE, "BABEL_LIBDIR=%s", FORMATDIR);
+  putenv(env);
+#endif
+
+  switch(choice) {
+  case 1:
+    testConcurrentCalculations();
+    break;
+  default:
+    cout << "Test number " << choice << " does not exist!\n";
+    return -1;
+  }
+
+  return 0;
+}
@@ -35,6 +35,8 @@ GNU General Public License for more details.
     #include <conio.h>
 #endif
 #include <cstdlib> // for exit() on Linux
+#include <cstring>
+#include <vector>
 
 #if !HAVE_STRNCASECMP
 extern "C" int strncasecmp(const char *s1, const char *s2, size_t n);
@@ -42,6 +44,16 @@ extern "C" int strncasecmp(const char *s1, const char *s2, size_t n);
 
 #include <openbabel/obconversion.h>
 #include <openbabel/plugin.h>
+#include <openbabel/oberror.h>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 using namespace OpenBabel;
@@ -54,9 +66,11 @@ void help();
 // There isn't a great way to do this -- we need to save argv[0] for usage()
 static char *program_name;
 
-int main(int argc,char *argv[])
+// A conversion with the command line arguments in argv[]
+static int Convert(int argc, char *argv[], istream *pIn)
 {
-  OBConversion Conv(&cin, &cout); //default input and output are console
+  //default input and output are console, or those of a request to the server
+  OBConversion Conv(pIn, &cout);
 
   OBFormat* pInFormat = nullptr;
   OBFormat* pOutFormat = nullptr;
@@ -102,7 +116,7 @@ int main(int argc,char *argv[])
                   {
                     cout << "Open Babel " << BABEL_VERSION << " -- "
                          << __DATE__ << " -- " << __TIME__ << endl;
-                    exit(0);
+                    return 0;
                   }
 
                 case 'i':
@@ -124,7 +138,7 @@ int main(int argc,char *argv[])
                     {
                       cerr << program_name << ": cannot read input format!" << endl;
                       usage();
-                      exit(1);
+                      return 1;
                     }
                   break;
 
@@ -148,7 +162,7 @@ int main(int argc,char *argv[])
                     {
                       cerr << program_name << ": cannot write output format!" << endl;
                       usage();
-                      exit(1);
+                      return 1;
                     }
                   break;
 
@@ -315,7 +329,7 @@ int main(int argc,char *argv[])
           cerr << "No input file or format spec or possibly a misplaced option.\n"
             "Most options must come after the input files. (-i -o -O -m can be anywhwere.)\n" <<endl;
           usage();
-          exit(1);
+          return 1;
         }
     }
 
@@ -328,7 +342,7 @@ int main(int argc,char *argv[])
           cerr << "Missing or unknown output file or format spec or possibly a misplaced option.\n"
             "Options, other than -i -o -O -m, must come after the input files.\n" <<endl;
           usage();
-          exit(1);
+          return 1;
         }
     }
 
@@ -336,13 +350,13 @@ int main(int argc,char *argv[])
     {
       cerr << "Invalid input format" << endl;
       usage();
-      exit(1);
+      return 1;
     }
     if(!Conv.SetOutFormat(pOutFormat, outGzip))
     {
       cerr << "Invalid output format" << endl;
       usage();
-      exit(1);
+      return 1;
     }
 
   if(SplitOrBatch)
@@ -391,6 +405,292 @@ int main(int argc,char *argv[])
   return 0;
 }
 
+#ifndef _WIN32
+/* Server mode: obabel --serve <socket path>
+
+   The server loads the plugins and data tables once, then forks a process
+   for each connection, which inherits them. A request is the working
+   directory of the client and the command line arguments (without the
+   program name), each ended by a NUL byte, then an empty argument (another
+   NUL), then the data for standard input up to the end of the client's
+   output. The reply is a line "<exit status> <output length> <error length>"
+   followed by what the conversion wrote to standard output and to standard
+   error, so the error log of each request is returned with it.
+
+   obabel --client <socket path> <arguments> sends a request, with its
+   standard input if there is no input file, and writes the reply as if the
+   conversion had been done by that process.
+*/
+
+static bool WriteAll(int fd, const char *p, size_t n)
+{
+  while (n) {
+    ssize_t written = write(fd, p, n);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    p += written;
+    n -= written;
+  }
+  return true;
+}
+
+static bool ReadAll(int fd, string &data)
+{
+  char buffer[65536];
+  for (;;) {
+    ssize_t n = read(fd, buffer, sizeof(buffer));
+    if (n == 0)
+      return true;
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    data.append(buffer, n);
+  }
+}
+
+// Done in the forked process
+static void HandleRequest(int fd)
+{
+  string request;
+  if (!ReadAll(fd, request))
+    return;
+
+  // the working directory, then the arguments up to an empty one
+  vector<string> args(1, "obabel");
+  string::size_type pos = request.find('\0');
+  string cwd = request.substr(0, pos);
+  for (;;) {
+    if (pos == string::npos)
+      return; // incomplete request
+    string::size_type end = request.find('\0', pos + 1);
+    if (end == pos + 1) {
+      pos = end + 1;
+      break;
+    }
+    if (end == string::npos)
+      return;
+    args.push_back(request.substr(pos + 1, end - pos - 1));
+    pos = end;
+  }
+  istringstream in(request.substr(pos));
+  request.clear();
+
+  // Everything written to the console, including the error log, is returned
+  stringstream out, err;
+  cin.rdbuf(in.rdbuf());
+  cout.rdbuf(out.rdbuf());
+  cerr.rdbuf(err.rdbuf());
+  clog.rdbuf(err.rdbuf());
+
+  int status;
+  if (!cwd.empty() && chdir(cwd.c_str()) != 0) {
+    err << "Cannot change to the directory " << cwd << endl;
+    status = 1;
+  }
+  else {
+    vector<char*> argv;
+    for (vector<string>::iterator arg = args.begin(); arg != args.end(); ++arg)
+      argv.push_back(&(*arg)[0]);
+    argv.push_back(nullptr);
+    status = Convert(static_cast<int>(args.size()), &argv[0], &in);
+  }
+  cout.flush();
+  clog.flush();
+
+  string output = out.str(), errors = err.str();
+  stringstream header;
+  header << status << ' ' << output.size() << ' ' << errors.size() << '\n';
+  if (WriteAll(fd, header.str().data(), header.str().size())
+      && WriteAll(fd, output.data(), output.size()))
+    WriteAll(fd, errors.data(), errors.size());
+}
+
+static char socketPath[sizeof(((sockaddr_un*)nullptr)->sun_path)];
+
+static void StopServer(int)
+{
+  unlink(socketPath);
+  _exit(0);
+}
+
+static int Serve(const char *path)
+{
+  if (strlen(path) >= sizeof(socketPath)) {
+    cerr << "The socket path " << path << " is too long" << endl;
+    return 1;
+  }
+  strcpy(socketPath, path);
+
+  // An old socket is replaced, but not any other kind of file
+  struct stat st;
+  if (lstat(path, &st) == 0) {
+    if (!S_ISSOCK(st.st_mode)) {
+      cerr << path << " exists and is not a socket" << endl;
+      return 1;
+    }
+    unlink(path);
+  }
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, path);
+  if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+      || chmod(path, S_IRUSR | S_IWUSR) != 0 || listen(fd, 128) != 0) {
+    cerr << "Cannot listen on " << path << ": " << strerror(errno) << endl;
+    return 1;
+  }
+
+  // What is loaded here is shared by the request processes, so the first
+  // conversion loads the data tables, SMARTS patterns and force field
+  // parameters which are read on first use
+  OBPlugin::LoadAllPlugins();
+  {
+    stringstream in, out, err;
+    streambuf *outbuf = cout.rdbuf(out.rdbuf());
+    streambuf *logbuf = clog.rdbuf(err.rdbuf());
+    streambuf *errbuf = cerr.rdbuf(err.rdbuf());
+    const char *warmup[] = { "obabel", "-:Oc1ccccc1C(=O)[O-]", "-osdf", "-h", "--gen3D", "--partialcharge", "gasteiger", nullptr };
+    Convert(7, const_cast<char**>(warmup), &in);
+    cout.rdbuf(outbuf);
+    clog.rdbuf(logbuf);
+    cerr.rdbuf(errbuf);
+    obErrorLog.ClearLog(); // or onceOnly messages would not be given by the requests
+  }
+
+  signal(SIGCHLD, SIG_IGN); // the request processes are not waited for
+  signal(SIGPIPE, SIG_IGN); // a client which has gone only fails the write
+  signal(SIGINT, StopServer);
+  signal(SIGTERM, StopServer);
+  clog << "Serving on " << path << endl;
+
+  for (;;) {
+    int conn = accept(fd, nullptr, nullptr);
+    if (conn < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      cerr << "Cannot accept a connection: " << strerror(errno) << endl;
+      unlink(path);
+      return 1;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+      close(fd);
+      signal(SIGINT, SIG_DFL);
+      signal(SIGTERM, SIG_DFL);
+      HandleRequest(conn);
+      close(conn);
+      _exit(0);
+    }
+    if (pid < 0)
+      cerr << "Cannot start a process for a request: " << strerror(errno) << endl;
+    close(conn);
+  }
+}
+
+// Whether a conversion with these arguments reads standard input, which is
+// when there is no input file, following the rules of Convert() for which
+// arguments are the text of options
+static bool ReadsStandardInput(int argc, char *argv[])
+{
+  for (int arg = 0; arg < argc; ++arg) {
+    const char *p = argv[arg];
+    if (*p != '-')
+      return false; // an input file
+    switch (p[1]) {
+    case ':':
+      return false; // SMILES on the command line
+    case 'H': case '?': case 'L': case 'V':
+      return false; // information only
+    case 'i': case 'o': case 'O': case 'f': case 'l': {
+      const char *param = p + 2;
+      if (!*param && arg < argc - 1)
+        param = argv[++arg]; // the parameter is the next argument
+      if ((p[1] == 'i' || p[1] == 'o') && strncasecmp(param, "MIME", 4) == 0)
+        ++arg; // then the MIME type
+      break;
+    }
+    case 'm':
+      break;
+    default: // the option's text is in the following arguments
+      while (arg < argc - 1 && *argv[arg + 1] != '-')
+        ++arg;
+    }
+  }
+  return true;
+}
+
+static int Client(const char *path, int argc, char *argv[])
+{
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+  if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    cerr << "Cannot connect to " << path << ": " << strerror(errno) << endl;
+    return 1;
+  }
+  signal(SIGPIPE, SIG_IGN);
+
+  char cwd[4096];
+  string request(getcwd(cwd, sizeof(cwd)) ? cwd : "");
+  request += '\0';
+  for (int arg = 0; arg < argc; ++arg) {
+    request += argv[arg];
+    request += '\0';
+  }
+  request += '\0';
+  if (ReadsStandardInput(argc, argv))
+    ReadAll(0, request);
+  string reply;
+  if (!WriteAll(fd, request.data(), request.size()) || shutdown(fd, SHUT_WR) != 0
+      || !ReadAll(fd, reply)) {
+    cerr << "The request to " << path << " failed: " << strerror(errno) << endl;
+    return 1;
+  }
+  close(fd);
+
+  int status;
+  size_t outputSize, errorSize;
+  istringstream header(reply);
+  if (!(header >> status >> outputSize >> errorSize) || header.get() != '\n'
+      || reply.size() != static_cast<size_t>(header.tellg()) + outputSize + errorSize) {
+    cerr << "The server at " << path << " did not complete the request" << endl;
+    return 1;
+  }
+  size_t start = static_cast<size_t>(header.tellg());
+  WriteAll(1, reply.data() + start, outputSize);
+  WriteAll(2, reply.data() + start + outputSize, errorSize);
+  return status;
+}
+#endif
+
+int main(int argc,char *argv[])
+{
+  if (argc > 1 && (!strcmp(argv[1], "--serve") || !strcmp(argv[1], "--client"))) {
+#ifndef _WIN32
+    if (argc < 3) {
+      cerr << "The socket path is missing after " << argv[1] << endl;
+      return 1;
+    }
+    if (!strcmp(argv[1], "--serve"))
+      return Serve(argv[2]);
+    return Client(argv[2], argc - 3, argv + 3);
+#else
+    cerr << argv[1] << " is not available on this platform" << endl;
+    return 1;
+#endif
+  }
+  return Convert(argc, argv, &cin);
+}
+
 void DoOption(const char* p, OBConversion& Conv,
           OBConversion::Option_type typ, int& arg, int argc, char *argv[])
 {
@@ -460,6 +760,11 @@ void help()
 #ifdef _WIN32
   cout << "   In Windows these can also be done using the forms" <<endl;
   cout << "     " << program_name << " infile.mol -O new*.smi and " << program_name << " *.mol -O *.smi respectively.\n" <<endl;
+#else
+  cout << "--serve <socket> Runs as a server on this Unix socket, keeping the plugins" << endl;
+  cout << "   and data loaded, for conversions requested with" << endl;
+  cout << "     " << program_name << " --client <socket> <the usual arguments>" << endl;
+  cout << "   Each request is done in a separate process, so several can run at once.\n" << endl;
 #endif
 
   OBFormat* pDefault = OBConversion::GetDefaultFormat();
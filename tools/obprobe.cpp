@@ -44,11 +44,14 @@ int main(int argc,char **argv)
   char *program_name = argv[0];
   char *type;
   int c;
-  double step, padding, pchg;
+  double step, padding, pchg, cutoff;
+  bool floatPrecision;
   string basename, filename = "", option;
 
   step    = 0.5;
   padding = 5.0;
+  cutoff  = 0.0;
+  floatPrecision = false;
 
   if (argc < 4) {
     cout << "Usage: obprobe [options] <type> <pchg> <filename>" << endl;
@@ -64,6 +67,10 @@ int main(int argc,char **argv)
     cout << endl;
     cout << "  -p <padding>    padding" << endl;
     cout << endl;
+    cout << "  -c <cutoff>     only include atoms within cutoff of a grid point" << endl;
+    cout << endl;
+    cout << "  -f              store the grid in single precision" << endl;
+    cout << endl;
     cout << "Example probes:" << endl;
     cout << endl;
     cout << "<type>  <pchg>    Description:" << endl;
@@ -87,6 +94,17 @@ int main(int argc,char **argv)
         padding = atof(paddingstr.c_str());
         ifile += 2;
       }
+
+      if ((option == "-c") && (argc > (i+1))) {
+        string cutoffstr = argv[i+1];
+        cutoff = atof(cutoffstr.c_str());
+        ifile += 2;
+      }
+
+      if (option == "-f") {
+        floatPrecision = true;
+        ifile += 1;
+      }
     }
     
     type = argv[ifile];
@@ -142,7 +160,11 @@ int main(int argc,char **argv)
       exit (-1);
     }
     
-    OBGridData* gd = pFF->GetGrid(step, padding, type, pchg);
+    OBGridData* gd = pFF->GetGrid(step, padding, type, pchg, cutoff, floatPrecision);
+    if (!gd) {
+      cerr << program_name << ": could not calculate the grid." << endl;
+      exit (-1);
+    }
     mol.SetData(gd);
 
     ofstream ofs;
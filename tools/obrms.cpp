@@ -35,6 +35,7 @@
 #include <openbabel/isomorphism.h>
 #include <openbabel/shared_ptr.h>
 #include <openbabel/obutil.h>
+#include <openbabel/math/align.h>
 
 #include "getopt.h"
 
@@ -218,6 +219,7 @@ int main(int argc, char **argv)
 	bool separate = false;
 	bool help = false;
 	bool docross = false;
+	bool triangle = false;
 	string fileRef;
 	string fileTest;
 	string fileOut;
@@ -230,12 +232,14 @@ int main(int argc, char **argv)
 	  "\t -f, --firstonly  use only the first structure in the reference file\n"
 	  "\t -m, --minimize   compute minimum RMSD\n"
 	  "\t -x, --cross      compute all n^2 RMSDs between molecules of reference file\n"
+	  "\t -t, --triangle   with -x, only output the RMSDs with the following molecules (streamed)\n"
 	  "\t -s, --separate   separate reference file into constituent molecules and report best RMSD\n"
 	  "\t -h, --help       help message\n";
 	struct option long_options[] = {
 	    {"firstonly", no_argument, nullptr, 'f'},
 	    {"minimize", no_argument, nullptr, 'm'},
 	    {"cross", no_argument, nullptr, 'x'},
+	    {"triangle", no_argument, nullptr, 't'},
 	    {"separate", no_argument, nullptr, 's'},
 	    {"out", required_argument, nullptr, 'o'},
 	    {"help", no_argument, nullptr, 'h'},
@@ -243,7 +247,7 @@ int main(int argc, char **argv)
 	};
 	int option_index = 0;
 	int c = 0;
-	while ((c = getopt_long(argc, argv, "hfmxso:", long_options, &option_index) ) != -1) {
+	while ((c = getopt_long(argc, argv, "hfmxtso:", long_options, &option_index) ) != -1) {
 	  switch(c) {
 	    case 'o':
 	      fileOut = optarg;
@@ -257,6 +261,9 @@ int main(int argc, char **argv)
 	    case 'x':
 	      docross = true;
 	      break;
+	    case 't':
+	      triangle = true;
+	      break;
 	    case 's':
 	      separate = true;
 	      break;
@@ -316,23 +323,47 @@ int main(int argc, char **argv)
 
 	if(docross) {
 	  //load in the entire reference file
-    vector<OBMol> refmols;
+    OBRMSDMatrix matrix(true, true, minimize);
+    vector<string> titles;
     while (refconv.Read(&molref))
     {
        processMol(molref);
-       refmols.push_back(molref);
+       if(titles.empty())
+         matrix.SetRefMol(molref);
+       matrix.AddMol(molref);
+       titles.push_back(molref.GetTitle());
     }
 
-    for(unsigned i = 0, n = refmols.size() ; i < n; i++) {
-      OBMol& ref = refmols[i];
-      Matcher matcher(ref);
-      cout << ref.GetTitle();
-      for(unsigned j = 0; j < n; j++) {
-        OBMol& moltest = refmols[j];
-        double rmsd = matcher.computeRMSD(moltest, minimize);
-        cout << ", " << rmsd;
+    unsigned n = titles.size();
+    if(triangle) {
+      //stream blocks of rows, only the RMSDs with the following molecules
+      const unsigned blockSize = 64;
+      vector<vector<double> > rows;
+      for(unsigned first = 0; first < n; first += blockSize) {
+        matrix.ComputeRows(first, first + blockSize, rows);
+        for(unsigned r = 0; r < rows.size(); r++) {
+          cout << titles[first + r];
+          for(unsigned j = 0; j < rows[r].size(); j++)
+            cout << ", " << rows[r][j];
+          cout << "\n";
+        }
+        cout.flush();
+      }
+    } else {
+      vector<double> rmsds; //upper triangle
+      matrix.Compute(rmsds);
+      for(unsigned i = 0; i < n; i++) {
+        cout << titles[i];
+        for(unsigned j = 0; j < n; j++) {
+          double rmsd = 0.0;
+          if(i < j)
+            rmsd = rmsds[i * n - i * (i + 1) / 2 + j - i - 1];
+          else if(j < i)
+            rmsd = rmsds[j * n - j * (j + 1) / 2 + i - j - 1];
+          cout << ", " << rmsd;
+        }
+        cout << "\n";
       }
-      cout << "\n";
     }
 
 	} else {